@@ -105,4 +105,5 @@
 #if JUCE_UNIT_TESTS
  #include "utilities/juce_ADSR_test.cpp"
  #include "midi/ump/juce_UMP_test.cpp"
+ #include "sources/juce_MixerAudioSource_test.cpp"
 #endif
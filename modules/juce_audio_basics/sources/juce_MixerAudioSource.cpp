@@ -23,38 +23,168 @@
 namespace juce
 {
 
+namespace MixerAudioSourceHelpers
+{
+    /*  A linear ramp from an input's gain at the start of a block to its target, which
+        may finish part of the way through the block, written as a function that can be
+        vectorised.
+    */
+    struct GainRamp
+    {
+        float getGain (int sample) const noexcept
+        {
+            return target + delta * jmax (0.0f, 1.0f - (float) (sample + 1) * rate);
+        }
+
+        bool isConstant (float gain) const noexcept
+        {
+            return exactlyEqual (delta, 0.0f) && exactlyEqual (target, gain);
+        }
+
+        float target = 1.0f, delta = 0.0f, rate = 0.0f;
+    };
+
+    /*  Adds a few sources to a destination at once, each with its own gain ramp, so that
+        the destination is only read and written once for all of them.
+    */
+    template <size_t numSources>
+    static void addWithRamps (float* dest, const float* const* sources, const GainRamp* ramps, int numSamples) noexcept
+    {
+        float targets[numSources], deltas[numSources], rates[numSources];
+        const float* src[numSources];
+
+        for (size_t s = 0; s < numSources; ++s)
+        {
+            targets[s] = ramps[s].target;
+            deltas[s]  = ramps[s].delta;
+            rates[s]   = ramps[s].rate;
+            src[s]     = sources[s];
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto sum = dest[i];
+            const auto position = (float) (i + 1);
+
+            for (size_t s = 0; s < numSources; ++s)
+                sum += src[s][i] * (targets[s] + deltas[s] * jmax (0.0f, 1.0f - position * rates[s]));
+
+            dest[i] = sum;
+        }
+    }
+
+    static void addWithRamps (float* dest, const float* const* sources, const GainRamp* ramps, int numSources, int numSamples) noexcept
+    {
+        switch (numSources)
+        {
+            case 1:  addWithRamps<1> (dest, sources, ramps, numSamples); break;
+            case 2:  addWithRamps<2> (dest, sources, ramps, numSamples); break;
+            case 3:  addWithRamps<3> (dest, sources, ramps, numSamples); break;
+            case 4:  addWithRamps<4> (dest, sources, ramps, numSamples); break;
+            default: jassertfalse; break;
+        }
+    }
+}
+
+//==============================================================================
+struct MixerAudioSource::Input final : public ReferenceCountedObject
+{
+    using Ptr = ReferenceCountedObjectPtr<Input>;
+
+    Input (AudioSource* sourceToUse, bool shouldDelete)
+        : source (sourceToUse), deleteWhenRemoved (shouldDelete)
+    {}
+
+    AudioSource* const source;
+    const bool deleteWhenRemoved;
+    std::atomic<float> targetGain { 1.0f };
+
+    // These are only used by the audio thread while the mixer is running
+    AudioBuffer<float> buffer;
+    float currentGain = 1.0f, rampTarget = 1.0f;
+    int numRampSamplesLeft = 0;
+    MixerAudioSourceHelpers::GainRamp blockRamp;
+    bool rendersIntoOutput = false;
+};
+
+//==============================================================================
+class MixerAudioSource::Worker final : public Thread
+{
+public:
+    explicit Worker (MixerAudioSource& mixerToUse)
+        : Thread ("MixerAudioSource worker"), mixer (mixerToUse)
+    {
+        if (! startRealtimeThread (RealtimeOptions{}))
+            startThread (Priority::highest);
+    }
+
+    ~Worker() override
+    {
+        stopThread (-1);
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait (-1);
+
+            if (! threadShouldExit())
+                mixer.renderInputs();
+        }
+    }
+
+private:
+    MixerAudioSource& mixer;
+
+    JUCE_DECLARE_NON_COPYABLE (Worker)
+};
+
+//==============================================================================
 MixerAudioSource::MixerAudioSource()
-   : currentSampleRate (0.0), bufferSizeExpected (0)
+   : inputs (std::make_unique<InputList>()),
+     currentSampleRate (0.0), bufferSizeExpected (0)
 {
+    activeInputs.store (inputs.get());
 }
 
 MixerAudioSource::~MixerAudioSource()
 {
+    workers.clear();
     removeAllInputs();
 }
 
 //==============================================================================
 void MixerAudioSource::addInputSource (AudioSource* input, const bool deleteWhenRemoved)
 {
-    if (input != nullptr && ! inputs.contains (input))
-    {
-        double localRate;
-        int localBufferSize;
+    if (input == nullptr)
+        return;
 
-        {
-            const ScopedLock sl (lock);
-            localRate = currentSampleRate;
-            localBufferSize = bufferSizeExpected;
-        }
-
-        if (localRate > 0.0)
-            input->prepareToPlay (localBufferSize, localRate);
+    double localRate;
+    int localBufferSize;
 
+    {
         const ScopedLock sl (lock);
 
-        inputsToDelete.setBit (inputs.size(), deleteWhenRemoved);
-        inputs.add (input);
+        for (auto* existing : *inputs)
+            if (existing->source == input)
+                return;
+
+        localRate = currentSampleRate;
+        localBufferSize = bufferSizeExpected;
     }
+
+    if (localRate > 0.0)
+        input->prepareToPlay (localBufferSize, localRate);
+
+    const ScopedLock sl (lock);
+
+    Input::Ptr newInput = new Input (input, deleteWhenRemoved);
+    newInput->buffer.setSize (numChannelsExpected.load(), bufferSizeExpected);
+
+    auto newInputs = std::make_unique<InputList> (*inputs);
+    newInputs->add (newInput);
+    publishInputs (std::move (newInputs));
 }
 
 void MixerAudioSource::removeInputSource (AudioSource* const input)
@@ -65,16 +195,17 @@ void MixerAudioSource::removeInputSource (AudioSource* const input)
 
         {
             const ScopedLock sl (lock);
-            const int index = inputs.indexOf (input);
+            auto newInputs = std::make_unique<InputList> (*inputs);
+            const auto index = newInputs->indexOf (findInput (*inputs, input));
 
             if (index < 0)
                 return;
 
-            if (inputsToDelete [index])
+            if (newInputs->getUnchecked (index)->deleteWhenRemoved)
                 toDelete.reset (input);
 
-            inputsToDelete.shiftBits (-1, index);
-            inputs.remove (index);
+            newInputs->remove (index);
+            publishInputs (std::move (newInputs));
         }
 
         input->releaseResources();
@@ -88,38 +219,95 @@ void MixerAudioSource::removeAllInputs()
     {
         const ScopedLock sl (lock);
 
-        for (int i = inputs.size(); --i >= 0;)
-            if (inputsToDelete[i])
-                toDelete.add (inputs.getUnchecked (i));
+        for (int i = inputs->size(); --i >= 0;)
+            if (inputs->getUnchecked (i)->deleteWhenRemoved)
+                toDelete.add (inputs->getUnchecked (i)->source);
 
-        inputs.clear();
+        publishInputs (std::make_unique<InputList>());
     }
 
     for (int i = toDelete.size(); --i >= 0;)
         toDelete.getUnchecked (i)->releaseResources();
 }
 
-void MixerAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+//==============================================================================
+void MixerAudioSource::setInputGain (AudioSource* input, float newGain)
+{
+    if (auto found = findActiveInput (input))
+        found->targetGain.store (newGain);
+}
+
+float MixerAudioSource::getInputGain (AudioSource* input) const
+{
+    if (auto found = findActiveInput (input))
+        return found->targetGain.load();
+
+    return 0.0f;
+}
+
+void MixerAudioSource::setGainRampDuration (double newDurationSeconds)
+{
+    jassert (newDurationSeconds >= 0.0);
+
+    const ScopedLock sl (lock);
+    gainRampDuration = newDurationSeconds;
+    rampLengthSamples = roundToInt (gainRampDuration * currentSampleRate);
+}
+
+//==============================================================================
+void MixerAudioSource::setNumWorkerThreads (int numThreads)
+{
+    jassert (numThreads >= 0);
+
+    std::vector<std::unique_ptr<Worker>> newWorkers;
+
+    for (int i = 0; i < numThreads; ++i)
+        newWorkers.push_back (std::make_unique<Worker> (*this));
+
+    {
+        const ScopedLock sl (workerLock);
+        std::swap (workers, newWorkers);
+    }
+
+    // The old workers finish rendering any inputs that they've already taken before they stop
+    newWorkers.clear();
+}
+
+int MixerAudioSource::getNumWorkerThreads() const noexcept
 {
-    tempBuffer.setSize (2, samplesPerBlockExpected);
+    const ScopedLock sl (workerLock);
+    return (int) workers.size();
+}
 
+//==============================================================================
+void MixerAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
     const ScopedLock sl (lock);
 
     currentSampleRate = sampleRate;
     bufferSizeExpected = samplesPerBlockExpected;
+    rampLengthSamples = roundToInt (gainRampDuration * currentSampleRate);
 
-    for (int i = inputs.size(); --i >= 0;)
-        inputs.getUnchecked (i)->prepareToPlay (samplesPerBlockExpected, sampleRate);
+    for (int i = inputs->size(); --i >= 0;)
+    {
+        auto& input = *inputs->getUnchecked (i);
+        input.source->prepareToPlay (samplesPerBlockExpected, sampleRate);
+        input.buffer.setSize (numChannelsExpected.load(), samplesPerBlockExpected);
+        input.currentGain = input.rampTarget = input.targetGain.load();
+        input.numRampSamplesLeft = 0;
+    }
 }
 
 void MixerAudioSource::releaseResources()
 {
     const ScopedLock sl (lock);
 
-    for (int i = inputs.size(); --i >= 0;)
-        inputs.getUnchecked (i)->releaseResources();
-
-    tempBuffer.setSize (2, 0);
+    for (int i = inputs->size(); --i >= 0;)
+    {
+        auto& input = *inputs->getUnchecked (i);
+        input.source->releaseResources();
+        input.buffer.setSize (2, 0);
+    }
 
     currentSampleRate = 0;
     bufferSizeExpected = 0;
@@ -127,31 +315,191 @@ void MixerAudioSource::releaseResources()
 
 void MixerAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
 {
-    const ScopedLock sl (lock);
+    auto* list = lockInputs();
+    const ScopeGuard unlockInputs { [this] { inputsInUse.store (nullptr); } };
+
+    if (list->isEmpty())
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    const auto numChannels = info.buffer->getNumChannels();
+    const auto rampLength = rampLengthSamples.load (std::memory_order_relaxed);
+
+    // The buffers were allocated for fewer channels than this, so they'll have to grow here,
+    // but they'll be big enough from the next call to prepareToPlay() or addInputSource()
+    if (numChannels > numChannelsExpected.load (std::memory_order_relaxed))
+        numChannelsExpected.store (numChannels);
 
-    if (inputs.size() > 0)
+    for (int i = 0; i < list->size(); ++i)
     {
-        inputs.getUnchecked (0)->getNextAudioBlock (info);
+        auto& input = *list->getUnchecked (i);
+        const auto target = input.targetGain.load (std::memory_order_relaxed);
 
-        if (inputs.size() > 1)
+        if (! exactlyEqual (target, input.rampTarget))
         {
-            tempBuffer.setSize (jmax (1, info.buffer->getNumChannels()),
-                                info.buffer->getNumSamples());
+            input.rampTarget = target;
+            input.numRampSamplesLeft = rampLength;
 
-            AudioSourceChannelInfo info2 (&tempBuffer, 0, info.numSamples);
+            if (rampLength <= 0)
+                input.currentGain = target;
+        }
 
-            for (int i = 1; i < inputs.size(); ++i)
-            {
-                inputs.getUnchecked (i)->getNextAudioBlock (info2);
+        input.blockRamp = { target,
+                            input.currentGain - target,
+                            input.numRampSamplesLeft > 0 ? 1.0f / (float) input.numRampSamplesLeft : 0.0f };
 
-                for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
-                    info.buffer->addFrom (chan, info.startSample, tempBuffer, chan, 0, info.numSamples);
-            }
+        if (input.numRampSamplesLeft > info.numSamples)
+        {
+            input.numRampSamplesLeft -= info.numSamples;
+            input.currentGain = input.blockRamp.getGain (info.numSamples - 1);
+        }
+        else
+        {
+            input.numRampSamplesLeft = 0;
+            input.currentGain = target;
         }
+
+        // Unless its gain is changing, the first input can go straight into the output
+        input.rendersIntoOutput = i == 0 && input.blockRamp.isConstant (1.0f);
+
+        if (! input.rendersIntoOutput)
+            input.buffer.setSize (jmax (1, numChannels), info.numSamples, false, false, true);
     }
-    else
+
+    jobInputs = list;
+    jobInfo = &info;
+    numJobInputsFinished.store (0);
+    jobState.store ((uint64) list->size() << 32);
+
+    if (const ScopedTryLock stl (workerLock); stl.isLocked())
+        for (auto& worker : workers)
+            worker->notify();
+
+    renderInputs();
+
+    // The workers are still rendering the last inputs. They should finish soon, but if one
+    // of them is waiting for this thread's core, spinning would hold it up indefinitely
+    for (int numSpins = 0; numJobInputsFinished.load() < list->size(); ++numSpins)
+        if (numSpins >= 1000)
+            Thread::yield();
+
+    mixInputs (*list, info);
+}
+
+//==============================================================================
+MixerAudioSource::Input* MixerAudioSource::findInput (const InputList& list, AudioSource* source) noexcept
+{
+    for (auto* input : list)
+        if (input->source == source)
+            return input;
+
+    return nullptr;
+}
+
+MixerAudioSource::Input::Ptr MixerAudioSource::findActiveInput (AudioSource* source) const noexcept
+{
+    // publishInputs() won't delete the list while this is counted as reading it, so the lock,
+    // which might be held while publishInputs() waits for the audio thread, isn't needed
+    ++numListReaders;
+    Input::Ptr result = findInput (*activeInputs.load(), source);
+    --numListReaders;
+
+    return result;
+}
+
+MixerAudioSource::InputList* MixerAudioSource::lockInputs() noexcept
+{
+    // Once the list is marked as being in use and is still the active one, it can't be
+    // deleted until it's unmarked
+    for (;;)
     {
+        auto* list = activeInputs.load();
+        inputsInUse.store (list);
+
+        if (activeInputs.load() == list)
+            return list;
+    }
+}
+
+void MixerAudioSource::publishInputs (std::unique_ptr<InputList> newInputs)
+{
+    std::swap (inputs, newInputs);
+    activeInputs.store (inputs.get());
+
+    while (inputsInUse.load() == newInputs.get() || numListReaders.load() > 0)
+        Thread::yield();
+}
+
+void MixerAudioSource::renderInputs() noexcept
+{
+    for (auto state = jobState.load();;)
+    {
+        const auto numInputs = (int) (state >> 32);
+        const auto index = (int) (state & 0xffffffff);
+
+        if (index >= numInputs)
+            return;
+
+        if (! jobState.compare_exchange_weak (state, state + 1))
+            continue;
+
+        auto& input = *jobInputs->getUnchecked (index);
+
+        if (input.rendersIntoOutput)
+        {
+            input.source->getNextAudioBlock (*jobInfo);
+        }
+        else
+        {
+            AudioSourceChannelInfo inputInfo (&input.buffer, 0, jobInfo->numSamples);
+            input.source->getNextAudioBlock (inputInfo);
+        }
+
+        numJobInputsFinished.fetch_add (1);
+        state = jobState.load();
+    }
+}
+
+void MixerAudioSource::mixInputs (const InputList& list, const AudioSourceChannelInfo& info) noexcept
+{
+    constexpr int maxSourcesPerPass = 4;
+
+    auto first = 0;
+
+    if (list.getFirst()->rendersIntoOutput)
+        first = 1;
+    else
         info.clearActiveBufferRegion();
+
+    for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+    {
+        auto* dest = info.buffer->getWritePointer (chan, info.startSample);
+
+        const float* sources[maxSourcesPerPass];
+        MixerAudioSourceHelpers::GainRamp ramps[maxSourcesPerPass];
+        auto numSources = 0;
+
+        for (int i = first; i < list.size(); ++i)
+        {
+            const auto& input = *list.getUnchecked (i);
+
+            if (input.blockRamp.isConstant (0.0f))
+                continue;
+
+            sources[numSources] = input.buffer.getReadPointer (chan);
+            ramps[numSources] = input.blockRamp;
+
+            if (++numSources == maxSourcesPerPass)
+            {
+                MixerAudioSourceHelpers::addWithRamps (dest, sources, ramps, numSources, info.numSamples);
+                numSources = 0;
+            }
+        }
+
+        if (numSources > 0)
+            MixerAudioSourceHelpers::addWithRamps (dest, sources, ramps, numSources, info.numSamples);
     }
 }
 
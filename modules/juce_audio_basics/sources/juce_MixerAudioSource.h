@@ -31,6 +31,17 @@ namespace juce
     prepareToPlay() and releaseResources() methods are called before and after adding
     them to the mixer.
 
+    The audio thread never waits for a lock: the list of inputs is swapped atomically
+    when inputs are added or removed, and removeInputSource() waits until the audio
+    thread has finished with the old list before returning. The buffers that the inputs
+    render into are allocated by prepareToPlay() and addInputSource(), with as many
+    channels as the largest block seen so far, and at least two.
+
+    Each input has a gain, which ramps smoothly to a new value when it's changed. The
+    inputs are summed together in a single pass over the output, rather than one pass
+    per input. With setNumWorkerThreads(), the inputs can also be rendered in parallel
+    on some worker threads, which is worthwhile when they are expensive to render.
+
     @tags{Audio}
 */
 class JUCE_API  MixerAudioSource  : public AudioSource
@@ -69,6 +80,43 @@ public:
     */
     void removeAllInputs();
 
+    //==============================================================================
+    /** Sets the gain applied to one of the inputs.
+
+        The gain ramps to its new value over the time set by setGainRampDuration().
+        This can be called from any thread, including from an input's getNextAudioBlock(),
+        and never waits for a lock.
+    */
+    void setInputGain (AudioSource* input, float newGain);
+
+    /** Returns the gain that an input is set to, or 0 if it isn't one of the inputs. */
+    float getInputGain (AudioSource* input) const;
+
+    /** Sets the time over which the gains of the inputs ramp to a new value.
+        The default is 50 milliseconds.
+    */
+    void setGainRampDuration (double newDurationSeconds);
+
+    //==============================================================================
+    /** Sets the number of threads which render the inputs in parallel with the
+        audio thread.
+
+        With no worker threads, which is the default, all the inputs are rendered one
+        after the other on the audio thread. Otherwise, the audio thread and the
+        workers render the inputs between them, and the audio thread waits for the
+        workers to finish before summing them. This is only worthwhile when the inputs
+        take a significant amount of time to render.
+
+        This can be called while the mixer is running, in which case the audio thread
+        renders any blocks that arrive while the threads are being replaced on its own.
+        Starting and stopping the threads can take a while, though, so it's best not to
+        call this from the audio thread.
+    */
+    void setNumWorkerThreads (int numThreads);
+
+    /** Returns the number of worker threads. */
+    int getNumWorkerThreads() const noexcept;
+
     //==============================================================================
     /** Implementation of the AudioSource method.
         This will call prepareToPlay() on all its input sources.
@@ -86,12 +134,42 @@ public:
 
 private:
     //==============================================================================
-    Array<AudioSource*> inputs;
-    BigInteger inputsToDelete;
+    struct Input;
+    class Worker;
+    using InputList = ReferenceCountedArray<Input>;
+
+    static Input* findInput (const InputList&, AudioSource*) noexcept;
+    ReferenceCountedObjectPtr<Input> findActiveInput (AudioSource*) const noexcept;
+    InputList* lockInputs() noexcept;
+    void publishInputs (std::unique_ptr<InputList>);
+    void renderInputs() noexcept;
+    void mixInputs (const InputList&, const AudioSourceChannelInfo&) noexcept;
+
+    //==============================================================================
+    // The inputs are only changed while holding the lock, and then swapped in for the
+    // audio thread, which marks the list that it's using while it renders. Other threads
+    // that look up an input in the active list count themselves in numListReaders instead.
+    std::unique_ptr<InputList> inputs;
+    std::atomic<InputList*> activeInputs { nullptr }, inputsInUse { nullptr };
+    mutable std::atomic<int> numListReaders { 0 };
     CriticalSection lock;
-    AudioBuffer<float> tempBuffer;
+
+    // The job that the audio thread shares with the workers, with the number of inputs
+    // in the top half of jobState and the index of the next one to render in the bottom half.
+    // The audio thread only tries to take workerLock, so that it never waits for the workers
+    // to be replaced.
+    std::vector<std::unique_ptr<Worker>> workers;
+    CriticalSection workerLock;
+    InputList* jobInputs = nullptr;
+    const AudioSourceChannelInfo* jobInfo = nullptr;
+    std::atomic<uint64> jobState { 0 };
+    std::atomic<int> numJobInputsFinished { 0 };
+
     double currentSampleRate;
     int bufferSizeExpected;
+    std::atomic<int> numChannelsExpected { 2 };
+    double gainRampDuration = 0.05;
+    std::atomic<int> rampLengthSamples { 0 };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixerAudioSource)
 };
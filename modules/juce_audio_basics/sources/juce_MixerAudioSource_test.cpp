@@ -0,0 +1,280 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+class MixerAudioSourceTests final : public UnitTest
+{
+public:
+    MixerAudioSourceTests()  : UnitTest ("MixerAudioSource", UnitTestCategories::audio)  {}
+
+    void runTest() override
+    {
+        beginTest ("Inputs are summed");
+        {
+            MixerAudioSource mixer;
+            mixer.prepareToPlay (64, 44100.0);
+
+            AudioBuffer<float> buffer (2, 64);
+            buffer.setSample (0, 0, 1.0f);
+            mixer.getNextAudioBlock (AudioSourceChannelInfo (buffer));
+            expectEquals (buffer.getMagnitude (0, 64), 0.0f);
+
+            for (auto value : { 1.0f, 2.0f, 3.0f })
+                mixer.addInputSource (new ConstantSource (value), true);
+
+            mixer.getNextAudioBlock (AudioSourceChannelInfo (buffer));
+            expect (isConstant (buffer, 0, 64, 6.0f));
+        }
+
+        beginTest ("Gains ramp to their new values");
+        {
+            MixerAudioSource mixer;
+            ConstantSource source (1.0f);
+            mixer.setGainRampDuration (0.01);
+            mixer.addInputSource (&source, false);
+            mixer.prepareToPlay (20, 1000.0);
+
+            AudioBuffer<float> buffer (1, 20);
+            mixer.getNextAudioBlock (AudioSourceChannelInfo (buffer));
+            expect (isConstant (buffer, 0, 20, 1.0f));
+
+            mixer.setInputGain (&source, 0.5f);
+            expectEquals (mixer.getInputGain (&source), 0.5f);
+
+            // The 10 sample ramp is spread over two blocks
+            AudioBuffer<float> rampBuffer (1, 25);
+            mixer.getNextAudioBlock (AudioSourceChannelInfo (&rampBuffer, 0, 5));
+            mixer.getNextAudioBlock (AudioSourceChannelInfo (&rampBuffer, 5, 20));
+
+            for (int i = 0; i < 10; ++i)
+                expectWithinAbsoluteError (rampBuffer.getSample (0, i), 1.0f - 0.05f * (float) (i + 1), 1.0e-6f);
+
+            expect (isConstant (rampBuffer, 10, 15, 0.5f));
+
+            mixer.setInputGain (&source, 0.0f);
+            mixer.getNextAudioBlock (AudioSourceChannelInfo (buffer));
+            mixer.getNextAudioBlock (AudioSourceChannelInfo (buffer));
+            expect (isConstant (buffer, 0, 20, 0.0f));
+            expectEquals (source.numBlocks, 5);
+
+            mixer.removeAllInputs();
+        }
+
+        beginTest ("Worker threads give the same result as the audio thread");
+        {
+            for (auto numWorkers : { 0, 1, 3 })
+            {
+                MixerAudioSource mixer;
+                mixer.setNumWorkerThreads (numWorkers);
+                expectEquals (mixer.getNumWorkerThreads(), numWorkers);
+
+                std::vector<std::unique_ptr<ConstantSource>> sources;
+
+                for (int i = 0; i < 16; ++i)
+                {
+                    sources.push_back (std::make_unique<ConstantSource> ((float) i));
+                    mixer.addInputSource (sources.back().get(), false);
+                }
+
+                mixer.prepareToPlay (128, 44100.0);
+                AudioBuffer<float> buffer (2, 128);
+                auto allCorrect = true;
+
+                for (int block = 0; block < 100; ++block)
+                {
+                    mixer.getNextAudioBlock (AudioSourceChannelInfo (buffer));
+                    allCorrect &= isConstant (buffer, 0, 128, 120.0f);
+                }
+
+                expect (allCorrect);
+
+                for (auto& source : sources)
+                    expectEquals (source->numBlocks, 100);
+
+                mixer.removeAllInputs();
+            }
+        }
+
+        beginTest ("Inputs can be added and removed while the mixer is running");
+        {
+            MixerAudioSource mixer;
+            mixer.setNumWorkerThreads (2);
+            mixer.prepareToPlay (32, 44100.0);
+
+            std::atomic<bool> finished { false };
+            std::atomic<int> numBlocks { 0 };
+
+            std::thread audioThread ([&]
+            {
+                AudioBuffer<float> buffer (2, 32);
+
+                while (! finished)
+                {
+                    mixer.getNextAudioBlock (AudioSourceChannelInfo (buffer));
+                    ++numBlocks;
+                }
+            });
+
+            // Waits until a whole block has been rendered since this was called
+            const auto waitForNextBlock = [&]
+            {
+                for (const auto target = numBlocks.load() + 2; numBlocks.load() < target;)
+                    Thread::yield();
+            };
+
+            std::vector<ConstantSource*> added;
+            auto random = getRandom();
+
+            waitForNextBlock();
+
+            for (int i = 0; i < 500; ++i)
+            {
+                if (added.empty() || random.nextBool())
+                {
+                    auto* source = new ConstantSource (1.0f);
+                    source->prepareToPlay (32, 44100.0);
+                    mixer.addInputSource (source, true);
+                    added.push_back (source);
+                }
+                else
+                {
+                    const auto index = (size_t) random.nextInt ((int) added.size());
+                    mixer.removeInputSource (added[index]);
+                    added.erase (added.begin() + (int) index);
+                }
+
+                waitForNextBlock();
+            }
+
+            mixer.removeAllInputs();
+
+            finished = true;
+            audioThread.join();
+
+            expectGreaterThan (numBlocks.load(), 0);
+            expectEquals (ConstantSource::numAlive.load(), 0);
+        }
+
+        beginTest ("Gains and worker threads can be changed while inputs are added and removed");
+        {
+            MixerAudioSource mixer;
+            mixer.prepareToPlay (32, 44100.0);
+
+            // This input sets its own gain from the audio thread, which mustn't wait for the
+            // thread that's adding and removing inputs
+            GainChangingSource gainChanger (mixer);
+            mixer.addInputSource (&gainChanger, false);
+
+            std::atomic<bool> finished { false };
+            std::atomic<int> numBlocks { 0 };
+
+            std::thread audioThread ([&]
+            {
+                AudioBuffer<float> buffer (4, 32);
+
+                while (! finished)
+                {
+                    mixer.getNextAudioBlock (AudioSourceChannelInfo (buffer));
+                    ++numBlocks;
+                }
+            });
+
+            for (int i = 0; i < 200; ++i)
+            {
+                if (i % 50 == 0)
+                    mixer.setNumWorkerThreads ((i / 50) % 3);
+
+                auto* source = new ConstantSource (1.0f);
+                mixer.addInputSource (source, true);
+                mixer.removeInputSource (source);
+
+                for (const auto target = numBlocks.load() + 1; numBlocks.load() < target;)
+                    Thread::yield();
+            }
+
+            finished = true;
+            audioThread.join();
+
+            expectEquals (mixer.getInputGain (&gainChanger), 0.5f);
+            expectGreaterOrEqual (gainChanger.numBlocks.load(), 200);
+
+            mixer.removeAllInputs();
+            expectEquals (ConstantSource::numAlive.load(), 0);
+        }
+    }
+
+private:
+    struct ConstantSource final : public AudioSource
+    {
+        explicit ConstantSource (float valueToUse) : value (valueToUse)     { ++numAlive; }
+        ~ConstantSource() override                                         { --numAlive; }
+
+        void prepareToPlay (int, double) override {}
+        void releaseResources() override {}
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+                FloatVectorOperations::fill (info.buffer->getWritePointer (chan, info.startSample), value, info.numSamples);
+
+            ++numBlocks;
+        }
+
+        const float value;
+        int numBlocks = 0;
+        static inline std::atomic<int> numAlive { 0 };
+    };
+
+    struct GainChangingSource final : public AudioSource
+    {
+        explicit GainChangingSource (MixerAudioSource& mixerToUse) : mixer (mixerToUse) {}
+
+        void prepareToPlay (int, double) override {}
+        void releaseResources() override {}
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            mixer.setInputGain (this, 0.5f);
+            info.clearActiveBufferRegion();
+            ++numBlocks;
+        }
+
+        MixerAudioSource& mixer;
+        std::atomic<int> numBlocks { 0 };
+    };
+
+    static bool isConstant (const AudioBuffer<float>& buffer, int start, int numSamples, float expected)
+    {
+        for (int chan = 0; chan < buffer.getNumChannels(); ++chan)
+            for (int i = start; i < start + numSamples; ++i)
+                if (std::abs (buffer.getSample (chan, i) - expected) > 1.0e-5f)
+                    return false;
+
+        return true;
+    }
+};
+
+static MixerAudioSourceTests mixerAudioSourceTests;
+
+} // namespace juce
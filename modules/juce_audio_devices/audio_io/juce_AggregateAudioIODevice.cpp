@@ -0,0 +1,1093 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/*  Carries audio from a callback running on one device's clock to a callback running
+    on another's.
+
+    The producer writes whole blocks into a FIFO. The consumer reads from it through a
+    resampler whose ratio is steered by a PI controller, so that the number of samples
+    in the FIFO stays at a fixed target. The integral term of the controller converges
+    on the ratio between the two clocks, so it doubles as a measurement of their drift.
+
+    The fill level seen by the consumer jumps by a whole block each time the producer
+    writes, so it's refined by adding the samples that the producer's device will have
+    captured since its last write. That keeps the measurement smooth, and means the
+    target only needs to cover one block from each side plus some headroom for jitter.
+*/
+class AggregateAudioIODevice::ClockBridge
+{
+public:
+    struct CallbackTime
+    {
+        uint64 nanoseconds = 0;
+        bool isHostTime = false;
+    };
+
+    static CallbackTime getCallbackTime (const AudioIODeviceCallbackContext& context) noexcept
+    {
+        if (context.hostTimeNs != nullptr)
+            return { *context.hostTimeNs, true };
+
+        return { (uint64) (Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks()) * 1.0e9), false };
+    }
+
+    ClockBridge (int numChannelsIn,
+                 double producerRate,
+                 int producerBlockSize,
+                 double consumerRate,
+                 int consumerBlockSize)
+        : numChannels (numChannelsIn),
+          producerSampleRate (producerRate),
+          producerBlock (producerBlockSize),
+          consumerBlock (consumerBlockSize),
+          nominalRatio (producerRate / consumerRate),
+          callbackPeriod (consumerBlockSize / consumerRate),
+          smoothingCoefficient (1.0 - std::exp (-callbackPeriod / errorSmoothingTime)),
+          proportionalGain (2.0 * damping * naturalFrequency / producerRate),
+          integralGain (naturalFrequency * naturalFrequency / producerRate),
+          maxSamplesPerRead (getNumSamplesNeeded (consumerBlockSize, nominalRatio * (1.0 + maxCorrection))),
+          headroom (jmax (32, roundToInt (producerRate * 0.001))),
+          targetFill (maxSamplesPerRead + producerBlockSize + headroom),
+          fifo (2 * (targetFill + producerBlockSize)),
+          buffer (numChannelsIn, fifo.getTotalSize()),
+          scratch (numChannelsIn, maxSamplesPerRead),
+          interpolators ((size_t) numChannelsIn)
+    {
+        buffer.clear();
+    }
+
+    int getNumChannels() const noexcept             { return numChannels; }
+
+    /** Returns the drift of the producer's clock relative to the consumer's, as a proportion. */
+    double getDrift() const noexcept                { return drift.load(); }
+
+    int getNumDropouts() const noexcept             { return numDropouts.load(); }
+
+    /** Returns the average delay that the bridge adds, in samples at the consumer's rate. */
+    int getLatencyInConsumerSamples() const noexcept
+    {
+        return roundToInt ((producerBlock / 2 + headroom + (double) WindowedSincInterpolator::getBaseLatency()) / nominalRatio);
+    }
+
+    //==============================================================================
+    void write (const float* const* data, int numSamples, CallbackTime time) noexcept
+    {
+        if (fifo.getFreeSpace() < numSamples)
+        {
+            overflowed.store (true);
+            return;
+        }
+
+        const auto scope = fifo.write (numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            buffer.copyFrom (ch, scope.startIndex1, data[ch], scope.blockSize1);
+            buffer.copyFrom (ch, scope.startIndex2, data[ch] + scope.blockSize1, scope.blockSize2);
+        }
+
+        // This must be published before the scope finishes the write, so that the
+        // consumer never sees the new samples alongside the old time
+        lastWriteNanoseconds.store (time.nanoseconds);
+        lastWriteUsedHostTime.store (time.isHostTime);
+    }
+
+    void read (float* const* dest, int numSamples, CallbackTime time) noexcept
+    {
+        if (numSamples > consumerBlock)
+        {
+            // The consumer is using a bigger block than the one it was opened with!
+            jassertfalse;
+            clear (dest, numSamples);
+            return;
+        }
+
+        if (overflowed.exchange (false) && isSynced)
+            loseSync();
+
+        auto fill = getFillLevel (time);
+
+        if (! isSynced)
+        {
+            if (fill < targetFill)
+            {
+                clear (dest, numSamples);
+                return;
+            }
+
+            const auto excess = jmin (fifo.getNumReady(), (int) (fill - targetFill));
+            fifo.finishedRead (excess);
+            fill -= excess;
+
+            for (auto& interpolator : interpolators)
+                interpolator.reset();
+
+            smoothedError = 0.0;
+            isSynced = true;
+        }
+
+        smoothedError += smoothingCoefficient * ((fill - targetFill) - smoothedError);
+        integral = jlimit (-maxCorrection, maxCorrection, integral + integralGain * smoothedError * callbackPeriod);
+        drift.store (integral);
+
+        const auto correction = jlimit (-maxCorrection, maxCorrection, integral + proportionalGain * smoothedError);
+        const auto ratio = nominalRatio * (1.0 + correction);
+        const auto numNeeded = getNumSamplesNeeded (numSamples, ratio);
+
+        if (fifo.getNumReady() < numNeeded)
+        {
+            loseSync();
+            clear (dest, numSamples);
+            return;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (numNeeded, start1, size1, start2, size2);
+
+        int numUsed = 0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            scratch.copyFrom (ch, 0, buffer, ch, start1, size1);
+            scratch.copyFrom (ch, size1, buffer, ch, start2, size2);
+            numUsed = interpolators[(size_t) ch].process (ratio, scratch.getReadPointer (ch), dest[ch], numSamples);
+        }
+
+        fifo.finishedRead (numUsed);
+    }
+
+private:
+    //==============================================================================
+    static constexpr double maxCorrection = 0.005;
+    static constexpr double naturalFrequency = 0.5;
+    static constexpr double damping = 0.7;
+    static constexpr double errorSmoothingTime = 0.1;
+
+    static int getNumSamplesNeeded (int numOutputSamples, double ratio) noexcept
+    {
+        // The interpolator's position is always less than one sample past the last input
+        // that it consumed, so this is an upper bound on the number that it'll use
+        return (int) std::ceil (numOutputSamples * ratio) + 1;
+    }
+
+    double getFillLevel (CallbackTime time) const noexcept
+    {
+        // The time is read after the number of samples, so that new samples are never paired
+        // with the time of the write before them
+        const auto numReady = (double) fifo.getNumReady();
+        const auto writeTime = lastWriteNanoseconds.load();
+        const auto writeUsedHostTime = lastWriteUsedHostTime.load();
+
+        if (writeTime == 0 || writeUsedHostTime != time.isHostTime || time.nanoseconds <= writeTime)
+            return numReady;
+
+        const auto elapsed = (double) (time.nanoseconds - writeTime) * 1.0e-9;
+        return numReady + jmin ((double) producerBlock, elapsed * producerSampleRate);
+    }
+
+    void loseSync() noexcept
+    {
+        isSynced = false;
+        numDropouts.fetch_add (1);
+    }
+
+    void clear (float* const* dest, int numSamples) const noexcept
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            FloatVectorOperations::clear (dest[ch], numSamples);
+    }
+
+    //==============================================================================
+    const int numChannels;
+    const double producerSampleRate;
+    const int producerBlock, consumerBlock;
+    const double nominalRatio, callbackPeriod, smoothingCoefficient, proportionalGain, integralGain;
+    const int maxSamplesPerRead, headroom, targetFill;
+
+    AbstractFifo fifo;
+    AudioBuffer<float> buffer, scratch;
+    std::vector<WindowedSincInterpolator> interpolators;
+
+    std::atomic<uint64> lastWriteNanoseconds { 0 };
+    std::atomic<bool> lastWriteUsedHostTime { false }, overflowed { false };
+    std::atomic<double> drift { 0.0 };
+    std::atomic<int> numDropouts { 0 };
+
+    // Only used by the consumer
+    bool isSynced = false;
+    double smoothedError = 0.0, integral = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE (ClockBridge)
+};
+
+//==============================================================================
+class AggregateAudioIODevice::Member final : public AudioIODeviceCallback
+{
+public:
+    Member (AggregateAudioIODevice& ownerIn, std::unique_ptr<AudioIODevice> deviceIn)
+        : owner (ownerIn), device (std::move (deviceIn))
+    {
+        jassert (device != nullptr);
+    }
+
+    void audioDeviceIOCallbackWithContext (const float* const* inputs,
+                                           int numInputs,
+                                           float* const* outputs,
+                                           int numOutputs,
+                                           int numSamples,
+                                           const AudioIODeviceCallbackContext& context) override
+    {
+        const auto time = ClockBridge::getCallbackTime (context);
+
+        if (inputBridge != nullptr && numInputs == inputBridge->getNumChannels())
+            inputBridge->write (inputs, numSamples, time);
+
+        if (outputBridge != nullptr && numOutputs == outputBridge->getNumChannels())
+        {
+            outputBridge->read (outputs, numSamples, time);
+        }
+        else
+        {
+            for (int ch = 0; ch < numOutputs; ++ch)
+                FloatVectorOperations::clear (outputs[ch], numSamples);
+        }
+    }
+
+    void audioDeviceAboutToStart (AudioIODevice*) override {}
+    void audioDeviceStopped() override {}
+
+    void audioDeviceError (const String& errorMessage) override
+    {
+        owner.audioDeviceError (device->getName() + ": " + errorMessage);
+    }
+
+    AggregateAudioIODevice& owner;
+    const std::unique_ptr<AudioIODevice> device;
+
+    int firstInputChannel = 0, firstOutputChannel = 0;
+    bool isInUse = false;
+    std::unique_ptr<ClockBridge> inputBridge, outputBridge;
+
+    JUCE_DECLARE_NON_COPYABLE (Member)
+};
+
+//==============================================================================
+AggregateAudioIODevice::AggregateAudioIODevice (const String& deviceName,
+                                                const String& typeNameIn,
+                                                std::vector<std::unique_ptr<AudioIODevice>> devicesToCombine)
+    : AudioIODevice (deviceName, typeNameIn)
+{
+    // There needs to be at least one device to act as the clock master!
+    jassert (! devicesToCombine.empty());
+
+    int numInputs = 0, numOutputs = 0;
+
+    for (auto& d : devicesToCombine)
+    {
+        auto member = std::make_unique<Member> (*this, std::move (d));
+        member->firstInputChannel = numInputs;
+        member->firstOutputChannel = numOutputs;
+
+        numInputs += member->device->getInputChannelNames().size();
+        numOutputs += member->device->getOutputChannelNames().size();
+
+        members.push_back (std::move (member));
+    }
+}
+
+AggregateAudioIODevice::~AggregateAudioIODevice()
+{
+    close();
+}
+
+int AggregateAudioIODevice::getNumDevices() const noexcept
+{
+    return (int) members.size();
+}
+
+AudioIODevice* AggregateAudioIODevice::getDevice (int index) const noexcept
+{
+    return isPositiveAndBelow (index, members.size()) ? members[(size_t) index]->device.get() : nullptr;
+}
+
+double AggregateAudioIODevice::getClockDrift (int index) const noexcept
+{
+    if (! isPositiveAndBelow (index, members.size()))
+        return 0.0;
+
+    const auto& m = *members[(size_t) index];
+
+    // The output bridge runs the other way, so its drift is the master's relative to this device
+    if (m.inputBridge != nullptr)
+        return m.inputBridge->getDrift() * 1.0e6;
+
+    if (m.outputBridge != nullptr)
+        return -m.outputBridge->getDrift() * 1.0e6;
+
+    return 0.0;
+}
+
+//==============================================================================
+StringArray AggregateAudioIODevice::getOutputChannelNames()
+{
+    StringArray result;
+
+    for (auto& m : members)
+        for (auto& channelName : m->device->getOutputChannelNames())
+            result.add (m->device->getName() + ": " + channelName);
+
+    return result;
+}
+
+StringArray AggregateAudioIODevice::getInputChannelNames()
+{
+    StringArray result;
+
+    for (auto& m : members)
+        for (auto& channelName : m->device->getInputChannelNames())
+            result.add (m->device->getName() + ": " + channelName);
+
+    return result;
+}
+
+Array<double> AggregateAudioIODevice::getAvailableSampleRates()   { return members.front()->device->getAvailableSampleRates(); }
+Array<int> AggregateAudioIODevice::getAvailableBufferSizes()      { return members.front()->device->getAvailableBufferSizes(); }
+int AggregateAudioIODevice::getDefaultBufferSize()                { return members.front()->device->getDefaultBufferSize(); }
+
+//==============================================================================
+template <typename Value>
+static std::optional<Value> getClosestAvailable (const Array<Value>& available, Value target)
+{
+    std::optional<Value> result;
+
+    for (auto value : available)
+        if (! result.has_value() || std::abs (value - target) < std::abs (*result - target))
+            result = value;
+
+    return result;
+}
+
+String AggregateAudioIODevice::open (const BigInteger& inputChannels,
+                                     const BigInteger& outputChannels,
+                                     double sampleRate,
+                                     int bufferSizeSamples)
+{
+    close();
+    lastError.clear();
+
+    auto& master = *members.front()->device;
+    double masterRate = 0.0;
+    int masterBlock = 0;
+
+    for (auto& m : members)
+    {
+        auto& d = *m->device;
+        const auto inputs  = inputChannels .getBitRange (m->firstInputChannel,  d.getInputChannelNames().size());
+        const auto outputs = outputChannels.getBitRange (m->firstOutputChannel, d.getOutputChannelNames().size());
+
+        if (&d == &master)
+        {
+            lastError = d.open (inputs, outputs, sampleRate, bufferSizeSamples);
+            masterRate = d.getCurrentSampleRate();
+            masterBlock = d.getCurrentBufferSizeSamples();
+        }
+        else if (! (inputs.isZero() && outputs.isZero()))
+        {
+            const auto rate = getClosestAvailable (d.getAvailableSampleRates(), masterRate).value_or (masterRate);
+            const auto block = getClosestAvailable (d.getAvailableBufferSizes(), roundToInt (masterBlock * rate / masterRate))
+                                   .value_or (d.getDefaultBufferSize());
+
+            lastError = d.open (inputs, outputs, rate, block);
+        }
+        else
+        {
+            continue;
+        }
+
+        if (lastError.isNotEmpty())
+        {
+            const auto error = d.getName() + ": " + lastError;
+            close();
+            lastError = error;
+            return lastError;
+        }
+
+        m->isInUse = true;
+    }
+
+    prepareStreams();
+    return {};
+}
+
+void AggregateAudioIODevice::prepareStreams()
+{
+    auto& master = *members.front()->device;
+    const auto masterRate = master.getCurrentSampleRate();
+    const auto masterBlock = master.getCurrentBufferSizeSamples();
+
+    numMasterInputs  = master.getActiveInputChannels() .countNumberOfSetBits();
+    numMasterOutputs = master.getActiveOutputChannels().countNumberOfSetBits();
+
+    int numSecondaryInputs = 0, numSecondaryOutputs = 0;
+
+    for (auto& m : members)
+    {
+        if (m == members.front() || ! m->isInUse)
+            continue;
+
+        auto& d = *m->device;
+        const auto rate = d.getCurrentSampleRate();
+        const auto block = d.getCurrentBufferSizeSamples();
+        const auto numInputs  = d.getActiveInputChannels() .countNumberOfSetBits();
+        const auto numOutputs = d.getActiveOutputChannels().countNumberOfSetBits();
+
+        if (numInputs > 0)
+            m->inputBridge = std::make_unique<ClockBridge> (numInputs, rate, block, masterRate, masterBlock);
+
+        if (numOutputs > 0)
+            m->outputBridge = std::make_unique<ClockBridge> (numOutputs, masterRate, masterBlock, rate, block);
+
+        numSecondaryInputs += numInputs;
+        numSecondaryOutputs += numOutputs;
+    }
+
+    secondaryChannels.setSize (numSecondaryInputs + numSecondaryOutputs, masterBlock);
+    secondaryChannels.clear();
+
+    inputPointers.assign ((size_t) (numMasterInputs + numSecondaryInputs), nullptr);
+    outputPointers.assign ((size_t) (numMasterOutputs + numSecondaryOutputs), nullptr);
+
+    for (int i = 0; i < numSecondaryInputs; ++i)
+        inputPointers[(size_t) (numMasterInputs + i)] = secondaryChannels.getWritePointer (i);
+
+    for (int i = 0; i < numSecondaryOutputs; ++i)
+        outputPointers[(size_t) (numMasterOutputs + i)] = secondaryChannels.getWritePointer (numSecondaryInputs + i);
+}
+
+void AggregateAudioIODevice::close()
+{
+    stop();
+
+    for (auto& m : members)
+    {
+        if (m->isInUse)
+            m->device->close();
+
+        m->isInUse = false;
+        m->inputBridge.reset();
+        m->outputBridge.reset();
+    }
+}
+
+bool AggregateAudioIODevice::isOpen()
+{
+    return members.front()->device->isOpen();
+}
+
+//==============================================================================
+void AggregateAudioIODevice::start (AudioIODeviceCallback* newCallback)
+{
+    if (newCallback == nullptr || ! isOpen())
+        return;
+
+    stop();
+
+    // The secondary devices are started first, so that their FIFOs are filling up by
+    // the time the master starts asking for audio
+    for (auto& m : members)
+        if (m != members.front() && m->isInUse)
+            m->device->start (m.get());
+
+    {
+        const ScopedLock sl (callbackLock);
+        callback = newCallback;
+    }
+
+    members.front()->device->start (this);
+}
+
+void AggregateAudioIODevice::stop()
+{
+    members.front()->device->stop();
+
+    for (auto& m : members)
+        if (m != members.front() && m->isInUse)
+            m->device->stop();
+
+    const ScopedLock sl (callbackLock);
+    callback = nullptr;
+}
+
+bool AggregateAudioIODevice::isPlaying()
+{
+    const ScopedLock sl (callbackLock);
+    return callback != nullptr && members.front()->device->isPlaying();
+}
+
+String AggregateAudioIODevice::getLastError()                           { return lastError; }
+
+int AggregateAudioIODevice::getCurrentBufferSizeSamples()               { return members.front()->device->getCurrentBufferSizeSamples(); }
+double AggregateAudioIODevice::getCurrentSampleRate()                   { return members.front()->device->getCurrentSampleRate(); }
+int AggregateAudioIODevice::getCurrentBitDepth()                        { return members.front()->device->getCurrentBitDepth(); }
+
+BigInteger AggregateAudioIODevice::getActiveOutputChannels() const
+{
+    BigInteger result;
+
+    for (auto& m : members)
+        if (m->isInUse)
+            result |= (m->device->getActiveOutputChannels() << m->firstOutputChannel);
+
+    return result;
+}
+
+BigInteger AggregateAudioIODevice::getActiveInputChannels() const
+{
+    BigInteger result;
+
+    for (auto& m : members)
+        if (m->isInUse)
+            result |= (m->device->getActiveInputChannels() << m->firstInputChannel);
+
+    return result;
+}
+
+int AggregateAudioIODevice::getOutputLatencyInSamples()
+{
+    auto& master = *members.front()->device;
+    auto latency = master.getOutputLatencyInSamples();
+
+    for (auto& m : members)
+    {
+        if (m->outputBridge == nullptr)
+            continue;
+
+        // The bridge's delay is in the secondary device's samples
+        const auto rateRatio = master.getCurrentSampleRate() / m->device->getCurrentSampleRate();
+        const auto deviceLatency = m->device->getOutputLatencyInSamples() + m->outputBridge->getLatencyInConsumerSamples();
+        latency = jmax (latency, roundToInt (deviceLatency * rateRatio));
+    }
+
+    return latency;
+}
+
+int AggregateAudioIODevice::getInputLatencyInSamples()
+{
+    auto& master = *members.front()->device;
+    auto latency = master.getInputLatencyInSamples();
+
+    for (auto& m : members)
+    {
+        if (m->inputBridge == nullptr)
+            continue;
+
+        const auto rateRatio = master.getCurrentSampleRate() / m->device->getCurrentSampleRate();
+        latency = jmax (latency, roundToInt (m->device->getInputLatencyInSamples() * rateRatio) + m->inputBridge->getLatencyInConsumerSamples());
+    }
+
+    return latency;
+}
+
+int AggregateAudioIODevice::getXRunCount() const noexcept
+{
+    auto result = 0;
+
+    for (auto& m : members)
+    {
+        if (! m->isInUse)
+            continue;
+
+        result += jmax (0, m->device->getXRunCount());
+
+        for (auto* bridge : { m->inputBridge.get(), m->outputBridge.get() })
+            if (bridge != nullptr)
+                result += bridge->getNumDropouts();
+    }
+
+    return result;
+}
+
+//==============================================================================
+void AggregateAudioIODevice::audioDeviceIOCallbackWithContext (const float* const* inputs,
+                                                               int numInputs,
+                                                               float* const* outputs,
+                                                               int numOutputs,
+                                                               int numSamples,
+                                                               const AudioIODeviceCallbackContext& context)
+{
+    if (numSamples > secondaryChannels.getNumSamples() || numInputs != numMasterInputs || numOutputs != numMasterOutputs)
+    {
+        // The master device isn't doing what it said it would when it was opened!
+        jassertfalse;
+
+        for (int ch = 0; ch < numOutputs; ++ch)
+            FloatVectorOperations::clear (outputs[ch], numSamples);
+
+        return;
+    }
+
+    const auto time = ClockBridge::getCallbackTime (context);
+
+    std::copy (inputs, inputs + numInputs, inputPointers.begin());
+    std::copy (outputs, outputs + numOutputs, outputPointers.begin());
+
+    auto* secondaryInputs  = secondaryChannels.getArrayOfWritePointers();
+    auto* secondaryOutputs = outputPointers.data() + numMasterOutputs;
+
+    for (auto& m : members)
+    {
+        if (m->inputBridge != nullptr)
+        {
+            m->inputBridge->read (secondaryInputs, numSamples, time);
+            secondaryInputs += m->inputBridge->getNumChannels();
+        }
+    }
+
+    for (auto* output = secondaryOutputs; output != outputPointers.data() + outputPointers.size(); ++output)
+        FloatVectorOperations::clear (*output, numSamples);
+
+    callback->audioDeviceIOCallbackWithContext (inputPointers.data(), (int) inputPointers.size(),
+                                                outputPointers.data(), (int) outputPointers.size(),
+                                                numSamples, context);
+
+    for (auto& m : members)
+    {
+        if (m->outputBridge != nullptr)
+        {
+            m->outputBridge->write (secondaryOutputs, numSamples, time);
+            secondaryOutputs += m->outputBridge->getNumChannels();
+        }
+    }
+}
+
+void AggregateAudioIODevice::audioDeviceAboutToStart (AudioIODevice*)
+{
+    const ScopedLock sl (callbackLock);
+
+    if (callback != nullptr)
+        callback->audioDeviceAboutToStart (this);
+}
+
+void AggregateAudioIODevice::audioDeviceStopped()
+{
+    const ScopedLock sl (callbackLock);
+
+    if (callback != nullptr)
+        callback->audioDeviceStopped();
+}
+
+void AggregateAudioIODevice::audioDeviceError (const String& errorMessage)
+{
+    const ScopedLock sl (callbackLock);
+
+    if (callback != nullptr)
+        callback->audioDeviceError (errorMessage);
+}
+
+//==============================================================================
+AggregateAudioIODeviceType::AggregateAudioIODeviceType (std::unique_ptr<AudioIODeviceType> typeToCombine)
+    : AudioIODeviceType (typeToCombine->getTypeName() + " Aggregate"),
+      combinedType (std::move (typeToCombine))
+{
+    combinedType->addListener (this);
+}
+
+AggregateAudioIODeviceType::~AggregateAudioIODeviceType()
+{
+    combinedType->removeListener (this);
+}
+
+void AggregateAudioIODeviceType::addAggregateDevice (const String& aggregateName, const StringArray& deviceNames)
+{
+    // An aggregate needs at least one device in it!
+    jassert (! deviceNames.isEmpty());
+
+    const auto index = aggregateNames.indexOf (aggregateName);
+
+    if (index >= 0)
+    {
+        aggregateDevices.set (index, deviceNames);
+    }
+    else
+    {
+        aggregateNames.add (aggregateName);
+        aggregateDevices.add (deviceNames);
+    }
+
+    callDeviceChangeListeners();
+}
+
+void AggregateAudioIODeviceType::removeAggregateDevice (const String& aggregateName)
+{
+    const auto index = aggregateNames.indexOf (aggregateName);
+
+    if (index < 0)
+        return;
+
+    aggregateNames.remove (index);
+    aggregateDevices.remove (index);
+
+    callDeviceChangeListeners();
+}
+
+StringArray AggregateAudioIODeviceType::getDevicesInAggregate (const String& aggregateName) const
+{
+    return aggregateDevices[aggregateNames.indexOf (aggregateName)];
+}
+
+void AggregateAudioIODeviceType::scanForDevices()
+{
+    combinedType->scanForDevices();
+}
+
+StringArray AggregateAudioIODeviceType::getDeviceNames (bool) const
+{
+    return aggregateNames;
+}
+
+int AggregateAudioIODeviceType::getDefaultDeviceIndex (bool) const
+{
+    return aggregateNames.isEmpty() ? -1 : 0;
+}
+
+int AggregateAudioIODeviceType::getIndexOfDevice (AudioIODevice* device, bool) const
+{
+    if (dynamic_cast<AggregateAudioIODevice*> (device) == nullptr)
+        return -1;
+
+    return aggregateNames.indexOf (device->getName());
+}
+
+bool AggregateAudioIODeviceType::hasSeparateInputsAndOutputs() const
+{
+    return false;
+}
+
+AudioIODevice* AggregateAudioIODeviceType::createDevice (const String& outputDeviceName, const String& inputDeviceName)
+{
+    const auto aggregateName = outputDeviceName.isNotEmpty() ? outputDeviceName : inputDeviceName;
+    const auto index = aggregateNames.indexOf (aggregateName);
+
+    if (index < 0)
+        return nullptr;
+
+    std::vector<std::unique_ptr<AudioIODevice>> devices;
+
+    for (auto& deviceName : aggregateDevices.getReference (index))
+    {
+        std::unique_ptr<AudioIODevice> device (combinedType->createDevice (deviceName, deviceName));
+
+        if (device == nullptr)
+            return nullptr;
+
+        devices.push_back (std::move (device));
+    }
+
+    if (devices.empty())
+        return nullptr;
+
+    return new AggregateAudioIODevice (aggregateName, getTypeName(), std::move (devices));
+}
+
+void AggregateAudioIODeviceType::audioDeviceListChanged()
+{
+    callDeviceChangeListeners();
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AggregateAudioIODeviceTests final : public UnitTest
+{
+public:
+    AggregateAudioIODeviceTests() : UnitTest ("AggregateAudioIODevice", UnitTestCategories::audio) {}
+
+    void runTest() override
+    {
+        beginTest ("The channels of all the devices are combined, and secondary devices are only opened when they're used");
+        {
+            AggregateAudioIODevice device ("aggregate", "test", makeDevices ({ { 44100.0 } }));
+
+            expect (device.getInputChannelNames()  == StringArray { "master: i1", "master: i2", "secondary: i1", "secondary: i2" });
+            expect (device.getOutputChannelNames() == StringArray { "master: o1", "master: o2", "secondary: o1", "secondary: o2" });
+
+            expect (device.open (makeChannels ({ 1 }), makeChannels ({ 0 }), 48000.0, 256).isEmpty());
+            expect (device.getDevice (0)->isOpen());
+            expect (! device.getDevice (1)->isOpen());
+            expect (device.getActiveInputChannels() == makeChannels ({ 1 }));
+
+            expect (device.open (makeChannels ({ 0, 3 }), makeChannels ({ 1, 2 }), 48000.0, 256).isEmpty());
+            expect (device.getDevice (1)->isOpen());
+            expect (device.getActiveInputChannels()  == makeChannels ({ 0, 3 }));
+            expect (device.getActiveOutputChannels() == makeChannels ({ 1, 2 }));
+            expect (device.getDevice (1)->getActiveInputChannels() == makeChannels ({ 1 }));
+
+            // The secondary device doesn't support the master's rate
+            expectEquals (device.getDevice (1)->getCurrentSampleRate(), 44100.0);
+
+            device.close();
+            expect (! device.getDevice (0)->isOpen());
+            expect (! device.getDevice (1)->isOpen());
+        }
+
+        beginTest ("Audio passes to and from secondary devices with drifting clocks and different rates, and the drift is measured");
+        {
+            struct Secondary
+            {
+                double drift, sampleRate, inputFrequency;
+                MockDevice* device = nullptr;
+                double time = 0.0;
+                int64 position = 0;
+                std::vector<float> received;
+            };
+
+            Secondary secondaries[] { { 200.0e-6, 48000.0, 0.01, {}, {}, {}, {} },
+                                     { -150.0e-6, 44100.0, 0.012, {}, {}, {}, {} } };
+            constexpr auto outputFrequency = 0.01;
+            constexpr auto lastOutputToSecondTime = 15.0;
+
+            AggregateAudioIODevice device ("aggregate", "test", makeDevices ({ { 48000.0 }, { 44100.0 } }));
+            expect (device.open (makeChannels ({ 0, 2, 4 }), makeChannels ({ 0, 2, 4 }), 48000.0, 256).isEmpty());
+
+            auto& master = dynamic_cast<MockDevice&> (*device.getDevice (0));
+
+            for (auto [index, secondary] : enumerate (secondaries, 1))
+            {
+                secondary.device = &dynamic_cast<MockDevice&> (*device.getDevice ((int) index));
+                secondary.time = 0.0013 * (double) index;
+                expectEquals (secondary.device->getCurrentSampleRate(), secondary.sampleRate);
+            }
+
+            std::vector<float> receivedFromFirst, receivedFromSecond;
+            auto masterTime = 0.0;
+            int64 masterPosition = 0;
+
+            MockCallback callback;
+            callback.onBlock = [&] (const float* const* inputs, float* const* outputs, int numSamples)
+            {
+                receivedFromFirst .insert (receivedFromFirst .end(), inputs[1], inputs[1] + numSamples);
+                receivedFromSecond.insert (receivedFromSecond.end(), inputs[2], inputs[2] + numSamples);
+
+                // After a while, stop writing to the second device's output, which should
+                // then fall silent rather than repeating whatever was last written
+                const auto numOutputs = masterTime < lastOutputToSecondTime ? 2 : 1;
+
+                for (int i = 0; i < numSamples; ++i, ++masterPosition)
+                    for (int output = 1; output <= numOutputs; ++output)
+                        outputs[output][i] = (float) std::sin (MathConstants<double>::twoPi * outputFrequency * (double) masterPosition);
+            };
+
+            device.start (&callback);
+            expect (device.isPlaying());
+
+            AudioBuffer<float> inputs (1, 256), outputs (1, 256);
+
+            while (masterTime < 30.0)
+            {
+                auto& next = *std::min_element (std::begin (secondaries), std::end (secondaries),
+                                                [] (const auto& a, const auto& b) { return a.time < b.time; });
+
+                if (next.time < masterTime)
+                {
+                    for (int i = 0; i < 128; ++i)
+                        inputs.setSample (0, i, (float) std::sin (MathConstants<double>::twoPi * next.inputFrequency * (double) next.position++));
+
+                    next.device->process (inputs, outputs, next.time);
+                    next.received.insert (next.received.end(), outputs.getReadPointer (0), outputs.getReadPointer (0) + 128);
+                    next.time += 128.0 / (next.sampleRate * (1.0 + next.drift));
+                }
+                else
+                {
+                    inputs.clear();
+                    master.process (inputs, outputs, masterTime);
+                    masterTime += 256.0 / 48000.0;
+                }
+            }
+
+            device.stop();
+            expect (! device.isPlaying());
+
+            expectWithinAbsoluteError (device.getClockDrift (1), secondaries[0].drift * 1.0e6, 5.0);
+            expectWithinAbsoluteError (device.getClockDrift (2), secondaries[1].drift * 1.0e6, 5.0);
+            expectEquals (device.getXRunCount(), 0);
+
+            // Once the first couple of seconds have passed, each sine wave should be smooth
+            // and at full level. The largest step between samples depends on the frequency
+            // of the sine relative to the rate at which it's received.
+            const auto expectSmoothSine = [this] (const std::vector<float>& received, double sampleRate, double endTime, double frequency)
+            {
+                const auto start = received.begin() + (int) (2.0 * sampleRate);
+                const auto end   = received.begin() + jmin ((int) received.size(), (int) (endTime * sampleRate));
+                auto largestStep = 0.0f, largestLevel = 0.0f;
+
+                for (auto it = std::next (start); it != end; ++it)
+                {
+                    largestStep = jmax (largestStep, std::abs (*it - *std::prev (it)));
+                    largestLevel = jmax (largestLevel, std::abs (*it));
+                }
+
+                expectLessThan (largestStep, (float) (MathConstants<double>::twoPi * frequency * 1.01));
+                expectGreaterThan (largestLevel, 0.95f);
+            };
+
+            expectSmoothSine (receivedFromFirst,  48000.0, 30.0, secondaries[0].inputFrequency);
+            expectSmoothSine (receivedFromSecond, 48000.0, 30.0, secondaries[1].inputFrequency * 44100.0 / 48000.0);
+            expectSmoothSine (secondaries[0].received, 48000.0, 30.0, outputFrequency);
+            expectSmoothSine (secondaries[1].received, 44100.0, lastOutputToSecondTime - 1.0, outputFrequency * 48000.0 / 44100.0);
+
+            const auto& silent = secondaries[1].received;
+            const auto silentStart = silent.begin() + (int) ((lastOutputToSecondTime + 1.0) * 44100.0);
+            expectEquals (FloatVectorOperations::findMaximum (&*silentStart, (int) std::distance (silentStart, silent.end())), 0.0f);
+            expectEquals (FloatVectorOperations::findMinimum (&*silentStart, (int) std::distance (silentStart, silent.end())), 0.0f);
+
+            // The secondary devices' audio shouldn't be delayed by a whole extra buffer
+            expectGreaterThan (device.getInputLatencyInSamples(), 0);
+            expectLessThan (device.getInputLatencyInSamples(),
+                            256 + (int) WindowedSincInterpolator::getBaseLatency());
+        }
+    }
+
+private:
+    class MockDevice final : public AudioIODevice
+    {
+    public:
+        MockDevice (const String& deviceName, Array<double> ratesIn, int blockSizeIn)
+            : AudioIODevice (deviceName, "test"), rates (std::move (ratesIn)), defaultBlockSize (blockSizeIn) {}
+
+        StringArray getOutputChannelNames() override        { return { "o1", "o2" }; }
+        StringArray getInputChannelNames() override         { return { "i1", "i2" }; }
+        Array<double> getAvailableSampleRates() override    { return rates; }
+        Array<int> getAvailableBufferSizes() override       { return { defaultBlockSize }; }
+        int getDefaultBufferSize() override                 { return defaultBlockSize; }
+
+        String open (const BigInteger& inputs, const BigInteger& outputs, double sr, int bs) override
+        {
+            inChannels = inputs;
+            outChannels = outputs;
+            sampleRate = sr;
+            blockSize = bs;
+            on = true;
+            return {};
+        }
+
+        void close() override                               { on = false; }
+        bool isOpen() override                              { return on; }
+
+        void start (AudioIODeviceCallback* c) override
+        {
+            callback = c;
+            callback->audioDeviceAboutToStart (this);
+        }
+
+        void stop() override
+        {
+            if (callback != nullptr)
+                callback->audioDeviceStopped();
+
+            callback = nullptr;
+        }
+
+        bool isPlaying() override                           { return callback != nullptr; }
+
+        void process (const AudioBuffer<float>& inputs, AudioBuffer<float>& outputs, double time)
+        {
+            const auto hostTime = (uint64_t) ((time + 1.0) * 1.0e9);
+            AudioIODeviceCallbackContext context;
+            context.hostTimeNs = &hostTime;
+
+            callback->audioDeviceIOCallbackWithContext (inputs.getArrayOfReadPointers(), inChannels.countNumberOfSetBits(),
+                                                        outputs.getArrayOfWritePointers(), outChannels.countNumberOfSetBits(),
+                                                        blockSize, context);
+        }
+
+        String getLastError() override                      { return {}; }
+        int getCurrentBufferSizeSamples() override          { return blockSize; }
+        double getCurrentSampleRate() override              { return sampleRate; }
+        int getCurrentBitDepth() override                   { return 32; }
+
+        BigInteger getActiveOutputChannels() const override { return outChannels; }
+        BigInteger getActiveInputChannels() const override  { return inChannels; }
+
+        int getOutputLatencyInSamples() override            { return 0; }
+        int getInputLatencyInSamples() override             { return 0; }
+
+    private:
+        const Array<double> rates;
+        const int defaultBlockSize;
+        AudioIODeviceCallback* callback = nullptr;
+        BigInteger inChannels, outChannels;
+        double sampleRate = 0.0;
+        int blockSize = 0;
+        bool on = false;
+    };
+
+    class MockCallback final : public AudioIODeviceCallback
+    {
+    public:
+        std::function<void (const float* const*, float* const*, int)> onBlock;
+
+        void audioDeviceIOCallbackWithContext (const float* const* inputs,
+                                               int,
+                                               float* const* outputs,
+                                               int,
+                                               int numSamples,
+                                               const AudioIODeviceCallbackContext&) override
+        {
+            NullCheckedInvocation::invoke (onBlock, inputs, outputs, numSamples);
+        }
+
+        void audioDeviceAboutToStart (AudioIODevice*) override {}
+        void audioDeviceStopped() override {}
+    };
+
+    static std::vector<std::unique_ptr<AudioIODevice>> makeDevices (std::initializer_list<Array<double>> secondaryRates)
+    {
+        std::vector<std::unique_ptr<AudioIODevice>> devices;
+        devices.push_back (std::make_unique<MockDevice> ("master", Array<double> { 44100.0, 48000.0 }, 256));
+
+        for (const auto& rates : secondaryRates)
+            devices.push_back (std::make_unique<MockDevice> (devices.size() == 1 ? String ("secondary") : "secondary " + String (devices.size()),
+                                                             rates, 128));
+
+        return devices;
+    }
+
+    static BigInteger makeChannels (std::initializer_list<int> channels)
+    {
+        BigInteger result;
+
+        for (auto channel : channels)
+            result.setBit (channel);
+
+        return result;
+    }
+};
+
+static AggregateAudioIODeviceTests aggregateAudioIODeviceTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    An AudioIODevice that combines several other devices, so that they can be
+    used together as though they were a single device.
+
+    The channels of all the devices are presented in a single callback: the input
+    and output channels of the first device come first, followed by those of the
+    second device, and so on.
+
+    The first device is the clock master, and its audio thread drives the callback.
+    Every other device runs on its own clock, which will never run at quite the same
+    rate as the master's. The audio for each of these devices passes through a small
+    FIFO, and the rate of a windowed-sinc resampler is continuously adjusted to keep
+    that FIFO at a constant fill level. The FIFOs are kept only as full as the
+    devices' block sizes require (plus a little headroom for scheduling jitter), so
+    on average a secondary device's audio is delayed by around half of its block,
+    rather than by a whole extra buffer.
+
+    The secondary devices may run at a different sample rate to the master; if
+    a device can't be opened at the master's rate, its closest available rate is
+    used instead.
+
+    You'll normally get one of these from an AggregateAudioIODeviceType.
+
+    @see AggregateAudioIODeviceType
+
+    @tags{Audio}
+*/
+class JUCE_API  AggregateAudioIODevice  : public AudioIODevice,
+                                          private AudioIODeviceCallback
+{
+public:
+    //==============================================================================
+    /** Creates a device that combines some other devices.
+
+        The first device in the list will be the clock master. The list must not
+        be empty.
+    */
+    AggregateAudioIODevice (const String& deviceName,
+                            const String& typeName,
+                            std::vector<std::unique_ptr<AudioIODevice>> devicesToCombine);
+
+    /** Destructor. */
+    ~AggregateAudioIODevice() override;
+
+    //==============================================================================
+    /** Returns the number of devices that are being combined. */
+    int getNumDevices() const noexcept;
+
+    /** Returns one of the devices that are being combined. Device 0 is the clock master. */
+    AudioIODevice* getDevice (int index) const noexcept;
+
+    /** Returns the measured difference between the clock of one of the devices and
+        the clock of the master device, in parts per million.
+
+        A positive value means that the device is running faster than the master.
+        The value is only meaningful while the device is playing, and takes a few
+        seconds to settle after it has started.
+    */
+    double getClockDrift (int index) const noexcept;
+
+    //==============================================================================
+    StringArray getOutputChannelNames() override;
+    StringArray getInputChannelNames() override;
+    Array<double> getAvailableSampleRates() override;
+    Array<int> getAvailableBufferSizes() override;
+    int getDefaultBufferSize() override;
+
+    String open (const BigInteger& inputChannels,
+                 const BigInteger& outputChannels,
+                 double sampleRate,
+                 int bufferSizeSamples) override;
+    void close() override;
+    bool isOpen() override;
+    void start (AudioIODeviceCallback* callback) override;
+    void stop() override;
+    bool isPlaying() override;
+    String getLastError() override;
+
+    int getCurrentBufferSizeSamples() override;
+    double getCurrentSampleRate() override;
+    int getCurrentBitDepth() override;
+    BigInteger getActiveOutputChannels() const override;
+    BigInteger getActiveInputChannels() const override;
+    int getOutputLatencyInSamples() override;
+    int getInputLatencyInSamples() override;
+    int getXRunCount() const noexcept override;
+
+private:
+    //==============================================================================
+    class ClockBridge;
+    class Member;
+
+    void audioDeviceIOCallbackWithContext (const float* const*, int, float* const*, int, int,
+                                           const AudioIODeviceCallbackContext&) override;
+    void audioDeviceAboutToStart (AudioIODevice*) override;
+    void audioDeviceStopped() override;
+    void audioDeviceError (const String&) override;
+
+    void prepareStreams();
+
+    std::vector<std::unique_ptr<Member>> members;
+    AudioBuffer<float> secondaryChannels;
+    std::vector<const float*> inputPointers;
+    std::vector<float*> outputPointers;
+    int numMasterInputs = 0, numMasterOutputs = 0;
+
+    CriticalSection callbackLock;
+    AudioIODeviceCallback* callback = nullptr;
+    String lastError;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AggregateAudioIODevice)
+};
+
+//==============================================================================
+/**
+    An AudioIODeviceType that lets several devices of another type be used together
+    as a single AggregateAudioIODevice.
+
+    This is useful on platforms where the system doesn't provide a way of combining
+    devices itself, e.g. to use two ALSA soundcards at once:
+
+    @code
+    auto type = std::make_unique<AggregateAudioIODeviceType> (std::unique_ptr<AudioIODeviceType> (AudioIODeviceType::createAudioIODeviceType_ALSA()));
+    type->addAggregateDevice ("Both cards", { "HDA Intel PCH, ALC3246 Analog", "USB Audio CODEC, USB Audio" });
+
+    deviceManager.addAudioDeviceType (std::move (type));
+    @endcode
+
+    The names of the devices that can be combined are the ones returned by the
+    wrapped type's getDeviceNames() method.
+
+    @see AggregateAudioIODevice
+
+    @tags{Audio}
+*/
+class JUCE_API  AggregateAudioIODeviceType  : public AudioIODeviceType,
+                                              private AudioIODeviceType::Listener
+{
+public:
+    //==============================================================================
+    /** Creates a type which combines devices of another type. The type must not be null. */
+    explicit AggregateAudioIODeviceType (std::unique_ptr<AudioIODeviceType> typeToCombine);
+
+    /** Destructor. */
+    ~AggregateAudioIODeviceType() override;
+
+    //==============================================================================
+    /** Defines an aggregate device, or replaces the devices of an existing one.
+
+        The first device in the list will be the aggregate's clock master.
+    */
+    void addAggregateDevice (const String& aggregateName, const StringArray& deviceNames);
+
+    /** Removes an aggregate device that was added with addAggregateDevice(). */
+    void removeAggregateDevice (const String& aggregateName);
+
+    /** Returns the names of the devices that make up an aggregate device. */
+    StringArray getDevicesInAggregate (const String& aggregateName) const;
+
+    /** Returns the type whose devices are being combined. */
+    AudioIODeviceType& getCombinedType() const noexcept             { return *combinedType; }
+
+    //==============================================================================
+    void scanForDevices() override;
+    StringArray getDeviceNames (bool wantInputNames = false) const override;
+    int getDefaultDeviceIndex (bool forInput) const override;
+    int getIndexOfDevice (AudioIODevice*, bool asInput) const override;
+    bool hasSeparateInputsAndOutputs() const override;
+    AudioIODevice* createDevice (const String& outputDeviceName, const String& inputDeviceName) override;
+
+private:
+    //==============================================================================
+    void audioDeviceListChanged() override;
+
+    std::unique_ptr<AudioIODeviceType> combinedType;
+    StringArray aggregateNames;
+    Array<StringArray> aggregateDevices;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AggregateAudioIODeviceType)
+};
+
+} // namespace juce
@@ -0,0 +1,235 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+#if JUCE_LINUX
+namespace AudioCallbackThreadHelpers
+{
+    static Result failWithError (const String& message, int err)
+    {
+        return Result::fail (message + ": " + String (strerror (err)));
+    }
+
+    // These return an errno value, or 0 if they succeed
+
+    static int setAffinity (const BigInteger& cpus) noexcept
+    {
+        cpu_set_t set;
+        CPU_ZERO (&set);
+
+        for (auto i = cpus.findNextSetBit (0); isPositiveAndBelow (i, CPU_SETSIZE); i = cpus.findNextSetBit (i + 1))
+        {
+            JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE ("-Wsign-conversion")
+            CPU_SET ((size_t) i, &set);
+            JUCE_END_IGNORE_WARNINGS_GCC_LIKE
+        }
+
+        return pthread_setaffinity_np (pthread_self(), sizeof (set), &set);
+    }
+
+    static int setPriority (int policy, int priority) noexcept
+    {
+        sched_param param{};
+        param.sched_priority = priority;
+
+        return pthread_setschedparam (pthread_self(), policy, &param);
+    }
+
+    static int setDeadline (double sampleRate, int blockSize, [[maybe_unused]] double proportionOfBlock) noexcept
+    {
+        if (sampleRate <= 0.0 || blockSize <= 0)
+            return EINVAL;
+
+       #if defined (SYS_sched_setattr)
+        // glibc doesn't provide a wrapper for sched_setattr, which is the only way to
+        // choose SCHED_DEADLINE, so this mirrors the kernel's struct sched_attr
+        struct SchedAttr
+        {
+            uint32 size, policy;
+            uint64 flags;
+            int32 nice;
+            uint32 priority;
+            uint64 runtime, deadline, period;
+        };
+
+        constexpr uint32 schedDeadline = 6;
+
+        const auto periodNs = (uint64) (1.0e9 * blockSize / sampleRate);
+
+        SchedAttr attr{};
+        attr.size = (uint32) sizeof (attr);
+        attr.policy = schedDeadline;
+        attr.runtime = (uint64) ((double) periodNs * proportionOfBlock);
+        attr.deadline = periodNs;
+        attr.period = periodNs;
+
+        if (syscall (SYS_sched_setattr, 0, &attr, 0) != 0)
+            return errno;
+
+        return 0;
+       #else
+        return ENOSYS;
+       #endif
+    }
+
+    // Locking is process-wide, so only the first thread to ask needs to do it
+    static Result lockMemory()
+    {
+        static std::atomic<bool> isLocked { false };
+
+        if (isLocked)
+            return Result::ok();
+
+        if (mlockall (MCL_CURRENT | MCL_FUTURE) != 0)
+            return failWithError ("Couldn't lock memory", errno);
+
+        isLocked = true;
+        return Result::ok();
+    }
+
+    // This mustn't be inlined, or the stack space would stay allocated in the caller
+    [[gnu::noinline]] static void prefaultStack (size_t numBytes) noexcept
+    {
+        const auto pageSize = (size_t) jmax (1L, sysconf (_SC_PAGESIZE));
+        auto* stack = static_cast<volatile char*> (alloca (numBytes));
+
+        for (size_t i = 0; i < numBytes; i += pageSize)
+            stack[i] = 0;
+    }
+}
+#endif
+
+//==============================================================================
+bool AudioCallbackThreadOptions::isEmpty() const noexcept
+{
+    return cpus.isZero()
+        && scheduling == Scheduling::unchanged
+        && ! lockMemory
+        && stackPrefaultBytes == 0;
+}
+
+bool AudioCallbackThreadOptions::operator== (const AudioCallbackThreadOptions& other) const
+{
+    const auto tie = [] (const AudioCallbackThreadOptions& o)
+    {
+        return std::tie (o.cpus, o.scheduling, o.priority, o.deadlineRuntime, o.lockMemory, o.stackPrefaultBytes);
+    };
+
+    return tie (*this) == tie (other);
+}
+
+Result AudioCallbackThreadOptions::applyToCurrentThread (double sampleRate, int blockSize) const
+{
+    const auto processResult = applyToProcess();
+    const auto threadResult = applyToCurrentThreadOnly (sampleRate, blockSize).getResult();
+
+    if (processResult.wasOk())
+        return threadResult;
+
+    if (threadResult.wasOk())
+        return processResult;
+
+    return Result::fail (processResult.getErrorMessage() + "\n" + threadResult.getErrorMessage());
+}
+
+Result AudioCallbackThreadOptions::applyToProcess() const
+{
+    if (! lockMemory)
+        return Result::ok();
+
+   #if JUCE_LINUX
+    return AudioCallbackThreadHelpers::lockMemory();
+   #else
+    return Result::fail ("Audio callback thread options are only supported on Linux");
+   #endif
+}
+
+AudioCallbackThreadOptions::ThreadResult AudioCallbackThreadOptions::applyToCurrentThreadOnly ([[maybe_unused]] double sampleRate,
+                                                                                               [[maybe_unused]] int blockSize) const noexcept
+{
+    ThreadResult result;
+
+   #if JUCE_LINUX
+    using namespace AudioCallbackThreadHelpers;
+
+    if (stackPrefaultBytes > 0)
+        prefaultStack (stackPrefaultBytes);
+
+    const auto applyAffinity = [&]
+    {
+        if (! cpus.isZero())
+            result.affinityError = setAffinity (cpus);
+    };
+
+    // The kernel refuses deadline scheduling for a thread that can't run on every CPU in its
+    // root domain, so for that policy the affinity is only restricted afterwards. That fails
+    // with EBUSY unless the CPUs make up an exclusive cpuset, but it still works if the
+    // deadline policy couldn't be set.
+    if (scheduling != Scheduling::deadline)
+        applyAffinity();
+
+    switch (scheduling)
+    {
+        case Scheduling::unchanged:     break;
+        case Scheduling::fifo:          result.schedulingError = setPriority (SCHED_FIFO, priority); break;
+        case Scheduling::roundRobin:    result.schedulingError = setPriority (SCHED_RR, priority); break;
+        case Scheduling::deadline:      result.schedulingError = setDeadline (sampleRate, blockSize, deadlineRuntime); break;
+    }
+
+    if (scheduling == Scheduling::deadline)
+        applyAffinity();
+   #else
+    if (! cpus.isZero() || stackPrefaultBytes > 0)
+        result.affinityError = ENOSYS;
+
+    if (scheduling != Scheduling::unchanged)
+        result.schedulingError = ENOSYS;
+   #endif
+
+    return result;
+}
+
+Result AudioCallbackThreadOptions::ThreadResult::getResult() const
+{
+    if (wasOk())
+        return Result::ok();
+
+   #if JUCE_LINUX
+    using namespace AudioCallbackThreadHelpers;
+
+    StringArray errors;
+
+    if (affinityError != 0)
+        errors.add (failWithError ("Couldn't set the CPU affinity", affinityError).getErrorMessage());
+
+    if (schedulingError != 0)
+        errors.add (failWithError ("Couldn't set the scheduling policy", schedulingError).getErrorMessage());
+
+    return Result::fail (errors.joinIntoString ("\n"));
+   #else
+    return Result::fail ("Audio callback thread options are only supported on Linux");
+   #endif
+}
+
+} // namespace juce
@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A set of options for tuning the scheduling of the threads that run an audio
+    device's callback.
+
+    Pass one of these to AudioDeviceManager::setCallbackThreadOptions(), and the
+    device manager will lock the process's memory before the device starts, and
+    apply the rest of the options to whichever thread calls the audio callback, the
+    first time that thread calls it. This works for threads that JUCE doesn't
+    create itself, such as the JACK process thread. Helper threads which do work
+    for the audio callback can call applyToCurrentThread() to be scheduled in the
+    same way, for example after joining the device's AudioWorkgroup.
+
+    Most of these options are only supported on Linux, and usually need the
+    process to have the CAP_SYS_NICE and CAP_IPC_LOCK capabilities, or a suitable
+    entry in /etc/security/limits.conf.
+
+    @see AudioDeviceManager::setCallbackThreadOptions
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioCallbackThreadOptions
+{
+public:
+    //==============================================================================
+    /** The scheduling policies that a thread can be given. */
+    enum class Scheduling
+    {
+        unchanged,      /**< Leaves the thread's scheduling as it is. */
+        fifo,           /**< SCHED_FIFO, with the priority given by getPriority(). */
+        roundRobin,     /**< SCHED_RR, with the priority given by getPriority(). */
+        deadline        /**< SCHED_DEADLINE, with a period of one audio block (Linux only). */
+    };
+
+    //==============================================================================
+    /** Restricts the thread to a set of CPUs, where each set bit is the index of a CPU
+        that the thread is allowed to run on. An empty set leaves the affinity unchanged.
+
+        Note that Linux won't let a thread with deadline scheduling have its affinity
+        restricted unless the CPUs belong to an exclusive cpuset, so this is best combined
+        with the fifo or roundRobin policies. With the deadline policy, the affinity is
+        applied after the policy, and only restricted if the kernel allows it.
+    */
+    [[nodiscard]] AudioCallbackThreadOptions withCpuAffinity (const BigInteger& newCpus) const
+    {
+        return withMember (*this, &AudioCallbackThreadOptions::cpus, newCpus);
+    }
+
+    /** Sets the scheduling policy, and for the fifo and roundRobin policies, the priority
+        in the range 1 to 99.
+    */
+    [[nodiscard]] AudioCallbackThreadOptions withScheduling (Scheduling newScheduling, int newPriority = 80) const
+    {
+        jassert (isPositiveAndBelow (newPriority - 1, 99));
+
+        auto copy = withMember (*this, &AudioCallbackThreadOptions::scheduling, newScheduling);
+        copy.priority = jlimit (1, 99, newPriority);
+        return copy;
+    }
+
+    /** For the deadline policy, sets the amount of CPU time that the thread is guaranteed
+        during each audio block, as a proportion of the block's duration.
+    */
+    [[nodiscard]] AudioCallbackThreadOptions withDeadlineRuntime (double newProportionOfBlock) const
+    {
+        jassert (0.0 < newProportionOfBlock && newProportionOfBlock <= 1.0);
+        return withMember (*this, &AudioCallbackThreadOptions::deadlineRuntime, jlimit (0.01, 1.0, newProportionOfBlock));
+    }
+
+    /** If this is true, all of the process's memory will be locked into RAM with
+        mlockall(), so that the audio thread never has to wait for a page to be loaded.
+    */
+    [[nodiscard]] AudioCallbackThreadOptions withLockedMemory (bool shouldLockMemory) const
+    {
+        return withMember (*this, &AudioCallbackThreadOptions::lockMemory, shouldLockMemory);
+    }
+
+    /** Touches this many bytes of the thread's stack, so that the pages are already
+        mapped when the callback first needs them. This is most useful together with
+        withLockedMemory().
+    */
+    [[nodiscard]] AudioCallbackThreadOptions withStackPrefault (size_t newNumBytes) const
+    {
+        return withMember (*this, &AudioCallbackThreadOptions::stackPrefaultBytes, newNumBytes);
+    }
+
+    //==============================================================================
+    /** Returns the set of CPUs that the thread is restricted to, or an empty set. */
+    [[nodiscard]] const BigInteger& getCpuAffinity() const noexcept   { return cpus; }
+
+    /** Returns the scheduling policy. */
+    [[nodiscard]] Scheduling getScheduling() const noexcept           { return scheduling; }
+
+    /** Returns the priority used with the fifo and roundRobin policies. */
+    [[nodiscard]] int getPriority() const noexcept                    { return priority; }
+
+    /** Returns the proportion of each block that a deadline-scheduled thread is guaranteed. */
+    [[nodiscard]] double getDeadlineRuntime() const noexcept          { return deadlineRuntime; }
+
+    /** Returns true if the process's memory should be locked. */
+    [[nodiscard]] bool isMemoryLocked() const noexcept                { return lockMemory; }
+
+    /** Returns the number of bytes of stack to prefault. */
+    [[nodiscard]] size_t getStackPrefault() const noexcept            { return stackPrefaultBytes; }
+
+    /** Returns true if these options wouldn't make any changes to a thread. */
+    [[nodiscard]] bool isEmpty() const noexcept;
+
+    //==============================================================================
+    /** The outcome of applyToCurrentThreadOnly().
+
+        This holds the system's error codes rather than any messages, so that it can be
+        created on an audio thread without allocating.
+    */
+    class JUCE_API  ThreadResult
+    {
+    public:
+        /** Returns true if all of the options were applied. */
+        [[nodiscard]] bool wasOk() const noexcept     { return affinityError == 0 && schedulingError == 0; }
+
+        /** Returns a Result describing any options that couldn't be applied. This
+            allocates, so it shouldn't be called on the audio thread.
+        */
+        [[nodiscard]] Result getResult() const;
+
+    private:
+        friend class AudioCallbackThreadOptions;
+
+        int affinityError = 0, schedulingError = 0;
+    };
+
+    /** Applies these options to the calling thread, and to the process if memory
+        locking is enabled.
+
+        The sample rate and block size are used to work out the period of the deadline
+        policy. Everything that can be applied is applied, even if some of the options
+        fail, and the returned Result describes any that did.
+
+        This can allocate and block, so audio threads should use applyToProcess() and
+        applyToCurrentThreadOnly() instead.
+    */
+    Result applyToCurrentThread (double sampleRate, int blockSize) const;
+
+    /** Applies the options that affect the whole process rather than one thread, which
+        at the moment is only memory locking.
+
+        This can block for some time, so it should be called before the audio starts,
+        rather than on the audio thread.
+    */
+    Result applyToProcess() const;
+
+    /** Applies the options that only affect the calling thread: the CPU affinity, the
+        scheduling policy and the stack prefaulting.
+
+        This doesn't allocate, so it can be called at the start of an audio callback.
+    */
+    ThreadResult applyToCurrentThreadOnly (double sampleRate, int blockSize) const noexcept;
+
+    /** @internal */
+    bool operator== (const AudioCallbackThreadOptions&) const;
+    /** @internal */
+    bool operator!= (const AudioCallbackThreadOptions& other) const   { return ! operator== (other); }
+
+private:
+    //==============================================================================
+    BigInteger cpus;
+    Scheduling scheduling = Scheduling::unchanged;
+    int priority = 80;
+    double deadlineRuntime = 0.5;
+    bool lockMemory = false;
+    size_t stackPrefaultBytes = 0;
+};
+
+} // namespace juce
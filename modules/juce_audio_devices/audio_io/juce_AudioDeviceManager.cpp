@@ -682,6 +682,74 @@ void AudioDeviceManager::setCurrentAudioDeviceType (const String& type, bool tre
     }
 }
 
+void AudioDeviceManager::setCallbackThreadOptions (const AudioCallbackThreadOptions& newOptions)
+{
+    {
+        const SpinLock::ScopedLockType sl (callbackThreadOptionsLock);
+
+        if (std::exchange (callbackThreadOptions, newOptions) == newOptions)
+            return;
+
+        callbackThreadOptionsAppliedTo = nullptr;
+        callbackThreadResult = {};
+    }
+
+    // If a device is already running, its memory needs locking now
+    if (currentAudioDevice != nullptr && currentAudioDevice->isPlaying())
+        applyCallbackThreadOptionsToProcess();
+}
+
+AudioCallbackThreadOptions AudioDeviceManager::getCallbackThreadOptions() const
+{
+    const SpinLock::ScopedLockType sl (callbackThreadOptionsLock);
+    return callbackThreadOptions;
+}
+
+Result AudioDeviceManager::getCallbackThreadOptionsResult() const
+{
+    const auto [processResult, threadResult] = [this]
+    {
+        const SpinLock::ScopedLockType sl (callbackThreadOptionsLock);
+        return std::tuple (callbackProcessResult, callbackThreadResult);
+    }();
+
+    const auto threadError = threadResult.getResult();
+
+    if (processResult.wasOk())
+        return threadError;
+
+    if (threadError.wasOk())
+        return processResult;
+
+    return Result::fail (processResult.getErrorMessage() + "\n" + threadError.getErrorMessage());
+}
+
+void AudioDeviceManager::applyCallbackThreadOptionsToProcess()
+{
+    const auto result = getCallbackThreadOptions().applyToProcess();
+
+    const SpinLock::ScopedLockType sl (callbackThreadOptionsLock);
+    callbackProcessResult = result;
+}
+
+void AudioDeviceManager::applyCallbackThreadOptionsToCurrentThread (int numSamples) noexcept
+{
+    const auto threadID = Thread::getCurrentThreadId();
+
+    if (threadID == callbackThreadOptionsAppliedTo.load())
+        return;
+
+    // If the options are being changed, this will try again on the next callback,
+    // rather than making the audio thread wait
+    const SpinLock::ScopedTryLockType sl (callbackThreadOptionsLock);
+
+    if (! sl.isLocked())
+        return;
+
+    callbackThreadOptionsAppliedTo = threadID;
+    callbackThreadResult = callbackThreadOptions.applyToCurrentThreadOnly (callbackSampleRate, numSamples);
+}
+
 AudioWorkgroup AudioDeviceManager::getDeviceAudioWorkgroup() const
 {
     return currentAudioDevice != nullptr ? currentAudioDevice->getWorkgroup() : AudioWorkgroup{};
@@ -997,6 +1065,8 @@ void AudioDeviceManager::audioDeviceIOCallbackInt (const float* const* inputChan
                                                    int numSamples,
                                                    const AudioIODeviceCallbackContext& context)
 {
+    applyCallbackThreadOptionsToCurrentThread (numSamples);
+
     const ScopedLock sl (audioCallbackLock);
 
     inputLevelGetter->updateLevel (inputChannelData, numInputChannels, numSamples);
@@ -1066,6 +1136,16 @@ void AudioDeviceManager::audioDeviceAboutToStartInt (AudioIODevice* const device
 
     updateCurrentSetup();
 
+    {
+        const SpinLock::ScopedLockType sl (callbackThreadOptionsLock);
+
+        // A new thread may end up with the same ID as the one that ran the last device
+        callbackThreadOptionsAppliedTo = nullptr;
+        callbackSampleRate = device->getCurrentSampleRate();
+    }
+
+    applyCallbackThreadOptionsToProcess();
+
     {
         const ScopedLock sl (audioCallbackLock);
 
@@ -1587,6 +1667,59 @@ public:
             ptr->restartDevices (newSr, newBs);
             expectEquals (numCalls, 1);
         }
+
+        beginTest ("Callback thread options are applied by the thread that calls the audio callback");
+        {
+            AudioDeviceManager manager;
+            manager.addAudioDeviceType (std::make_unique<MockDeviceType> ("foo",
+                                                                          StringArray { "foo in a" },
+                                                                          StringArray { "foo out a" }));
+
+            AudioDeviceManager::AudioDeviceSetup setup;
+            setup.inputDeviceName = "foo in a";
+            setup.outputDeviceName = "foo out a";
+            manager.setAudioDeviceSetup (setup, true);
+
+            MockCallback callback;
+            manager.addAudioCallback (&callback);
+
+            BigInteger allCpus;
+            allCpus.setRange (0, SystemStats::getNumCpus(), true);
+
+            const auto options = AudioCallbackThreadOptions().withCpuAffinity (allCpus)
+                                                             .withStackPrefault (64 * 1024);
+            expect (! options.isEmpty());
+            expect (AudioCallbackThreadOptions().isEmpty());
+
+            manager.setCallbackThreadOptions (options);
+            expect (manager.getCallbackThreadOptions() == options);
+
+            auto* device = dynamic_cast<MockDevice*> (manager.getCurrentAudioDevice());
+            expect (device != nullptr);
+
+            std::thread audioThread ([device] { device->process (64); });
+            audioThread.join();
+
+            const auto result = manager.getCallbackThreadOptionsResult();
+
+           #if JUCE_LINUX
+            // Some of the CPUs may be out of bounds for this process, e.g. in a container
+            expect (result.wasOk() || result.getErrorMessage().startsWith ("Couldn't set the CPU affinity"),
+                    result.getErrorMessage());
+
+            // Errors from the audio thread should be reported once they've happened
+            BigInteger missingCpu;
+            missingCpu.setBit (1023);
+
+            manager.setCallbackThreadOptions (AudioCallbackThreadOptions().withCpuAffinity (missingCpu));
+            expect (manager.getCallbackThreadOptionsResult().wasOk());
+
+            std::thread ([device] { device->process (64); }).join();
+            expect (manager.getCallbackThreadOptionsResult().getErrorMessage().startsWith ("Couldn't set the CPU affinity"));
+           #else
+            expect (result.failed());
+           #endif
+        }
     }
 
 private:
@@ -1799,6 +1932,16 @@ private:
             playing = true;
         }
 
+        void process (int numSamples)
+        {
+            AudioBuffer<float> buffer (3, numSamples);
+            buffer.clear();
+
+            callback->audioDeviceIOCallbackWithContext (buffer.getArrayOfReadPointers(), inChannels.countNumberOfSetBits(),
+                                                        buffer.getArrayOfWritePointers(), outChannels.countNumberOfSetBits(),
+                                                        numSamples, {});
+        }
+
         void stop() override
         {
             playing = false;
@@ -265,6 +265,28 @@ public:
     /** Returns the current audio device workgroup, if supported. */
     AudioWorkgroup getDeviceAudioWorkgroup() const;
 
+    //==============================================================================
+    /** Sets the scheduling options for the thread that calls the audio callback.
+
+        The process's memory is locked, if requested, before the device starts. The rest
+        of the options are applied by the audio thread itself at the start of the next
+        callback, and again whenever the device starts calling back on a different thread.
+        This means that they also apply to threads which JUCE doesn't create, like the
+        JACK process thread. Changes that have been made to a thread can't be undone by
+        setting different options, so it's best to set these before opening a device.
+
+        @see AudioCallbackThreadOptions, getCallbackThreadOptionsResult
+    */
+    void setCallbackThreadOptions (const AudioCallbackThreadOptions& newOptions);
+
+    /** Returns the options set with setCallbackThreadOptions(). */
+    AudioCallbackThreadOptions getCallbackThreadOptions() const;
+
+    /** Returns the outcome of the last attempt to apply the callback thread options, which
+        will describe any options that the system refused.
+    */
+    Result getCallbackThreadOptionsResult() const;
+
     /** Closes the currently-open device.
         You can call restartLastAudioDevice() later to reopen it in the same state
         that it was just in.
@@ -524,6 +546,13 @@ private:
     std::unique_ptr<AudioBuffer<float>> testSound;
     int testSoundPosition = 0;
 
+    SpinLock callbackThreadOptionsLock;
+    AudioCallbackThreadOptions callbackThreadOptions;
+    std::atomic<Thread::ThreadID> callbackThreadOptionsAppliedTo { nullptr };
+    Result callbackProcessResult = Result::ok();
+    AudioCallbackThreadOptions::ThreadResult callbackThreadResult;
+    double callbackSampleRate = 0.0;
+
     AudioProcessLoadMeasurer loadMeasurer;
 
     LevelMeter::Ptr inputLevelGetter   { new LevelMeter() },
@@ -545,6 +574,8 @@ private:
     void handleIncomingMidiMessageInt (MidiInput*, const MidiMessage&);
     void audioDeviceListChanged();
     void midiDeviceListChanged();
+    void applyCallbackThreadOptionsToProcess();
+    void applyCallbackThreadOptionsToCurrentThread (int numSamples) noexcept;
 
     String restartDevice (int blockSizeToUse, double sampleRateToUse,
                           const BigInteger& ins, const BigInteger& outs);
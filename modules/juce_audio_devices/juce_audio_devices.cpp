@@ -149,6 +149,12 @@
 
 //==============================================================================
 #elif JUCE_LINUX || JUCE_BSD
+ #if JUCE_LINUX
+  #include <alloca.h>
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+ #endif
+
  #if JUCE_ALSA
   /* Got an include error here? If so, you've either not got ALSA installed, or you've
      not got your paths set up correctly to find its header files.
@@ -257,6 +263,8 @@ namespace juce
 }
 #endif
 
+#include "audio_io/juce_AggregateAudioIODevice.cpp"
+#include "audio_io/juce_AudioCallbackThreadOptions.cpp"
 #include "audio_io/juce_AudioDeviceManager.cpp"
 #include "audio_io/juce_AudioIODevice.cpp"
 #include "audio_io/juce_AudioIODeviceType.cpp"
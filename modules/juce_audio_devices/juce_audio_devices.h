@@ -180,7 +180,9 @@ namespace juce
 
 #include "audio_io/juce_AudioIODevice.h"
 #include "audio_io/juce_AudioIODeviceType.h"
+#include "audio_io/juce_AggregateAudioIODevice.h"
 #include "audio_io/juce_SystemAudioVolume.h"
+#include "audio_io/juce_AudioCallbackThreadOptions.h"
 #include "sources/juce_AudioSourcePlayer.h"
 #include "sources/juce_AudioTransportSource.h"
 #include "audio_io/juce_AudioDeviceManager.h"
@@ -30,6 +30,12 @@ namespace
  #define JUCE_ALSA_LOGGING 0
 #endif
 
+// When this is enabled, devices that support it are accessed through a memory-mapped
+// ring buffer, so that samples are converted straight to or from the hardware's buffer
+#ifndef JUCE_ALSA_MMAP
+ #define JUCE_ALSA_MMAP 1
+#endif
+
 #if JUCE_ALSA_LOGGING
  #define JUCE_ALSA_LOG(dbgtext)   { juce::String tempDbgBuf ("ALSA: "); tempDbgBuf << dbgtext; Logger::writeToLog (tempDbgBuf); DBG (tempDbgBuf); }
  #define JUCE_CHECKED_RESULT(x)   (logErrorMessage (x, __LINE__))
@@ -208,16 +214,35 @@ public:
             return false;
         }
 
-        if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED) >= 0) // works better for plughw..
-            isInterleaved = true;
-        else if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_NONINTERLEAVED) >= 0)
-            isInterleaved = false;
-        else
+        struct AccessType
+        {
+            snd_pcm_access_t access;
+            bool mmap, interleaved;
+        };
+
+        const AccessType accessTypesToTry[] = {
+           #if JUCE_ALSA_MMAP
+            { SND_PCM_ACCESS_MMAP_INTERLEAVED,    true,  true },
+            { SND_PCM_ACCESS_MMAP_NONINTERLEAVED, true,  false },
+           #endif
+            { SND_PCM_ACCESS_RW_INTERLEAVED,      false, true }, // works better for plughw..
+            { SND_PCM_ACCESS_RW_NONINTERLEAVED,   false, false }
+        };
+
+        const auto accessType = std::find_if (std::begin (accessTypesToTry), std::end (accessTypesToTry), [&] (const AccessType& t)
+        {
+            return snd_pcm_hw_params_set_access (handle, hwParams, t.access) >= 0;
+        });
+
+        if (accessType == std::end (accessTypesToTry))
         {
             jassertfalse;
             return false;
         }
 
+        isMmap = accessType->mmap;
+        isInterleaved = accessType->interleaved;
+
         enum { isFloatBit = 1 << 16, isLittleEndianBit = 1 << 17, onlyUseLower24Bits = 1 << 18 };
 
         const int formatsToTry[] = { SND_PCM_FORMAT_FLOAT_LE,   32 | isFloatBit | isLittleEndianBit,
@@ -237,6 +262,7 @@ public:
             {
                 const int type = formatsToTry [i + 1];
                 bitDepth = type & 255;
+                isNativeFloat = (type & isFloatBit) != 0 && ((type & isLittleEndianBit) != 0) == (JUCE_LITTLE_ENDIAN != 0);
 
                 converter.reset (createConverter (isInput, bitDepth,
                                                   (type & isFloatBit) != 0,
@@ -276,6 +302,9 @@ public:
         else
             latency = (int) frames * ((int) periods - 1); // (this is the method JACK uses to guess the latency..)
 
+        if (JUCE_ALSA_FAILED (snd_pcm_hw_params_get_buffer_size (hwParams, &bufferFrames)))
+            bufferFrames = frames * periods;
+
         JUCE_ALSA_LOG ("frames: " << (int) frames << ", periods: " << (int) periods
                           << ", samplesPerPeriod: " << (int) samplesPerPeriod);
 
@@ -289,11 +318,17 @@ public:
             || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_silence_size (handle, swParams, boundary))
             || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_start_threshold (handle, swParams, samplesPerPeriod))
             || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_stop_threshold (handle, swParams, boundary))
+            || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_avail_min (handle, swParams, (snd_pcm_uframes_t) bufferSize))
             || JUCE_ALSA_FAILED (snd_pcm_sw_params (handle, swParams)))
         {
             return false;
         }
 
+        pollDescriptors.resize ((size_t) jmax (0, snd_pcm_poll_descriptors_count (handle)));
+
+        if (JUCE_ALSA_FAILED (snd_pcm_poll_descriptors (handle, pollDescriptors.data(), (unsigned int) pollDescriptors.size())))
+            return false;
+
        #if JUCE_ALSA_LOGGING
         // enable this to dump the config of the devices that get opened
         snd_output_t* out;
@@ -311,6 +346,10 @@ public:
     bool writeToOutputDevice (AudioBuffer<float>& outputChannelBuffer, const int numSamples)
     {
         jassert (numChannelsRunning <= outputChannelBuffer.getNumChannels());
+
+        if (isMmap)
+            return transferMmap (outputChannelBuffer, numSamples);
+
         float* const* const data = outputChannelBuffer.getArrayOfWritePointers();
         snd_pcm_sframes_t numDone = 0;
 
@@ -349,6 +388,10 @@ public:
     bool readFromInputDevice (AudioBuffer<float>& inputChannelBuffer, const int numSamples)
     {
         jassert (numChannelsRunning <= inputChannelBuffer.getNumChannels());
+
+        if (isMmap)
+            return transferMmap (inputChannelBuffer, numSamples);
+
         float* const* const data = inputChannelBuffer.getArrayOfWritePointers();
 
         if (isInterleaved)
@@ -397,20 +440,119 @@ public:
         return true;
     }
 
+    /** Returns the number of frames that can be read or written without blocking,
+        or a negative error code if the device has failed.
+    */
+    snd_pcm_sframes_t getNumFramesAvailable()
+    {
+        auto avail = snd_pcm_avail_update (handle);
+
+        if (avail < 0)
+            return recoverFromError ((int) avail) ? 0 : avail;
+
+        // The stop threshold means that an xrun doesn't stop the device, so when using mmap
+        // we have to skip over the frames that were lost to get back in step with the hardware
+        if (isMmap && (snd_pcm_uframes_t) avail > bufferFrames)
+        {
+            ++(isInput ? overrunCount : underrunCount);
+            snd_pcm_forward (handle, (snd_pcm_uframes_t) avail - bufferFrames);
+            return (snd_pcm_sframes_t) bufferFrames;
+        }
+
+        return avail;
+    }
+
+    /** Starts a device that's been prepared, but isn't running yet. */
+    bool startIfNeeded()
+    {
+        if (snd_pcm_state (handle) != SND_PCM_STATE_PREPARED)
+            return true;
+
+        return ! JUCE_ALSA_FAILED (snd_pcm_start (handle));
+    }
+
     //==============================================================================
     snd_pcm_t* handle;
     String error;
     int bitDepth, numChannelsRunning, latency;
     int underrunCount = 0, overrunCount = 0;
+    snd_pcm_uframes_t bufferFrames = 0;
+    std::vector<pollfd> pollDescriptors;
 
 private:
     //==============================================================================
     String deviceID;
     const bool isInput;
-    bool isInterleaved;
+    bool isInterleaved, isMmap = false, isNativeFloat = false;
     MemoryBlock scratch;
     std::unique_ptr<AudioData::Converter> converter;
 
+    //==============================================================================
+    // Converts the samples in place in the hardware's ring buffer, rather than going via
+    // a scratch buffer and snd_pcm_readi/writei
+    bool transferMmap (AudioBuffer<float>& buffer, const int numSamples)
+    {
+        float* const* const data = buffer.getArrayOfWritePointers();
+
+        for (int numDone = 0; numDone < numSamples;)
+        {
+            const snd_pcm_channel_area_t* areas = nullptr;
+            snd_pcm_uframes_t offset = 0, frames = (snd_pcm_uframes_t) (numSamples - numDone);
+
+            if (const auto err = snd_pcm_mmap_begin (handle, &areas, &offset, &frames); err < 0)
+                return recoverFromError (err);
+
+            if (frames == 0)
+            {
+                JUCE_ALSA_LOG ("Did not transfer all samples: numDone: " << numDone << ", numSamples: " << numSamples);
+                break;
+            }
+
+            for (int i = 0; i < numChannelsRunning; ++i)
+            {
+                const auto& area = areas[i];
+                auto* hardwareData = addBytesToPointer (area.addr, (area.first + offset * area.step) / 8);
+
+                if (isInput)
+                    convertSamples (data[i] + numDone, hardwareData, (int) frames);
+                else
+                    convertSamples (hardwareData, data[i] + numDone, (int) frames);
+            }
+
+            const auto numCommitted = snd_pcm_mmap_commit (handle, offset, frames);
+
+            if (numCommitted < 0)
+                return recoverFromError ((int) numCommitted);
+
+            if ((snd_pcm_uframes_t) numCommitted != frames)
+            {
+                JUCE_ALSA_LOG ("Did not commit all samples: numCommitted: " << numCommitted << ", frames: " << (int) frames);
+                break;
+            }
+
+            numDone += (int) frames;
+        }
+
+        // Writing to the ring buffer directly doesn't start the device automatically
+        return isInput || startIfNeeded();
+    }
+
+    void convertSamples (void* dest, const void* source, int numSamples) const
+    {
+        if (isNativeFloat && ! isInterleaved)
+            FloatVectorOperations::copy (static_cast<float*> (dest), static_cast<const float*> (source), numSamples);
+        else
+            converter->convertSamples (dest, source, numSamples);
+    }
+
+    bool recoverFromError (int err)
+    {
+        if (err == -(EPIPE))
+            ++(isInput ? overrunCount : underrunCount);
+
+        return ! JUCE_ALSA_FAILED (snd_pcm_recover (handle, err, 1 /* silent */));
+    }
+
     //==============================================================================
     template <class SampleType>
     struct ConverterHelper
@@ -674,23 +816,19 @@ public:
 
     void run() override
     {
+        if (! startDevices())
+        {
+            JUCE_ALSA_LOG ("Couldn't start devices");
+            return;
+        }
+
         while (! threadShouldExit())
         {
+            if (! waitForDevices())
+                break;
+
             if (inputDevice != nullptr && inputDevice->handle != nullptr)
             {
-                if (outputDevice == nullptr || outputDevice->handle == nullptr)
-                {
-                    JUCE_ALSA_FAILED (snd_pcm_wait (inputDevice->handle, 2000));
-
-                    if (threadShouldExit())
-                        break;
-
-                    auto avail = snd_pcm_avail_update (inputDevice->handle);
-
-                    if (avail < 0)
-                        JUCE_ALSA_FAILED (snd_pcm_recover (inputDevice->handle, (int) avail, 0));
-                }
-
                 audioIoInProgress = true;
 
                 if (! inputDevice->readFromInputDevice (inputChannelBuffer, bufferSize))
@@ -727,16 +865,6 @@ public:
 
             if (outputDevice != nullptr && outputDevice->handle != nullptr)
             {
-                JUCE_ALSA_FAILED (snd_pcm_wait (outputDevice->handle, 2000));
-
-                if (threadShouldExit())
-                    break;
-
-                auto avail = snd_pcm_avail_update (outputDevice->handle);
-
-                if (avail < 0)
-                    JUCE_ALSA_FAILED (snd_pcm_recover (outputDevice->handle, (int) avail, 0));
-
                 audioIoInProgress = true;
 
                 if (! outputDevice->writeToOutputDevice (outputChannelBuffer, bufferSize))
@@ -798,6 +926,7 @@ private:
     AudioBuffer<float> inputChannelBuffer, outputChannelBuffer;
     Array<const float*> inputChannelDataForCallback;
     Array<float*> outputChannelDataForCallback;
+    std::vector<pollfd> pollDescriptors;
 
     unsigned int minChansOut = 0, maxChansOut = 0;
     unsigned int minChansIn = 0, maxChansIn = 0;
@@ -812,6 +941,109 @@ private:
         return true;
     }
 
+    //==============================================================================
+    bool startDevices()
+    {
+        size_t numPollDescriptors = 0;
+
+        for (auto* device : { inputDevice.get(), outputDevice.get() })
+            if (device != nullptr)
+                numPollDescriptors += device->pollDescriptors.size();
+
+        pollDescriptors.reserve (numPollDescriptors);
+
+        // Filling all but one block of the output with silence before starting means that
+        // the latency stays at the amount that the device reported
+        if (outputDevice != nullptr)
+        {
+            outputChannelBuffer.clear();
+
+            for (auto i = (int) outputDevice->bufferFrames / bufferSize - 1; --i >= 0;)
+                if (! outputDevice->writeToOutputDevice (outputChannelBuffer, bufferSize))
+                    return false;
+        }
+
+        return inputDevice == nullptr || inputDevice->startIfNeeded();
+    }
+
+    // Waits until a whole block can be read from the input and written to the output,
+    // using a single poll() on both devices' descriptors
+    bool waitForDevices()
+    {
+        for (;;)
+        {
+            if (threadShouldExit())
+                return false;
+
+            bool deviceFailed = false;
+
+            auto isReady = [&] (ALSADevice* device)
+            {
+                if (device == nullptr || device->handle == nullptr)
+                    return true;
+
+                // After recovering from an xrun, an input has to be restarted
+                if (device == inputDevice.get() && ! device->startIfNeeded())
+                {
+                    deviceFailed = true;
+                    return false;
+                }
+
+                const auto avail = device->getNumFramesAvailable();
+                deviceFailed |= JUCE_ALSA_FAILED ((int) avail);
+                return avail >= jmin ((snd_pcm_sframes_t) bufferSize, (snd_pcm_sframes_t) device->bufferFrames);
+            };
+
+            const auto inputReady = isReady (inputDevice.get());
+            const auto outputReady = isReady (outputDevice.get());
+
+            if (deviceFailed)
+                return false;
+
+            if (inputReady && outputReady)
+                return true;
+
+            // Only wait for the devices that aren't ready yet, or poll() would return straight away
+            pollDescriptors.clear();
+
+            for (auto [device, ready] : { std::pair (inputDevice.get(), inputReady), std::pair (outputDevice.get(), outputReady) })
+            {
+                if (device == nullptr)
+                    continue;
+
+                for (auto descriptor : device->pollDescriptors)
+                {
+                    if (ready)
+                        descriptor.events = 0;
+
+                    pollDescriptors.push_back (descriptor);
+                }
+            }
+
+            // A short timeout lets us notice when the thread should exit
+            if (poll (pollDescriptors.data(), (nfds_t) pollDescriptors.size(), 100) < 0 && errno != EINTR)
+                return false;
+
+            auto* descriptors = pollDescriptors.data();
+
+            for (auto* device : { inputDevice.get(), outputDevice.get() })
+            {
+                if (device == nullptr)
+                    continue;
+
+                const auto numDescriptors = (unsigned int) device->pollDescriptors.size();
+
+                if (device->handle != nullptr)
+                {
+                    unsigned short revents = 0;
+                    snd_pcm_poll_descriptors_revents (device->handle, descriptors, numDescriptors, &revents);
+                }
+
+                descriptors += numDescriptors;
+            }
+        }
+    }
+
     void initialiseRatesAndChannels()
     {
         sampleRates.clear();
@@ -3482,6 +3482,15 @@ public:
                    : nullopt;
         };
 
+        // The wrapper may add parameters of its own, such as a bypass, which the plugin can't see
+        const auto& juceParameters = pluginInstance->getParameters();
+
+        const auto getEventIndex = [&] (const AudioProcessorParameter& param)
+        {
+            const auto index = param.getParameterIndex();
+            return isPositiveAndBelow (index, juceParameters.size()) && juceParameters.getUnchecked (index) == &param ? index : -1;
+        };
+
         const auto numParamsChanged = paramChanges.getParameterCount();
 
         for (Steinberg::int32 i = 0; i < numParamsChanged; ++i)
@@ -3502,9 +3511,31 @@ public:
                 }
                 else
                #endif
-                if (const auto change = getPointFromQueue (paramQueue, numPoints - 1))
+                if (auto* param = comPluginInstance->getParamForVSTParamID (vstParamID))
                 {
-                    if (auto* param = comPluginInstance->getParamForVSTParamID (vstParamID))
+                    // VST3 automation ramps linearly between points. A ramp towards the first point
+                    // starts from the value that the parameter had at the end of the previous block.
+                    if (const auto eventIndex = getEventIndex (*param); eventIndex >= 0)
+                    {
+                        for (Steinberg::int32 point = 0; point < numPoints; ++point)
+                        {
+                            if (const auto change = getPointFromQueue (paramQueue, point))
+                            {
+                                const auto isFirstAtStart = point == 0 && change->offsetSamples == 0;
+
+                                if (point == 0 && ! isFirstAtStart)
+                                    parameterEvents.addEvent ({ eventIndex, 0, param->getValue(), ParameterEventList::Interpolation::step });
+
+                                parameterEvents.addEvent ({ eventIndex,
+                                                            (int) change->offsetSamples,
+                                                            (float) change->value,
+                                                            isFirstAtStart ? ParameterEventList::Interpolation::step
+                                                                           : ParameterEventList::Interpolation::linear });
+                            }
+                        }
+                    }
+
+                    if (const auto change = getPointFromQueue (paramQueue, numPoints - 1))
                         setValueAndNotifyIfChanged (*param, (float) change->value);
                 }
             }
@@ -3557,6 +3588,7 @@ public:
         }
 
         midiBuffer.clear();
+        parameterEvents.clear();
 
         if (data.inputParameterChanges != nullptr)
             processParameterChanges (*data.inputParameterChanges);
@@ -3696,12 +3728,16 @@ private:
             }
             else
             {
+                pluginInstance->setParameterEvents (parameterEvents.isEmpty() ? nullptr : &parameterEvents);
+
                 // processBlockBypassed should only ever be called if the AudioProcessor doesn't
                 // return a valid parameter from getBypassParameter
                 if (pluginInstance->getBypassParameter() == nullptr && comPluginInstance->getBypassParameter()->getValue() >= 0.5f)
                     pluginInstance->processBlockBypassed (buffer, midiBuffer);
                 else
                     pluginInstance->processBlock (buffer, midiBuffer);
+
+                pluginInstance->setParameterEvents (nullptr);
             }
 
            #if JUCE_DEBUG && (! JucePlugin_ProducesMidiOutput)
@@ -3752,6 +3788,9 @@ private:
         midiBuffer.ensureSize (2048);
         midiBuffer.clear();
 
+        parameterEvents.ensureStorageAllocated (jmax (2048, 4 * p.getParameters().size()));
+        parameterEvents.clear();
+
         bufferMapper.updateFromProcessor (p);
         bufferMapper.prepare (bufferSize);
     }
@@ -3830,6 +3869,7 @@ private:
     Vst::ProcessSetup processSetup;
 
     MidiBuffer midiBuffer;
+    ParameterEventList parameterEvents;
     ClientBufferMapper bufferMapper;
 
     bool active = false;
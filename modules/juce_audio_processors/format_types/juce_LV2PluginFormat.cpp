@@ -2462,6 +2462,11 @@ public:
         return cache.get ((size_t) getParameterIndex());
     }
 
+    float convertFrom0to1 (float normalised) const noexcept
+    {
+        return range.convertFrom0to1 (normalised);
+    }
+
     float getDefaultValue() const override { return normalisedDefault; }
     float getDenormalisedDefaultValue() const { return info.defaultValue; }
 
@@ -3566,7 +3571,7 @@ public:
     ParameterWriter (FloatWriter write, LV2_URID urid, uint32_t controlPortIndex)
         : data (PatchBacking { write, urid, controlPortIndex }), kind (Kind::patch) {}
 
-    void writeToProcessor (const ParameterWriterUrids urids, LV2_Atom_Forge* forge, float value) const
+    void writeToProcessor (const ParameterWriterUrids urids, LV2_Atom_Forge* forge, float value, int64_t frameTime = 0) const
     {
         switch (kind)
         {
@@ -3574,7 +3579,7 @@ public:
             {
                 if (forge != nullptr)
                 {
-                    lv2_atom_forge_frame_time (forge, 0);
+                    lv2_atom_forge_frame_time (forge, frameTime);
                     writeSetToForge (urids, *forge, value);
                 }
 
@@ -3956,6 +3961,24 @@ public:
                                         });
     }
 
+    /*  Only patch parameters can be changed part way through a block, as the value of a
+        control port is fixed for the whole of each run() call. Events for control ports are
+        skipped, and those ports will be set to the value at the end of the block instead.
+    */
+    void postEventToProcessor (const ParameterWriterUrids helperUrids,
+                               LV2_Atom_Forge* forge,
+                               const ParameterEventList::Event& event) const
+    {
+        if (! isPositiveAndBelow (event.parameterIndex, writers.size()))
+            return;
+
+        const auto& writer = writers[(size_t) event.parameterIndex];
+
+        if (const auto* urid = writer.getUrid())
+            if (auto* param = getParamByUrid (*urid))
+                writer.writeToProcessor (helperUrids, forge, param->convertFrom0to1 (event.value), event.sampleOffset);
+    }
+
     void postChangedParametersToUi (UiEventListener* target,
                                     const ParameterWriterUrids helperUrids,
                                     MessageBufferInterface<UiMessageHeader>& uiMessages)
@@ -4852,14 +4875,33 @@ private:
         {
             if (port.header.direction == Port::Direction::input)
             {
+                // Parameter events share the control port's sequence with MIDI, so the two must
+                // be merged to keep the sequence in time order
+                const ParameterEventList::Event* nextEvent = nullptr;
+                const ParameterEventList::Event* endEvent = nullptr;
+
+                if (const auto* events = getParameterEvents(); events != nullptr && &port == controlPort)
+                {
+                    nextEvent = events->begin();
+                    endEvent  = events->end();
+                }
+
+                const auto postEventsUpTo = [&] (int samplePosition)
+                {
+                    for (; nextEvent != endEvent && nextEvent->sampleOffset <= samplePosition; ++nextEvent)
+                        parameterValues.postEventToProcessor (getParameterWriterUrids(), controlPortForge, *nextEvent);
+                };
+
                 for (const auto meta : midiBuffer)
                 {
+                    postEventsUpTo (meta.samplePosition);
                     port.addEventToSequence (meta.samplePosition,
                                              instance->urids.mLV2_MIDI__MidiEvent,
                                              static_cast<uint32_t> (meta.numBytes),
                                              meta.data);
                 }
 
+                postEventsUpTo (std::numeric_limits<int>::max());
                 port.endSequence();
             }
         }
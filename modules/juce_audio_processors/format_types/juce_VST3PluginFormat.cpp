@@ -2081,10 +2081,11 @@ struct VST3ComponentHolder
 };
 
 //==============================================================================
-/*  A queue which can store up to one element.
+/*  A queue which can store a small, fixed number of points.
 
-    This is more memory-efficient than storing large vectors of
-    parameter changes that we'll just throw away.
+    Usually there's just one point per block, but sample-accurate parameter events
+    may add more. If the queue fills up, new points replace the final one, so that
+    the parameter still ends up at the right value.
 */
 class ParamValueQueue final : public Vst::IParamValueQueue
 {
@@ -2110,41 +2111,79 @@ public:
         if (! isPositiveAndBelow (index, size))
             return kResultFalse;
 
-        sampleOffset = 0;
-        value = cachedValue;
+        sampleOffset = points[(size_t) index].sampleOffset;
+        value = points[(size_t) index].value;
 
         return kResultTrue;
     }
 
-    tresult PLUGIN_API addPoint (Steinberg::int32,
+    tresult PLUGIN_API addPoint (Steinberg::int32 sampleOffset,
                                  Vst::ParamValue value,
                                  Steinberg::int32& index) override
     {
-        index = size++;
-        set ((float) value);
-
+        index = append (sampleOffset, (float) value);
         return kResultTrue;
     }
 
     void set (float valueIn)
     {
-        cachedValue = valueIn;
-        size = 1;
+        size = 0;
+        append (0, valueIn);
+        holdsEvents = false;
+    }
+
+    /*  Adds a point from a ParameterEventList. The first event for this queue in each block
+        replaces the single point that was added by set().
+    */
+    void addEvent (const ParameterEventList::Event& event)
+    {
+        if (! std::exchange (holdsEvents, true))
+            size = 0;
+
+        // VST3 ramps between points, so a step needs an extra point just before it to hold the old value
+        if (event.interpolation == ParameterEventList::Interpolation::step
+            && size > 0
+            && points[(size_t) size - 1].sampleOffset < event.sampleOffset - 1)
+        {
+            append (event.sampleOffset - 1, points[(size_t) size - 1].value);
+        }
+
+        append (event.sampleOffset, event.value);
     }
 
-    void clear() { size = 0; }
+    void clear()
+    {
+        size = 0;
+        holdsEvents = false;
+    }
 
     float get() const noexcept
     {
         jassert (size > 0);
-        return cachedValue;
+        return points[(size_t) size - 1].value;
     }
 
 private:
+    struct Point
+    {
+        Steinberg::int32 sampleOffset;
+        float value;
+    };
+
+    Steinberg::int32 append (Steinberg::int32 sampleOffset, float valueIn)
+    {
+        if (size == (Steinberg::int32) points.size())
+            --size;
+
+        points[(size_t) size] = { sampleOffset, valueIn };
+        return size++;
+    }
+
     const Vst::ParamID paramId;
     const Steinberg::int32 parameterIndex;
-    float cachedValue;
+    std::array<Point, 16> points;
     Steinberg::int32 size = 0;
+    bool holdsEvents = false;
     Atomic<int> refCount;
 };
 
@@ -2224,7 +2263,10 @@ public:
     void clear()
     {
         for (auto* item : queues)
+        {
             item->index = notInVector;
+            item->ptr->clear();
+        }
 
         queues.clear();
     }
@@ -2751,6 +2793,9 @@ public:
             inputParameterChanges->set (cachedParamValues.getParamID (index), value);
         });
 
+        if (auto* events = getParameterEvents())
+            addParameterEvents (*events);
+
         processor->process (data);
 
         outputParameterChanges->forEach ([&] (Steinberg::int32 vstParamIndex, Vst::ParamID id, float value)
@@ -3520,6 +3565,22 @@ private:
         lastProcessBlockCallWasBypass = processBlockBypassedCalled;
     }
 
+    void addParameterEvents (const ParameterEventList& events)
+    {
+        const auto& params = getParameters();
+
+        for (const auto& event : events)
+        {
+            if (auto* param = dynamic_cast<VST3Parameter*> (params[event.parameterIndex]))
+            {
+                Steinberg::int32 queueIndex = 0;
+
+                if (auto* queue = inputParameterChanges->addParameterData (param->getParamID(), queueIndex))
+                    queue->addEvent (event);
+            }
+        }
+    }
+
     //==============================================================================
     /** @note An IPlugView, when first created, should start with a ref-count of 1! */
     IPlugView* tryCreatingView() const
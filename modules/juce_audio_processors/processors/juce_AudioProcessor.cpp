@@ -596,6 +596,18 @@ void AudioProcessor::processBypassed (AudioBuffer<floatType>& buffer, MidiBuffer
 void AudioProcessor::processBlockBypassed (AudioBuffer<float>&  buffer, MidiBuffer& midi)    { processBypassed (buffer, midi); }
 void AudioProcessor::processBlockBypassed (AudioBuffer<double>& buffer, MidiBuffer& midi)    { processBypassed (buffer, midi); }
 
+bool AudioProcessor::canProcessInBatchWith (const AudioProcessor&) const   { return false; }
+
+template <typename FloatType>
+static void processBatchItemsInTurn (Span<const AudioProcessor::BatchItem<FloatType>> items)
+{
+    for (const auto& item : items)
+        item.processor.processBlock (item.buffer, item.midiMessages);
+}
+
+void AudioProcessor::processBatch (Span<const BatchItem<float>>  items)   { processBatchItemsInTurn (items); }
+void AudioProcessor::processBatch (Span<const BatchItem<double>> items)   { processBatchItemsInTurn (items); }
+
 void AudioProcessor::processBlock ([[maybe_unused]] AudioBuffer<double>& buffer,
                                    [[maybe_unused]] MidiBuffer& midiMessages)
 {
@@ -955,6 +967,36 @@ std::unique_ptr<XmlElement> AudioProcessor::getXmlFromBinary (const void* data,
     return {};
 }
 
+// The header is followed by a format version, so that the layout can be changed in the future
+const uint32 magicValueTreeNumber = 0x21324357;
+const int valueTreeBinaryVersion = 1;
+
+void AudioProcessor::copyValueTreeToBinary (const ValueTree& tree, juce::MemoryBlock& destData)
+{
+    MemoryOutputStream out (destData, false);
+    out.writeInt ((int) magicValueTreeNumber);
+    out.writeCompressedInt (valueTreeBinaryVersion);
+    tree.writeToStream (out);
+}
+
+ValueTree AudioProcessor::getValueTreeFromBinary (const void* data, const int sizeInBytes)
+{
+    if (sizeInBytes > 4 && ByteOrder::littleEndianInt (data) == magicValueTreeNumber)
+    {
+        MemoryInputStream in (addBytesToPointer (data, 4), (size_t) sizeInBytes - 4, false);
+
+        if (in.readCompressedInt() > valueTreeBinaryVersion)
+            return {};
+
+        return ValueTree::readFromStream (in);
+    }
+
+    if (auto xml = getXmlFromBinary (data, sizeInBytes))
+        return ValueTree::fromXml (*xml);
+
+    return {};
+}
+
 bool AudioProcessor::canApplyBusCountChange (bool isInput, bool isAdding,
                                              AudioProcessor::BusProperties& outProperties)
 {
@@ -304,6 +304,63 @@ public:
     virtual void processBlockBypassed (AudioBuffer<double>& buffer,
                                        MidiBuffer& midiMessages);
 
+    //==============================================================================
+    /** One of the processors in a call to processBatch(), along with the buffers that
+        it should render into.
+    */
+    template <typename FloatType>
+    struct BatchItem
+    {
+        AudioProcessor& processor;
+        AudioBuffer<FloatType>& buffer;
+        MidiBuffer& midiMessages;
+    };
+
+    /** Returns true if this processor can render another one's blocks, along with its own,
+        in a single call to processBatch().
+
+        A host that is running many copies of the same processor (e.g. one for each channel
+        of a mixer) can use this to hand them all to one of the copies at once, so that it
+        can share work between them, or process their channels in parallel using SIMD.
+        The AudioProcessorGraph does this for nodes that don't depend on each other.
+
+        The default implementation returns false.
+
+        @see processBatch
+    */
+    virtual bool canProcessInBatchWith (const AudioProcessor& other) const;
+
+    /** Renders the next block for a batch of processors.
+
+        This is called on the member of the batch whose canProcessInBatchWith() accepted the
+        others, or, while that one is suspended, on another member that accepts them all. The
+        items will include the members that need rendering in this block.
+        Usually that includes this processor, but it's left out of any block that it
+        doesn't need rendering for, e.g. because it's bypassed, in which case this should
+        just render the other items. Each
+        item's buffer and MIDI messages follow the same rules as the arguments passed to
+        processBlock(), and the getPlayHead() and getParameterEvents() of each processor
+        are valid for the duration of the call. All the buffers have the same number of
+        samples.
+
+        Bypassed processors aren't included in a batch, so you don't need to check the
+        bypass parameters here.
+
+        The default implementation calls processBlock() on each processor in turn.
+
+        @see canProcessInBatchWith
+    */
+    virtual void processBatch (Span<const BatchItem<float>> items);
+
+    /** Renders the next block for a batch of processors.
+
+        This is the double precision version of processBatch(), which will only be called
+        for processors that are using double precision processing.
+
+        @see canProcessInBatchWith
+    */
+    virtual void processBatch (Span<const BatchItem<double>> items);
+
 
     //==============================================================================
     /**
@@ -727,6 +784,30 @@ public:
     */
     AudioPlayHead* getPlayHead() const noexcept                 { return playHead; }
 
+    //==============================================================================
+    /** Returns the sample-accurate parameter changes that the host has sent for the
+        block that is currently being processed, or nullptr if there aren't any.
+
+        As with getPlayHead(), you can ONLY call this from your processBlock() method,
+        and you mustn't keep the pointer beyond the end of the current callback.
+
+        By the time processBlock() is called, the parameters will already have been set
+        to the values they have at the end of the block, so a processor that ignores
+        this list will behave just as it would have done without it.
+
+        @see ParameterEventList, setParameterEvents
+    */
+    const ParameterEventList* getParameterEvents() const noexcept   { return parameterEvents; }
+
+    /** Tells the processor about the parameter changes that happen during the next block.
+
+        Hosts should call this just before calling processBlock(), and then set it back
+        to nullptr afterwards. The processor doesn't take ownership of the list.
+
+        @see getParameterEvents
+    */
+    void setParameterEvents (const ParameterEventList* newEvents) noexcept  { parameterEvents = newEvents; }
+
     //==============================================================================
     /** Returns the total number of input channels.
 
@@ -1311,6 +1392,27 @@ public:
     */
     static std::unique_ptr<XmlElement> getXmlFromBinary (const void* data, int sizeInBytes);
 
+    /** Helper function that converts a ValueTree into a binary blob.
+
+        This stores the tree in its own binary format rather than as XML text, so it's
+        much quicker than calling copyXmlToBinary() with the result of ValueTree::createXml(),
+        and the data is smaller.
+
+        Use getValueTreeFromBinary() to reverse this operation.
+
+        @see AudioProcessorValueTreeState::copyStateToBinary
+    */
+    static void copyValueTreeToBinary (const ValueTree& tree,
+                                       juce::MemoryBlock& destData);
+
+    /** Retrieves a ValueTree that was stored as binary with the copyValueTreeToBinary() method.
+
+        This will also read XML that was stored with copyXmlToBinary(), so a processor can
+        switch from one to the other without losing the ability to load its old state.
+        This returns an invalid ValueTree if the data's unsuitable or corrupted.
+    */
+    static ValueTree getValueTreeFromBinary (const void* data, int sizeInBytes);
+
     /** @internal */
     static void JUCE_CALLTYPE setTypeOfNextNewPlugin (WrapperType);
 
@@ -1527,6 +1629,7 @@ private:
     int blockSize = 0, latencySamples = 0;
     bool suspended = false;
     std::atomic<bool> nonRealtime { false };
+    const ParameterEventList* parameterEvents = nullptr;
     ProcessingPrecision processingPrecision = singlePrecision;
     CriticalSection callbackLock, listenerLock, activeEditorLock;
 
@@ -114,6 +114,14 @@ public:
                              new Node { nodeID, std::move (newProcessor) });
     }
 
+    /*  Adds a node that may also belong to another set of nodes. */
+    Node::Ptr addNode (Node::Ptr node)
+    {
+        const auto iter = std::lower_bound (array.begin(), array.end(), node->nodeID, ImplicitNode::compare);
+        jassert (iter == array.end() || (*iter)->nodeID != node->nodeID);
+        return array.insert ((int) std::distance (array.begin(), iter), node);
+    }
+
     Node::Ptr removeNode (NodeID nodeID)
     {
         const auto iter = std::lower_bound (array.begin(), array.end(), nodeID, ImplicitNode::compare);
@@ -142,7 +150,9 @@ public:
 private:
     static auto equalRange (const std::set<NodeAndChannel>& pins, const NodeID node)
     {
-        return std::equal_range (pins.cbegin(), pins.cend(), node, ImplicitNode::compare);
+        // std::equal_range would only be able to step through the set one item at a time
+        return std::make_pair (pins.lower_bound ({ node, std::numeric_limits<int>::min() }),
+                               pins.upper_bound ({ node, std::numeric_limits<int>::max() }));
     }
 
     using Map = std::map<NodeAndChannel, std::set<NodeAndChannel>>;
@@ -304,6 +314,13 @@ public:
             return false;
         }
 
+        template <typename Fn>
+        void forEachSource (Fn&& fn) const
+        {
+            for (const auto& [source, destinations] : map)
+                fn (source, destinations);
+        }
+
     private:
         Map map;
     };
@@ -362,7 +379,8 @@ private:
 
     std::pair<Map::const_iterator, Map::const_iterator> getMatchingDestinations (NodeID destID) const
     {
-        return std::equal_range (sourcesForDestination.cbegin(), sourcesForDestination.cend(), destID, ImplicitNode::compare);
+        return { sourcesForDestination.lower_bound ({ destID, std::numeric_limits<int>::min() }),
+                 sourcesForDestination.upper_bound ({ destID, std::numeric_limits<int>::max() }) };
     }
 
     Map sourcesForDestination;
@@ -391,6 +409,15 @@ class NodeStates
 public:
     using Node           = AudioProcessorGraph::Node;
     using NodeID         = AudioProcessorGraph::NodeID;
+    using NodeStatus     = AudioProcessorGraph::NodePreparationStatus;
+
+    /*  onJobFinished is called on a preparation thread each time a node has been prepared in
+        the background, so that the graph can be rebuilt to include it. It mustn't block, or
+        take any lock that may be held while calling applySettings(), because applySettings()
+        may have to wait a moment for a finished job to return.
+    */
+    explicit NodeStates (std::function<void()> onJobFinishedIn)
+        : onJobFinished (std::move (onJobFinishedIn)) {}
 
     /*  Called from prepareToPlay and releaseResources with the PrepareSettings that should be
         used next time the graph is rebuilt.
@@ -417,6 +444,10 @@ public:
         be prepared/unprepared as necessary. If the PrepareSettings have not changed, then only
         new nodes will be prepared/unprepared.
 
+        If there are preparation threads, new nodes (other than the graph's IO nodes) are queued
+        to be prepared in the background instead, and are reported by getNodesBeingPrepared()
+        until a later call finds that they're ready.
+
         Returns the settings that were applied to the nodes.
     */
     std::optional<PrepareSettings> applySettings (const Nodes& n)
@@ -446,28 +477,46 @@ public:
         // Due to the implied mutex between prepareToPlay/releaseResources/processBlock, it's also
         // impossible to receive new PrepareSettings and to start a new RenderSequence rebuild while
         // a processBlock call is in progress.
+        //
+        // Nodes that are being prepared in the background aren't part of the current
+        // RenderSequence, so the audio thread can't call processBlock on them until they're ready.
+        // A node can't be released while it's being prepared, but this may be called from the
+        // graph's updater, so it mustn't wait for the preparation threads. Instead, a node whose
+        // job is running is released when the job finishes, and is then queued again.
 
         if (settingsChanged)
         {
+            cancelQueuedJobs();
+
             for (const auto& node : n.getNodes())
-                node->getProcessor()->releaseResources();
+                if (! isBeingPrepared (node->nodeID))
+                    node->getProcessor()->releaseResources();
 
             preparedNodes.clear();
         }
 
+        collectFinishedJobs();
+
         if (current.has_value())
         {
             for (const auto& node : n.getNodes())
             {
-                if (preparedNodes.find (node->nodeID) != preparedNodes.cend())
+                if (preparedNodes.find (node->nodeID) != preparedNodes.cend()
+                    || jobs.find (node->nodeID) != jobs.cend())
                     continue;
 
-                preparedNodes.insert (node->nodeID);
+                // The IO nodes are cheap to prepare, and the graph can't make a sound without them
+                if (pool != nullptr && dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (node->getProcessor()) == nullptr)
+                {
+                    auto job = std::make_unique<PreparationJob> (node, *current, onJobFinished);
+                    pool->addJob (job.get(), false);
+                    jobs.emplace (node->nodeID, std::move (job));
+                    statusChanges.emplace_back (node->nodeID, NodeStatus::queued);
+                    continue;
+                }
 
-                node->getProcessor()->setProcessingPrecision (node->getProcessor()->supportsDoublePrecisionProcessing() ? current->precision
-                                                                                                                        : AudioProcessor::singlePrecision);
-                node->getProcessor()->setRateAndBufferSizeDetails (current->sampleRate, current->blockSize);
-                node->getProcessor()->prepareToPlay               (current->sampleRate, current->blockSize);
+                preparedNodes.insert (node->nodeID);
+                prepare (*node, *current);
             }
         }
 
@@ -479,6 +528,7 @@ public:
     void removeNode (const NodeID n)
     {
         preparedNodes.erase (n);
+        cancelJob (n);
     }
 
     /*  Call from the main thread to indicate that all nodes have been removed from the graph.
@@ -486,12 +536,437 @@ public:
     void clear()
     {
         preparedNodes.clear();
+
+        while (! jobs.empty())
+            cancelJob (jobs.begin()->first);
+    }
+
+    /*  Call from the main thread only.
+
+        Nodes that were queued with the old number of threads and haven't started to be prepared
+        will be queued again next time applySettings() is called.
+    */
+    void setNumPreparationThreads (int numThreads)
+    {
+        numThreads = jmax (0, numThreads);
+
+        if (numThreads == getNumPreparationThreads())
+            return;
+
+        waitForPreparationThreads();
+
+        pool = numThreads > 0 ? std::make_unique<ThreadPool> (ThreadPoolOptions{}.withThreadName ("Graph node preparation")
+                                                                                 .withNumberOfThreads (numThreads))
+                              : nullptr;
+    }
+
+    int getNumPreparationThreads() const noexcept
+    {
+        return pool != nullptr ? pool->getNumThreads() : 0;
+    }
+
+    /*  Call from the main thread only. */
+    std::set<NodeID> getNodesBeingPrepared() const
+    {
+        std::set<NodeID> result;
+
+        for (const auto& job : jobs)
+            result.insert (job.first);
+
+        return result;
+    }
+
+    /*  Call from the main thread only. */
+    bool isBeingPrepared (NodeID n) const   { return jobs.find (n) != jobs.cend(); }
+    int getNumBeingPrepared() const         { return (int) jobs.size(); }
+
+    /*  Call from the main thread only. Returns the status changes since the last call, in order. */
+    std::vector<std::pair<NodeID, NodeStatus>> takeStatusChanges()
+    {
+        return std::exchange (statusChanges, {});
+    }
+
+    /*  Call from the main thread before destroying anything that onJobFinished refers to.
+        Queued jobs are abandoned, and any jobs that are running are allowed to finish.
+    */
+    void stopPreparationThreads()
+    {
+        waitForPreparationThreads();
+        pool.reset();
     }
 
 private:
+    static void prepare (const Node& node, const PrepareSettings& settings)
+    {
+        auto* processor = node.getProcessor();
+        processor->setProcessingPrecision (processor->supportsDoublePrecisionProcessing() ? settings.precision
+                                                                                           : AudioProcessor::singlePrecision);
+        processor->setRateAndBufferSizeDetails (settings.sampleRate, settings.blockSize);
+        processor->prepareToPlay               (settings.sampleRate, settings.blockSize);
+    }
+
+    /*  Prepares a single node on one of the preparation threads. The job keeps the node alive, so
+        a node that's removed from the graph while it's being prepared isn't deleted until the job
+        has finished with it.
+    */
+    class PreparationJob final : public ThreadPoolJob
+    {
+    public:
+        PreparationJob (Node::Ptr nodeIn, const PrepareSettings& settingsIn, std::function<void()> onFinishedIn)
+            : ThreadPoolJob ("Prepare " + nodeIn->getProcessor()->getName()),
+              node (std::move (nodeIn)),
+              settings (settingsIn),
+              onFinished (std::move (onFinishedIn))
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            prepare (*node, settings);
+            finished.store (true, std::memory_order_release);
+
+            if (onFinished != nullptr)
+                onFinished();
+
+            return jobHasFinished;
+        }
+
+        bool hasFinished() const { return finished.load (std::memory_order_acquire); }
+        const PrepareSettings& getSettings() const { return settings; }
+
+        /*  Call once the job has finished, if the node's preparation is no longer wanted. */
+        void releaseNode() const { node->getProcessor()->releaseResources(); }
+
+    private:
+        Node::Ptr node;
+        PrepareSettings settings;
+        std::function<void()> onFinished;
+        std::atomic<bool> finished { false };
+    };
+
+    /*  Moves the nodes whose jobs have finished into the set of prepared nodes. The nodes of
+        the other finished jobs are released, either because they've been removed from the graph,
+        or because the settings changed while they were being prepared, in which case they'll be
+        queued again.
+    */
+    void collectFinishedJobs()
+    {
+        const auto isFinished = [this] (const std::unique_ptr<PreparationJob>& job)
+        {
+            if (! job->hasFinished())
+                return false;
+
+            // The pool may still be holding on to the job for a moment after it has run
+            pool->waitForJobToFinish (job.get(), -1);
+            return true;
+        };
+
+        for (auto it = jobs.begin(); it != jobs.end();)
+        {
+            if (! isFinished (it->second))
+            {
+                ++it;
+                continue;
+            }
+
+            if (current == it->second->getSettings())
+            {
+                preparedNodes.insert (it->first);
+                statusChanges.emplace_back (it->first, NodeStatus::ready);
+            }
+            else
+            {
+                it->second->releaseNode();
+            }
+
+            it = jobs.erase (it);
+        }
+
+        const auto releaseIfFinished = [&] (const std::unique_ptr<PreparationJob>& job)
+        {
+            if (! isFinished (job))
+                return false;
+
+            job->releaseNode();
+            return true;
+        };
+
+        abandonedJobs.erase (std::remove_if (abandonedJobs.begin(), abandonedJobs.end(), releaseIfFinished),
+                             abandonedJobs.end());
+    }
+
+    /*  Removes a node's job from the queue. If the job has already started, it's kept until it
+        has finished, as the node can't be released while it's being prepared.
+    */
+    void cancelJob (NodeID n)
+    {
+        const auto it = jobs.find (n);
+
+        if (it == jobs.end())
+            return;
+
+        if (! pool->removeJob (it->second.get(), false, 0))
+            abandonedJobs.push_back (std::move (it->second));
+        else if (it->second->hasFinished())
+            it->second->releaseNode();
+
+        jobs.erase (it);
+        statusChanges.emplace_back (n, NodeStatus::cancelled);
+    }
+
+    /*  Forgets the jobs that haven't started, so that they can be queued again. The ones that
+        are running are left to finish.
+    */
+    void cancelQueuedJobs()
+    {
+        for (auto it = jobs.begin(); it != jobs.end();)
+        {
+            if (! it->second->hasFinished() && pool->removeJob (it->second.get(), false, 0))
+                it = jobs.erase (it);
+            else
+                ++it;
+        }
+    }
+
+    /*  Finishes the jobs that are running, and forgets the ones that haven't started. This blocks,
+        so it mustn't be called from the graph's updater.
+    */
+    void waitForPreparationThreads()
+    {
+        if (pool == nullptr)
+            return;
+
+        pool->removeAllJobs (false, -1);
+        collectFinishedJobs();
+
+        // These never ran, so they'll be queued again
+        jobs.clear();
+        abandonedJobs.clear();
+    }
+
     std::mutex mutex;
     std::set<NodeID> preparedNodes;
     std::optional<PrepareSettings> current, next;
+
+    std::function<void()> onJobFinished;
+    std::unique_ptr<ThreadPool> pool;
+    std::map<NodeID, std::unique_ptr<PreparationJob>> jobs;
+    std::vector<std::unique_ptr<PreparationJob>> abandonedJobs;
+    std::vector<std::pair<NodeID, NodeStatus>> statusChanges;
+};
+
+//==============================================================================
+/*  Collects the times taken by a single node to process each block.
+
+    The times are sorted into a histogram with logarithmically spaced bins, so that the
+    percentiles can be estimated without storing every measurement. Only the audio thread
+    records times, so the counters are updated without any read-modify-write operations.
+    Any thread may take a snapshot of the counters at any time.
+*/
+class NodeTimingHistogram
+{
+public:
+    struct Snapshot
+    {
+        uint64 numBlocks = 0;
+        double minSeconds = 0, meanSeconds = 0, p99Seconds = 0, maxSeconds = 0;
+    };
+
+    /*  Call from the audio thread only. */
+    void record (int64 ticks) noexcept
+    {
+        if (resetRequested.exchange (false, std::memory_order_acquire))
+            clearCounts();
+
+        const auto t = (uint64) jmax ((int64) 0, ticks);
+        increment (bins[(size_t) getBinIndex (t)], 1u);
+
+        const auto n = count.load (std::memory_order_relaxed);
+        sum.store (sum.load (std::memory_order_relaxed) + t, std::memory_order_relaxed);
+
+        if (n == 0 || t < minTicks.load (std::memory_order_relaxed))
+            minTicks.store (t, std::memory_order_relaxed);
+
+        if (t > maxTicks.load (std::memory_order_relaxed))
+            maxTicks.store (t, std::memory_order_relaxed);
+
+        count.store (n + 1, std::memory_order_release);
+    }
+
+    /*  Asks the audio thread to discard the times recorded so far. */
+    void requestReset() noexcept
+    {
+        resetRequested.store (true, std::memory_order_release);
+    }
+
+    /*  May be called from any thread. The fields of the snapshot are read one by one, so
+        they may come from neighbouring blocks if the audio thread is running.
+    */
+    Snapshot getSnapshot() const
+    {
+        Snapshot result;
+
+        if (resetRequested.load (std::memory_order_acquire))
+            return result;
+
+        const auto n = count.load (std::memory_order_acquire);
+
+        if (n == 0)
+            return result;
+
+        const auto minimum = minTicks.load (std::memory_order_relaxed);
+        const auto maximum = jmax (minimum, maxTicks.load (std::memory_order_relaxed));
+
+        // The 99th percentile is reported as the top of the bin that contains it
+        const auto target = n - n / 100;
+        uint64 total = 0;
+        auto p99 = maximum;
+
+        for (size_t i = 0; i < bins.size(); ++i)
+        {
+            total += bins[i].load (std::memory_order_relaxed);
+
+            if (total >= target)
+            {
+                p99 = jlimit (minimum, maximum, getBinStart ((int) i + 1));
+                break;
+            }
+        }
+
+        result.numBlocks   = n;
+        result.minSeconds  = Time::highResolutionTicksToSeconds ((int64) minimum);
+        result.meanSeconds = Time::highResolutionTicksToSeconds ((int64) (sum.load (std::memory_order_relaxed) / n));
+        result.p99Seconds  = Time::highResolutionTicksToSeconds ((int64) p99);
+        result.maxSeconds  = Time::highResolutionTicksToSeconds ((int64) maximum);
+        return result;
+    }
+
+private:
+    // Each power of two is split into 8 bins, and values below 8 have a bin each
+    static constexpr int binsPerOctave = 8;
+    static constexpr int numBins = binsPerOctave * 62;
+
+    static int getHighestSetBit (uint64 t) noexcept
+    {
+        const auto high = (uint32) (t >> 32);
+        return high != 0 ? 32 + findHighestSetBit (high) : findHighestSetBit ((uint32) t);
+    }
+
+    static int getBinIndex (uint64 t) noexcept
+    {
+        if (t < (uint64) binsPerOctave)
+            return (int) t;
+
+        const auto msb = getHighestSetBit (t);
+        const auto mantissa = (int) ((t >> (msb - 3)) & (binsPerOctave - 1));
+        return binsPerOctave * (msb - 2) + mantissa;
+    }
+
+    static uint64 getBinStart (int index) noexcept
+    {
+        if (index < binsPerOctave)
+            return (uint64) index;
+
+        if (index >= numBins)
+            return std::numeric_limits<uint64>::max();
+
+        const auto msb = index / binsPerOctave + 2;
+        return (uint64) (binsPerOctave + index % binsPerOctave) << (msb - 3);
+    }
+
+    template <typename Value>
+    static void increment (std::atomic<Value>& a, Value delta) noexcept
+    {
+        a.store (a.load (std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    void clearCounts() noexcept
+    {
+        for (auto& b : bins)
+            b.store (0, std::memory_order_relaxed);
+
+        sum.store (0, std::memory_order_relaxed);
+        minTicks.store (0, std::memory_order_relaxed);
+        maxTicks.store (0, std::memory_order_relaxed);
+        count.store (0, std::memory_order_release);
+    }
+
+    std::array<std::atomic<uint32>, (size_t) numBins> bins {};
+    std::atomic<uint64> count { 0 }, sum { 0 }, minTicks { 0 }, maxTicks { 0 };
+    std::atomic<bool> resetRequested { false };
+};
+
+//==============================================================================
+/*  Owns the timing histograms of the nodes in a graph.
+
+    Render sequences hold on to the histograms of the nodes that they render, so a histogram
+    can safely be dropped from here while the audio thread is still recording into it.
+*/
+class NodeTimings
+{
+public:
+    using NodeID = AudioProcessorGraph::NodeID;
+
+    struct Entry
+    {
+        NodeID nodeID;
+        String name;
+        NodeTimingHistogram::Snapshot snapshot;
+    };
+
+    std::shared_ptr<NodeTimingHistogram> getHistogram (NodeID n, const String& name)
+    {
+        const std::lock_guard<std::mutex> lock (mutex);
+        auto& named = histograms[n];
+        named.name = name;
+
+        if (named.histogram == nullptr)
+            named.histogram = std::make_shared<NodeTimingHistogram>();
+
+        return named.histogram;
+    }
+
+    void removeNode (NodeID n)
+    {
+        const std::lock_guard<std::mutex> lock (mutex);
+        histograms.erase (n);
+    }
+
+    void clear()
+    {
+        const std::lock_guard<std::mutex> lock (mutex);
+        histograms.clear();
+    }
+
+    void reset()
+    {
+        const std::lock_guard<std::mutex> lock (mutex);
+
+        for (auto& pair : histograms)
+            pair.second.histogram->requestReset();
+    }
+
+    std::vector<Entry> getEntries() const
+    {
+        const std::lock_guard<std::mutex> lock (mutex);
+        std::vector<Entry> result;
+        result.reserve (histograms.size());
+
+        for (const auto& pair : histograms)
+            result.push_back ({ pair.first, pair.second.name, pair.second.histogram->getSnapshot() });
+
+        return result;
+    }
+
+private:
+    struct NamedHistogram
+    {
+        String name;
+        std::shared_ptr<NodeTimingHistogram> histogram;
+    };
+
+    mutable std::mutex mutex;
+    std::map<NodeID, NamedHistogram> histograms;
 };
 
 //==============================================================================
@@ -513,9 +988,19 @@ struct GraphRenderSequence
         GlobalIO globalIO;
         AudioPlayHead* audioPlayHead;
         int numSamples;
+
+        // A flag for each of the rendering buffers, which is set when the buffer is known to
+        // be silent for the rest of the current block
+        bool* silentBuffers;
+        bool sleepingEnabled;
+
+        // The position of this chunk in the block that was passed to the graph
+        int startSample;
+        bool isFinalChunk;
     };
 
-    void perform (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages, AudioPlayHead* audioPlayHead)
+    void perform (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages, AudioPlayHead* audioPlayHead, bool sleepingEnabled,
+                  int startSample = 0, bool isFinalChunk = true)
     {
         auto numSamples = buffer.getNumSamples();
         auto maxSamples = renderingBuffer.getNumSamples();
@@ -534,7 +1019,8 @@ struct GraphRenderSequence
 
                 // Splitting up the buffer like this will cause the play head and host time to be
                 // invalid for all but the first chunk...
-                perform (audioChunk, midiChunk, audioPlayHead);
+                perform (audioChunk, midiChunk, audioPlayHead, sleepingEnabled,
+                         chunkStartSample, chunkStartSample + chunkSize == numSamples);
 
                 chunkStartSample += maxSamples;
             }
@@ -546,13 +1032,21 @@ struct GraphRenderSequence
         currentAudioOutputBuffer.clear();
         currentMidiOutputBuffer.clear();
 
+        // Only the read-only empty buffer is known to be silent until the ops have filled the others
+        std::fill (silentBuffers.get(), silentBuffers.get() + numSilentBuffers, false);
+        silentBuffers[0] = true;
+
         {
             const Context context { { buffer,
                                       currentAudioOutputBuffer,
                                       midiMessages,
                                       currentMidiOutputBuffer },
                                     audioPlayHead,
-                                    numSamples };
+                                    numSamples,
+                                    silentBuffers.get(),
+                                    sleepingEnabled,
+                                    startSample,
+                                    isFinalChunk };
 
             for (const auto& op : renderOps)
                 op->process (context);
@@ -580,7 +1074,8 @@ struct GraphRenderSequence
 
             void process (const Context& c) override
             {
-                FloatVectorOperations::clear (channelBuffer, c.numSamples);
+                if (! std::exchange (c.silentBuffers[index], true))
+                    FloatVectorOperations::clear (channelBuffer, c.numSamples);
             }
 
             FloatType* channelBuffer = nullptr;
@@ -604,7 +1099,12 @@ struct GraphRenderSequence
 
             void process (const Context& c) override
             {
-                FloatVectorOperations::copy (toBuffer, fromBuffer, c.numSamples);
+                if (! c.silentBuffers[from])
+                    FloatVectorOperations::copy (toBuffer, fromBuffer, c.numSamples);
+                else if (! c.silentBuffers[to])
+                    FloatVectorOperations::clear (toBuffer, c.numSamples);
+
+                c.silentBuffers[to] = c.silentBuffers[from];
             }
 
             FloatType* fromBuffer = nullptr;
@@ -629,7 +1129,13 @@ struct GraphRenderSequence
 
             void process (const Context& c) override
             {
-                FloatVectorOperations::add (toBuffer, fromBuffer, c.numSamples);
+                if (c.silentBuffers[from])
+                    return;
+
+                if (std::exchange (c.silentBuffers[to], false))
+                    FloatVectorOperations::copy (toBuffer, fromBuffer, c.numSamples);
+                else
+                    FloatVectorOperations::add (toBuffer, fromBuffer, c.numSamples);
             }
 
             FloatType* fromBuffer = nullptr;
@@ -733,6 +1239,20 @@ struct GraphRenderSequence
 
             void process (const Context& c) override
             {
+                // Once the delay line only holds silence, a silent input needs no work at all
+                if (c.silentBuffers[channel])
+                {
+                    if (numSilentSamples >= (int) buffer.size())
+                        return;
+
+                    numSilentSamples += c.numSamples;
+                }
+                else
+                {
+                    numSilentSamples = 0;
+                }
+
+                c.silentBuffers[channel] = false;
                 auto* data = channelBuffer;
 
                 for (int i = c.numSamples; --i >= 0;)
@@ -748,7 +1268,7 @@ struct GraphRenderSequence
             std::vector<FloatType> buffer;
             FloatType* channelBuffer = nullptr;
             const int channel;
-            int readIndex = 0, writeIndex;
+            int readIndex = 0, writeIndex, numSilentSamples = 0;
         };
 
         renderOps.push_back (std::make_unique<DelayChannelOp> (chan, delaySize));
@@ -785,6 +1305,24 @@ struct GraphRenderSequence
         renderOps.push_back (std::move (op));
     }
 
+    struct BatchMember
+    {
+        Node::Ptr node;
+        Array<int> audioChannelsUsed;
+        int totalNumChans = 0, midiBuffer = 0;
+    };
+
+    void addBatchOp (const std::vector<BatchMember>& batch)
+    {
+        std::vector<std::unique_ptr<ProcessOp>> members;
+        members.reserve (batch.size());
+
+        for (const auto& member : batch)
+            members.push_back (std::make_unique<ProcessOp> (member.node, member.audioChannelsUsed, member.totalNumChans, member.midiBuffer));
+
+        renderOps.push_back (std::make_unique<BatchOp> (std::move (members)));
+    }
+
     void prepareBuffers (int blockSize)
     {
         renderingBuffer.setSize (numBuffersNeeded + 1, blockSize);
@@ -794,6 +1332,9 @@ struct GraphRenderSequence
 
         currentMidiOutputBuffer.clear();
 
+        numSilentBuffers = (size_t) numBuffersNeeded + 1;
+        silentBuffers.calloc (numSilentBuffers);
+
         midiBuffers.clearQuick();
         midiBuffers.resize (numMidiBuffersNeeded);
 
@@ -808,9 +1349,26 @@ struct GraphRenderSequence
             op->prepare (renderingBuffer.getArrayOfWritePointers(), midiBuffers.data());
     }
 
+    /*  Wraps each of the node ops so that its processing time is recorded. This must be
+        called before prepareBuffers().
+    */
+    void addNodeTimings (NodeTimings& timings)
+    {
+        for (auto& op : renderOps)
+        {
+            if (auto* nodeOp = dynamic_cast<NodeOp*> (op.get()))
+            {
+                auto histogram = timings.getHistogram (nodeOp->node->nodeID, nodeOp->processor.getName());
+                op = std::make_unique<TimedOp> (std::move (op), std::move (histogram));
+            }
+        }
+    }
+
     int numBuffersNeeded = 0, numMidiBuffersNeeded = 0;
 
     AudioBuffer<FloatType> renderingBuffer, currentAudioOutputBuffer;
+    HeapBlock<bool> silentBuffers;
+    size_t numSilentBuffers = 0;
 
     MidiBuffer currentMidiOutputBuffer;
 
@@ -852,31 +1410,72 @@ private:
 
         void process (const Context& c) final
         {
-            processor.setPlayHead (c.audioPlayHead);
+            AudioBuffer<FloatType> buffer { audioChannels.data(), getNumAudioChannels(), c.numSamples };
 
-            auto numAudioChannels = [this]
-            {
-                if (const auto* proc = node->getProcessor())
-                    if (proc->getTotalNumInputChannels() == 0 && proc->getTotalNumOutputChannels() == 0)
-                        return 0;
+            if (beginBlock (c, buffer))
+                processWithBuffer (c, isBypassedForBlock(), buffer, *midiBuffer);
 
-                return (int) audioChannels.size();
-            }();
+            endBlock (c);
+        }
 
-            AudioBuffer<FloatType> buffer { audioChannels.data(), numAudioChannels, c.numSamples };
+        int getNumAudioChannels() const
+        {
+            if (const auto* proc = node->getProcessor())
+                if (proc->getTotalNumInputChannels() == 0 && proc->getTotalNumOutputChannels() == 0)
+                    return 0;
 
-            if (processor.isSuspended())
-            {
-                buffer.clear();
-            }
-            else
-            {
-                const auto bypass = node->isBypassed() && processor.getBypassParameter() == nullptr;
-                processWithBuffer (c.globalIO, bypass, buffer, *midiBuffer);
-            }
+            return (int) audioChannels.size();
+        }
+
+        // Returns false if the processor is suspended, in which case its output has been cleared
+        bool beginBlock (const Context& c, AudioBuffer<FloatType>& buffer)
+        {
+            processor.setPlayHead (c.audioPlayHead);
+
+            if (! processor.isSuspended())
+                return true;
+
+            buffer.clear();
+            setChannelsSilent (c, 0, buffer.getNumChannels(), true);
+            return false;
+        }
+
+        bool isBypassedForBlock() const
+        {
+            return node->isBypassed() && processor.getBypassParameter() == nullptr;
+        }
+
+        void endBlock (const Context& c)
+        {
+            // The events only apply to this block, whether or not the node used them
+            if (c.isFinalChunk)
+                node->getParameterEvents().clear();
+        }
+
+        virtual void processWithBuffer (const Context&, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer& midi) = 0;
+
+        bool isChannelSilent (const Context& c, int channel) const
+        {
+            return c.silentBuffers[audioChannelsToUse.getUnchecked (channel)];
+        }
+
+        void setChannelsSilent (const Context& c, int begin, int end, bool silent) const
+        {
+            for (auto i = begin; i < end; ++i)
+                if (const auto index = audioChannelsToUse.getUnchecked (i); index != 0)
+                    c.silentBuffers[index] = silent;
         }
 
-        virtual void processWithBuffer (const GlobalIO&, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer& midi) = 0;
+        // Checking the samples themselves is only worth doing if nodes are allowed to sleep
+        template <typename Value>
+        static bool containsSilence (const Context& c, const AudioBuffer<Value>& audio, int channel)
+        {
+            if (audio.hasBeenCleared())
+                return true;
+
+            return c.sleepingEnabled
+                && FloatVectorOperations::findMinAndMax (audio.getReadPointer (channel), audio.getNumSamples()) == Range<Value>();
+        }
 
         const Node::Ptr node;
         AudioProcessor& processor;
@@ -889,11 +1488,114 @@ private:
 
     struct ProcessOp final : public NodeOp
     {
-        using NodeOp::NodeOp;
+        ProcessOp (const Node::Ptr& n,
+                   const Array<int>& audioChannelsUsed,
+                   int totalNumChans,
+                   int midiBufferIndex)
+            : NodeOp (n, audioChannelsUsed, totalNumChans, midiBufferIndex),
+              numInputs (this->processor.getTotalNumInputChannels()),
+              numOutputs (this->processor.getTotalNumOutputChannels()),
+              sleepAfterSamples (getSamplesUntilSleep (this->processor))
+        {
+            // Splitting a block may add a couple of events for each parameter
+            chunkEvents.ensureStorageAllocated (n->getParameterEvents().getCapacity()
+                                                  + 2 * this->processor.getParameters().size());
+        }
+
+        void processWithBuffer (const Context& c, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer& midi) final
+        {
+            if (isAwake (c, bypass, audio, midi))
+            {
+                callProcessWithEvents (c, bypass, audio, midi);
+                updateOutputFlags (c, audio);
+            }
+        }
+
+        // Returns false if the processor is asleep, in which case its output has been cleared
+        bool isAwake (const Context& c, bool bypass, AudioBuffer<FloatType>& audio, const MidiBuffer& midi)
+        {
+            if (! c.sleepingEnabled || bypass || sleepAfterSamples < 0 || ! isInputSilent (c, midi))
+            {
+                numSilentInputSamples = 0;
+                return true;
+            }
+
+            if (numSilentInputSamples >= sleepAfterSamples)
+            {
+                // The input channels that are also outputs are already known to be silent
+                for (auto i = numInputs; i < numOutputs; ++i)
+                    if (! this->isChannelSilent (c, i))
+                        audio.clear (i, 0, audio.getNumSamples());
+
+                this->setChannelsSilent (c, 0, numOutputs, true);
+                return false;
+            }
+
+            numSilentInputSamples += audio.getNumSamples();
+            return true;
+        }
+
+        // A processor can only go to sleep if its output depends entirely on its input, and
+        // it has said how long it'll take for its output to die away after the input stops
+        static int getSamplesUntilSleep (const AudioProcessor& p)
+        {
+            const auto tail = p.getTailLengthSeconds();
+
+            if (! (0.0 <= tail && tail < std::numeric_limits<double>::infinity()) || p.producesMidi())
+                return -1;
+
+            if (p.getTotalNumInputChannels() == 0 && ! p.acceptsMidi())
+                return -1;
+
+            return p.getLatencySamples() + (int) std::ceil (jmin (tail * p.getSampleRate(), (double) std::numeric_limits<int>::max() / 2));
+        }
+
+        bool isInputSilent (const Context& c, const MidiBuffer& midi) const
+        {
+            if (this->processor.acceptsMidi() && ! midi.isEmpty())
+                return false;
+
+            if (! this->node->getParameterEvents().isEmpty())
+                return false;
+
+            for (auto i = 0; i < numInputs; ++i)
+                if (! this->isChannelSilent (c, i))
+                    return false;
+
+            return true;
+        }
+
+        void updateOutputFlags (const Context& c, const AudioBuffer<FloatType>& audio) const
+        {
+            for (auto i = 0; i < jmin (numOutputs, audio.getNumChannels()); ++i)
+                this->setChannelsSilent (c, i, i + 1, this->containsSilence (c, audio, i));
+
+            // A processor may also write into its input-only channels, such as a sidechain,
+            // so those buffers will need clearing before they're reused
+            this->setChannelsSilent (c, numOutputs, audio.getNumChannels(), false);
+        }
+
+        const ParameterEventList* getParameterEventsForChunk (const Context& c)
+        {
+            const auto& events = this->node->getParameterEvents();
 
-        void processWithBuffer (const GlobalIO&, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer& midi) final
+            if (events.isEmpty())
+                return nullptr;
+
+            if (c.startSample == 0 && c.isFinalChunk)
+                return &events;
+
+            chunkEvents.clear();
+            chunkEvents.addEvents (events, c.startSample, c.numSamples, -c.startSample);
+            return chunkEvents.isEmpty() ? nullptr : &chunkEvents;
+        }
+
+        template <typename Value>
+        void callProcessWithEvents (const Context& c, bool bypass, AudioBuffer<Value>& buffer, MidiBuffer& midi)
         {
-            callProcess (bypass, audio, midi);
+            this->processor.setParameterEvents (getParameterEventsForChunk (c));
+            callProcess (bypass, buffer, midi);
+            this->processor.setParameterEvents (nullptr);
         }
 
         void callProcess (bool bypass, AudioBuffer<float>& buffer, MidiBuffer& midi)
@@ -934,16 +1636,135 @@ private:
         }
 
         AudioBuffer<float> tempBufferFloat, tempBufferDouble;
+        ParameterEventList chunkEvents;
+        const int numInputs, numOutputs, sleepAfterSamples;
+        int numSilentInputSamples = 0;
+    };
+
+    /*  Renders a group of nodes with a single call to AudioProcessor::processBatch() on the
+        first of them that isn't suspended or asleep. Nodes that are bypassed are rendered on
+        their own, and nodes that are suspended or asleep are left out of the batch.
+    */
+    struct BatchOp final : public RenderOp
+    {
+        explicit BatchOp (std::vector<std::unique_ptr<ProcessOp>> membersIn)
+            : members (std::move (membersIn)),
+              buffers (members.size()),
+              emptyMidiBuffers (members.size())
+        {
+            items.reserve (members.size());
+            awakeMembers.reserve (members.size());
+            possibleLeaders.reserve (members.size());
+        }
+
+        void prepare (FloatType* const* renderBuffer, MidiBuffer* midiBuffers) override
+        {
+            for (auto& member : members)
+                member->prepare (renderBuffer, midiBuffers);
+        }
+
+        void process (const Context& c) override
+        {
+            items.clear();
+            awakeMembers.clear();
+            possibleLeaders.clear();
+
+            for (size_t i = 0; i < members.size(); ++i)
+            {
+                auto& member = *members[i];
+                auto& buffer = buffers[i];
+                buffer.setDataToReferTo (member.audioChannels.data(), member.getNumAudioChannels(), c.numSamples);
+
+                // The plan doesn't reserve a MIDI buffer for batched nodes that don't use MIDI
+                auto& midi = [&]() -> MidiBuffer&
+                {
+                    if (member.processor.acceptsMidi() || member.processor.producesMidi())
+                        return *member.midiBuffer;
+
+                    emptyMidiBuffers[i].clear();
+                    return emptyMidiBuffers[i];
+                }();
+
+                if (! member.beginBlock (c, buffer))
+                    continue;
+
+                if (member.isBypassedForBlock())
+                {
+                    member.processWithBuffer (c, true, buffer, midi);
+                    possibleLeaders.push_back (i);
+                }
+                else if (member.isAwake (c, false, buffer, midi))
+                {
+                    member.processor.setParameterEvents (member.getParameterEventsForChunk (c));
+                    items.push_back ({ member.processor, buffer, midi });
+                    awakeMembers.push_back (i);
+                    possibleLeaders.push_back (i);
+                }
+            }
+
+            if (! items.empty())
+            {
+                if (auto* leader = findLeader())
+                {
+                    leader->processBatch (Span<const Item> (items));
+                }
+                else
+                {
+                    for (size_t i = 0; i < items.size(); ++i)
+                        members[awakeMembers[i]]->callProcess (false, items[i].buffer, items[i].midiMessages);
+                }
+            }
+
+            for (const auto i : awakeMembers)
+            {
+                members[i]->processor.setParameterEvents (nullptr);
+                members[i]->updateOutputFlags (c, buffers[i]);
+            }
+
+            for (auto& member : members)
+                member->endBlock (c);
+        }
+
+        using Item = AudioProcessor::BatchItem<FloatType>;
+
+        // The batch was formed by its first member's canProcessInBatchWith(), so that member
+        // renders it whenever it can, even if it's bypassed and so left out of the items. A
+        // suspended or sleeping member mustn't be called, so another member that accepts all
+        // the items takes over, and if there isn't one, each item is rendered on its own.
+        AudioProcessor* findLeader() const
+        {
+            for (const auto i : possibleLeaders)
+            {
+                auto& candidate = members[i]->processor;
+
+                if (i == 0 || std::all_of (items.begin(), items.end(), [&] (const Item& item)
+                                           {
+                                               return &item.processor == &candidate
+                                                   || candidate.canProcessInBatchWith (item.processor);
+                                           }))
+                {
+                    return &candidate;
+                }
+            }
+
+            return nullptr;
+        }
+
+        std::vector<std::unique_ptr<ProcessOp>> members;
+        std::vector<AudioBuffer<FloatType>> buffers;
+        std::vector<MidiBuffer> emptyMidiBuffers;
+        std::vector<Item> items;
+        std::vector<size_t> awakeMembers, possibleLeaders;
     };
 
     struct MidiInOp final : public NodeOp
     {
         using NodeOp::NodeOp;
 
-        void processWithBuffer (const GlobalIO& g, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer& midi) final
+        void processWithBuffer (const Context& c, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer& midi) final
         {
             if (! bypass)
-                midi.addEvents (g.midiIn, 0, audio.getNumSamples(), 0);
+                midi.addEvents (c.globalIO.midiIn, 0, audio.getNumSamples(), 0);
         }
     };
 
@@ -951,10 +1772,10 @@ private:
     {
         using NodeOp::NodeOp;
 
-        void processWithBuffer (const GlobalIO& g, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer& midi) final
+        void processWithBuffer (const Context& c, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer& midi) final
         {
             if (! bypass)
-                g.midiOut.addEvents (midi, 0, audio.getNumSamples(), 0);
+                c.globalIO.midiOut.addEvents (midi, 0, audio.getNumSamples(), 0);
         }
     };
 
@@ -962,13 +1783,21 @@ private:
     {
         using NodeOp::NodeOp;
 
-        void processWithBuffer (const GlobalIO& g, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer&) final
+        void processWithBuffer (const Context& c, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer&) final
         {
+            this->setChannelsSilent (c, 0, audio.getNumChannels(), false);
+
             if (bypass)
                 return;
 
-            for (int i = jmin (g.audioIn.getNumChannels(), audio.getNumChannels()); --i >= 0;)
-                audio.copyFrom (i, 0, g.audioIn, i, 0, audio.getNumSamples());
+            const auto& audioIn = c.globalIO.audioIn;
+            const auto numChannels = jmin (audioIn.getNumChannels(), audio.getNumChannels());
+
+            for (int i = numChannels; --i >= 0;)
+            {
+                audio.copyFrom (i, 0, audioIn, i, 0, audio.getNumSamples());
+                this->setChannelsSilent (c, i, i + 1, this->containsSilence (c, audioIn, i));
+            }
         }
     };
 
@@ -976,14 +1805,38 @@ private:
     {
         using NodeOp::NodeOp;
 
-        void processWithBuffer (const GlobalIO& g, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer&) final
+        void processWithBuffer (const Context& c, bool bypass, AudioBuffer<FloatType>& audio, MidiBuffer&) final
         {
             if (bypass)
                 return;
 
-            for (int i = jmin (g.audioOut.getNumChannels(), audio.getNumChannels()); --i >= 0;)
-                g.audioOut.addFrom (i, 0, audio, i, 0, audio.getNumSamples());
+            auto& audioOut = c.globalIO.audioOut;
+
+            for (int i = jmin (audioOut.getNumChannels(), audio.getNumChannels()); --i >= 0;)
+                if (! this->isChannelSilent (c, i))
+                    audioOut.addFrom (i, 0, audio, i, 0, audio.getNumSamples());
+        }
+    };
+
+    struct TimedOp final : public RenderOp
+    {
+        TimedOp (std::unique_ptr<RenderOp> opIn, std::shared_ptr<NodeTimingHistogram> histogramIn)
+            : op (std::move (opIn)), histogram (std::move (histogramIn)) {}
+
+        void prepare (FloatType* const* renderBuffer, MidiBuffer* buffers) override
+        {
+            op->prepare (renderBuffer, buffers);
+        }
+
+        void process (const Context& c) override
+        {
+            const auto start = Time::getHighResolutionTicks();
+            op->process (c);
+            histogram->record (Time::getHighResolutionTicks() - start);
         }
+
+        std::unique_ptr<RenderOp> op;
+        std::shared_ptr<NodeTimingHistogram> histogram;
     };
 
     std::vector<std::unique_ptr<RenderOp>> renderOps;
@@ -1000,121 +1853,464 @@ struct SequenceAndLatency
 };
 
 //==============================================================================
-class RenderSequenceBuilder
+/*  Holds information about the properties of a graph node at the point it was prepared.
+
+    If the bus layout or latency of a given node changes, the graph should be rebuilt so
+    that channel connections are ordered correctly, and the graph's internal delay lines have
+    the correct delay.
+*/
+class NodeAttributes
 {
+    auto tie() const { return std::tie (layout, latencySamples); }
+
 public:
-    using Node           = AudioProcessorGraph::Node;
+    AudioProcessor::BusesLayout layout;
+    int latencySamples = 0;
+
+    bool operator== (const NodeAttributes& other) const { return tie() == other.tie(); }
+    bool operator!= (const NodeAttributes& other) const { return tie() != other.tie(); }
+};
+
+//==============================================================================
+/*  Records which output of which node is held in one of the buffers of a render sequence. */
+struct AssignedBuffer
+{
     using NodeID         = AudioProcessorGraph::NodeID;
-    using Connection     = AudioProcessorGraph::Connection;
     using NodeAndChannel = AudioProcessorGraph::NodeAndChannel;
 
-    static constexpr auto midiChannelIndex = AudioProcessorGraph::midiChannelIndex;
+    NodeAndChannel channel;
 
-    template <typename FloatType>
-    static SequenceAndLatency build (const Nodes& n, const Connections& c)
-    {
-        GraphRenderSequence<FloatType> sequence;
-        const RenderSequenceBuilder builder (n, c, sequence);
-        return { std::move (sequence), builder.totalLatency };
-    }
+    static AssignedBuffer createReadOnlyEmpty() noexcept    { return { { zeroNodeID(), 0 } }; }
+    static AssignedBuffer createFree() noexcept             { return { { freeNodeID(), 0 } }; }
 
-private:
-    //==============================================================================
-    const Array<Node*> orderedNodes;
+    bool isReadOnlyEmpty() const noexcept                   { return channel.nodeID == zeroNodeID(); }
+    bool isFree() const noexcept                            { return channel.nodeID == freeNodeID(); }
+    bool isAssigned() const noexcept                        { return ! (isReadOnlyEmpty() || isFree()); }
 
-    struct AssignedBuffer
-    {
-        NodeAndChannel channel;
+    void setFree() noexcept                                 { channel = { freeNodeID(), 0 }; }
+    void setAssignedToNonExistentNode() noexcept            { channel = { anonNodeID(), 0 }; }
+
+private:
+    static NodeID anonNodeID() { return NodeID (0x7ffffffd); }
+    static NodeID zeroNodeID() { return NodeID (0x7ffffffe); }
+    static NodeID freeNodeID() { return NodeID (0x7fffffff); }
+};
 
-        static AssignedBuffer createReadOnlyEmpty() noexcept    { return { { zeroNodeID(), 0 } }; }
-        static AssignedBuffer createFree() noexcept             { return { { freeNodeID(), 0 } }; }
+//==============================================================================
+/*  The operations needed to render a graph, independent of the processing precision.
 
-        bool isReadOnlyEmpty() const noexcept                   { return channel.nodeID == zeroNodeID(); }
-        bool isFree() const noexcept                            { return channel.nodeID == freeNodeID(); }
-        bool isAssigned() const noexcept                        { return ! (isReadOnlyEmpty() || isFree()); }
+    The operations are grouped into a step for each node, in the order that the nodes will be
+    rendered.
+*/
+class RenderPlan
+{
+public:
+    using Node = AudioProcessorGraph::Node;
 
-        void setFree() noexcept                                 { channel = { freeNodeID(), 0 }; }
-        void setAssignedToNonExistentNode() noexcept            { channel = { anonNodeID(), 0 }; }
+    struct Op
+    {
+        enum class Type { clearChannel, copyChannel, addChannel, clearMidi, copyMidi, addMidi, delayChannel };
 
-    private:
-        static NodeID anonNodeID() { return NodeID (0x7ffffffd); }
-        static NodeID zeroNodeID() { return NodeID (0x7ffffffe); }
-        static NodeID freeNodeID() { return NodeID (0x7fffffff); }
+        Type type;
+        int first = 0, second = 0;
     };
 
-    Array<AssignedBuffer> audioBuffers, midiBuffers;
-
-    enum { readOnlyEmptyBufferIndex = 0 };
+    struct Step
+    {
+        Node::Ptr node;
+        std::vector<Op> ops;
+        Array<int> audioChannelsUsed;
+        int totalNumChans = 0, midiBuffer = 0;
+    };
 
-    std::unordered_map<uint32, int> delays;
-    int totalLatency = 0;
+    void addClearChannelOp (int index)                    { pendingOps.push_back ({ Op::Type::clearChannel, index }); }
+    void addCopyChannelOp (int srcIndex, int dstIndex)    { pendingOps.push_back ({ Op::Type::copyChannel, srcIndex, dstIndex }); }
+    void addAddChannelOp (int srcIndex, int dstIndex)     { pendingOps.push_back ({ Op::Type::addChannel, srcIndex, dstIndex }); }
+    void addClearMidiBufferOp (int index)                 { pendingOps.push_back ({ Op::Type::clearMidi, index }); }
+    void addCopyMidiBufferOp (int srcIndex, int dstIndex) { pendingOps.push_back ({ Op::Type::copyMidi, srcIndex, dstIndex }); }
+    void addAddMidiBufferOp (int srcIndex, int dstIndex)  { pendingOps.push_back ({ Op::Type::addMidi, srcIndex, dstIndex }); }
+    void addDelayChannelOp (int chan, int delaySize)      { pendingOps.push_back ({ Op::Type::delayChannel, chan, delaySize }); }
 
-    int getNodeDelay (NodeID nodeID) const noexcept
+    void addProcessOp (const Node::Ptr& node,
+                       const Array<int>& audioChannelsUsed,
+                       int totalNumChans,
+                       int midiBuffer)
     {
-        const auto iter = delays.find (nodeID.uid);
-        return iter != delays.end() ? iter->second : 0;
+        Step step;
+        step.node = node;
+        step.ops = std::exchange (pendingOps, {});
+        step.audioChannelsUsed = audioChannelsUsed;
+        step.totalNumChans = totalNumChans;
+        step.midiBuffer = midiBuffer;
+        steps.push_back (std::move (step));
     }
 
-    int getInputLatencyForNode (const Connections& c, NodeID nodeID) const
+    template <typename FloatType>
+    SequenceAndLatency createSequence (bool allowBatches) const
     {
-        const auto sources = c.getSourceNodesForDestination (nodeID);
-        return std::accumulate (sources.cbegin(), sources.cend(), 0, [this] (auto acc, auto source)
-        {
-            return jmax (acc, this->getNodeDelay (source));
-        });
-    }
+        GraphRenderSequence<FloatType> sequence;
 
-    //==============================================================================
-    void getAllParentsOfNode (const NodeID& child,
-                              std::set<NodeID>& parents,
-                              const std::map<NodeID, std::set<NodeID>>& otherParents,
-                              const Connections& c)
-    {
-        for (const auto& parentNode : c.getSourceNodesForDestination (child))
+        // The batch that each step belongs to, if any
+        const auto batches = allowBatches ? findBatches (std::is_same_v<FloatType, double>)
+                                          : std::vector<std::vector<size_t>>{};
+        std::vector<const std::vector<size_t>*> batchForStep (steps.size(), nullptr);
+
+        for (const auto& batch : batches)
+            for (const auto index : batch)
+                batchForStep[index] = &batch;
+
+        for (size_t stepIndex = 0; stepIndex < steps.size(); ++stepIndex)
         {
-            if (parentNode == child)
-                continue;
+            const auto& step = steps[stepIndex];
 
-            if (parents.insert (parentNode).second)
+            for (const auto& op : step.ops)
             {
-                const auto parentParents = otherParents.find (parentNode);
-
-                if (parentParents != otherParents.end())
+                switch (op.type)
                 {
-                    parents.insert (parentParents->second.begin(), parentParents->second.end());
-                    continue;
+                    case Op::Type::clearChannel:    sequence.addClearChannelOp (op.first);              break;
+                    case Op::Type::copyChannel:     sequence.addCopyChannelOp (op.first, op.second);    break;
+                    case Op::Type::addChannel:      sequence.addAddChannelOp (op.first, op.second);     break;
+                    case Op::Type::clearMidi:       sequence.addClearMidiBufferOp (op.first);           break;
+                    case Op::Type::copyMidi:        sequence.addCopyMidiBufferOp (op.first, op.second); break;
+                    case Op::Type::addMidi:         sequence.addAddMidiBufferOp (op.first, op.second);  break;
+                    case Op::Type::delayChannel:    sequence.addDelayChannelOp (op.first, op.second);   break;
                 }
+            }
 
-                getAllParentsOfNode (parentNode, parents, otherParents, c);
+            if (const auto* batch = batchForStep[stepIndex])
+            {
+                // A batch is rendered in place of its last member, when all of its inputs are ready
+                if (batch->back() == stepIndex)
+                {
+                    std::vector<typename GraphRenderSequence<FloatType>::BatchMember> members;
+
+                    for (const auto index : *batch)
+                        members.push_back ({ steps[index].node, steps[index].audioChannelsUsed, steps[index].totalNumChans, steps[index].midiBuffer });
+
+                    sequence.addBatchOp (members);
+                }
+            }
+            else
+            {
+                sequence.addProcessOp (step.node, step.audioChannelsUsed, step.totalNumChans, step.midiBuffer);
             }
         }
+
+        sequence.numBuffersNeeded = numBuffersNeeded;
+        sequence.numMidiBuffersNeeded = numMidiBuffersNeeded;
+
+        return { std::move (sequence), latencySamples };
     }
 
-    Array<Node*> createOrderedNodeList (const Nodes& n, const Connections& c)
+    std::vector<Step> steps;
+    int numBuffersNeeded = 0, numMidiBuffersNeeded = 0, latencySamples = 0;
+
+private:
+    static bool usesMidi (const AudioProcessor& p)
     {
-        Array<Node*> result;
+        return p.acceptsMidi() || p.producesMidi();
+    }
 
-        std::map<NodeID, std::set<NodeID>> nodeParents;
+    static bool canBeBatched (const AudioProcessor& p, bool isDoublePrecision)
+    {
+        return dynamic_cast<const AudioProcessorGraph::AudioGraphIOProcessor*> (&p) == nullptr
+            && p.isUsingDoublePrecision() == isDoublePrecision;
+    }
 
-        for (auto& node : n.getNodes())
+    /*  Finds groups of steps whose processors can be rendered by a single call to
+        AudioProcessor::processBatch(). As a batch is rendered in place of its last member,
+        the ops between its members mustn't touch any of the earlier members' buffers.
+    */
+    std::vector<std::vector<size_t>> findBatches (bool isDoublePrecision) const
+    {
+        struct OpenBatch
         {
-            const auto nodeID = node->nodeID;
-            int insertionIndex = 0;
+            std::vector<size_t> members;
+            std::set<int> audioChannels, midiBuffers;
 
-            for (; insertionIndex < result.size(); ++insertionIndex)
+            bool usesAudio (int index) const { return index != 0 && audioChannels.count (index) != 0; }
+            bool usesMidi (int index) const  { return midiBuffers.count (index) != 0; }
+        };
+
+        std::vector<std::vector<size_t>> result;
+        std::vector<OpenBatch> open;
+
+        const auto closeBatchesWhere = [&] (auto&& predicate)
+        {
+            for (auto it = open.begin(); it != open.end();)
             {
-                auto& parents = nodeParents[result.getUnchecked (insertionIndex)->nodeID];
+                if (! predicate (*it))
+                {
+                    ++it;
+                    continue;
+                }
 
-                if (parents.find (nodeID) != parents.end())
-                    break;
+                if (it->members.size() > 1)
+                    result.push_back (std::move (it->members));
+
+                it = open.erase (it);
             }
+        };
 
-            result.insert (insertionIndex, node);
-            getAllParentsOfNode (nodeID, nodeParents[node->nodeID], nodeParents, c);
-        }
+        for (size_t stepIndex = 0; stepIndex < steps.size(); ++stepIndex)
+        {
+            const auto& step = steps[stepIndex];
 
-        return result;
-    }
+            for (const auto& op : step.ops)
+            {
+                closeBatchesWhere ([&op] (const OpenBatch& b)
+                {
+                    switch (op.type)
+                    {
+                        case Op::Type::clearChannel:
+                        case Op::Type::delayChannel:    return b.usesAudio (op.first);
+                        case Op::Type::copyChannel:
+                        case Op::Type::addChannel:      return b.usesAudio (op.first) || b.usesAudio (op.second);
+                        case Op::Type::clearMidi:       return b.usesMidi (op.first);
+                        case Op::Type::copyMidi:
+                        case Op::Type::addMidi:         return b.usesMidi (op.first) || b.usesMidi (op.second);
+                    }
+
+                    return true;
+                });
+            }
+
+            const auto& processor = *step.node->getProcessor();
+            const auto batchable = canBeBatched (processor, isDoublePrecision);
+
+            // Batched nodes that don't use MIDI are given an empty MIDI buffer of their own
+            const auto usesMidiBuffer = ! batchable || usesMidi (processor);
+
+            closeBatchesWhere ([&] (const OpenBatch& b)
+            {
+                return (usesMidiBuffer && b.usesMidi (step.midiBuffer))
+                    || std::any_of (step.audioChannelsUsed.begin(), step.audioChannelsUsed.end(), [&b] (int i) { return b.usesAudio (i); });
+            });
+
+            if (! batchable)
+                continue;
+
+            auto batch = std::find_if (open.begin(), open.end(), [&] (const OpenBatch& b)
+            {
+                return steps[b.members.front()].node->getProcessor()->canProcessInBatchWith (processor);
+            });
+
+            if (batch == open.end())
+                batch = open.emplace (open.end());
+
+            batch->members.push_back (stepIndex);
+            batch->audioChannels.insert (step.audioChannelsUsed.begin(), step.audioChannelsUsed.end());
+
+            if (usesMidiBuffer)
+                batch->midiBuffers.insert (step.midiBuffer);
+        }
+
+        closeBatchesWhere ([] (const OpenBatch&) { return true; });
+        return result;
+    }
+
+    std::vector<Op> pendingOps;
+};
+
+//==============================================================================
+class RenderSequenceBuilder
+{
+public:
+    using Node           = AudioProcessorGraph::Node;
+    using NodeID         = AudioProcessorGraph::NodeID;
+    using Connection     = AudioProcessorGraph::Connection;
+    using NodeAndChannel = AudioProcessorGraph::NodeAndChannel;
+
+    static constexpr auto midiChannelIndex = AudioProcessorGraph::midiChannelIndex;
+
+    static RenderPlan build (const Nodes& n, const Connections& c)
+    {
+        RenderPlan plan;
+        const RenderSequenceBuilder builder (n, c, plan);
+        return plan;
+    }
+
+private:
+    //==============================================================================
+    const Array<Node*> orderedNodes;
+    std::unordered_map<uint32, int> positions;
+
+    // The position of the last node that reads from each output
+    std::map<NodeAndChannel, int> lastUses;
+
+    Array<AssignedBuffer> audioBuffers, midiBuffers;
+
+    enum { readOnlyEmptyBufferIndex = 0 };
+
+    std::unordered_map<uint32, int> delays;
+    int totalLatency = 0;
+
+    int getNodeDelay (NodeID nodeID) const noexcept
+    {
+        const auto iter = delays.find (nodeID.uid);
+        return iter != delays.end() ? iter->second : 0;
+    }
+
+    int getInputLatencyForNode (const Connections& c, NodeID nodeID) const
+    {
+        const auto sources = c.getSourceNodesForDestination (nodeID);
+        return std::accumulate (sources.cbegin(), sources.cend(), 0, [this] (auto acc, auto source)
+        {
+            return jmax (acc, this->getNodeDelay (source));
+        });
+    }
+
+    //==============================================================================
+    void getAllParentsOfNode (const NodeID& child,
+                              std::set<NodeID>& parents,
+                              const std::map<NodeID, std::set<NodeID>>& otherParents,
+                              const Connections& c)
+    {
+        for (const auto& parentNode : c.getSourceNodesForDestination (child))
+        {
+            if (parentNode == child)
+                continue;
+
+            if (parents.insert (parentNode).second)
+            {
+                const auto parentParents = otherParents.find (parentNode);
+
+                if (parentParents != otherParents.end())
+                {
+                    parents.insert (parentParents->second.begin(), parentParents->second.end());
+                    continue;
+                }
+
+                getAllParentsOfNode (parentNode, parents, otherParents, c);
+            }
+        }
+    }
+
+    /*  Returns true if any two of the graph's nodes could be rendered in the same batch. */
+    static bool containsBatchableNodes (const Nodes& n)
+    {
+        std::vector<const AudioProcessor*> kinds;
+
+        for (auto* node : n.getNodes())
+        {
+            const auto& processor = *node->getProcessor();
+
+            if (std::any_of (kinds.begin(), kinds.end(), [&] (auto* k) { return k->canProcessInBatchWith (processor); }))
+                return true;
+
+            kinds.push_back (&processor);
+        }
+
+        return false;
+    }
+
+    /*  Orders the nodes so that each one comes after all of its inputs, and otherwise by ID.
+        Returns nothing if the graph contains a feedback loop.
+
+        If some of the nodes can be batched, the nodes are ordered by their distance from the
+        graph's inputs first, so that nodes which don't depend on each other end up together.
+    */
+    static std::optional<Array<Node*>> createTopologicalNodeList (const Nodes& n, const Connections& c)
+    {
+        const auto& nodes = n.getNodes();
+        const auto numNodes = (size_t) nodes.size();
+
+        // Nodes are identified here by their index in the array, which is sorted by ID
+        const auto getIndex = [&] (NodeID nodeID)
+        {
+            const auto iter = std::lower_bound (nodes.begin(), nodes.end(), nodeID, ImplicitNode::compare);
+            return iter != nodes.end() && (*iter)->nodeID == nodeID ? (size_t) std::distance (nodes.begin(), iter)
+                                                                    : numNodes;
+        };
+
+        std::vector<std::vector<size_t>> destinations (numNodes);
+        std::vector<size_t> numSources (numNodes);
+
+        for (size_t i = 0; i < numNodes; ++i)
+        {
+            const auto nodeID = nodes.getUnchecked ((int) i)->nodeID;
+
+            for (const auto& source : c.getSourceNodesForDestination (nodeID))
+            {
+                const auto sourceIndex = getIndex (source);
+
+                if (source != nodeID && sourceIndex < numNodes)
+                {
+                    destinations[sourceIndex].push_back (i);
+                    ++numSources[i];
+                }
+            }
+        }
+
+        const auto orderByLevel = containsBatchableNodes (n);
+        std::vector<size_t> levels (numNodes);
+
+        using LevelAndIndex = std::pair<size_t, size_t>;
+        std::priority_queue<LevelAndIndex, std::vector<LevelAndIndex>, std::greater<>> ready;
+
+        for (size_t i = 0; i < numNodes; ++i)
+            if (numSources[i] == 0)
+                ready.emplace (0, i);
+
+        Array<Node*> result;
+        result.ensureStorageAllocated ((int) numNodes);
+
+        while (! ready.empty())
+        {
+            const auto index = ready.top().second;
+            ready.pop();
+            result.add (nodes.getUnchecked ((int) index));
+
+            for (const auto destination : destinations[index])
+            {
+                if (orderByLevel)
+                    levels[destination] = jmax (levels[destination], levels[index] + 1);
+
+                if (--numSources[destination] == 0)
+                    ready.emplace (levels[destination], destination);
+            }
+        }
+
+        if (result.size() != (int) numNodes)
+            return {};
+
+        return result;
+    }
+
+    Array<Node*> orderNodes (const Nodes& n, const Connections& c)
+    {
+        if (auto ordered = createTopologicalNodeList (n, c))
+            return std::move (*ordered);
+
+        return createOrderedNodeList (n, c);
+    }
+
+    /*  Orders the nodes of a graph that contains feedback loops. */
+    Array<Node*> createOrderedNodeList (const Nodes& n, const Connections& c)
+    {
+        Array<Node*> result;
+
+        std::map<NodeID, std::set<NodeID>> nodeParents;
+
+        for (auto& node : n.getNodes())
+        {
+            const auto nodeID = node->nodeID;
+            int insertionIndex = 0;
+
+            for (; insertionIndex < result.size(); ++insertionIndex)
+            {
+                auto& parents = nodeParents[result.getUnchecked (insertionIndex)->nodeID];
+
+                if (parents.find (nodeID) != parents.end())
+                    break;
+            }
+
+            result.insert (insertionIndex, node);
+            getAllParentsOfNode (nodeID, nodeParents[node->nodeID], nodeParents, c);
+        }
+
+        return result;
+    }
 
     //==============================================================================
     template <typename RenderSequence>
@@ -1473,30 +2669,48 @@ private:
             return true;
         }
 
-        return std::any_of (orderedNodes.begin() + stepIndexToSearchFrom + 1, orderedNodes.end(), [&] (const auto* node)
+        const auto iter = lastUses.find (output);
+        return iter != lastUses.end() && iter->second > stepIndexToSearchFrom;
+    }
+
+    void findLastUses (const Connections::DestinationsForSources& reversed)
+    {
+        reversed.forEachSource ([&] (const NodeAndChannel& source, const std::set<NodeAndChannel>& destinations)
         {
-            return c.isSourceConnectedToDestinationNodeIgnoringChannel (output, node->nodeID, -1);
+            auto lastUse = -1;
+
+            for (const auto& destination : destinations)
+                if (const auto iter = positions.find (destination.nodeID.uid); iter != positions.end())
+                    lastUse = jmax (lastUse, iter->second);
+
+            lastUses.emplace (source, lastUse);
         });
     }
 
-    template <typename RenderSequence>
-    RenderSequenceBuilder (const Nodes& n, const Connections& c, RenderSequence& sequence)
-        : orderedNodes (createOrderedNodeList (n, c))
+    RenderSequenceBuilder (const Nodes& n, const Connections& c, RenderPlan& plan)
+        : orderedNodes (orderNodes (n, c))
     {
-        audioBuffers.add (AssignedBuffer::createReadOnlyEmpty()); // first buffer is read-only zeros
-        midiBuffers .add (AssignedBuffer::createReadOnlyEmpty());
+        for (int i = 0; i < orderedNodes.size(); ++i)
+            positions.emplace (orderedNodes.getUnchecked (i)->nodeID.uid, i);
 
         const auto reversed = c.getDestinationsForSources();
+        findLastUses (reversed);
+
+        audioBuffers.add (AssignedBuffer::createReadOnlyEmpty()); // first buffer is read-only zeros
+        midiBuffers .add (AssignedBuffer::createReadOnlyEmpty());
 
         for (int i = 0; i < orderedNodes.size(); ++i)
         {
-            createRenderingOpsForNode (c, reversed, sequence, *orderedNodes.getUnchecked (i), i);
+            auto& node = *orderedNodes.getUnchecked (i);
+            createRenderingOpsForNode (c, reversed, plan, node, i);
+
             markAnyUnusedBuffersAsFree (reversed, audioBuffers, i);
             markAnyUnusedBuffersAsFree (reversed, midiBuffers, i);
         }
 
-        sequence.numBuffersNeeded = audioBuffers.size();
-        sequence.numMidiBuffersNeeded = midiBuffers.size();
+        plan.numBuffersNeeded = audioBuffers.size();
+        plan.numMidiBuffersNeeded = midiBuffers.size();
+        plan.latencySamples = totalLatency;
     }
 };
 
@@ -1512,18 +2726,20 @@ class RenderSequence
 public:
     using AudioGraphIOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
 
-    RenderSequence (const PrepareSettings s, const Nodes& n, const Connections& c)
+    // Nodes that are rendered in a batch can't be timed individually, so there are no batches while profiling
+    RenderSequence (const PrepareSettings s, const RenderPlan& plan, NodeTimings* timings)
         : RenderSequence (s, s.precision == AudioProcessor::ProcessingPrecision::singlePrecision
-                                ? RenderSequenceBuilder::build<float>  (n, c)
-                                : RenderSequenceBuilder::build<double> (n, c))
+                                ? plan.createSequence<float>  (timings == nullptr)
+                                : plan.createSequence<double> (timings == nullptr),
+                          timings)
     {
     }
 
     template <typename FloatType>
-    void process (AudioBuffer<FloatType>& audio, MidiBuffer& midi, AudioPlayHead* playHead)
+    void process (AudioBuffer<FloatType>& audio, MidiBuffer& midi, AudioPlayHead* playHead, bool sleepingEnabled)
     {
         if (auto* s = std::get_if<GraphRenderSequence<FloatType>> (&sequence.sequence))
-            s->perform (audio, midi, playHead);
+            s->perform (audio, midi, playHead, sleepingEnabled);
         else
             jassertfalse; // Not prepared for this audio format!
     }
@@ -1540,35 +2756,22 @@ private:
         jassertfalse;
     }
 
-    RenderSequence (const PrepareSettings s, SequenceAndLatency&& built)
+    RenderSequence (const PrepareSettings s, SequenceAndLatency&& built, NodeTimings* timings)
         : settings (s), sequence (std::move (built))
     {
-        visitRenderSequence (*this, [&] (auto& seq) { seq.prepareBuffers (settings.blockSize); });
+        visitRenderSequence (*this, [&] (auto& seq)
+        {
+            if (timings != nullptr)
+                seq.addNodeTimings (*timings);
+
+            seq.prepareBuffers (settings.blockSize);
+        });
     }
 
     PrepareSettings settings;
     SequenceAndLatency sequence;
 };
 
-//==============================================================================
-/*  Holds information about the properties of a graph node at the point it was prepared.
-
-    If the bus layout or latency of a given node changes, the graph should be rebuilt so
-    that channel connections are ordered correctly, and the graph's internal delay lines have
-    the correct delay.
-*/
-class NodeAttributes
-{
-    auto tie() const { return std::tie (layout, latencySamples); }
-
-public:
-    AudioProcessor::BusesLayout layout;
-    int latencySamples = 0;
-
-    bool operator== (const NodeAttributes& other) const { return tie() == other.tie(); }
-    bool operator!= (const NodeAttributes& other) const { return tie() != other.tie(); }
-};
-
 //==============================================================================
 /*  Holds information about a particular graph configuration, without sharing ownership of any
     graph nodes. Can be checked for equality with other RenderSequenceSignature instances to see
@@ -1576,11 +2779,11 @@ public:
 */
 class RenderSequenceSignature
 {
-    auto tie() const { return std::tie (settings, connections, nodes); }
+    auto tie() const { return std::tie (settings, connections, nodes, timed); }
 
 public:
-    RenderSequenceSignature (const PrepareSettings s, const Nodes& n, const Connections& c)
-        : settings (s), connections (c), nodes (getNodeMap (n)) {}
+    RenderSequenceSignature (const PrepareSettings s, const Nodes& n, const Connections& c, bool isTimed)
+        : settings (s), connections (c), nodes (getNodeMap (n)), timed (isTimed) {}
 
     bool operator== (const RenderSequenceSignature& other) const { return tie() == other.tie(); }
     bool operator!= (const RenderSequenceSignature& other) const { return tie() != other.tie(); }
@@ -1607,6 +2810,7 @@ private:
     PrepareSettings settings;
     Connections connections;
     NodeMap nodes;
+    bool timed = false;
 };
 
 //==============================================================================
@@ -1653,6 +2857,15 @@ public:
     /*  Call from the audio thread only. */
     RenderSequence* getAudioThreadState() const { return audioThreadState.get(); }
 
+    /*  Returns true once the audio thread has picked up the last sequence that was set, after
+        which it won't use any of the older sequences again.
+    */
+    bool isAudioThreadUpToDate()
+    {
+        const SpinLock::ScopedLockType lock (mutex);
+        return ! isNew;
+    }
+
 private:
     void timerCallback() override
     {
@@ -1668,639 +2881,2338 @@ private:
 };
 
 //==============================================================================
-AudioProcessorGraph::Connection::Connection (NodeAndChannel src, NodeAndChannel dst) noexcept
-    : source (src), destination (dst)
-{
-}
-
-bool AudioProcessorGraph::Connection::operator== (const Connection& other) const noexcept
-{
-    return source == other.source && destination == other.destination;
-}
-
-bool AudioProcessorGraph::Connection::operator!= (const Connection& c) const noexcept
-{
-    return ! operator== (c);
-}
-
-bool AudioProcessorGraph::Connection::operator< (const Connection& other) const noexcept
+/*  A queue of blocks of audio that have been rendered ahead of time. The blocks are written by
+    an AnticipativeRenderer, and read on the audio thread.
+
+    Each block is labelled with the position at which it should be played, counted in samples
+    from the last time that the playback jumped. When the reader sees the host's position jump,
+    it starts counting again from zero, and throws away any blocks that were rendered for the
+    old position. The reader also passes on the host's position every block, so that the writer
+    can work out where each new block will be played.
+
+    The blocks are stored at the precision that the graph is rendering with. Rather than polling,
+    the writer sleeps while it has nothing to do, and the reader wakes it up once it has read
+    something.
+*/
+class AnticipationBuffer
 {
-    const auto tie = [] (auto& x)
+public:
+    using PositionInfo = AudioPlayHead::PositionInfo;
+    using ProcessingPrecision = AudioProcessor::ProcessingPrecision;
+
+    AnticipationBuffer (int numChannelsIn, int blockSizeIn, int numBlocks, double sampleRateIn, ProcessingPrecision precisionIn)
+        : numChannels (numChannelsIn),
+          blockSize (blockSizeIn),
+          sampleRate (sampleRateIn),
+          precision (precisionIn),
+          // An AbstractFifo always keeps one slot empty
+          fifo (numBlocks + 1),
+          blocks ((size_t) numBlocks + 1)
     {
-        return std::tie (x.source.nodeID,
-                         x.destination.nodeID,
-                         x.source.channelIndex,
-                         x.destination.channelIndex);
-    };
-    return tie (*this) < tie (other);
-}
+        for (auto& block : blocks)
+        {
+            if (precision == AudioProcessor::doublePrecision)
+                block.getAudio<double>().setSize (numChannels, blockSize);
+            else
+                block.getAudio<float>().setSize (numChannels, blockSize);
+        }
+    }
 
-//==============================================================================
-class AudioProcessorGraph::Pimpl
-{
-public:
-    explicit Pimpl (AudioProcessorGraph& o) : owner (&o) {}
+    bool matches (int otherNumChannels, int otherBlockSize, int otherNumBlocks, double otherSampleRate, ProcessingPrecision otherPrecision) const
+    {
+        return numChannels == otherNumChannels
+            && blockSize == otherBlockSize
+            && (int) blocks.size() == otherNumBlocks + 1
+            && approximatelyEqual (sampleRate, otherSampleRate)
+            && precision == otherPrecision;
+    }
 
-    const auto& getNodes() const { return nodes.getNodes(); }
+    int getNumChannels() const noexcept     { return numChannels; }
+    int getBlockSize() const noexcept       { return blockSize; }
 
-    void clear (UpdateKind updateKind)
+    /*  Call from the main thread. While the writer is active, a reader that's waiting for data
+        will keep waiting. Deactivating the writer also wakes it up if it's waiting for the reader.
+    */
+    void setWriterActive (bool isActive)
     {
-        if (getNodes().isEmpty())
-            return;
+        writerActive = isActive;
 
-        nodes = Nodes{};
-        connections = Connections{};
-        nodeStates.clear();
-        topologyChanged (updateKind);
+        if (! isActive)
+            readerProgress.signal();
     }
 
-    auto getNodeForId (NodeID nodeID) const
+    /*  Call from the writer's thread only. Sleeps until isDone() returns true, checking it again
+        each time the reader has published a new position or read a block, or when the writer is
+        deactivated.
+    */
+    template <typename Condition>
+    void waitForReader (Condition&& isDone)
     {
-        return nodes.getNodeForId (nodeID);
-    }
+        for (;;)
+        {
+            // Setting the flag before checking means that the reader can't make progress
+            // between the check and the wait without waking this thread
+            writerWaiting = true;
 
-    Node::Ptr addNode (std::unique_ptr<AudioProcessor> newProcessor,
-                       std::optional<NodeID> nodeID,
-                       UpdateKind updateKind)
+            if (isDone())
+            {
+                writerWaiting = false;
+                return;
+            }
+
+            readerProgress.wait (-1);
+        }
+    }
+
+    //==============================================================================
+    /*  Call from the audio thread only. Fills the buffer with the next samples to be played.
+
+        If waitForData is true, this waits for the writer to catch up whenever it's active;
+        otherwise, any samples that haven't been rendered yet are left silent.
+    */
+    template <typename FloatType>
+    void read (AudioBuffer<FloatType>& audio, const Optional<PositionInfo>& position, bool waitForData)
     {
-        if (newProcessor.get() == owner)
+        const auto numSamples = audio.getNumSamples();
+
+        if (hasJumped (position))
         {
-            jassertfalse;
-            return nullptr;
+            ++readerGeneration;
+            readPosition = 0;
         }
 
-        const auto idToUse = nodeID.value_or (NodeID { lastNodeID.uid + 1 });
+        lastPosition = position;
+        lastNumSamples = numSamples;
+        publishReference (waitForData);
+        wakeWriter();
 
-        auto added = nodes.addNode (std::move (newProcessor), idToUse);
+        for (auto done = 0; done < numSamples;)
+        {
+            if (fifo.getNumReady() == 0)
+            {
+                if (waitForData && writerActive)
+                {
+                    Thread::sleep (1);
+                    continue;
+                }
 
-        if (added == nullptr)
-            return nullptr;
+                clear (audio, done, numSamples - done);
+                readPosition += numSamples - done;
+                break;
+            }
 
-        if (lastNodeID < idToUse)
-            lastNodeID = idToUse;
+            int start1, size1, start2, size2;
+            fifo.prepareToRead (1, start1, size1, start2, size2);
+            const auto& block = blocks[(size_t) start1];
 
-        setParentGraph (added->getProcessor());
+            if (block.generation != readerGeneration || block.start + blockSize <= readPosition)
+            {
+                fifo.finishedRead (1);
+                wakeWriter();
+                continue;
+            }
 
-        topologyChanged (updateKind);
-        return added;
-    }
+            if (block.start > readPosition)
+            {
+                // The writer skipped ahead after falling behind
+                const auto gap = (int) jmin ((int64) (numSamples - done), block.start - readPosition);
+                clear (audio, done, gap);
+                done += gap;
+                readPosition += gap;
+                continue;
+            }
 
-    Node::Ptr removeNode (NodeID nodeID, UpdateKind updateKind)
-    {
-        connections.disconnectNode (nodeID);
-        auto result = nodes.removeNode (nodeID);
-        nodeStates.removeNode (nodeID);
-        topologyChanged (updateKind);
-        return result;
-    }
+            const auto offset = (int) (readPosition - block.start);
+            const auto num = jmin (blockSize - offset, numSamples - done);
+            const auto& source = block.template getAudio<FloatType>();
 
-    std::vector<Connection> getConnections() const
-    {
-        return connections.getConnections();
+            // The graph renders both parts at the same precision
+            jassert (source.getNumChannels() == numChannels);
+
+            for (auto channel = 0; channel < jmin (source.getNumChannels(), audio.getNumChannels()); ++channel)
+                FloatVectorOperations::copy (audio.getWritePointer (channel, done), source.getReadPointer (channel, offset), num);
+
+            done += num;
+            readPosition += num;
+
+            if (offset + num == blockSize)
+            {
+                fifo.finishedRead (1);
+                wakeWriter();
+            }
+        }
     }
 
-    bool isConnected (const Connection& c) const
+    //==============================================================================
+    /*  Call from the writer's thread only. If there's room for another block, this clears it
+        ready to be written, and returns the position at which it will be played.
+    */
+    std::optional<Optional<PositionInfo>> startWriting()
     {
-        return connections.isConnected (c);
+        if (fifo.getFreeSpace() == 0)
+            return {};
+
+        Reference ref;
+
+        {
+            const SpinLock::ScopedLockType lock (referenceLock);
+
+            // Nothing can be rendered until the reader has said where the playback is
+            if (! hasReference)
+                return {};
+
+            ref = reference;
+        }
+
+        if (std::exchange (writerGeneration, ref.generation) != ref.generation)
+            writePosition = ref.readPosition;
+        else
+            writePosition = jmax (writePosition, ref.readPosition);
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        currentBlock = &blocks[(size_t) start1];
+        currentBlock->generation = writerGeneration;
+        currentBlock->start = writePosition;
+        currentBlock->getAudio<float>().clear();
+        currentBlock->getAudio<double>().clear();
+
+        return advance (ref.position, writePosition - ref.readPosition, sampleRate);
     }
 
-    bool isConnected (NodeID srcID, NodeID destID) const
+    /*  Call from the writer's thread only, between startWriting() and finishWriting(). */
+    template <typename FloatType>
+    void writeToCurrentBlock (const AudioBuffer<FloatType>& audio)
     {
-        return connections.isConnected (srcID, destID);
+        if (currentBlock == nullptr)
+        {
+            jassertfalse;
+            return;
+        }
+
+        // The sequence that's rendered ahead should be processed in whole blocks
+        jassert (audio.getNumSamples() == blockSize);
+
+        auto& dest = currentBlock->getAudio<FloatType>();
+        jassert (dest.getNumChannels() == numChannels);
+
+        for (auto channel = 0; channel < jmin (dest.getNumChannels(), audio.getNumChannels()); ++channel)
+            FloatVectorOperations::copy (dest.getWritePointer (channel), audio.getReadPointer (channel), jmin (blockSize, audio.getNumSamples()));
     }
 
-    bool isAnInputTo (const Node& src, const Node& dst) const
+    /*  Call from the writer's thread only. */
+    void finishWriting()
     {
-        return isAnInputTo (src.nodeID, dst.nodeID);
+        currentBlock = nullptr;
+        writePosition += blockSize;
+        fifo.finishedWrite (1);
     }
 
-    bool isAnInputTo (NodeID src, NodeID dst) const
+private:
+    struct Block
     {
-        return connections.isAnInputTo (src, dst);
-    }
+        // Only the buffer for the graph's precision is allocated
+        template <typename FloatType>
+        AudioBuffer<FloatType>& getAudio() noexcept
+        {
+            if constexpr (std::is_same_v<FloatType, float>)
+                return floatAudio;
+            else
+                return doubleAudio;
+        }
 
-    bool canConnect (const Connection& c) const
+        template <typename FloatType>
+        const AudioBuffer<FloatType>& getAudio() const noexcept
+        {
+            return const_cast<Block*> (this)->getAudio<FloatType>();
+        }
+
+        AudioBuffer<float> floatAudio;
+        AudioBuffer<double> doubleAudio;
+        uint32 generation = 0;
+        int64 start = 0;
+    };
+
+    struct Reference
     {
-        return connections.canConnect (nodes, c);
-    }
+        uint32 generation = 0;
+        int64 readPosition = 0;
+        Optional<PositionInfo> position;
+    };
 
-    bool addConnection (const Connection& c, UpdateKind updateKind)
+    /*  Moves a position on by a number of samples, if the playback is running. */
+    static Optional<PositionInfo> advance (Optional<PositionInfo> position, int64 numSamples, double sampleRate)
     {
-        if (! connections.addConnection (nodes, c))
-            return false;
+        if (! position.hasValue() || ! position->getIsPlaying() || numSamples == 0)
+            return position;
 
-        jassert (isConnected (c));
-        topologyChanged (updateKind);
-        return true;
+        const auto seconds = (double) numSamples / sampleRate;
+
+        if (const auto time = position->getTimeInSamples())
+            position->setTimeInSamples (*time + numSamples);
+
+        if (const auto time = position->getTimeInSeconds())
+            position->setTimeInSeconds (*time + seconds);
+
+        if (const auto ppq = position->getPpqPosition())
+            if (const auto bpm = position->getBpm())
+                position->setPpqPosition (*ppq + seconds * *bpm / 60.0);
+
+        position->setHostTimeNs (nullopt);
+        return position;
     }
 
-    bool removeConnection (const Connection& c, UpdateKind updateKind)
+    bool hasJumped (const Optional<PositionInfo>& position) const
     {
-        if (! connections.removeConnection (c))
-            return false;
+        if (! position.hasValue() || ! lastPosition.hasValue())
+            return position.hasValue() != lastPosition.hasValue();
 
-        topologyChanged (updateKind);
-        return true;
+        if (position->getIsPlaying() != lastPosition->getIsPlaying())
+            return true;
+
+        return position->getTimeInSamples() != advance (lastPosition, lastNumSamples, sampleRate)->getTimeInSamples();
     }
 
-    bool disconnectNode (NodeID nodeID, UpdateKind updateKind)
+    void publishReference (bool mustPublish)
     {
-        if (! connections.disconnectNode (nodeID))
-            return false;
+        const auto update = [this]
+        {
+            reference = { readerGeneration, readPosition, lastPosition };
+            hasReference = true;
+        };
 
-        topologyChanged (updateKind);
-        return true;
+        if (mustPublish)
+        {
+            const SpinLock::ScopedLockType lock (referenceLock);
+            update();
+        }
+        else if (const SpinLock::ScopedTryLockType lock (referenceLock); lock.isLocked())
+        {
+            update();
+        }
     }
 
-    bool isConnectionLegal (const Connection& c) const
+    template <typename FloatType>
+    static void clear (AudioBuffer<FloatType>& audio, int start, int num)
     {
-        return connections.isConnectionLegal (nodes, c);
+        if (num > 0)
+            audio.clear (start, num);
     }
 
-    bool removeIllegalConnections (UpdateKind updateKind)
+    // The audio thread only signals the event when the writer is actually waiting for it
+    void wakeWriter()
     {
-        const auto result = connections.removeIllegalConnections (nodes);
-        topologyChanged (updateKind);
-        return result;
+        if (writerWaiting.exchange (false))
+            readerProgress.signal();
     }
 
-    //==============================================================================
-    void prepareToPlay (double sampleRate, int estimatedSamplesPerBlock)
-    {
-        owner->setRateAndBufferSizeDetails (sampleRate, estimatedSamplesPerBlock);
+    const int numChannels, blockSize;
+    const double sampleRate;
+    const ProcessingPrecision precision;
+    AbstractFifo fifo;
+    std::vector<Block> blocks;
+    std::atomic<bool> writerActive { false }, writerWaiting { false };
+    WaitableEvent readerProgress;
+
+    SpinLock referenceLock;
+    Reference reference;
+    bool hasReference = false;
+
+    // Used by the reader only
+    uint32 readerGeneration = 0;
+    int64 readPosition = 0;
+    Optional<PositionInfo> lastPosition;
+    int lastNumSamples = 0;
+
+    // Used by the writer only
+    uint32 writerGeneration = 0;
+    int64 writePosition = 0;
+    Block* currentBlock = nullptr;
+};
 
-        PrepareSettings settings;
-        settings.precision  = owner->getProcessingPrecision();
-        settings.sampleRate = sampleRate;
-        settings.blockSize  = estimatedSamplesPerBlock;
+//==============================================================================
+/*  The hidden nodes that join the part of a graph that's rendered ahead of time to the live part.
 
-        nodeStates.setState (settings);
+    The export node comes at the end of the part that's rendered ahead, and writes its inputs into
+    an AnticipationBuffer. The import node stands in for that part of the graph in the live part,
+    and plays back the contents of the buffer from its outputs.
+*/
+class AnticipationProcessor : public AudioProcessor
+{
+public:
+    AnticipationProcessor (const BusesProperties& layout, std::shared_ptr<AnticipationBuffer> bufferIn)
+        : AudioProcessor (layout), buffer (std::move (bufferIn)) {}
+
+    const String getName() const override                         { return "Anticipation"; }
+    double getTailLengthSeconds() const override                  { return std::numeric_limits<double>::infinity(); }
+    bool acceptsMidi() const override                             { return false; }
+    bool producesMidi() const override                            { return false; }
+    AudioProcessorEditor* createEditor() override                 { return nullptr; }
+    bool hasEditor() const override                               { return false; }
+    int getNumPrograms() override                                 { return 0; }
+    int getCurrentProgram() override                              { return 0; }
+    void setCurrentProgram (int) override                         {}
+    const String getProgramName (int) override                    { return {}; }
+    void changeProgramName (int, const String&) override          {}
+    void getStateInformation (juce::MemoryBlock&) override        {}
+    void setStateInformation (const void*, int) override          {}
+    void prepareToPlay (double, int) override                     {}
+    void releaseResources() override                              {}
+    bool supportsDoublePrecisionProcessing() const override       { return true; }
+
+protected:
+    std::shared_ptr<AnticipationBuffer> buffer;
+};
 
-        topologyChanged (UpdateKind::sync);
-    }
+class AnticipationExportProcessor final : public AnticipationProcessor
+{
+public:
+    explicit AnticipationExportProcessor (std::shared_ptr<AnticipationBuffer> b)
+        : AnticipationProcessor (BusesProperties().withInput ("in", AudioChannelSet::discreteChannels (b->getNumChannels())), b) {}
 
-    void releaseResources()
-    {
-        nodeStates.setState (nullopt);
-        topologyChanged (UpdateKind::sync);
-    }
+    void processBlock (AudioBuffer<float>&  audio, MidiBuffer&) override    { buffer->writeToCurrentBlock (audio); }
+    void processBlock (AudioBuffer<double>& audio, MidiBuffer&) override    { buffer->writeToCurrentBlock (audio); }
+};
 
-    void rebuild (UpdateKind updateKind)
-    {
-        if (updateKind == UpdateKind::none)
-            return;
+class AnticipationImportProcessor final : public AnticipationProcessor
+{
+public:
+    explicit AnticipationImportProcessor (std::shared_ptr<AnticipationBuffer> b)
+        : AnticipationProcessor (BusesProperties().withOutput ("out", AudioChannelSet::discreteChannels (b->getNumChannels())), b) {}
 
-        if (updateKind == UpdateKind::sync && MessageManager::getInstance()->isThisTheMessageThread())
-            handleAsyncUpdate();
-        else
-            updater.triggerAsyncUpdate();
+    void processBlock (AudioBuffer<float>&  audio, MidiBuffer&) override    { read (audio); }
+    void processBlock (AudioBuffer<double>& audio, MidiBuffer&) override    { read (audio); }
+
+private:
+    template <typename FloatType>
+    void read (AudioBuffer<FloatType>& audio)
+    {
+        auto* currentPlayHead = getPlayHead();
+        buffer->read (audio, currentPlayHead != nullptr ? currentPlayHead->getPosition() : nullopt, isNonRealtime());
     }
+};
 
-    void reset()
+//==============================================================================
+/*  Renders the part of a graph that doesn't depend on the graph's live inputs on a thread of its
+    own, filling the AnticipationBuffer that's shared with the sequence's export node.
+*/
+class AnticipativeRenderer final : private Thread
+{
+public:
+    AnticipativeRenderer (std::function<bool()> isLiveSequenceInUseIn, const std::atomic<bool>& sleepingEnabledIn)
+        : Thread ("Graph anticipative rendering"),
+          isLiveSequenceInUse (std::move (isLiveSequenceInUseIn)),
+          sleepingEnabled (sleepingEnabledIn)
     {
-        for (auto* n : getNodes())
-            n->getProcessor()->reset();
     }
 
-    void setNonRealtime (bool isProcessingNonRealtime)
+    ~AnticipativeRenderer() override
     {
-        for (auto* n : getNodes())
-            n->getProcessor()->setNonRealtime (isProcessingNonRealtime);
+        stop();
     }
 
-    template <typename Value>
-    void processBlock (AudioBuffer<Value>& audio, MidiBuffer& midi, AudioPlayHead* playHead)
+    /*  Call from the main thread only. */
+    void start (std::unique_ptr<RenderSequence> newSequence, std::shared_ptr<AnticipationBuffer> newBuffer)
     {
-        renderSequenceExchange.updateAudioThreadState();
+        stop();
 
-        if (renderSequenceExchange.getAudioThreadState() == nullptr && MessageManager::getInstance()->isThisTheMessageThread())
-            handleAsyncUpdate();
+        sequence = std::move (newSequence);
+        buffer = std::move (newBuffer);
+        buffer->setWriterActive (true);
+        startThread (Priority::high);
+    }
 
-        if (owner->isNonRealtime())
-        {
-            while (renderSequenceExchange.getAudioThreadState() == nullptr)
-            {
-                Thread::sleep (1);
-                renderSequenceExchange.updateAudioThreadState();
-            }
-        }
+    /*  Call from the main thread only. */
+    void stop()
+    {
+        // The thread must be told to exit before it's woken up, or it might go back to sleep
+        signalThreadShouldExit();
 
-        auto* state = renderSequenceExchange.getAudioThreadState();
+        if (buffer != nullptr)
+            buffer->setWriterActive (false);
 
-        // Only process if the graph has the correct blockSize, sampleRate etc.
-        if (state != nullptr && state->getSettings() == nodeStates.getLastRequestedSettings())
-        {
-            state->process (audio, midi, playHead);
-        }
-        else
-        {
-            audio.clear();
-            midi.clear();
-        }
+        stopThread (-1);
+        sequence.reset();
+        buffer.reset();
     }
 
-    /*  Call from the audio thread only. */
-    auto* getAudioThreadState() const { return renderSequenceExchange.getAudioThreadState(); }
-
 private:
-    void setParentGraph (AudioProcessor* p) const
+    struct PlayHead final : public AudioPlayHead
     {
-        if (auto* ioProc = dynamic_cast<AudioGraphIOProcessor*> (p))
-            ioProc->setParentGraph (owner);
-    }
+        Optional<PositionInfo> getPosition() const override { return position; }
 
-    void topologyChanged (UpdateKind updateKind)
-    {
-        owner->sendChangeMessage();
-        rebuild (updateKind);
-    }
+        Optional<PositionInfo> position;
+    };
 
-    void handleAsyncUpdate()
+    void run() override
     {
-        if (const auto newSettings = nodeStates.applySettings (nodes))
+        // Nodes that have just moved here from the live part of the graph may still be in use on
+        // the audio thread, until it picks up the new live sequence, whose import node will then
+        // wake this thread
+        buffer->waitForReader ([this] { return threadShouldExit() || isLiveSequenceInUse(); });
+
+        if (threadShouldExit())
+            return;
+
+        const auto blockSize = buffer->getBlockSize();
+        const auto isDouble = sequence->getSettings().precision == AudioProcessor::doublePrecision;
+
+        AudioBuffer<float>  floatAudio  (isDouble ? 0 : 1, blockSize);
+        AudioBuffer<double> doubleAudio (isDouble ? 1 : 0, blockSize);
+        MidiBuffer midi;
+        PlayHead playHead;
+
+        for (;;)
         {
-            for (const auto node : nodes.getNodes())
-                setParentGraph (node->getProcessor());
+            std::optional<Optional<AudioPlayHead::PositionInfo>> position;
 
-            const RenderSequenceSignature newSignature (*newSettings, nodes, connections);
+            // Once the buffer is full, or before the reader has said where the playback is, this
+            // sleeps until the reader has made some progress
+            buffer->waitForReader ([&]
+            {
+                position = buffer->startWriting();
+                return position.has_value() || threadShouldExit();
+            });
 
-            if (std::exchange (lastBuiltSequence, newSignature) != newSignature)
+            if (threadShouldExit())
             {
-                auto sequence = std::make_unique<RenderSequence> (*newSettings, nodes, connections);
-                owner->setLatencySamples (sequence->getLatencySamples());
-                renderSequenceExchange.set (std::move (sequence));
+                // The block that was started is never finished, which leaves it out of the fifo
+                return;
             }
-        }
-        else
-        {
-            lastBuiltSequence.reset();
-            renderSequenceExchange.set (nullptr);
+
+            playHead.position = *position;
+            midi.clear();
+
+            if (isDouble)
+                sequence->process (doubleAudio, midi, &playHead, sleepingEnabled.load (std::memory_order_relaxed));
+            else
+                sequence->process (floatAudio, midi, &playHead, sleepingEnabled.load (std::memory_order_relaxed));
+
+            buffer->finishWriting();
         }
     }
 
-    AudioProcessorGraph* owner = nullptr;
-    Nodes nodes;
-    Connections connections;
-    NodeStates nodeStates;
-    RenderSequenceExchange renderSequenceExchange;
-    NodeID lastNodeID;
-    std::optional<RenderSequenceSignature> lastBuiltSequence;
-    LockingAsyncUpdater updater { [this] { handleAsyncUpdate(); } };
+    std::function<bool()> isLiveSequenceInUse;
+    const std::atomic<bool>& sleepingEnabled;
+    std::unique_ptr<RenderSequence> sequence;
+    std::shared_ptr<AnticipationBuffer> buffer;
 };
 
 //==============================================================================
-AudioProcessorGraph::AudioProcessorGraph() : pimpl (std::make_unique<Pimpl> (*this)) {}
-AudioProcessorGraph::~AudioProcessorGraph() = default;
+/*  Finds the nodes that can be rendered ahead of time, which are those that don't depend on the
+    graph's inputs, directly or indirectly.
 
-const String AudioProcessorGraph::getName() const                   { return "Audio Graph"; }
-bool AudioProcessorGraph::supportsDoublePrecisionProcessing() const { return true; }
-double AudioProcessorGraph::getTailLengthSeconds() const            { return 0; }
-bool AudioProcessorGraph::acceptsMidi() const                       { return true; }
-bool AudioProcessorGraph::producesMidi() const                      { return true; }
-void AudioProcessorGraph::getStateInformation (MemoryBlock&)        {}
-void AudioProcessorGraph::setStateInformation (const void*, int)    {}
+    Nodes that send MIDI to the live part of the graph can't be rendered ahead, and nor can nodes
+    whose parameter event lists have storage allocated, because those events arrive on the audio
+    thread. Everything that depends on a live node is live too.
+*/
+static std::set<AudioProcessorGraph::NodeID> findNodesToRenderAhead (const Nodes& n, const Connections& c)
+{
+    std::set<AudioProcessorGraph::NodeID> live;
 
-void AudioProcessorGraph::processBlock (AudioBuffer<float>&  audio, MidiBuffer& midi)                       { return pimpl->processBlock (audio, midi, getPlayHead()); }
-void AudioProcessorGraph::processBlock (AudioBuffer<double>& audio, MidiBuffer& midi)                       { return pimpl->processBlock (audio, midi, getPlayHead()); }
-std::vector<AudioProcessorGraph::Connection> AudioProcessorGraph::getConnections() const                    { return pimpl->getConnections(); }
-bool AudioProcessorGraph::addConnection (const Connection& c, UpdateKind updateKind)                        { return pimpl->addConnection (c, updateKind); }
-bool AudioProcessorGraph::removeConnection (const Connection& c, UpdateKind updateKind)                     { return pimpl->removeConnection (c, updateKind); }
-void AudioProcessorGraph::prepareToPlay (double sampleRate, int estimatedSamplesPerBlock)                   { return pimpl->prepareToPlay (sampleRate, estimatedSamplesPerBlock); }
-void AudioProcessorGraph::clear (UpdateKind updateKind)                                                     { return pimpl->clear (updateKind); }
-const ReferenceCountedArray<AudioProcessorGraph::Node>& AudioProcessorGraph::getNodes() const noexcept      { return pimpl->getNodes(); }
-AudioProcessorGraph::Node* AudioProcessorGraph::getNodeForId (NodeID x) const                               { return pimpl->getNodeForId (x).get(); }
-bool AudioProcessorGraph::disconnectNode (NodeID nodeID, UpdateKind updateKind)                             { return pimpl->disconnectNode (nodeID, updateKind); }
-void AudioProcessorGraph::releaseResources()                                                                { return pimpl->releaseResources(); }
-bool AudioProcessorGraph::removeIllegalConnections (UpdateKind updateKind)                                  { return pimpl->removeIllegalConnections (updateKind); }
-void AudioProcessorGraph::rebuild()                                                                         { return pimpl->rebuild (UpdateKind::sync); }
-void AudioProcessorGraph::reset()                                                                           { return pimpl->reset(); }
-bool AudioProcessorGraph::canConnect (const Connection& c) const                                            { return pimpl->canConnect (c); }
-bool AudioProcessorGraph::isConnected (const Connection& c) const noexcept                                  { return pimpl->isConnected (c); }
-bool AudioProcessorGraph::isConnected (NodeID a, NodeID b) const noexcept                                   { return pimpl->isConnected (a, b); }
-bool AudioProcessorGraph::isConnectionLegal (const Connection& c) const                                     { return pimpl->isConnectionLegal (c); }
-bool AudioProcessorGraph::isAnInputTo (const Node& source, const Node& destination) const noexcept          { return pimpl->isAnInputTo (source, destination); }
-bool AudioProcessorGraph::isAnInputTo (NodeID source, NodeID destination) const noexcept                    { return pimpl->isAnInputTo (source, destination); }
+    for (auto* node : n.getNodes())
+        if (dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (node->getProcessor()) != nullptr
+            || node->getParameterEvents().getCapacity() > 0)
+            live.insert (node->nodeID);
 
-AudioProcessorGraph::Node::Ptr AudioProcessorGraph::addNode (std::unique_ptr<AudioProcessor> newProcessor,
-                                                             std::optional<NodeID> nodeId,
-                                                             UpdateKind updateKind)
-{
-    return pimpl->addNode (std::move (newProcessor), nodeId, updateKind);
-}
+    const auto isLive = [&] (AudioProcessorGraph::NodeID nodeID) { return live.find (nodeID) != live.end(); };
+    const auto connections = c.getConnections();
 
-void AudioProcessorGraph::setNonRealtime (bool isProcessingNonRealtime) noexcept
-{
-    AudioProcessor::setNonRealtime (isProcessingNonRealtime);
-    pimpl->setNonRealtime (isProcessingNonRealtime);
+    for (auto changed = true; changed;)
+    {
+        changed = false;
+
+        for (const auto& connection : connections)
+        {
+            const auto source = connection.source.nodeID, destination = connection.destination.nodeID;
+
+            if (isLive (source) && ! isLive (destination))
+                changed |= live.insert (destination).second;
+            else if (connection.source.isMIDI() && isLive (destination) && ! isLive (source))
+                changed |= live.insert (source).second;
+        }
+    }
+
+    std::set<AudioProcessorGraph::NodeID> result;
+
+    for (auto* node : n.getNodes())
+        if (! isLive (node->nodeID))
+            result.insert (node->nodeID);
+
+    return result;
 }
 
-AudioProcessorGraph::Node::Ptr AudioProcessorGraph::removeNode (NodeID nodeID, UpdateKind updateKind)
+//==============================================================================
+AudioProcessorGraph::Connection::Connection (NodeAndChannel src, NodeAndChannel dst) noexcept
+    : source (src), destination (dst)
 {
-    return pimpl->removeNode (nodeID, updateKind);
 }
 
-AudioProcessorGraph::Node::Ptr AudioProcessorGraph::removeNode (Node* node, UpdateKind updateKind)
+bool AudioProcessorGraph::Connection::operator== (const Connection& other) const noexcept
 {
-    if (node != nullptr)
-        return removeNode (node->nodeID, updateKind);
-
-    jassertfalse;
-    return {};
+    return source == other.source && destination == other.destination;
 }
 
-//==============================================================================
-AudioProcessorGraph::AudioGraphIOProcessor::AudioGraphIOProcessor (const IODeviceType deviceType)
-    : type (deviceType)
+bool AudioProcessorGraph::Connection::operator!= (const Connection& c) const noexcept
 {
+    return ! operator== (c);
 }
 
-AudioProcessorGraph::AudioGraphIOProcessor::~AudioGraphIOProcessor() = default;
-
-const String AudioProcessorGraph::AudioGraphIOProcessor::getName() const
+bool AudioProcessorGraph::Connection::operator< (const Connection& other) const noexcept
 {
-    switch (type)
+    const auto tie = [] (auto& x)
     {
-        case audioOutputNode:   return "Audio Output";
-        case audioInputNode:    return "Audio Input";
-        case midiOutputNode:    return "MIDI Output";
-        case midiInputNode:     return "MIDI Input";
-        default:                break;
-    }
-
-    return {};
+        return std::tie (x.source.nodeID,
+                         x.destination.nodeID,
+                         x.source.channelIndex,
+                         x.destination.channelIndex);
+    };
+    return tie (*this) < tie (other);
 }
 
-void AudioProcessorGraph::AudioGraphIOProcessor::fillInPluginDescription (PluginDescription& d) const
+//==============================================================================
+class AudioProcessorGraph::Pimpl
 {
-    d.name = getName();
-    d.category = "I/O devices";
-    d.pluginFormatName = "Internal";
-    d.manufacturerName = "JUCE";
-    d.version = "1.0";
-    d.isInstrument = false;
-
-    d.deprecatedUid = d.uniqueId = d.name.hashCode();
+public:
+    explicit Pimpl (AudioProcessorGraph& o) : owner (&o) {}
 
-    d.numInputChannels = getTotalNumInputChannels();
+    ~Pimpl()
+    {
+        // The preparation threads trigger the notifier, so they must stop before it's destroyed
+        nodeStates.stopPreparationThreads();
+        anticipativeRenderer.stop();
+    }
 
-    if (type == audioOutputNode && graph != nullptr)
-        d.numInputChannels = graph->getTotalNumInputChannels();
+    const auto& getNodes() const { return nodes.getNodes(); }
 
-    d.numOutputChannels = getTotalNumOutputChannels();
+    void clear (UpdateKind updateKind)
+    {
+        if (getNodes().isEmpty())
+            return;
 
-    if (type == audioInputNode && graph != nullptr)
-        d.numOutputChannels = graph->getTotalNumOutputChannels();
-}
+        nodes = Nodes{};
+        connections = Connections{};
+        nodeStates.clear();
+        nodeTimings.clear();
+        topologyChanged (updateKind);
+        sendPreparationStatusChanges();
+    }
 
-void AudioProcessorGraph::AudioGraphIOProcessor::prepareToPlay (double, int)
-{
-    jassert (graph != nullptr);
-}
+    auto getNodeForId (NodeID nodeID) const
+    {
+        return nodes.getNodeForId (nodeID);
+    }
 
-void AudioProcessorGraph::AudioGraphIOProcessor::releaseResources()
-{
-}
+    Node::Ptr addNode (std::unique_ptr<AudioProcessor> newProcessor,
+                       std::optional<NodeID> nodeID,
+                       UpdateKind updateKind)
+    {
+        if (newProcessor.get() == owner)
+        {
+            jassertfalse;
+            return nullptr;
+        }
 
-bool AudioProcessorGraph::AudioGraphIOProcessor::supportsDoublePrecisionProcessing() const
-{
-    return true;
-}
+        const auto idToUse = nodeID.value_or (NodeID { lastNodeID.uid + 1 });
 
-void AudioProcessorGraph::AudioGraphIOProcessor::processBlock (AudioBuffer<float>&, MidiBuffer&)
-{
-    // The graph should never call this!
-    jassertfalse;
-}
+        auto added = nodes.addNode (std::move (newProcessor), idToUse);
 
-void AudioProcessorGraph::AudioGraphIOProcessor::processBlock (AudioBuffer<double>&, MidiBuffer&)
-{
-    // The graph should never call this!
-    jassertfalse;
-}
+        if (added == nullptr)
+            return nullptr;
 
-double AudioProcessorGraph::AudioGraphIOProcessor::getTailLengthSeconds() const
-{
-    return 0;
-}
+        if (lastNodeID < idToUse)
+            lastNodeID = idToUse;
 
-bool AudioProcessorGraph::AudioGraphIOProcessor::acceptsMidi() const
-{
-    return type == midiOutputNode;
-}
+        setParentGraph (added->getProcessor());
 
-bool AudioProcessorGraph::AudioGraphIOProcessor::producesMidi() const
-{
-    return type == midiInputNode;
-}
+        topologyChanged (updateKind);
+        return added;
+    }
 
-bool AudioProcessorGraph::AudioGraphIOProcessor::isInput() const noexcept           { return type == audioInputNode  || type == midiInputNode; }
-bool AudioProcessorGraph::AudioGraphIOProcessor::isOutput() const noexcept          { return type == audioOutputNode || type == midiOutputNode; }
+    Node::Ptr removeNode (NodeID nodeID, UpdateKind updateKind)
+    {
+        connections.disconnectNode (nodeID);
+        auto result = nodes.removeNode (nodeID);
+        nodeStates.removeNode (nodeID);
+        nodeTimings.removeNode (nodeID);
+        topologyChanged (updateKind);
+        sendPreparationStatusChanges();
+        return result;
+    }
 
-bool AudioProcessorGraph::AudioGraphIOProcessor::hasEditor() const                  { return false; }
-AudioProcessorEditor* AudioProcessorGraph::AudioGraphIOProcessor::createEditor()    { return nullptr; }
+    std::vector<Connection> getConnections() const
+    {
+        return connections.getConnections();
+    }
 
-int AudioProcessorGraph::AudioGraphIOProcessor::getNumPrograms()                    { return 0; }
-int AudioProcessorGraph::AudioGraphIOProcessor::getCurrentProgram()                 { return 0; }
-void AudioProcessorGraph::AudioGraphIOProcessor::setCurrentProgram (int)            { }
+    bool isConnected (const Connection& c) const
+    {
+        return connections.isConnected (c);
+    }
 
-const String AudioProcessorGraph::AudioGraphIOProcessor::getProgramName (int)       { return {}; }
-void AudioProcessorGraph::AudioGraphIOProcessor::changeProgramName (int, const String&) {}
+    bool isConnected (NodeID srcID, NodeID destID) const
+    {
+        return connections.isConnected (srcID, destID);
+    }
 
-void AudioProcessorGraph::AudioGraphIOProcessor::getStateInformation (MemoryBlock&)     {}
-void AudioProcessorGraph::AudioGraphIOProcessor::setStateInformation (const void*, int) {}
+    bool isAnInputTo (const Node& src, const Node& dst) const
+    {
+        return isAnInputTo (src.nodeID, dst.nodeID);
+    }
 
-void AudioProcessorGraph::AudioGraphIOProcessor::setParentGraph (AudioProcessorGraph* const newGraph)
-{
-    graph = newGraph;
+    bool isAnInputTo (NodeID src, NodeID dst) const
+    {
+        return connections.isAnInputTo (src, dst);
+    }
 
-    if (graph == nullptr)
-        return;
+    bool canConnect (const Connection& c) const
+    {
+        return connections.canConnect (nodes, c);
+    }
 
-    setPlayConfigDetails (type == audioOutputNode ? newGraph->getTotalNumOutputChannels() : 0,
-                          type == audioInputNode  ? newGraph->getTotalNumInputChannels()  : 0,
-                          getSampleRate(),
-                          getBlockSize());
+    bool addConnection (const Connection& c, UpdateKind updateKind)
+    {
+        if (! connections.addConnection (nodes, c))
+            return false;
 
-    updateHostDisplay();
-}
+        jassert (isConnected (c));
+        topologyChanged (updateKind);
+        return true;
+    }
 
-//==============================================================================
-//==============================================================================
-#if JUCE_UNIT_TESTS
+    bool removeConnection (const Connection& c, UpdateKind updateKind)
+    {
+        if (! connections.removeConnection (c))
+            return false;
 
-class AudioProcessorGraphTests final : public UnitTest
-{
-public:
-    AudioProcessorGraphTests()
-        : UnitTest ("AudioProcessorGraph", UnitTestCategories::audioProcessors) {}
+        topologyChanged (updateKind);
+        return true;
+    }
 
-    void runTest() override
+    bool disconnectNode (NodeID nodeID, UpdateKind updateKind)
     {
-        const auto midiChannel = AudioProcessorGraph::midiChannelIndex;
+        if (! connections.disconnectNode (nodeID))
+            return false;
 
-        beginTest ("isConnected returns true when two nodes are connected");
-        {
-            AudioProcessorGraph graph;
-            const auto nodeA = graph.addNode (BasicProcessor::make ({}, MidiIn::no, MidiOut::yes))->nodeID;
+        topologyChanged (updateKind);
+        return true;
+    }
+
+    bool isConnectionLegal (const Connection& c) const
+    {
+        return connections.isConnectionLegal (nodes, c);
+    }
+
+    bool removeIllegalConnections (UpdateKind updateKind)
+    {
+        const auto result = connections.removeIllegalConnections (nodes);
+        topologyChanged (updateKind);
+        return result;
+    }
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int estimatedSamplesPerBlock)
+    {
+        owner->setRateAndBufferSizeDetails (sampleRate, estimatedSamplesPerBlock);
+
+        PrepareSettings settings;
+        settings.precision  = owner->getProcessingPrecision();
+        settings.sampleRate = sampleRate;
+        settings.blockSize  = estimatedSamplesPerBlock;
+
+        graphSettings = settings;
+        updateNodeSettings();
+    }
+
+    void releaseResources()
+    {
+        graphSettings.reset();
+        updateNodeSettings();
+    }
+
+    void rebuild (UpdateKind updateKind)
+    {
+        if (updateKind == UpdateKind::none)
+            return;
+
+        if (updateKind == UpdateKind::sync && MessageManager::getInstance()->isThisTheMessageThread())
+            handleAsyncUpdate();
+        else
+            updater.triggerAsyncUpdate();
+    }
+
+    void reset()
+    {
+        for (auto* n : getNodes())
+            n->getProcessor()->reset();
+    }
+
+    void setNonRealtime (bool isProcessingNonRealtime)
+    {
+        for (auto* n : getNodes())
+            n->getProcessor()->setNonRealtime (isProcessingNonRealtime);
+
+        if (importNode != nullptr)
+            importNode->getProcessor()->setNonRealtime (isProcessingNonRealtime);
+    }
+
+    template <typename Value>
+    void processBlock (AudioBuffer<Value>& audio, MidiBuffer& midi, AudioPlayHead* playHead)
+    {
+        renderSequenceExchange.updateAudioThreadState();
+
+        if (renderSequenceExchange.getAudioThreadState() == nullptr && MessageManager::getInstance()->isThisTheMessageThread())
+            handleAsyncUpdate();
+
+        if (owner->isNonRealtime())
+        {
+            while (renderSequenceExchange.getAudioThreadState() == nullptr)
+            {
+                Thread::sleep (1);
+                renderSequenceExchange.updateAudioThreadState();
+            }
+        }
+
+        auto* state = renderSequenceExchange.getAudioThreadState();
+
+        // Only process if the graph has the correct blockSize, sampleRate etc.
+        if (state != nullptr && state->getSettings() == nodeStates.getLastRequestedSettings())
+        {
+            state->process (audio, midi, playHead, sleepingEnabled.load (std::memory_order_relaxed));
+        }
+        else
+        {
+            audio.clear();
+            midi.clear();
+        }
+    }
+
+    /*  Call from the audio thread only. */
+    auto* getAudioThreadState() const { return renderSequenceExchange.getAudioThreadState(); }
+
+    //==============================================================================
+    void setNodeProfilingEnabled (bool shouldBeEnabled)
+    {
+        if (std::exchange (profilingEnabled, shouldBeEnabled) != shouldBeEnabled)
+            rebuild (UpdateKind::sync);
+    }
+
+    bool isNodeProfilingEnabled() const { return profilingEnabled; }
+
+    void resetNodeTimings() { nodeTimings.reset(); }
+
+    void setNodeSleepingEnabled (bool shouldBeEnabled) { sleepingEnabled = shouldBeEnabled; }
+    bool isNodeSleepingEnabled() const { return sleepingEnabled; }
+
+    //==============================================================================
+    void setNumNodePreparationThreads (int numThreads)
+    {
+        if (numThreads == nodeStates.getNumPreparationThreads())
+            return;
+
+        nodeStates.setNumPreparationThreads (numThreads);
+        rebuild (UpdateKind::sync);
+    }
+
+    int getNumNodePreparationThreads() const noexcept   { return nodeStates.getNumPreparationThreads(); }
+    bool isNodeBeingPrepared (NodeID nodeID) const      { return nodeStates.isBeingPrepared (nodeID); }
+    int getNumNodesBeingPrepared() const                { return nodeStates.getNumBeingPrepared(); }
+
+    //==============================================================================
+    void setAnticipativeRenderingEnabled (bool shouldBeEnabled, int blockSize, int numBlocksAhead)
+    {
+        const AnticipationOptions newOptions { shouldBeEnabled, jmax (1, blockSize), jmax (1, numBlocksAhead) };
+
+        if (std::exchange (anticipationOptions, newOptions) != newOptions)
+            updateNodeSettings();
+    }
+
+    bool isAnticipativeRenderingEnabled() const noexcept    { return anticipationOptions.enabled; }
+
+    bool isNodeRenderedAhead (NodeID nodeID) const
+    {
+        return nodesRenderedAhead.find (nodeID) != nodesRenderedAhead.end();
+    }
+
+    //==============================================================================
+    std::vector<NodeTiming> getNodeTimings() const
+    {
+        std::vector<NodeTiming> result;
+
+        for (const auto& entry : nodeTimings.getEntries())
+        {
+            NodeTiming timing;
+            timing.nodeID           = entry.nodeID;
+            timing.name             = entry.name;
+            timing.numBlocks        = entry.snapshot.numBlocks;
+            timing.minMicroseconds  = entry.snapshot.minSeconds  * 1.0e6;
+            timing.meanMicroseconds = entry.snapshot.meanSeconds * 1.0e6;
+            timing.p99Microseconds  = entry.snapshot.p99Seconds  * 1.0e6;
+            timing.maxMicroseconds  = entry.snapshot.maxSeconds  * 1.0e6;
+            result.push_back (timing);
+        }
+
+        return result;
+    }
+
+private:
+    void setParentGraph (AudioProcessor* p) const
+    {
+        if (auto* ioProc = dynamic_cast<AudioGraphIOProcessor*> (p))
+            ioProc->setParentGraph (owner);
+    }
+
+    void topologyChanged (UpdateKind updateKind)
+    {
+        owner->sendChangeMessage();
+        rebuild (updateKind);
+    }
+
+    /*  While anticipative rendering is enabled, the nodes are prepared with its block size if
+        that's larger than the graph's, as any of them might be rendered ahead.
+    */
+    void updateNodeSettings()
+    {
+        auto settings = graphSettings;
+
+        if (settings.has_value() && anticipationOptions.enabled)
+            settings->blockSize = jmax (settings->blockSize, anticipationOptions.blockSize);
+
+        nodeStates.setState (settings);
+        topologyChanged (UpdateKind::sync);
+    }
+
+    void sendPreparationStatusChanges()
+    {
+        for (const auto& [nodeID, status] : nodeStates.takeStatusChanges())
+            NullCheckedInvocation::invoke (owner->onNodePreparationStatusChanged, nodeID, status);
+    }
+
+    void buildSequence (const PrepareSettings& settings, const Nodes& n, const Connections& c)
+    {
+        const RenderSequenceSignature newSignature (settings, n, c, profilingEnabled);
+
+        if (std::exchange (lastBuiltSequence, newSignature) == newSignature)
+            return;
+
+        auto sequence = std::make_unique<RenderSequence> (settings,
+                                                          RenderSequenceBuilder::build (n, c),
+                                                          profilingEnabled ? &nodeTimings : nullptr);
+        owner->setLatencySamples (sequence->getLatencySamples());
+        renderSequenceExchange.set (std::move (sequence));
+    }
+
+    //==============================================================================
+    struct GraphSplit
+    {
+        Nodes liveNodes, aheadNodes;
+        Connections liveConnections, aheadConnections;
+        std::set<NodeID> aheadNodeIDs;
+    };
+
+    /*  Splits the graph into the part that's rendered ahead of time and the live part, and joins
+        the parts with the export and import nodes. Returns nullopt if nothing that's rendered
+        ahead would be heard by the live part.
+    */
+    std::optional<GraphSplit> splitForAnticipation (const PrepareSettings& settings, const Nodes& n, const Connections& c)
+    {
+        const auto ahead = findNodesToRenderAhead (n, c);
+        const auto isAhead = [&] (NodeID nodeID) { return ahead.find (nodeID) != ahead.end(); };
+        const auto allConnections = c.getConnections();
+
+        // Each output that's rendered ahead and used by the live part gets a channel of the buffer
+        std::map<NodeAndChannel, int> bufferChannels;
+
+        for (const auto& connection : allConnections)
+            if (isAhead (connection.source.nodeID) && ! isAhead (connection.destination.nodeID))
+                bufferChannels.emplace (connection.source, (int) bufferChannels.size());
+
+        if (bufferChannels.empty())
+            return {};
+
+        updateAnticipationNodes (settings, (int) bufferChannels.size());
+
+        GraphSplit split;
+        split.aheadNodeIDs = ahead;
+
+        for (auto* node : n.getNodes())
+            (isAhead (node->nodeID) ? split.aheadNodes : split.liveNodes).addNode (Node::Ptr (node));
+
+        split.liveNodes.addNode (importNode);
+        split.aheadNodes.addNode (exportNode);
+
+        for (const auto& connection : allConnections)
+        {
+            const auto sourceIsAhead = isAhead (connection.source.nodeID);
+            const auto destinationIsAhead = isAhead (connection.destination.nodeID);
+
+            if (sourceIsAhead && destinationIsAhead)
+            {
+                split.aheadConnections.addConnection (split.aheadNodes, connection);
+            }
+            else if (! sourceIsAhead && ! destinationIsAhead)
+            {
+                split.liveConnections.addConnection (split.liveNodes, connection);
+            }
+            else if (sourceIsAhead)
+            {
+                jassert (! connection.source.isMIDI());
+
+                const auto channel = bufferChannels.at (connection.source);
+                split.aheadConnections.addConnection (split.aheadNodes, { connection.source, { exportNode->nodeID, channel } });
+                split.liveConnections.addConnection (split.liveNodes, { { importNode->nodeID, channel }, connection.destination });
+            }
+        }
+
+        return split;
+    }
+
+    /*  Makes sure that the import and export nodes share a buffer with the right layout. */
+    void updateAnticipationNodes (const PrepareSettings& settings, int numChannels)
+    {
+        if (anticipationBuffer != nullptr
+            && anticipationBuffer->matches (numChannels, anticipationOptions.blockSize, anticipationOptions.numBlocks, settings.sampleRate, settings.precision))
+        {
+            return;
+        }
+
+        anticipativeRenderer.stop();
+
+        anticipationBuffer = std::make_shared<AnticipationBuffer> (numChannels,
+                                                                   anticipationOptions.blockSize,
+                                                                   anticipationOptions.numBlocks,
+                                                                   settings.sampleRate,
+                                                                   settings.precision);
+
+        // The hidden nodes use IDs just below the ones that AssignedBuffer reserves
+        importNode = new Node { NodeID (0x7ffffffc), std::make_unique<AnticipationImportProcessor> (anticipationBuffer) };
+        exportNode = new Node { NodeID (0x7ffffffb), std::make_unique<AnticipationExportProcessor> (anticipationBuffer) };
+        importNode->getProcessor()->setNonRealtime (owner->isNonRealtime());
+
+        // These nodes aren't prepared along with the others, so they need the graph's precision here
+        for (auto* node : { importNode.get(), exportNode.get() })
+            node->getProcessor()->setProcessingPrecision (settings.precision);
+
+        // The new nodes may have the same attributes as the old ones, so both sequences must be rebuilt
+        lastBuiltSequence.reset();
+        lastBuiltAheadSequence.reset();
+    }
+
+    void stopAnticipation()
+    {
+        anticipativeRenderer.stop();
+        anticipationBuffer.reset();
+        importNode = nullptr;
+        exportNode = nullptr;
+        lastBuiltAheadSequence.reset();
+        nodesRenderedAhead.clear();
+    }
+
+    void buildSequences (const PrepareSettings& settings, const Nodes& n, const Connections& c)
+    {
+        auto split = anticipationOptions.enabled ? splitForAnticipation (settings, n, c) : std::nullopt;
+
+        if (! split.has_value())
+        {
+            stopAnticipation();
+            buildSequence (settings, n, c);
+            return;
+        }
+
+        const PrepareSettings aheadSettings { settings.precision, settings.sampleRate, anticipationOptions.blockSize };
+        const RenderSequenceSignature aheadSignature (aheadSettings, split->aheadNodes, split->aheadConnections, profilingEnabled);
+        std::unique_ptr<RenderSequence> aheadSequence;
+
+        if (std::exchange (lastBuiltAheadSequence, aheadSignature) != aheadSignature)
+        {
+            // Nodes that move to the live part mustn't be rendered on both threads at once
+            anticipativeRenderer.stop();
+
+            aheadSequence = std::make_unique<RenderSequence> (aheadSettings,
+                                                              RenderSequenceBuilder::build (split->aheadNodes, split->aheadConnections),
+                                                              profilingEnabled ? &nodeTimings : nullptr);
+
+            // The live part must be delayed to line up with the latest output that's rendered ahead
+            importNode->getProcessor()->setLatencySamples (aheadSequence->getLatencySamples());
+        }
+
+        nodesRenderedAhead = split->aheadNodeIDs;
+        buildSequence (settings, split->liveNodes, split->liveConnections);
+
+        if (aheadSequence != nullptr)
+            anticipativeRenderer.start (std::move (aheadSequence), anticipationBuffer);
+    }
+
+    void handleAsyncUpdate()
+    {
+        if (const auto newSettings = nodeStates.applySettings (nodes))
+        {
+            for (const auto node : nodes.getNodes())
+                setParentGraph (node->getProcessor());
+
+            const auto nodesBeingPrepared = nodeStates.getNodesBeingPrepared();
+
+            if (nodesBeingPrepared.empty())
+            {
+                buildSequences (*newSettings, nodes, connections);
+            }
+            else
+            {
+                // Nodes that aren't ready yet are left out, along with their connections, and
+                // will be added when the graph is rebuilt after they've been prepared
+                auto readyNodes = nodes;
+                auto readyConnections = connections;
+
+                for (const auto nodeID : nodesBeingPrepared)
+                {
+                    readyNodes.removeNode (nodeID);
+                    readyConnections.disconnectNode (nodeID);
+                }
+
+                buildSequences (*newSettings, readyNodes, readyConnections);
+            }
+        }
+        else
+        {
+            stopAnticipation();
+            lastBuiltSequence.reset();
+            renderSequenceExchange.set (nullptr);
+        }
+
+        sendPreparationStatusChanges();
+    }
+
+    AudioProcessorGraph* owner = nullptr;
+    Nodes nodes;
+    Connections connections;
+    NodeStates nodeStates { [this] { preparedNodeNotifier.triggerAsyncUpdate(); } };
+    RenderSequenceExchange renderSequenceExchange;
+    NodeID lastNodeID;
+    std::optional<RenderSequenceSignature> lastBuiltSequence;
+    NodeTimings nodeTimings;
+    bool profilingEnabled = false;
+    std::atomic<bool> sleepingEnabled { false };
+    std::optional<PrepareSettings> graphSettings;
+
+    struct AnticipationOptions
+    {
+        bool enabled = false;
+        int blockSize = 4096, numBlocks = 4;
+
+        auto tie() const { return std::tie (enabled, blockSize, numBlocks); }
+        bool operator== (const AnticipationOptions& other) const { return tie() == other.tie(); }
+        bool operator!= (const AnticipationOptions& other) const { return tie() != other.tie(); }
+    };
+
+    AnticipationOptions anticipationOptions;
+    std::shared_ptr<AnticipationBuffer> anticipationBuffer;
+    Node::Ptr importNode, exportNode;
+    std::optional<RenderSequenceSignature> lastBuiltAheadSequence;
+    std::set<NodeID> nodesRenderedAhead;
+    AnticipativeRenderer anticipativeRenderer { [this] { return renderSequenceExchange.isAudioThreadUpToDate(); }, sleepingEnabled };
+    LockingAsyncUpdater updater { [this] { handleAsyncUpdate(); } };
+
+    /*  Rebuilds the graph once a node has been prepared in the background. Unlike the updater,
+        this can be triggered without taking the lock that the updater holds while the graph is
+        rebuilt, which may have to wait for the job that triggered it to return.
+    */
+    struct PreparedNodeNotifier final : public AsyncUpdater
+    {
+        explicit PreparedNodeNotifier (Pimpl& ownerIn) : owner (ownerIn) {}
+        ~PreparedNodeNotifier() override { cancelPendingUpdate(); }
+
+        void handleAsyncUpdate() override { owner.handleAsyncUpdate(); }
+
+        Pimpl& owner;
+    };
+
+    PreparedNodeNotifier preparedNodeNotifier { *this };
+};
+
+//==============================================================================
+AudioProcessorGraph::AudioProcessorGraph() : pimpl (std::make_unique<Pimpl> (*this)) {}
+AudioProcessorGraph::~AudioProcessorGraph() = default;
+
+const String AudioProcessorGraph::getName() const                   { return "Audio Graph"; }
+bool AudioProcessorGraph::supportsDoublePrecisionProcessing() const { return true; }
+double AudioProcessorGraph::getTailLengthSeconds() const            { return 0; }
+bool AudioProcessorGraph::acceptsMidi() const                       { return true; }
+bool AudioProcessorGraph::producesMidi() const                      { return true; }
+void AudioProcessorGraph::getStateInformation (MemoryBlock&)        {}
+void AudioProcessorGraph::setStateInformation (const void*, int)    {}
+
+void AudioProcessorGraph::processBlock (AudioBuffer<float>&  audio, MidiBuffer& midi)                       { return pimpl->processBlock (audio, midi, getPlayHead()); }
+void AudioProcessorGraph::processBlock (AudioBuffer<double>& audio, MidiBuffer& midi)                       { return pimpl->processBlock (audio, midi, getPlayHead()); }
+std::vector<AudioProcessorGraph::Connection> AudioProcessorGraph::getConnections() const                    { return pimpl->getConnections(); }
+bool AudioProcessorGraph::addConnection (const Connection& c, UpdateKind updateKind)                        { return pimpl->addConnection (c, updateKind); }
+bool AudioProcessorGraph::removeConnection (const Connection& c, UpdateKind updateKind)                     { return pimpl->removeConnection (c, updateKind); }
+void AudioProcessorGraph::prepareToPlay (double sampleRate, int estimatedSamplesPerBlock)                   { return pimpl->prepareToPlay (sampleRate, estimatedSamplesPerBlock); }
+void AudioProcessorGraph::clear (UpdateKind updateKind)                                                     { return pimpl->clear (updateKind); }
+const ReferenceCountedArray<AudioProcessorGraph::Node>& AudioProcessorGraph::getNodes() const noexcept      { return pimpl->getNodes(); }
+AudioProcessorGraph::Node* AudioProcessorGraph::getNodeForId (NodeID x) const                               { return pimpl->getNodeForId (x).get(); }
+bool AudioProcessorGraph::disconnectNode (NodeID nodeID, UpdateKind updateKind)                             { return pimpl->disconnectNode (nodeID, updateKind); }
+void AudioProcessorGraph::releaseResources()                                                                { return pimpl->releaseResources(); }
+bool AudioProcessorGraph::removeIllegalConnections (UpdateKind updateKind)                                  { return pimpl->removeIllegalConnections (updateKind); }
+void AudioProcessorGraph::rebuild()                                                                         { return pimpl->rebuild (UpdateKind::sync); }
+void AudioProcessorGraph::reset()                                                                           { return pimpl->reset(); }
+void AudioProcessorGraph::setNodeProfilingEnabled (bool shouldBeEnabled)                                    { return pimpl->setNodeProfilingEnabled (shouldBeEnabled); }
+bool AudioProcessorGraph::isNodeProfilingEnabled() const noexcept                                           { return pimpl->isNodeProfilingEnabled(); }
+void AudioProcessorGraph::resetNodeTimings()                                                                { return pimpl->resetNodeTimings(); }
+void AudioProcessorGraph::setNodeSleepingEnabled (bool shouldBeEnabled)                                     { return pimpl->setNodeSleepingEnabled (shouldBeEnabled); }
+bool AudioProcessorGraph::isNodeSleepingEnabled() const noexcept                                            { return pimpl->isNodeSleepingEnabled(); }
+void AudioProcessorGraph::setNumNodePreparationThreads (int numThreads)                                     { return pimpl->setNumNodePreparationThreads (numThreads); }
+int AudioProcessorGraph::getNumNodePreparationThreads() const noexcept                                      { return pimpl->getNumNodePreparationThreads(); }
+bool AudioProcessorGraph::isNodeBeingPrepared (NodeID nodeID) const                                         { return pimpl->isNodeBeingPrepared (nodeID); }
+int AudioProcessorGraph::getNumNodesBeingPrepared() const                                                   { return pimpl->getNumNodesBeingPrepared(); }
+bool AudioProcessorGraph::isAnticipativeRenderingEnabled() const noexcept                                   { return pimpl->isAnticipativeRenderingEnabled(); }
+bool AudioProcessorGraph::isNodeRenderedAhead (NodeID nodeID) const                                         { return pimpl->isNodeRenderedAhead (nodeID); }
+std::vector<AudioProcessorGraph::NodeTiming> AudioProcessorGraph::getNodeTimings() const                    { return pimpl->getNodeTimings(); }
+bool AudioProcessorGraph::canConnect (const Connection& c) const                                            { return pimpl->canConnect (c); }
+bool AudioProcessorGraph::isConnected (const Connection& c) const noexcept                                  { return pimpl->isConnected (c); }
+bool AudioProcessorGraph::isConnected (NodeID a, NodeID b) const noexcept                                   { return pimpl->isConnected (a, b); }
+bool AudioProcessorGraph::isConnectionLegal (const Connection& c) const                                     { return pimpl->isConnectionLegal (c); }
+bool AudioProcessorGraph::isAnInputTo (const Node& source, const Node& destination) const noexcept          { return pimpl->isAnInputTo (source, destination); }
+bool AudioProcessorGraph::isAnInputTo (NodeID source, NodeID destination) const noexcept                    { return pimpl->isAnInputTo (source, destination); }
+
+void AudioProcessorGraph::setAnticipativeRenderingEnabled (bool shouldBeEnabled, int newBlockSize, int newNumBlocksAhead)
+{
+    pimpl->setAnticipativeRenderingEnabled (shouldBeEnabled, newBlockSize, newNumBlocksAhead);
+}
+
+AudioProcessorGraph::Node::Ptr AudioProcessorGraph::addNode (std::unique_ptr<AudioProcessor> newProcessor,
+                                                             std::optional<NodeID> nodeId,
+                                                             UpdateKind updateKind)
+{
+    return pimpl->addNode (std::move (newProcessor), nodeId, updateKind);
+}
+
+void AudioProcessorGraph::setNonRealtime (bool isProcessingNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime (isProcessingNonRealtime);
+    pimpl->setNonRealtime (isProcessingNonRealtime);
+}
+
+AudioProcessorGraph::Node::Ptr AudioProcessorGraph::removeNode (NodeID nodeID, UpdateKind updateKind)
+{
+    return pimpl->removeNode (nodeID, updateKind);
+}
+
+AudioProcessorGraph::Node::Ptr AudioProcessorGraph::removeNode (Node* node, UpdateKind updateKind)
+{
+    if (node != nullptr)
+        return removeNode (node->nodeID, updateKind);
+
+    jassertfalse;
+    return {};
+}
+
+bool AudioProcessorGraph::exportNodeTimings (const File& file) const
+{
+    String csv ("node_id,name,blocks,min_us,mean_us,p99_us,max_us\n");
+
+    for (const auto& t : getNodeTimings())
+    {
+        csv << String (t.nodeID.uid) << ','
+            << t.name.quoted() << ','
+            << String (t.numBlocks) << ','
+            << String (t.minMicroseconds, 3) << ','
+            << String (t.meanMicroseconds, 3) << ','
+            << String (t.p99Microseconds, 3) << ','
+            << String (t.maxMicroseconds, 3) << '\n';
+    }
+
+    return file.replaceWithText (csv);
+}
+
+//==============================================================================
+AudioProcessorGraph::AudioGraphIOProcessor::AudioGraphIOProcessor (const IODeviceType deviceType)
+    : type (deviceType)
+{
+}
+
+AudioProcessorGraph::AudioGraphIOProcessor::~AudioGraphIOProcessor() = default;
+
+const String AudioProcessorGraph::AudioGraphIOProcessor::getName() const
+{
+    switch (type)
+    {
+        case audioOutputNode:   return "Audio Output";
+        case audioInputNode:    return "Audio Input";
+        case midiOutputNode:    return "MIDI Output";
+        case midiInputNode:     return "MIDI Input";
+        default:                break;
+    }
+
+    return {};
+}
+
+void AudioProcessorGraph::AudioGraphIOProcessor::fillInPluginDescription (PluginDescription& d) const
+{
+    d.name = getName();
+    d.category = "I/O devices";
+    d.pluginFormatName = "Internal";
+    d.manufacturerName = "JUCE";
+    d.version = "1.0";
+    d.isInstrument = false;
+
+    d.deprecatedUid = d.uniqueId = d.name.hashCode();
+
+    d.numInputChannels = getTotalNumInputChannels();
+
+    if (type == audioOutputNode && graph != nullptr)
+        d.numInputChannels = graph->getTotalNumInputChannels();
+
+    d.numOutputChannels = getTotalNumOutputChannels();
+
+    if (type == audioInputNode && graph != nullptr)
+        d.numOutputChannels = graph->getTotalNumOutputChannels();
+}
+
+void AudioProcessorGraph::AudioGraphIOProcessor::prepareToPlay (double, int)
+{
+    jassert (graph != nullptr);
+}
+
+void AudioProcessorGraph::AudioGraphIOProcessor::releaseResources()
+{
+}
+
+bool AudioProcessorGraph::AudioGraphIOProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+void AudioProcessorGraph::AudioGraphIOProcessor::processBlock (AudioBuffer<float>&, MidiBuffer&)
+{
+    // The graph should never call this!
+    jassertfalse;
+}
+
+void AudioProcessorGraph::AudioGraphIOProcessor::processBlock (AudioBuffer<double>&, MidiBuffer&)
+{
+    // The graph should never call this!
+    jassertfalse;
+}
+
+double AudioProcessorGraph::AudioGraphIOProcessor::getTailLengthSeconds() const
+{
+    return 0;
+}
+
+bool AudioProcessorGraph::AudioGraphIOProcessor::acceptsMidi() const
+{
+    return type == midiOutputNode;
+}
+
+bool AudioProcessorGraph::AudioGraphIOProcessor::producesMidi() const
+{
+    return type == midiInputNode;
+}
+
+bool AudioProcessorGraph::AudioGraphIOProcessor::isInput() const noexcept           { return type == audioInputNode  || type == midiInputNode; }
+bool AudioProcessorGraph::AudioGraphIOProcessor::isOutput() const noexcept          { return type == audioOutputNode || type == midiOutputNode; }
+
+bool AudioProcessorGraph::AudioGraphIOProcessor::hasEditor() const                  { return false; }
+AudioProcessorEditor* AudioProcessorGraph::AudioGraphIOProcessor::createEditor()    { return nullptr; }
+
+int AudioProcessorGraph::AudioGraphIOProcessor::getNumPrograms()                    { return 0; }
+int AudioProcessorGraph::AudioGraphIOProcessor::getCurrentProgram()                 { return 0; }
+void AudioProcessorGraph::AudioGraphIOProcessor::setCurrentProgram (int)            { }
+
+const String AudioProcessorGraph::AudioGraphIOProcessor::getProgramName (int)       { return {}; }
+void AudioProcessorGraph::AudioGraphIOProcessor::changeProgramName (int, const String&) {}
+
+void AudioProcessorGraph::AudioGraphIOProcessor::getStateInformation (MemoryBlock&)     {}
+void AudioProcessorGraph::AudioGraphIOProcessor::setStateInformation (const void*, int) {}
+
+void AudioProcessorGraph::AudioGraphIOProcessor::setParentGraph (AudioProcessorGraph* const newGraph)
+{
+    graph = newGraph;
+
+    if (graph == nullptr)
+        return;
+
+    setPlayConfigDetails (type == audioOutputNode ? newGraph->getTotalNumOutputChannels() : 0,
+                          type == audioInputNode  ? newGraph->getTotalNumInputChannels()  : 0,
+                          getSampleRate(),
+                          getBlockSize());
+
+    updateHostDisplay();
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioProcessorGraphTests final : public UnitTest
+{
+public:
+    AudioProcessorGraphTests()
+        : UnitTest ("AudioProcessorGraph", UnitTestCategories::audioProcessors) {}
+
+    void runTest() override
+    {
+        const auto midiChannel = AudioProcessorGraph::midiChannelIndex;
+
+        beginTest ("isConnected returns true when two nodes are connected");
+        {
+            AudioProcessorGraph graph;
+            const auto nodeA = graph.addNode (BasicProcessor::make ({}, MidiIn::no, MidiOut::yes))->nodeID;
             const auto nodeB = graph.addNode (BasicProcessor::make ({}, MidiIn::yes, MidiOut::no))->nodeID;
 
-            expect (graph.canConnect ({ { nodeA, midiChannel }, { nodeB, midiChannel } }));
-            expect (! graph.canConnect ({ { nodeB, midiChannel }, { nodeA, midiChannel } }));
-            expect (! graph.canConnect ({ { nodeA, midiChannel }, { nodeA, midiChannel } }));
-            expect (! graph.canConnect ({ { nodeB, midiChannel }, { nodeB, midiChannel } }));
+            expect (graph.canConnect ({ { nodeA, midiChannel }, { nodeB, midiChannel } }));
+            expect (! graph.canConnect ({ { nodeB, midiChannel }, { nodeA, midiChannel } }));
+            expect (! graph.canConnect ({ { nodeA, midiChannel }, { nodeA, midiChannel } }));
+            expect (! graph.canConnect ({ { nodeB, midiChannel }, { nodeB, midiChannel } }));
+
+            expect (graph.getConnections().empty());
+            expect (! graph.isConnected ({ { nodeA, midiChannel }, { nodeB, midiChannel } }));
+            expect (! graph.isConnected (nodeA, nodeB));
+
+            expect (graph.addConnection ({ { nodeA, midiChannel }, { nodeB, midiChannel } }));
+
+            expect (graph.getConnections().size() == 1);
+            expect (graph.isConnected ({ { nodeA, midiChannel }, { nodeB, midiChannel } }));
+            expect (graph.isConnected (nodeA, nodeB));
+
+            expect (graph.disconnectNode (nodeA));
+
+            expect (graph.getConnections().empty());
+            expect (! graph.isConnected ({ { nodeA, midiChannel }, { nodeB, midiChannel } }));
+            expect (! graph.isConnected (nodeA, nodeB));
+        }
+
+        beginTest ("graph lookups work with a large number of connections");
+        {
+            AudioProcessorGraph graph;
+
+            std::vector<AudioProcessorGraph::NodeID> nodeIDs;
+
+            constexpr auto numNodes = 100;
+
+            for (auto i = 0; i < numNodes; ++i)
+            {
+                nodeIDs.push_back (graph.addNode (BasicProcessor::make (BasicProcessor::getStereoProperties(),
+                                                                        MidiIn::yes,
+                                                                        MidiOut::yes))->nodeID);
+            }
+
+            for (auto it = nodeIDs.begin(); it != std::prev (nodeIDs.end()); ++it)
+            {
+                expect (graph.addConnection ({ { it[0], 0 }, { it[1], 0 } }));
+                expect (graph.addConnection ({ { it[0], 1 }, { it[1], 1 } }));
+            }
+
+            // Check whether isConnected reports correct results when called
+            // with both connections and nodes
+            for (auto it = nodeIDs.begin(); it != std::prev (nodeIDs.end()); ++it)
+            {
+                expect (graph.isConnected ({ { it[0], 0 }, { it[1], 0 } }));
+                expect (graph.isConnected ({ { it[0], 1 }, { it[1], 1 } }));
+                expect (graph.isConnected (it[0], it[1]));
+            }
+
+            const auto& nodes = graph.getNodes();
+
+            expect (! graph.isAnInputTo (*nodes[0], *nodes[0]));
+
+            // Check whether isAnInputTo behaves correctly for a non-cyclic graph
+            for (auto it = std::next (nodes.begin()); it != std::prev (nodes.end()); ++it)
+            {
+                expect (! graph.isAnInputTo (**it, **it));
+
+                expect (graph.isAnInputTo (*nodes[0], **it));
+                expect (! graph.isAnInputTo (**it, *nodes[0]));
+
+                expect (graph.isAnInputTo (**it, *nodes[nodes.size() - 1]));
+                expect (! graph.isAnInputTo (*nodes[nodes.size() - 1], **it));
+            }
+
+            // Make the graph cyclic
+            graph.addConnection ({ { nodeIDs.back(), 0 }, { nodeIDs.front(), 0 } });
+            graph.addConnection ({ { nodeIDs.back(), 1 }, { nodeIDs.front(), 1 } });
+
+            // Check whether isAnInputTo behaves correctly for a cyclic graph
+            for (const auto* node : graph.getNodes())
+            {
+                expect (graph.isAnInputTo (*node, *node));
+
+                expect (graph.isAnInputTo (*nodes[0], *node));
+                expect (graph.isAnInputTo (*node, *nodes[0]));
+
+                expect (graph.isAnInputTo (*node, *nodes[nodes.size() - 1]));
+                expect (graph.isAnInputTo (*nodes[nodes.size() - 1], *node));
+            }
+        }
+
+        beginTest ("rebuilding the graph recalculates overall latency");
+        {
+            AudioProcessorGraph graph;
+
+            const auto nodeA = graph.addNode (BasicProcessor::make (BasicProcessor::getStereoProperties(), MidiIn::no, MidiOut::no))->nodeID;
+            const auto nodeB = graph.addNode (BasicProcessor::make (BasicProcessor::getStereoProperties(), MidiIn::no, MidiOut::no))->nodeID;
+            const auto final = graph.addNode (BasicProcessor::make (BasicProcessor::getInputOnlyProperties(), MidiIn::no, MidiOut::no))->nodeID;
+
+            expect (graph.addConnection ({ { nodeA, 0 }, { nodeB, 0 } }));
+            expect (graph.addConnection ({ { nodeA, 1 }, { nodeB, 1 } }));
+            expect (graph.addConnection ({ { nodeB, 0 }, { final, 0 } }));
+            expect (graph.addConnection ({ { nodeB, 1 }, { final, 1 } }));
+
+            expect (graph.getLatencySamples() == 0);
+
+            // Graph isn't built, latency is 0 if prepareToPlay hasn't been called yet
+            const auto nodeALatency = 100;
+            graph.getNodeForId (nodeA)->getProcessor()->setLatencySamples (nodeALatency);
+            graph.rebuild();
+            expect (graph.getLatencySamples() == 0);
+
+            graph.prepareToPlay (44100, 512);
+
+            expect (graph.getLatencySamples() == nodeALatency);
+
+            const auto nodeBLatency = 200;
+            graph.getNodeForId (nodeB)->getProcessor()->setLatencySamples (nodeBLatency);
+            graph.rebuild();
+            expect (graph.getLatencySamples() == nodeALatency + nodeBLatency);
+
+            const auto finalLatency = 300;
+            graph.getNodeForId (final)->getProcessor()->setLatencySamples (finalLatency);
+            graph.rebuild();
+            expect (graph.getLatencySamples() == nodeALatency + nodeBLatency + finalLatency);
+        }
+
+        beginTest ("large render sequence can be built");
+        {
+            AudioProcessorGraph graph;
+
+            std::vector<AudioProcessorGraph::NodeID> nodeIDs;
+
+            constexpr auto numNodes = 1000;
+            constexpr auto numChannels = 100;
+
+            for (auto i = 0; i < numNodes; ++i)
+            {
+                nodeIDs.push_back (graph.addNode (BasicProcessor::make (BasicProcessor::getMultichannelProperties (numChannels),
+                                                                        MidiIn::yes,
+                                                                        MidiOut::yes))->nodeID);
+            }
+
+            for (auto it = nodeIDs.begin(); it != std::prev (nodeIDs.end()); ++it)
+                for (auto channel = 0; channel < numChannels; ++channel)
+                    expect (graph.addConnection ({ { it[0], channel }, { it[1], channel } }));
+
+            const auto b = std::chrono::steady_clock::now();
+            graph.prepareToPlay (44100.0, 512);
+            const auto e = std::chrono::steady_clock::now();
+            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds> (e - b).count();
+
+            // No test here, but older versions of the graph would take forever to complete building
+            // this graph, so we just want to make sure that we finish the test without timing out.
+            logMessage ("render sequence built in " + String (duration) + " ms");
+        }
 
-            expect (graph.getConnections().empty());
-            expect (! graph.isConnected ({ { nodeA, midiChannel }, { nodeB, midiChannel } }));
-            expect (! graph.isConnected (nodeA, nodeB));
+        beginTest ("graphs that have been changed render the same as graphs that are built from scratch");
+        {
+            using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+            using NodeID = AudioProcessorGraph::NodeID;
+
+            constexpr auto numNodes = 60;
+            constexpr auto blockSize = 64;
+            const NodeID inputID { 1 }, outputID { 2 };
+
+            auto random = getRandom();
+
+            const auto addIONodes = [&] (AudioProcessorGraph& g)
+            {
+                g.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+                g.addNode (std::make_unique<IOProcessor> (IOProcessor::audioInputNode),  inputID);
+                g.addNode (std::make_unique<IOProcessor> (IOProcessor::audioOutputNode), outputID);
+            };
+
+            const auto render = [&] (AudioProcessorGraph& g)
+            {
+                AudioBuffer<float> result (2, 4 * blockSize);
+
+                for (auto start = 0; start < result.getNumSamples(); start += blockSize)
+                {
+                    AudioBuffer<float> block (2, blockSize);
+                    MidiBuffer midi;
+
+                    for (auto channel = 0; channel < 2; ++channel)
+                        for (auto i = 0; i < blockSize; ++i)
+                            block.setSample (channel, i, std::sin ((float) (start + i) * 0.1f * (float) (channel + 1)));
+
+                    g.processBlock (block, midi);
+
+                    for (auto channel = 0; channel < 2; ++channel)
+                        result.copyFrom (channel, start, block, channel, 0, blockSize);
+                }
+
+                return result;
+            };
+
+            AudioProcessorGraph graph;
+            addIONodes (graph);
+
+            for (auto i = 0; i < numNodes; ++i)
+            {
+                auto processor = std::make_unique<OffsetProcessor> (0.01f * (float) i);
+                processor->setLatencySamples (random.nextInt (3) == 0 ? random.nextInt (4) : 0);
+                const auto nodeID = graph.addNode (std::move (processor), NodeID { (uint32) (i + 3) })->nodeID;
+
+                for (auto channel = 0; channel < 2; ++channel)
+                    graph.addConnection ({ { nodeID, channel }, { outputID, channel } });
+            }
+
+            graph.prepareToPlay (44100.0, blockSize);
+
+            const auto getRandomNode = [&] { return NodeID { (uint32) (random.nextInt (numNodes) + 3) }; };
+
+            const auto addRandomConnections = [&] (int numConnections)
+            {
+                for (auto i = 0; i < numConnections; ++i)
+                {
+                    const auto a = getRandomNode(), b = getRandomNode();
+                    const auto channel = random.nextInt (2);
+
+                    // Connections only go from lower to higher IDs, so there are no feedback loops
+                    if (a < b)
+                        graph.addConnection ({ { a, channel }, { b, random.nextInt (2) } });
+                    else
+                        graph.addConnection ({ { inputID, channel }, { a, channel } });
+                }
+            };
+
+            const auto expectMatchesGraphBuiltFromScratch = [&]
+            {
+                AudioProcessorGraph fresh;
+                addIONodes (fresh);
+
+                for (auto* node : graph.getNodes())
+                {
+                    if (auto* processor = dynamic_cast<OffsetProcessor*> (node->getProcessor()))
+                    {
+                        auto copy = std::make_unique<OffsetProcessor> (processor->offset);
+                        copy->setLatencySamples (processor->getLatencySamples());
+                        fresh.addNode (std::move (copy), node->nodeID);
+                    }
+                }
+
+                for (const auto& connection : graph.getConnections())
+                    expect (fresh.addConnection (connection));
+
+                fresh.prepareToPlay (44100.0, blockSize);
+                expectEquals (fresh.getLatencySamples(), graph.getLatencySamples());
+
+                const auto expected = render (fresh);
+                const auto actual = render (graph);
+
+                auto maxError = 0.0f;
+
+                for (auto channel = 0; channel < 2; ++channel)
+                    for (auto i = 0; i < expected.getNumSamples(); ++i)
+                        maxError = jmax (maxError, std::abs (expected.getSample (channel, i) - actual.getSample (channel, i))
+                                                       / jmax (1.0f, std::abs (expected.getSample (channel, i))));
+
+                expectLessThan (maxError, 1.0e-5f);
+            };
+
+            addRandomConnections (150);
+            expectMatchesGraphBuiltFromScratch();
+
+            for (auto i = 0; i < 20; ++i)
+            {
+                const auto connections = graph.getConnections();
+                graph.removeConnection (connections[(size_t) random.nextInt ((int) connections.size())]);
+            }
+
+            addRandomConnections (20);
+            expectMatchesGraphBuiltFromScratch();
+
+            for (auto i = 0; i < 5; ++i)
+            {
+                graph.getNodeForId (getRandomNode())->getProcessor()->setLatencySamples (random.nextInt (5));
+                graph.rebuild();
+            }
+
+            expectMatchesGraphBuiltFromScratch();
+
+            graph.removeNode (NodeID { numNodes / 2 });
+            graph.removeNode (NodeID { numNodes - 5 });
+            expectMatchesGraphBuiltFromScratch();
+
+            // A feedback loop
+            graph.addConnection ({ { NodeID { numNodes }, 0 }, { NodeID { 4 }, 0 } });
+            expectMatchesGraphBuiltFromScratch();
+        }
+
+        beginTest ("node timings are only collected while profiling is enabled");
+        {
+            AudioProcessorGraph graph;
+
+            const auto nodeA = graph.addNode (BasicProcessor::make (BasicProcessor::getStereoProperties(), MidiIn::no, MidiOut::no))->nodeID;
+            const auto nodeB = graph.addNode (BasicProcessor::make (BasicProcessor::getStereoProperties(), MidiIn::no, MidiOut::no))->nodeID;
+
+            expect (graph.addConnection ({ { nodeA, 0 }, { nodeB, 0 } }));
+            expect (graph.addConnection ({ { nodeA, 1 }, { nodeB, 1 } }));
+
+            graph.prepareToPlay (44100.0, 512);
+
+            AudioBuffer<float> audio (2, 512);
+            MidiBuffer midi;
+
+            const auto processBlocks = [&] (int numBlocks)
+            {
+                for (auto i = 0; i < numBlocks; ++i)
+                    graph.processBlock (audio, midi);
+            };
+
+            processBlocks (10);
+            expect (! graph.isNodeProfilingEnabled());
+            expect (graph.getNodeTimings().empty());
+
+            constexpr auto numBlocks = 200;
+
+            graph.setNodeProfilingEnabled (true);
+            expect (graph.isNodeProfilingEnabled());
+            processBlocks (numBlocks);
+
+            auto timings = graph.getNodeTimings();
+            expect (timings.size() == 2);
+
+            for (const auto& t : timings)
+            {
+                expect (t.nodeID == nodeA || t.nodeID == nodeB);
+                expect (t.name == "Basic Processor");
+                expect (t.numBlocks == (uint64) numBlocks);
+                expect (t.minMicroseconds <= t.meanMicroseconds);
+                expect (t.meanMicroseconds <= t.maxMicroseconds);
+                expect (t.minMicroseconds <= t.p99Microseconds);
+                expect (t.p99Microseconds <= t.maxMicroseconds);
+            }
+
+            graph.setNodeProfilingEnabled (false);
+            processBlocks (10);
+
+            for (const auto& t : graph.getNodeTimings())
+                expect (t.numBlocks == (uint64) numBlocks);
+
+            graph.resetNodeTimings();
+
+            for (const auto& t : graph.getNodeTimings())
+                expect (t.numBlocks == 0);
+
+            graph.setNodeProfilingEnabled (true);
+            processBlocks (3);
+
+            for (const auto& t : graph.getNodeTimings())
+                expect (t.numBlocks == 3);
+
+            graph.removeNode (nodeA);
+            timings = graph.getNodeTimings();
+            expect (timings.size() == 1 && timings.front().nodeID == nodeB);
+
+            const TemporaryFile temp (".csv");
+            expect (graph.exportNodeTimings (temp.getFile()));
+
+            StringArray lines;
+            temp.getFile().readLines (lines);
+            lines.removeEmptyStrings();
+
+            expect (lines.size() == 2);
+            expect (lines[0].startsWith ("node_id,name,blocks"));
+            expect (lines[1].startsWith (String (nodeB.uid) + ",\"Basic Processor\",3,"));
+        }
+
+        beginTest ("nodes only sleep after their tail has elapsed");
+        {
+            constexpr auto blockSize = 512;
+            constexpr auto sampleRate = 44100.0;
+
+            for (const auto tailBlocks : { 0, 4, -1 })
+            {
+                const auto tail = tailBlocks < 0 ? std::numeric_limits<double>::infinity()
+                                                 : tailBlocks * blockSize / sampleRate;
+
+                AudioProcessorGraph graph;
+                graph.setPlayConfigDetails (2, 2, sampleRate, blockSize);
+
+                auto processor = std::make_unique<CountingProcessor> (tail);
+                auto& counter = *processor;
+
+                const auto input  = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioInputNode))->nodeID;
+                const auto node   = graph.addNode (std::move (processor))->nodeID;
+                const auto output = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode))->nodeID;
+
+                for (auto channel = 0; channel < 2; ++channel)
+                {
+                    expect (graph.addConnection ({ { input, channel }, { node, channel } }));
+                    expect (graph.addConnection ({ { node, channel }, { output, channel } }));
+                }
+
+                graph.prepareToPlay (sampleRate, blockSize);
+                expect (! graph.isNodeSleepingEnabled());
+
+                AudioBuffer<float> audio (2, blockSize);
+                MidiBuffer midi;
+
+                const auto processBlocks = [&] (int numBlocks, float inputLevel)
+                {
+                    counter.numBlocks = 0;
+
+                    for (auto i = 0; i < numBlocks; ++i)
+                    {
+                        if (inputLevel > 0.0f)
+                        {
+                            for (auto channel = 0; channel < audio.getNumChannels(); ++channel)
+                                FloatVectorOperations::fill (audio.getWritePointer (channel), inputLevel, blockSize);
+                        }
+                        else
+                        {
+                            audio.clear();
+                        }
+
+                        graph.processBlock (audio, midi);
+                    }
+
+                    return counter.numBlocks;
+                };
+
+                constexpr auto numBlocks = 20;
+
+                // Without sleeping enabled, the node processes every block
+                expectEquals (processBlocks (numBlocks, 0.0f), numBlocks);
+
+                graph.setNodeSleepingEnabled (true);
+                expect (graph.isNodeSleepingEnabled());
+
+                const auto expectedBlocks = tailBlocks < 0 ? numBlocks : tailBlocks;
+                expectEquals (processBlocks (numBlocks, 0.0f), expectedBlocks);
+                expectEquals (audio.getMagnitude (0, blockSize), 0.0f);
+
+                // Any input wakes the node up again
+                expectEquals (processBlocks (1, 0.5f), 1);
+                expectEquals (audio.getMagnitude (0, blockSize), 0.5f);
+
+                expectEquals (processBlocks (numBlocks, 0.0f), expectedBlocks);
+                expectEquals (audio.getMagnitude (0, blockSize), 0.0f);
+
+                graph.setNodeSleepingEnabled (false);
+                expectEquals (processBlocks (numBlocks, 0.0f), numBlocks);
+            }
+        }
+
+        beginTest ("buffers written by a node's input-only channels are cleared before they're reused");
+        {
+            constexpr auto blockSize = 512;
+            constexpr auto sampleRate = 44100.0;
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (0, 2, sampleRate, blockSize);
+
+            // The source's silent output feeds the sidechain, which the processor then scribbles
+            // over. Once the MIDI-only node has been rendered, those buffers are free again, so
+            // they'll be handed to the last node's unconnected inputs.
+            const auto source    = graph.addNode (std::make_unique<SilentSourceProcessor>())->nodeID;
+            const auto sidechain = graph.addNode (std::make_unique<SidechainWritingProcessor>())->nodeID;
+            const auto midiOnly  = graph.addNode (BasicProcessor::make ({}, MidiIn::yes, MidiOut::yes))->nodeID;
+            const auto last      = graph.addNode (BasicProcessor::make (BasicProcessor::getStereoProperties(), MidiIn::yes, MidiOut::no))->nodeID;
+            const auto output    = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode))->nodeID;
+
+            for (auto channel = 0; channel < 2; ++channel)
+            {
+                expect (graph.addConnection ({ { source, channel }, { sidechain, channel + 2 } }));
+                expect (graph.addConnection ({ { last, channel }, { output, channel } }));
+            }
+
+            // The MIDI connections only make sure that the nodes are rendered in this order
+            expect (graph.addConnection ({ { sidechain, AudioProcessorGraph::midiChannelIndex },
+                                           { midiOnly,  AudioProcessorGraph::midiChannelIndex } }));
+            expect (graph.addConnection ({ { midiOnly,  AudioProcessorGraph::midiChannelIndex },
+                                           { last,      AudioProcessorGraph::midiChannelIndex } }));
+
+            graph.prepareToPlay (sampleRate, blockSize);
+
+            AudioBuffer<float> audio (2, blockSize);
+            MidiBuffer midi;
+
+            for (auto i = 0; i < 3; ++i)
+            {
+                audio.clear();
+                graph.processBlock (audio, midi);
+
+                for (auto channel = 0; channel < 2; ++channel)
+                    expectEquals (audio.getMagnitude (channel, 0, blockSize), 0.0f);
+            }
+        }
+
+        beginTest ("parameter events are passed to nodes, and split along with the block");
+        {
+            using Interpolation = ParameterEventList::Interpolation;
+
+            constexpr auto blockSize = 256;
+            constexpr auto sampleRate = 44100.0;
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, sampleRate, blockSize);
+            graph.setNodeSleepingEnabled (true);
+
+            auto processor = std::make_unique<EventRecordingProcessor>();
+            auto& recorder = *processor;
+
+            const auto input  = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioInputNode))->nodeID;
+            const auto node   = graph.addNode (std::move (processor));
+            const auto output = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode))->nodeID;
+
+            node->getParameterEvents().ensureStorageAllocated (16);
+
+            for (auto channel = 0; channel < 2; ++channel)
+            {
+                expect (graph.addConnection ({ { input, channel }, { node->nodeID, channel } }));
+                expect (graph.addConnection ({ { node->nodeID, channel }, { output, channel } }));
+            }
+
+            graph.prepareToPlay (sampleRate, blockSize);
+
+            const auto processBlock = [&] (int numSamples, std::initializer_list<ParameterEventList::Event> events)
+            {
+                for (const auto& e : events)
+                    node->getParameterEvents().addEvent (e);
+
+                AudioBuffer<float> audio (2, numSamples);
+                audio.clear();
+                MidiBuffer midi;
+
+                recorder.blocks.clear();
+                graph.processBlock (audio, midi);
+                expect (node->getParameterEvents().isEmpty());
+            };
+
+            // With silent input, the node falls asleep...
+            for (auto i = 0; i < 4; ++i)
+                processBlock (blockSize, {});
+
+            expect (recorder.blocks.empty());
+
+            // ...but parameter changes wake it up
+            processBlock (blockSize, { { 0, 0, 0.2f, Interpolation::step }, { 0, 100, 0.8f, Interpolation::linear } });
+
+            expectEquals ((int) recorder.blocks.size(), 1);
+            expectEquals ((int) recorder.blocks[0].size(), 2);
+            expectEquals (recorder.blocks[0][1].sampleOffset, 100);
+            expectEquals (recorder.blocks[0][1].value, 0.8f);
+
+            // A block that's bigger than the graph was prepared for is split, along with its events
+            processBlock (2 * blockSize, { { 0, 0, 0.0f, Interpolation::step }, { 0, 400, 1.0f, Interpolation::linear } });
+
+            expectEquals ((int) recorder.blocks.size(), 2);
+            expectEquals ((int) recorder.blocks[0].size(), 2);
+            expectEquals ((int) recorder.blocks[1].size(), 2);
+
+            expectEquals (recorder.blocks[0][1].sampleOffset, blockSize - 1);
+            expectWithinAbsoluteError (recorder.blocks[0][1].value, (float) (blockSize - 1) / 400.0f, 1.0e-6f);
+
+            expectEquals (recorder.blocks[1][0].sampleOffset, 0);
+            expect (recorder.blocks[1][0].interpolation == Interpolation::step);
+            expectWithinAbsoluteError (recorder.blocks[1][0].value, (float) blockSize / 400.0f, 1.0e-6f);
+            expectEquals (recorder.blocks[1][1].sampleOffset, 400 - blockSize);
+            expectEquals (recorder.blocks[1][1].value, 1.0f);
+        }
+
+        beginTest ("nodes prepared in the background are only rendered once they're ready");
+        {
+            using PreparationStatus = AudioProcessorGraph::NodePreparationStatus;
+
+            constexpr auto blockSize = 128;
+            constexpr auto sampleRate = 44100.0;
+
+            WaitableEvent canFinishFirst (true), canFinishOthers (true);
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, sampleRate, blockSize);
+            graph.setNumNodePreparationThreads (1);
+            expectEquals (graph.getNumNodePreparationThreads(), 1);
+
+            std::vector<std::pair<AudioProcessorGraph::NodeID, PreparationStatus>> statuses;
+            graph.onNodePreparationStatusChanged = [&] (auto nodeID, auto status) { statuses.emplace_back (nodeID, status); };
+
+            const auto output = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode))->nodeID;
+            graph.prepareToPlay (sampleRate, blockSize);
+
+            const auto addSlowNode = [&] (float level, WaitableEvent& canFinish)
+            {
+                auto node = graph.addNode (std::make_unique<SlowPreparingProcessor> (level, canFinish));
+
+                for (auto channel = 0; channel < 2; ++channel)
+                    expect (graph.addConnection ({ { node->nodeID, channel }, { output, channel } }));
+
+                return node;
+            };
+
+            const auto getProcessor = [] (const AudioProcessorGraph::Node::Ptr& node)
+            {
+                return static_cast<SlowPreparingProcessor*> (node->getProcessor());
+            };
+
+            AudioBuffer<float> audio (2, blockSize);
+            MidiBuffer midi;
+
+            const auto render = [&]
+            {
+                audio.clear();
+                graph.processBlock (audio, midi);
+                return audio.getMagnitude (0, blockSize);
+            };
+
+            const auto nodeA = addSlowNode (0.5f, canFinishFirst);
+            expect (graph.isNodeBeingPrepared (nodeA->nodeID));
+            expect (! graph.isNodeBeingPrepared (output));
+
+            // The graph carries on rendering while the node is being prepared
+            expectEquals (render(), 0.0f);
+
+            canFinishFirst.signal();
+
+            for (auto i = 0; i < 5000 && graph.isNodeBeingPrepared (nodeA->nodeID); ++i)
+            {
+                Thread::sleep (1);
+                graph.rebuild();
+            }
+
+            expect (! graph.isNodeBeingPrepared (nodeA->nodeID));
+            expectEquals (getProcessor (nodeA)->numPrepares.load(), 1);
+            expectEquals (render(), 0.5f);
+
+            // With a single thread, the second node is prepared while the third waits in the queue
+            const auto nodeB = addSlowNode (0.25f, canFinishOthers);
+            const auto nodeC = addSlowNode (0.25f, canFinishOthers);
+            expectEquals (graph.getNumNodesBeingPrepared(), 2);
+
+            for (auto i = 0; i < 5000 && getProcessor (nodeB)->numPrepares == 0; ++i)
+                Thread::sleep (1);
+
+            graph.removeNode (nodeC->nodeID);
+            graph.removeNode (nodeB->nodeID);
+            expectEquals (graph.getNumNodesBeingPrepared(), 0);
+            expectEquals (render(), 0.5f);
+
+            canFinishOthers.signal();
+            graph.setNumNodePreparationThreads (0);
+
+            // The node that was removed while it was being prepared is released once it's ready
+            expectEquals (getProcessor (nodeB)->numPrepares.load(), 1);
+            expectEquals (getProcessor (nodeB)->numReleases.load(), 1);
+            expectEquals (getProcessor (nodeC)->numPrepares.load(), 0);
+
+            const std::vector<std::pair<AudioProcessorGraph::NodeID, PreparationStatus>> expectedStatuses
+            {
+                { nodeA->nodeID, PreparationStatus::queued },
+                { nodeA->nodeID, PreparationStatus::ready },
+                { nodeB->nodeID, PreparationStatus::queued },
+                { nodeC->nodeID, PreparationStatus::queued },
+                { nodeC->nodeID, PreparationStatus::cancelled },
+                { nodeB->nodeID, PreparationStatus::cancelled }
+            };
+
+            expect (statuses == expectedStatuses);
+        }
+
+        beginTest ("changing the settings doesn't wait for nodes that are being prepared");
+        {
+            constexpr auto blockSize = 128;
+
+            WaitableEvent canFinishKept (true), canFinishRemoved (true);
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+            graph.setNumNodePreparationThreads (2);
+
+            const auto output = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode))->nodeID;
+            graph.prepareToPlay (44100.0, blockSize);
+
+            const auto kept    = graph.addNode (std::make_unique<SlowPreparingProcessor> (0.5f, canFinishKept));
+            const auto removed = graph.addNode (std::make_unique<SlowPreparingProcessor> (0.25f, canFinishRemoved));
+
+            for (auto channel = 0; channel < 2; ++channel)
+                expect (graph.addConnection ({ { kept->nodeID, channel }, { output, channel } }));
+
+            const auto getProcessor = [] (const AudioProcessorGraph::Node::Ptr& node)
+            {
+                return static_cast<SlowPreparingProcessor*> (node->getProcessor());
+            };
+
+            for (auto i = 0; i < 5000 && (getProcessor (kept)->numPrepares == 0 || getProcessor (removed)->numPrepares == 0); ++i)
+                Thread::sleep (1);
+
+            // Both nodes are still being prepared, so these would never return if they waited
+            graph.removeNode (removed->nodeID);
+            graph.prepareToPlay (48000.0, blockSize);
+
+            expect (graph.isNodeBeingPrepared (kept->nodeID));
+            expectEquals (getProcessor (kept)->numReleases.load(), 0);
+
+            AudioBuffer<float> audio (2, blockSize);
+            MidiBuffer midi;
+
+            const auto render = [&]
+            {
+                audio.clear();
+                graph.processBlock (audio, midi);
+                return audio.getMagnitude (0, blockSize);
+            };
+
+            expectEquals (render(), 0.0f);
+
+            // The node that finishes with the old settings is released, and prepared again
+            canFinishKept.signal();
+
+            for (auto i = 0; i < 5000 && graph.isNodeBeingPrepared (kept->nodeID); ++i)
+            {
+                Thread::sleep (1);
+                graph.rebuild();
+            }
+
+            expect (! graph.isNodeBeingPrepared (kept->nodeID));
+            expectEquals (getProcessor (kept)->numPrepares.load(), 2);
+            expectEquals (getProcessor (kept)->numReleases.load(), 1);
+            expectEquals (getProcessor (kept)->preparedSampleRate.load(), 48000.0);
+            expectEquals (render(), 0.5f);
+
+            // The removed node is released as soon as it has been prepared
+            canFinishRemoved.signal();
+
+            for (auto i = 0; i < 5000 && getProcessor (removed)->numReleases == 0; ++i)
+            {
+                Thread::sleep (1);
+                graph.rebuild();
+            }
+
+            expectEquals (getProcessor (removed)->numPrepares.load(), 1);
+            expectEquals (getProcessor (removed)->numReleases.load(), 1);
+        }
+
+        beginTest ("nodes without live inputs can be rendered ahead of time, and follow the play head");
+        {
+            constexpr auto blockSize = 256;
+            constexpr auto sampleRate = 44100.0;
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, sampleRate, blockSize);
+            graph.setNonRealtime (true);
+
+            TestPlayHead playHead;
+            graph.setPlayHead (&playHead);
+
+            const auto input  = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioInputNode))->nodeID;
+            const auto output = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode))->nodeID;
+            const auto ramp   = graph.addNode (std::make_unique<RampProcessor>())->nodeID;
+            const auto offset = graph.addNode (std::make_unique<OffsetProcessor> (0.0f))->nodeID;
+
+            for (auto channel = 0; channel < 2; ++channel)
+            {
+                expect (graph.addConnection ({ { ramp,   channel }, { output, channel } }));
+                expect (graph.addConnection ({ { input,  channel }, { offset, channel } }));
+                expect (graph.addConnection ({ { offset, channel }, { output, channel } }));
+            }
+
+            graph.setAnticipativeRenderingEnabled (true, 1024, 3);
+            expect (graph.isAnticipativeRenderingEnabled());
+
+            graph.prepareToPlay (sampleRate, blockSize);
+
+            expect (graph.isNodeRenderedAhead (ramp));
+            expect (! graph.isNodeRenderedAhead (offset));
+            expect (! graph.isNodeRenderedAhead (input));
+            expect (! graph.isNodeRenderedAhead (output));
+
+            AudioBuffer<float> audio (2, blockSize);
+            MidiBuffer midi;
+
+            // The input is halved by the live node, and mixed with the ramp
+            const auto renderMatches = [&] (int numBlocks)
+            {
+                auto result = true;
+
+                for (auto block = 0; block < numBlocks; ++block)
+                {
+                    for (auto channel = 0; channel < 2; ++channel)
+                        FloatVectorOperations::fill (audio.getWritePointer (channel), 0.5f, blockSize);
+
+                    graph.processBlock (audio, midi);
+
+                    for (auto i = 0; i < blockSize; ++i)
+                        for (auto channel = 0; channel < 2; ++channel)
+                            result &= approximatelyEqual (audio.getSample (channel, i), RampProcessor::getValueAt (playHead.time + i) + 0.25f);
+
+                    playHead.time += blockSize;
+                }
+
+                return result;
+            };
+
+            // The background thread stops once it has rendered numBlocksAhead blocks, including
+            // the one that's being played
+            auto& rampProcessor = dynamic_cast<RampProcessor&> (*graph.getNodeForId (ramp)->getProcessor());
+            expect (renderMatches (1));
 
-            expect (graph.addConnection ({ { nodeA, midiChannel }, { nodeB, midiChannel } }));
+            for (auto i = 0; i < 5000 && rampProcessor.numBlocks < 3; ++i)
+                Thread::sleep (1);
 
-            expect (graph.getConnections().size() == 1);
-            expect (graph.isConnected ({ { nodeA, midiChannel }, { nodeB, midiChannel } }));
-            expect (graph.isConnected (nodeA, nodeB));
+            Thread::sleep (20);
+            expectEquals (rampProcessor.numBlocks.load(), 3);
 
-            expect (graph.disconnectNode (nodeA));
+            expect (renderMatches (20));
 
-            expect (graph.getConnections().empty());
-            expect (! graph.isConnected ({ { nodeA, midiChannel }, { nodeB, midiChannel } }));
-            expect (! graph.isConnected (nodeA, nodeB));
+            // After the play head jumps, the ramp is rendered again from the new position
+            playHead.time = 123457;
+            expect (renderMatches (20));
+
+            graph.setAnticipativeRenderingEnabled (false);
+            expect (! graph.isNodeRenderedAhead (ramp));
+            expect (renderMatches (4));
         }
 
-        beginTest ("graph lookups work with a large number of connections");
+        beginTest ("audio that's rendered ahead of time keeps the graph's precision");
         {
+            constexpr auto blockSize = 256;
+            constexpr auto sampleRate = 44100.0;
+
             AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (0, 2, sampleRate, blockSize);
+            graph.setProcessingPrecision (AudioProcessor::doublePrecision);
+            graph.setNonRealtime (true);
 
-            std::vector<AudioProcessorGraph::NodeID> nodeIDs;
+            TestPlayHead playHead;
+            graph.setPlayHead (&playHead);
 
-            constexpr auto numNodes = 100;
+            const auto output = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode))->nodeID;
+            const auto source = graph.addNode (std::make_unique<PreciseSourceProcessor>())->nodeID;
 
-            for (auto i = 0; i < numNodes; ++i)
-            {
-                nodeIDs.push_back (graph.addNode (BasicProcessor::make (BasicProcessor::getStereoProperties(),
-                                                                        MidiIn::yes,
-                                                                        MidiOut::yes))->nodeID);
-            }
+            for (auto channel = 0; channel < 2; ++channel)
+                expect (graph.addConnection ({ { source, channel }, { output, channel } }));
 
-            for (auto it = nodeIDs.begin(); it != std::prev (nodeIDs.end()); ++it)
-            {
-                expect (graph.addConnection ({ { it[0], 0 }, { it[1], 0 } }));
-                expect (graph.addConnection ({ { it[0], 1 }, { it[1], 1 } }));
-            }
+            graph.setAnticipativeRenderingEnabled (true, 1024, 3);
+            graph.prepareToPlay (sampleRate, blockSize);
+            expect (graph.isNodeRenderedAhead (source));
 
-            // Check whether isConnected reports correct results when called
-            // with both connections and nodes
-            for (auto it = nodeIDs.begin(); it != std::prev (nodeIDs.end()); ++it)
+            AudioBuffer<double> audio (2, blockSize);
+            MidiBuffer midi;
+            auto allExact = true;
+
+            for (auto block = 0; block < 8; ++block)
             {
-                expect (graph.isConnected ({ { it[0], 0 }, { it[1], 0 } }));
-                expect (graph.isConnected ({ { it[0], 1 }, { it[1], 1 } }));
-                expect (graph.isConnected (it[0], it[1]));
+                graph.processBlock (audio, midi);
+                playHead.time += blockSize;
+
+                for (auto channel = 0; channel < 2; ++channel)
+                    for (auto i = 0; i < blockSize; ++i)
+                        allExact &= exactlyEqual (audio.getSample (channel, i), PreciseSourceProcessor::value);
             }
 
-            const auto& nodes = graph.getNodes();
+            expect (allExact);
+        }
 
-            expect (! graph.isAnInputTo (*nodes[0], *nodes[0]));
+        beginTest ("nodes that can be batched are rendered together, one dependency level at a time");
+        {
+            constexpr auto numStrips = 8;
+            constexpr auto blockSize = 64;
+            constexpr auto sampleRate = 44100.0;
 
-            // Check whether isAnInputTo behaves correctly for a non-cyclic graph
-            for (auto it = std::next (nodes.begin()); it != std::prev (nodes.end()); ++it)
-            {
-                expect (! graph.isAnInputTo (**it, **it));
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (numStrips, numStrips, sampleRate, blockSize);
 
-                expect (graph.isAnInputTo (*nodes[0], **it));
-                expect (! graph.isAnInputTo (**it, *nodes[0]));
+            BatchingProcessor::Log log;
 
-                expect (graph.isAnInputTo (**it, *nodes[nodes.size() - 1]));
-                expect (! graph.isAnInputTo (*nodes[nodes.size() - 1], **it));
-            }
+            const auto input  = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioInputNode))->nodeID;
+            const auto output = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode))->nodeID;
 
-            // Make the graph cyclic
-            graph.addConnection ({ { nodeIDs.back(), 0 }, { nodeIDs.front(), 0 } });
-            graph.addConnection ({ { nodeIDs.back(), 1 }, { nodeIDs.front(), 1 } });
+            std::vector<AudioProcessorGraph::Node::Ptr> firstStage;
 
-            // Check whether isAnInputTo behaves correctly for a cyclic graph
-            for (const auto* node : graph.getNodes())
+            for (auto i = 0; i < numStrips; ++i)
             {
-                expect (graph.isAnInputTo (*node, *node));
+                const auto first  = graph.addNode (std::make_unique<BatchingProcessor> ((float) (i + 1), log));
+                const auto second = graph.addNode (std::make_unique<BatchingProcessor> (0.5f, log))->nodeID;
 
-                expect (graph.isAnInputTo (*nodes[0], *node));
-                expect (graph.isAnInputTo (*node, *nodes[0]));
+                expect (graph.addConnection ({ { input, i }, { first->nodeID, 0 } }));
+                expect (graph.addConnection ({ { first->nodeID, 0 }, { second, 0 } }));
+                expect (graph.addConnection ({ { second, 0 }, { output, i } }));
 
-                expect (graph.isAnInputTo (*node, *nodes[nodes.size() - 1]));
-                expect (graph.isAnInputTo (*nodes[nodes.size() - 1], *node));
+                firstStage.push_back (first);
             }
-        }
 
-        beginTest ("rebuilding the graph recalculates overall latency");
-        {
-            AudioProcessorGraph graph;
+            graph.prepareToPlay (sampleRate, blockSize);
 
-            const auto nodeA = graph.addNode (BasicProcessor::make (BasicProcessor::getStereoProperties(), MidiIn::no, MidiOut::no))->nodeID;
-            const auto nodeB = graph.addNode (BasicProcessor::make (BasicProcessor::getStereoProperties(), MidiIn::no, MidiOut::no))->nodeID;
-            const auto final = graph.addNode (BasicProcessor::make (BasicProcessor::getInputOnlyProperties(), MidiIn::no, MidiOut::no))->nodeID;
+            AudioBuffer<float> audio (numStrips, blockSize);
+            MidiBuffer midi;
 
-            expect (graph.addConnection ({ { nodeA, 0 }, { nodeB, 0 } }));
-            expect (graph.addConnection ({ { nodeA, 1 }, { nodeB, 1 } }));
-            expect (graph.addConnection ({ { nodeB, 0 }, { final, 0 } }));
-            expect (graph.addConnection ({ { nodeB, 1 }, { final, 1 } }));
+            const auto processBlock = [&]
+            {
+                log = {};
 
-            expect (graph.getLatencySamples() == 0);
+                for (auto channel = 0; channel < numStrips; ++channel)
+                    FloatVectorOperations::fill (audio.getWritePointer (channel), 1.0f, blockSize);
 
-            // Graph isn't built, latency is 0 if prepareToPlay hasn't been called yet
-            const auto nodeALatency = 100;
-            graph.getNodeForId (nodeA)->getProcessor()->setLatencySamples (nodeALatency);
-            graph.rebuild();
-            expect (graph.getLatencySamples() == 0);
+                graph.processBlock (audio, midi);
+            };
 
-            graph.prepareToPlay (44100, 512);
+            // Each stage depends on the one before, so the stages make separate batches
+            processBlock();
 
-            expect (graph.getLatencySamples() == nodeALatency);
+            expect (log.batchSizes == std::vector<size_t> { numStrips, numStrips });
+            expectEquals (log.numSingleBlocks, 0);
 
-            const auto nodeBLatency = 200;
-            graph.getNodeForId (nodeB)->getProcessor()->setLatencySamples (nodeBLatency);
-            graph.rebuild();
-            expect (graph.getLatencySamples() == nodeALatency + nodeBLatency);
+            for (auto i = 0; i < numStrips; ++i)
+                expectEquals (audio.getSample (i, blockSize - 1), 0.5f * (float) (i + 1));
 
-            const auto finalLatency = 300;
-            graph.getNodeForId (final)->getProcessor()->setLatencySamples (finalLatency);
-            graph.rebuild();
-            expect (graph.getLatencySamples() == nodeALatency + nodeBLatency + finalLatency);
-        }
+            // Bypassed nodes are left out of their batch
+            firstStage[3]->setBypassed (true);
+            processBlock();
 
-        beginTest ("large render sequence can be built");
-        {
-            AudioProcessorGraph graph;
+            expect (log.batchSizes == std::vector<size_t> { numStrips - 1, numStrips });
+            expectEquals (audio.getSample (3, blockSize - 1), 0.5f);
+            firstStage[3]->setBypassed (false);
 
-            std::vector<AudioProcessorGraph::NodeID> nodeIDs;
+            // The batch is still rendered by the node that formed it, while that node is bypassed
+            const auto leader = std::find_if (firstStage.begin(), firstStage.end(), [&] (const auto& node)
+            {
+                return node->getProcessor() == log.batchProcessors.front();
+            });
 
-            constexpr auto numNodes = 1000;
-            constexpr auto numChannels = 100;
+            expect (leader != firstStage.end());
+            (*leader)->setBypassed (true);
+            processBlock();
 
-            for (auto i = 0; i < numNodes; ++i)
-            {
-                nodeIDs.push_back (graph.addNode (BasicProcessor::make (BasicProcessor::getMultichannelProperties (numChannels),
-                                                                        MidiIn::yes,
-                                                                        MidiOut::yes))->nodeID);
-            }
+            expect (log.batchSizes == std::vector<size_t> { numStrips - 1, numStrips });
+            expect (log.batchProcessors.front() == (*leader)->getProcessor());
+            (*leader)->setBypassed (false);
 
-            for (auto it = nodeIDs.begin(); it != std::prev (nodeIDs.end()); ++it)
-                for (auto channel = 0; channel < numChannels; ++channel)
-                    expect (graph.addConnection ({ { it[0], channel }, { it[1], channel } }));
+            // While the node that formed the batch is suspended, another member renders it
+            (*leader)->getProcessor()->suspendProcessing (true);
+            processBlock();
 
-            const auto b = std::chrono::steady_clock::now();
-            graph.prepareToPlay (44100.0, 512);
-            const auto e = std::chrono::steady_clock::now();
-            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds> (e - b).count();
+            expect (log.batchSizes == std::vector<size_t> { numStrips - 1, numStrips });
+            expect (log.batchProcessors.front() != (*leader)->getProcessor());
+            expectEquals (audio.getSample ((int) std::distance (firstStage.begin(), leader), blockSize - 1), 0.0f);
+            (*leader)->getProcessor()->suspendProcessing (false);
 
-            // No test here, but older versions of the graph would take forever to complete building
-            // this graph, so we just want to make sure that we finish the test without timing out.
-            logMessage ("render sequence built in " + String (duration) + " ms");
+            // While profiling, each node is rendered on its own
+            graph.setNodeProfilingEnabled (true);
+            processBlock();
+
+            expect (log.batchSizes.empty());
+            expectEquals (log.numSingleBlocks, 2 * numStrips);
+            expectEquals (audio.getSample (7, blockSize - 1), 4.0f);
         }
     }
 
 private:
+    friend class AudioProcessorGraphBenchmark;
+
     enum class MidiIn  { no, yes };
     enum class MidiOut { no, yes };
 
-    class BasicProcessor final : public AudioProcessor
+    class BasicProcessor : public AudioProcessor
     {
     public:
         explicit BasicProcessor (const AudioProcessor::BusesProperties& layout, MidiIn mIn, MidiOut mOut)
@@ -2357,10 +5269,318 @@ private:
         MidiIn midiIn;
         MidiOut midiOut;
     };
+
+    class OffsetProcessor final : public BasicProcessor
+    {
+    public:
+        explicit OffsetProcessor (float offsetIn)
+            : BasicProcessor (getStereoProperties(), MidiIn::no, MidiOut::no), offset (offsetIn) {}
+
+        void processBlock (AudioBuffer<float>& audio, MidiBuffer&) override
+        {
+            for (auto channel = 0; channel < audio.getNumChannels(); ++channel)
+            {
+                audio.applyGain (channel, 0, audio.getNumSamples(), 0.5f);
+                FloatVectorOperations::add (audio.getWritePointer (channel), offset, audio.getNumSamples());
+            }
+        }
+
+        using BasicProcessor::processBlock;
+
+        const float offset;
+    };
+
+    class CountingProcessor final : public BasicProcessor
+    {
+    public:
+        explicit CountingProcessor (double tailIn)
+            : BasicProcessor (getStereoProperties(), MidiIn::no, MidiOut::no), tail (tailIn) {}
+
+        double getTailLengthSeconds() const override { return tail; }
+
+        void processBlock (AudioBuffer<float>&, MidiBuffer&) override { ++numBlocks; }
+
+        using BasicProcessor::processBlock;
+
+        const double tail;
+        int numBlocks = 0;
+    };
+
+    class SilentSourceProcessor final : public BasicProcessor
+    {
+    public:
+        SilentSourceProcessor()
+            : BasicProcessor (BusesProperties().withOutput ("out", AudioChannelSet::stereo()), MidiIn::no, MidiOut::no) {}
+
+        void processBlock (AudioBuffer<float>& audio, MidiBuffer&) override { audio.clear(); }
+
+        using BasicProcessor::processBlock;
+    };
+
+    // Writes to all of its channels, including the sidechain inputs that aren't also outputs
+    class SidechainWritingProcessor final : public BasicProcessor
+    {
+    public:
+        SidechainWritingProcessor()
+            : BasicProcessor (BusesProperties().withInput  ("in",        AudioChannelSet::stereo())
+                                               .withInput  ("sidechain", AudioChannelSet::stereo())
+                                               .withOutput ("out",       AudioChannelSet::stereo()),
+                              MidiIn::no,
+                              MidiOut::yes) {}
+
+        void processBlock (AudioBuffer<float>& audio, MidiBuffer&) override
+        {
+            for (auto channel = 0; channel < audio.getNumChannels(); ++channel)
+                FloatVectorOperations::fill (audio.getWritePointer (channel), 1.0f, audio.getNumSamples());
+        }
+
+        using BasicProcessor::processBlock;
+    };
+
+    class BatchingProcessor final : public BasicProcessor
+    {
+    public:
+        struct Log
+        {
+            std::vector<size_t> batchSizes;
+            std::vector<const AudioProcessor*> batchProcessors;
+            int numSingleBlocks = 0;
+        };
+
+        BatchingProcessor (float gainIn, Log& logIn)
+            : BasicProcessor (getMultichannelProperties (1), MidiIn::no, MidiOut::no), gain (gainIn), log (logIn) {}
+
+        bool canProcessInBatchWith (const AudioProcessor& other) const override
+        {
+            return dynamic_cast<const BatchingProcessor*> (&other) != nullptr;
+        }
+
+        void processBatch (Span<const BatchItem<float>> items) override
+        {
+            log.batchSizes.push_back (items.size());
+            log.batchProcessors.push_back (this);
+
+            for (const auto& item : items)
+                item.buffer.applyGain (static_cast<BatchingProcessor&> (item.processor).gain);
+        }
+
+        void processBlock (AudioBuffer<float>& audio, MidiBuffer&) override
+        {
+            ++log.numSingleBlocks;
+            audio.applyGain (gain);
+        }
+
+        using BasicProcessor::processBatch;
+        using BasicProcessor::processBlock;
+
+        const float gain;
+        Log& log;
+    };
+
+    class EventRecordingProcessor final : public BasicProcessor
+    {
+    public:
+        EventRecordingProcessor()
+            : BasicProcessor (getStereoProperties(), MidiIn::no, MidiOut::no) {}
+
+        double getTailLengthSeconds() const override { return 0.0; }
+
+        void processBlock (AudioBuffer<float>&, MidiBuffer&) override
+        {
+            auto& events = blocks.emplace_back();
+
+            if (auto* list = getParameterEvents())
+                events.assign (list->begin(), list->end());
+        }
+
+        using BasicProcessor::processBlock;
+
+        std::vector<std::vector<ParameterEventList::Event>> blocks;
+    };
+
+    class SlowPreparingProcessor final : public BasicProcessor
+    {
+    public:
+        SlowPreparingProcessor (float levelIn, WaitableEvent& canFinishIn)
+            : BasicProcessor (getStereoProperties(), MidiIn::no, MidiOut::no), level (levelIn), canFinish (canFinishIn) {}
+
+        void prepareToPlay (double sampleRate, int) override
+        {
+            ++numPrepares;
+            canFinish.wait (-1);
+            preparedSampleRate = sampleRate;
+        }
+
+        void releaseResources() override { ++numReleases; }
+
+        void processBlock (AudioBuffer<float>& audio, MidiBuffer&) override
+        {
+            for (auto channel = 0; channel < audio.getNumChannels(); ++channel)
+                FloatVectorOperations::fill (audio.getWritePointer (channel), level, audio.getNumSamples());
+        }
+
+        using BasicProcessor::processBlock;
+
+        const float level;
+        WaitableEvent& canFinish;
+        std::atomic<int> numPrepares { 0 }, numReleases { 0 };
+        std::atomic<double> preparedSampleRate { 0.0 };
+    };
+
+    // Plays a sawtooth that follows the play head's position
+    class RampProcessor final : public BasicProcessor
+    {
+    public:
+        RampProcessor()
+            : BasicProcessor (BusesProperties().withOutput ("out", AudioChannelSet::stereo()), MidiIn::no, MidiOut::no) {}
+
+        static float getValueAt (int64 time) { return (float) (time % 1000) / 1000.0f; }
+
+        void processBlock (AudioBuffer<float>& audio, MidiBuffer&) override
+        {
+            const auto position = getPlayHead() != nullptr ? getPlayHead()->getPosition() : nullopt;
+            const auto time = position.hasValue() ? position->getTimeInSamples().orFallback (0) : 0;
+
+            for (auto i = 0; i < audio.getNumSamples(); ++i)
+                for (auto channel = 0; channel < audio.getNumChannels(); ++channel)
+                    audio.setSample (channel, i, getValueAt (time + i));
+
+            ++numBlocks;
+        }
+
+        using BasicProcessor::processBlock;
+
+        std::atomic<int> numBlocks { 0 };
+    };
+
+    // Outputs a value that can't be represented in single precision
+    class PreciseSourceProcessor final : public BasicProcessor
+    {
+    public:
+        PreciseSourceProcessor()
+            : BasicProcessor (BusesProperties().withOutput ("out", AudioChannelSet::stereo()), MidiIn::no, MidiOut::no) {}
+
+        static constexpr double value = 1.0 + 1.0e-10;
+
+        void processBlock (AudioBuffer<double>& audio, MidiBuffer&) override
+        {
+            for (auto channel = 0; channel < audio.getNumChannels(); ++channel)
+                FloatVectorOperations::fill (audio.getWritePointer (channel), value, audio.getNumSamples());
+        }
+
+        using BasicProcessor::processBlock;
+    };
+
+    struct TestPlayHead final : public AudioPlayHead
+    {
+        Optional<PositionInfo> getPosition() const override
+        {
+            PositionInfo info;
+            info.setIsPlaying (true);
+            info.setTimeInSamples (time);
+            return info;
+        }
+
+        int64 time = 0;
+    };
 };
 
 static AudioProcessorGraphTests audioProcessorGraphTests;
 
+//==============================================================================
+class AudioProcessorGraphBenchmark final : public UnitTest
+{
+public:
+    AudioProcessorGraphBenchmark()
+        : UnitTest ("AudioProcessorGraph Benchmark", UnitTestCategories::benchmarks) {}
+
+    void runTest() override
+    {
+        using Tests = AudioProcessorGraphTests;
+        using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+        using UpdateKind = AudioProcessorGraph::UpdateKind;
+
+        beginTest ("Rebuilding a graph after adding a connection");
+
+        logMessage ("nodes, full build ms, connection from first strip ms, connection into last strip ms");
+
+        // The graph is made of strips of processors, like the channels of a mixer, which
+        // are fed by the graph's input and summed into its output
+        constexpr auto stripLength = 10;
+
+        for (auto numNodes : { 100, 250, 500, 1000 })
+        {
+            AudioProcessorGraph graph;
+
+            const auto input  = graph.addNode (std::make_unique<IOProcessor> (IOProcessor::audioInputNode),  std::nullopt, UpdateKind::none)->nodeID;
+            const auto output = graph.addNode (std::make_unique<IOProcessor> (IOProcessor::audioOutputNode), std::nullopt, UpdateKind::none)->nodeID;
+
+            std::vector<AudioProcessorGraph::NodeID> nodeIDs;
+
+            for (auto i = 0; i < numNodes; ++i)
+            {
+                nodeIDs.push_back (graph.addNode (Tests::BasicProcessor::make (Tests::BasicProcessor::getStereoProperties(),
+                                                                               Tests::MidiIn::no,
+                                                                               Tests::MidiOut::no),
+                                                  std::nullopt,
+                                                  UpdateKind::none)->nodeID);
+            }
+
+            const auto connectBoth = [&] (AudioProcessorGraph::NodeID source, AudioProcessorGraph::NodeID destination)
+            {
+                for (auto channel = 0; channel < 2; ++channel)
+                    graph.addConnection ({ { source, channel }, { destination, channel } }, UpdateKind::none);
+            };
+
+            for (size_t i = 0; i < nodeIDs.size(); ++i)
+            {
+                const auto positionInStrip = i % stripLength;
+
+                if (positionInStrip == 0)
+                    connectBoth (input, nodeIDs[i]);
+                else
+                    connectBoth (nodeIDs[i - 1], nodeIDs[i]);
+
+                if (positionInStrip == stripLength - 1 || i == nodeIDs.size() - 1)
+                    connectBoth (nodeIDs[i], output);
+            }
+
+            const auto toMilliseconds = [] (int64 ticks)
+            {
+                return String (Time::highResolutionTicksToSeconds (ticks) * 1.0e3, 3);
+            };
+
+            const auto start = Time::getHighResolutionTicks();
+            graph.prepareToPlay (44100.0, 512);
+            const auto fullBuild = Time::getHighResolutionTicks() - start;
+
+            const auto timeConnection = [&] (AudioProcessorGraph::Connection connection)
+            {
+                constexpr auto numRepeats = 5;
+                const auto begin = Time::getHighResolutionTicks();
+
+                for (auto i = 0; i < numRepeats; ++i)
+                {
+                    expect (graph.addConnection (connection));
+                    expect (graph.removeConnection (connection));
+                }
+
+                return (Time::getHighResolutionTicks() - begin) / (2 * numRepeats);
+            };
+
+            const auto fromFirstStrip = timeConnection ({ { nodeIDs.front(), 0 }, { nodeIDs[stripLength], 0 } });
+            const auto intoLastStrip  = timeConnection ({ { nodeIDs[nodeIDs.size() - stripLength - 1], 0 }, { nodeIDs.back(), 0 } });
+
+            logMessage (String (numNodes) + ", "
+                        + toMilliseconds (fullBuild) + ", "
+                        + toMilliseconds (fromFirstStrip) + ", "
+                        + toMilliseconds (intoLastStrip));
+        }
+    }
+};
+
+static AudioProcessorGraphBenchmark audioProcessorGraphBenchmark;
+
 #endif
 
 } // namespace juce
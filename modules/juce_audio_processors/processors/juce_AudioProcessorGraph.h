@@ -40,6 +40,10 @@ namespace juce
     To play back a graph through an audio device, you might want to use an
     AudioProcessorPlayer object.
 
+    Nodes whose processors can be rendered together (see
+    AudioProcessor::canProcessInBatchWith()) are passed to a single call to
+    AudioProcessor::processBatch(), as long as none of them depends on another.
+
     @tags{Audio}
 */
 class JUCE_API  AudioProcessorGraph   : public AudioProcessor,
@@ -157,6 +161,18 @@ public:
         */
         bool userRequestedBypass() const { return bypassed; }
 
+        //==============================================================================
+        /** Returns a list of sample-accurate parameter changes for this node's processor.
+
+            Fill this on the audio thread just before calling processBlock() on the graph,
+            and the graph will hand it to the processor (see AudioProcessor::getParameterEvents())
+            when the node is processed. The list is cleared at the end of each block.
+
+            As the list never allocates on the audio thread, call
+            ParameterEventList::ensureStorageAllocated() on it when the node is added.
+        */
+        ParameterEventList& getParameterEvents() noexcept       { return parameterEvents; }
+
         /** @internal
 
             To create a new node, use AudioProcessorGraph::addNode.
@@ -171,6 +187,7 @@ public:
         //==============================================================================
         std::unique_ptr<AudioProcessor> processor;
         std::atomic<bool> bypassed { false };
+        ParameterEventList parameterEvents;
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Node)
     };
@@ -323,6 +340,187 @@ public:
     */
     void rebuild();
 
+    //==============================================================================
+    /** A summary of the time that a node has spent processing.
+        @see getNodeTimings
+    */
+    struct NodeTiming
+    {
+        NodeID nodeID;
+        String name;
+        uint64 numBlocks = 0;
+
+        double minMicroseconds = 0, meanMicroseconds = 0, p99Microseconds = 0, maxMicroseconds = 0;
+    };
+
+    /** Enables or disables timing of the nodes' processing.
+
+        While this is enabled, the graph measures how long each node takes to process each
+        block, which can help to find out which nodes are using the most CPU. The timings
+        are kept in fixed-size histograms, so recording them doesn't allocate or lock on the
+        audio thread. When it's disabled, which is the default, the graph doesn't do any
+        extra work at all.
+
+        Changing this will rebuild the graph. Disabling it keeps the timings collected so
+        far until resetNodeTimings() is called. While it's enabled, nodes are never rendered
+        in batches, so that each one can be timed on its own.
+
+        @see getNodeTimings
+    */
+    void setNodeProfilingEnabled (bool shouldBeEnabled);
+
+    /** Returns true if the nodes' processing is being timed.
+        @see setNodeProfilingEnabled
+    */
+    bool isNodeProfilingEnabled() const noexcept;
+
+    /** Returns the processing times of each node that has been timed.
+
+        The 99th percentile is an estimate, which may be up to an eighth longer than the
+        actual value. This can be called from any thread.
+
+        @see setNodeProfilingEnabled
+    */
+    std::vector<NodeTiming> getNodeTimings() const;
+
+    /** Discards the processing times that have been collected so far. */
+    void resetNodeTimings();
+
+    /** Writes the results of getNodeTimings() to a file as comma-separated values.
+        Returns false if the file couldn't be written.
+    */
+    bool exportNodeTimings (const File& file) const;
+
+    //==============================================================================
+    /** Lets nodes stop processing while they're only producing silence.
+
+        The graph always keeps track of which of its internal buffers are silent, so that it
+        can skip copying and mixing them. When sleeping is enabled, a node whose inputs have
+        all been silent for longer than its tail length plus its latency is put to sleep:
+        its processBlock() isn't called, and its outputs are treated as silent, until some
+        audio or MIDI arrives at its inputs again. Bypassed nodes, nodes that produce MIDI,
+        and nodes without any audio or MIDI inputs never go to sleep.
+
+        This is disabled by default, because many processors return 0 from
+        AudioProcessor::getTailLengthSeconds() even though they carry on producing sound
+        after their input stops. A processor that can make a sound from silent input should
+        return std::numeric_limits<double>::infinity() as its tail length to stay awake.
+
+        This can be called from any thread, and doesn't rebuild the graph.
+    */
+    void setNodeSleepingEnabled (bool shouldBeEnabled);
+
+    /** Returns true if nodes are allowed to go to sleep.
+        @see setNodeSleepingEnabled
+    */
+    bool isNodeSleepingEnabled() const noexcept;
+
+    //==============================================================================
+    /** The stages that a node goes through when it's prepared in the background.
+        @see setNumNodePreparationThreads, onNodePreparationStatusChanged
+    */
+    enum class NodePreparationStatus
+    {
+        queued,     /**< The node is waiting to be prepared, and the graph isn't rendering it yet. */
+        ready,      /**< The node has been prepared, and the graph has started rendering it. */
+        cancelled   /**< The node was removed from the graph before it was ready. */
+    };
+
+    /** Lets the nodes be prepared on background threads.
+
+        Normally, a node that's added to a prepared graph has its prepareToPlay() method
+        called on the message thread the next time the graph is rebuilt, which can block
+        the message thread for a long time if the processor loads samples or impulse
+        responses when it's prepared.
+
+        If numThreads is greater than zero, a pool of that many threads prepares the nodes
+        instead. Until a node is ready, the graph carries on rendering without it and without
+        its connections, and it's added to the rendering as soon as it has been prepared.
+        The graph's input and output nodes are always prepared straight away. A node that's
+        removed while it's being prepared isn't deleted until its prepareToPlay() returns,
+        and if the graph itself is prepared or released, it waits for the nodes that are
+        already being prepared to finish.
+
+        While a node is being prepared its processor is in use on another thread, so avoid
+        calling any of its methods that aren't thread-safe until it's ready. When rendering
+        offline, you may want to wait until getNumNodesBeingPrepared() returns 0.
+
+        The default is 0, which prepares the nodes on the message thread.
+
+        @see onNodePreparationStatusChanged, isNodeBeingPrepared
+    */
+    void setNumNodePreparationThreads (int numThreads);
+
+    /** Returns the number of threads that prepare the nodes in the background.
+        @see setNumNodePreparationThreads
+    */
+    int getNumNodePreparationThreads() const noexcept;
+
+    /** Returns true if a node is waiting to be prepared in the background, or is being
+        prepared. This must only be called from the message thread.
+
+        @see setNumNodePreparationThreads
+    */
+    bool isNodeBeingPrepared (NodeID) const;
+
+    /** Returns the number of nodes that are waiting to be prepared in the background, or are
+        being prepared. This must only be called from the message thread.
+
+        @see setNumNodePreparationThreads
+    */
+    int getNumNodesBeingPrepared() const;
+
+    /** Called on the message thread when a node that's prepared in the background is queued,
+        is ready, or is removed before it's ready. A node may be queued again if the graph is
+        prepared with different settings while it's waiting.
+
+        @see setNumNodePreparationThreads
+    */
+    std::function<void (NodeID, NodePreparationStatus)> onNodePreparationStatusChanged;
+
+    //==============================================================================
+    /** Lets the parts of the graph that don't depend on its live inputs be rendered ahead of time.
+
+        When this is enabled, the graph looks for nodes that aren't fed by its audio or MIDI input
+        nodes, directly or indirectly - a file player and the chain of effects after it, for
+        example. Those nodes are rendered on a background thread in blocks of blockSize samples,
+        up to numBlocksAhead blocks before they're needed, and the audio callback only has to
+        mix in their output. This lowers the load on the audio thread, and makes dropouts less
+        likely when the graph is busy. There's a single background thread, because each block
+        that's rendered ahead carries on from the state that the previous one left the nodes in.
+
+        A node stays live if it sends MIDI to a live node, or if its parameter event list has
+        storage allocated (see Node::getParameterEvents()), as those events are added on the
+        audio thread.
+
+        The nodes that are rendered ahead see a play head which predicts the host's position.
+        Whenever the host's position jumps, or playback starts or stops, the audio that has been
+        rendered ahead is thrown away, and those nodes are silent until the background thread
+        has caught up. Likewise, their output is silent whenever the background thread falls
+        behind, unless the graph is rendering in non-realtime mode, when the audio callback
+        waits for it instead. Changes to the nodes, such as parameter changes, are heard once the
+        audio that has already been rendered has been played, which may be up to
+        numBlocksAhead * blockSize samples later.
+
+        While this is enabled, all the nodes are prepared with a maximum block size of at least
+        blockSize, so changing it may prepare them again. The default is disabled.
+
+        @see isNodeRenderedAhead
+    */
+    void setAnticipativeRenderingEnabled (bool shouldBeEnabled, int blockSize = 4096, int numBlocksAhead = 4);
+
+    /** Returns true if anticipative rendering is enabled.
+        @see setAnticipativeRenderingEnabled
+    */
+    bool isAnticipativeRenderingEnabled() const noexcept;
+
+    /** Returns true if the node was rendered ahead of time when the graph was last rebuilt.
+        This must only be called from the message thread.
+
+        @see setAnticipativeRenderingEnabled
+    */
+    bool isNodeRenderedAhead (NodeID) const;
+
     //==============================================================================
     /** A special type of AudioProcessor that can live inside an AudioProcessorGraph
         in order to use the audio that comes into and out of the graph itself.
@@ -0,0 +1,244 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+void ParameterEventList::ensureStorageAllocated (int numEvents)
+{
+    events.reserve ((size_t) jmax (0, numEvents));
+}
+
+bool ParameterEventList::addEvent (const Event& newEvent) noexcept
+{
+    if (events.size() == events.capacity())
+        return false;
+
+    // Events usually arrive in order, so searching backwards finds the right place quickly
+    auto insertPos = events.end();
+
+    while (insertPos != events.begin() && std::prev (insertPos)->sampleOffset > newEvent.sampleOffset)
+        --insertPos;
+
+    events.insert (insertPos, newEvent);
+    return true;
+}
+
+void ParameterEventList::addEvents (const ParameterEventList& otherList,
+                                    int startSample,
+                                    int numSamples,
+                                    int sampleDeltaToAdd)
+{
+    const auto endSample = startSample + numSamples;
+
+    const auto findFirstAtOrAfter = [&] (int sample)
+    {
+        return std::find_if (otherList.begin(), otherList.end(), [sample] (const Event& e) { return e.sampleOffset >= sample; });
+    };
+
+    const auto firstInRange    = findFirstAtOrAfter (startSample);
+    const auto firstAfterRange = findFirstAtOrAfter (endSample);
+
+    const auto hasEventFor = [] (const Event* b, const Event* e, int index)
+    {
+        return std::any_of (b, e, [index] (const Event& ev) { return ev.parameterIndex == index; });
+    };
+
+    // Parameters that changed before the range need their value at the start of it
+    for (auto it = otherList.begin(); it != firstInRange; ++it)
+    {
+        const auto index = it->parameterIndex;
+
+        if (! hasEventFor (it + 1, firstInRange, index)
+            && ! std::any_of (firstInRange, firstAfterRange, [&] (const Event& e) { return e.parameterIndex == index
+                                                                                          && e.sampleOffset == startSample; }))
+        {
+            addEvent ({ index, startSample + sampleDeltaToAdd, otherList.getValueAt (index, startSample, it->value), Interpolation::step });
+        }
+    }
+
+    for (auto it = firstInRange; it != firstAfterRange; ++it)
+        addEvent ({ it->parameterIndex, it->sampleOffset + sampleDeltaToAdd, it->value, it->interpolation });
+
+    // Ramps that continue past the end of the range need to reach their value at the end of it
+    const auto lastSample = endSample - 1;
+
+    for (auto it = firstAfterRange; it != otherList.end(); ++it)
+    {
+        const auto index = it->parameterIndex;
+
+        if (it->interpolation == Interpolation::linear
+            && ! hasEventFor (firstAfterRange, it, index)
+            && hasEventFor (otherList.begin(), firstAfterRange, index)
+            && ! std::any_of (firstInRange, firstAfterRange, [&] (const Event& e) { return e.parameterIndex == index
+                                                                                          && e.sampleOffset == lastSample; }))
+        {
+            addEvent ({ index, lastSample + sampleDeltaToAdd, otherList.getValueAt (index, lastSample, it->value), Interpolation::linear });
+        }
+    }
+}
+
+int ParameterEventList::getNextEventTime (int sampleOffset) const noexcept
+{
+    const auto it = std::upper_bound (begin(), end(), sampleOffset,
+                                      [] (int offset, const Event& e) { return offset < e.sampleOffset; });
+
+    return it != end() ? it->sampleOffset : -1;
+}
+
+float ParameterEventList::getValueAt (int parameterIndex, int sampleOffset, float valueIfNoEvents) const noexcept
+{
+    const Event* previous = nullptr;
+
+    for (const auto& e : *this)
+    {
+        if (e.parameterIndex != parameterIndex)
+            continue;
+
+        if (e.sampleOffset <= sampleOffset)
+        {
+            previous = &e;
+            continue;
+        }
+
+        if (previous != nullptr && e.interpolation == Interpolation::linear)
+        {
+            const auto proportion = (float) (sampleOffset - previous->sampleOffset)
+                                  / (float) (e.sampleOffset - previous->sampleOffset);
+
+            return previous->value + proportion * (e.value - previous->value);
+        }
+
+        break;
+    }
+
+    return previous != nullptr ? previous->value : valueIfNoEvents;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ParameterEventListTests final : public UnitTest
+{
+public:
+    ParameterEventListTests()
+        : UnitTest ("ParameterEventList", UnitTestCategories::audioProcessorParameters)
+    {}
+
+    void runTest() override
+    {
+        using Interpolation = ParameterEventList::Interpolation;
+
+        beginTest ("Events are kept in order, and a full list doesn't grow");
+        {
+            ParameterEventList list;
+            list.ensureStorageAllocated (4);
+
+            expect (list.addEvent ({ 0, 10, 0.1f, Interpolation::step }));
+            expect (list.addEvent ({ 1, 0,  0.2f, Interpolation::step }));
+            expect (list.addEvent ({ 2, 10, 0.3f, Interpolation::step }));
+            expect (list.addEvent ({ 3, 5,  0.4f, Interpolation::step }));
+            expect (! list.addEvent ({ 4, 0, 0.5f, Interpolation::step }));
+
+            expectEquals (list.getNumEvents(), 4);
+            expectEquals (list.getCapacity(), 4);
+
+            const std::vector<int> expectedOrder { 1, 3, 0, 2 };
+            std::vector<int> order;
+
+            for (const auto& e : list)
+                order.push_back (e.parameterIndex);
+
+            expect (order == expectedOrder);
+
+            expectEquals (list.getNextEventTime (-1), 0);
+            expectEquals (list.getNextEventTime (0), 5);
+            expectEquals (list.getNextEventTime (5), 10);
+            expectEquals (list.getNextEventTime (10), -1);
+
+            list.clear();
+            expect (list.isEmpty());
+            expectEquals (list.getCapacity(), 4);
+        }
+
+        beginTest ("Values follow steps and ramps");
+        {
+            ParameterEventList list;
+            list.ensureStorageAllocated (8);
+
+            list.addEvent ({ 0, 0,   0.0f, Interpolation::step });
+            list.addEvent ({ 0, 100, 1.0f, Interpolation::linear });
+            list.addEvent ({ 0, 150, 0.5f, Interpolation::step });
+            list.addEvent ({ 1, 20,  0.7f, Interpolation::step });
+
+            expectWithinAbsoluteError (list.getValueAt (0, 0,   -1.0f), 0.0f,  1.0e-6f);
+            expectWithinAbsoluteError (list.getValueAt (0, 25,  -1.0f), 0.25f, 1.0e-6f);
+            expectWithinAbsoluteError (list.getValueAt (0, 100, -1.0f), 1.0f,  1.0e-6f);
+            expectWithinAbsoluteError (list.getValueAt (0, 149, -1.0f), 1.0f,  1.0e-6f);
+            expectWithinAbsoluteError (list.getValueAt (0, 200, -1.0f), 0.5f,  1.0e-6f);
+
+            expectEquals (list.getValueAt (1, 19, -1.0f), -1.0f);
+            expectEquals (list.getValueAt (1, 20, -1.0f), 0.7f);
+            expectEquals (list.getValueAt (2, 20, -1.0f), -1.0f);
+        }
+
+        beginTest ("Copying a range keeps the values at its edges");
+        {
+            ParameterEventList source;
+            source.ensureStorageAllocated (8);
+
+            source.addEvent ({ 0, 0,   0.0f, Interpolation::step });
+            source.addEvent ({ 0, 100, 1.0f, Interpolation::linear });
+            source.addEvent ({ 1, 60,  0.3f, Interpolation::step });
+            source.addEvent ({ 2, 10,  0.2f, Interpolation::step });
+            source.addEvent ({ 2, 80,  0.9f, Interpolation::step });
+
+            ParameterEventList chunk;
+            chunk.ensureStorageAllocated (8);
+            chunk.addEvents (source, 50, 50, -50);
+
+            expectEquals (chunk.getNumEvents(), 5);
+
+            // Parameter 0 ramps across the whole range
+            expectWithinAbsoluteError (chunk.getValueAt (0, 0,  -1.0f), 0.5f,  1.0e-6f);
+            expectWithinAbsoluteError (chunk.getValueAt (0, 25, -1.0f), 0.75f, 1.0e-6f);
+            expectWithinAbsoluteError (chunk.getValueAt (0, 49, -1.0f), 0.99f, 1.0e-6f);
+
+            // Parameter 1 has no earlier value, so nothing is added for it
+            expectEquals (chunk.getValueAt (1, 0,  -1.0f), -1.0f);
+            expectEquals (chunk.getValueAt (1, 10, -1.0f), 0.3f);
+
+            // Parameter 2 holds its earlier value until its next step
+            expectEquals (chunk.getValueAt (2, 0,  -1.0f), 0.2f);
+            expectEquals (chunk.getValueAt (2, 30, -1.0f), 0.9f);
+        }
+    }
+};
+
+static ParameterEventListTests parameterEventListTests;
+
+#endif
+
+} // namespace juce
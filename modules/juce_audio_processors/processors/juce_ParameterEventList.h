@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A list of timestamped parameter changes that happen during a single block of audio.
+
+    Hosts that can automate parameters more finely than once per block (e.g. VST3 hosts)
+    will fill one of these, and it can be retrieved with AudioProcessor::getParameterEvents()
+    during a call to processBlock(). A processor can use it to split its block at the
+    points where the parameters change, rather than smoothing every parameter on every
+    sample.
+
+    Events are kept in order of their sample offset, and events with the same offset
+    stay in the order in which they were added. The list never allocates once
+    ensureStorageAllocated() has been called, so it's safe to fill on the audio thread.
+
+    Where a list has been filled by JUCE, the first event for each parameter is one
+    that holds the parameter's value at the start of the block. By the time processBlock()
+    is called, the parameters themselves will already have been set to the values that
+    they have at the end of the block.
+
+    @see AudioProcessor::getParameterEvents
+
+    @tags{Audio}
+*/
+class JUCE_API  ParameterEventList
+{
+public:
+    //==============================================================================
+    /** Describes how a parameter gets from its previous value to the value of an event. */
+    enum class Interpolation
+    {
+        step,       /**< The parameter jumps to the new value at the event's sample offset. */
+        linear      /**< The parameter ramps linearly from the value of the previous event for
+                         the same parameter, and arrives at the new value at the event's offset. */
+    };
+
+    /** A single parameter change. */
+    struct Event
+    {
+        /** The index of the parameter in the processor's AudioProcessor::getParameters() array. */
+        int parameterIndex = 0;
+
+        /** The position of the change, relative to the start of the block. */
+        int sampleOffset = 0;
+
+        /** The normalised (0 to 1) value of the parameter at this position. */
+        float value = 0.0f;
+
+        /** How the parameter gets to this value from the previous event. */
+        Interpolation interpolation = Interpolation::step;
+    };
+
+    //==============================================================================
+    /** Creates an empty list. */
+    ParameterEventList() = default;
+
+    /** Makes sure that the list can hold at least this many events without allocating.
+        Call this before the list is used on the audio thread.
+    */
+    void ensureStorageAllocated (int numEvents);
+
+    /** Returns the number of events that the list can hold without allocating. */
+    int getCapacity() const noexcept                    { return (int) events.capacity(); }
+
+    /** Removes all the events. This doesn't release the list's storage. */
+    void clear() noexcept                               { events.clear(); }
+
+    /** Returns true if the list contains no events. */
+    bool isEmpty() const noexcept                       { return events.empty(); }
+
+    /** Returns the number of events in the list. */
+    int getNumEvents() const noexcept                   { return (int) events.size(); }
+
+    //==============================================================================
+    /** Adds an event, keeping the list in order of sample offset.
+
+        If the list is already full, the event is discarded and this returns false,
+        as the list will never allocate to make room for it.
+    */
+    bool addEvent (const Event& newEvent) noexcept;
+
+    /** Copies the events from a range of samples in another list.
+
+        The events that lie between startSample and (startSample + numSamples) are added
+        to this list, with sampleDeltaToAdd added to their offsets. Extra events are added
+        to hold the values of any parameters that changed before the start of the range,
+        and to finish any ramps that carry on past its end, so that the copied events can
+        be interpreted on their own.
+    */
+    void addEvents (const ParameterEventList& otherList,
+                    int startSample,
+                    int numSamples,
+                    int sampleDeltaToAdd);
+
+    //==============================================================================
+    /** Returns the sample offset of the first event that lies after the given sample,
+        or -1 if there isn't one.
+
+        This can be used to split a block into the sections between parameter changes.
+    */
+    int getNextEventTime (int sampleOffset) const noexcept;
+
+    /** Returns the normalised value that a parameter has at a sample offset, following
+        any ramps between events.
+
+        If there are no events for the parameter at or before the offset, this returns
+        valueIfNoEvents.
+    */
+    float getValueAt (int parameterIndex, int sampleOffset, float valueIfNoEvents) const noexcept;
+
+    //==============================================================================
+    /** Returns a pointer to the first event in the list. */
+    const Event* begin() const noexcept                 { return events.data(); }
+
+    /** Returns a pointer to the position after the last event in the list. */
+    const Event* end() const noexcept                   { return events.data() + events.size(); }
+
+private:
+    //==============================================================================
+    std::vector<Event> events;
+
+    JUCE_LEAK_DETECTOR (ParameterEventList)
+};
+
+} // namespace juce
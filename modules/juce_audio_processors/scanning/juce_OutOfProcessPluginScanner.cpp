@@ -0,0 +1,886 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+// The coordinator's end of the connection to one worker process. A request is the
+// format name, the plugin's identifier and the timeout, and the worker replies with
+// an XML list of the descriptions that it found.
+class OutOfProcessPluginScanner::WorkerProcess final : private ChildProcessCoordinator
+{
+public:
+    WorkerProcess() = default;
+
+    ~WorkerProcess() override
+    {
+        killWorkerProcess();
+    }
+
+    bool launch (const File& executable, const String& commandLineUID)
+    {
+        launched = launchWorkerProcess (executable, commandLineUID, 0, 0);
+        return launched;
+    }
+
+    bool isLaunched() const noexcept    { return launched; }
+
+    bool isConnected() const
+    {
+        const std::lock_guard<std::mutex> lock { mutex };
+        return ! connectionLost;
+    }
+
+    enum class Outcome
+    {
+        finished,
+        crashed,
+        workerFailed,   // the worker died before it was given the plugin, so the plugin isn't to blame
+        abandoned
+    };
+
+    template <typename ShouldExitFn>
+    Outcome scan (const String& formatName,
+                  const String& fileOrIdentifier,
+                  int timeoutMs,
+                  ShouldExitFn&& shouldExit,
+                  OwnedArray<PluginDescription>& results)
+    {
+        MemoryBlock block;
+
+        {
+            MemoryOutputStream stream { block, false };
+            stream.writeString (formatName);
+            stream.writeString (fileOrIdentifier);
+            stream.writeInt (timeoutMs);
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock { mutex };
+
+            // The worker may have died after its last scan, e.g. while unloading that plugin
+            if (connectionLost)
+                return Outcome::workerFailed;
+
+            response.reset();
+            gotResponse = false;
+        }
+
+        if (! sendMessageToWorker (block))
+            return Outcome::workerFailed;
+
+        const auto startTime = Time::getMillisecondCounter();
+
+        std::unique_lock<std::mutex> lock { mutex };
+
+        while (! (gotResponse || connectionLost))
+        {
+            if (shouldExit())
+                return Outcome::abandoned;
+
+            if ((int) (Time::getMillisecondCounter() - startTime) > timeoutMs)
+                return Outcome::crashed;
+
+            condvar.wait_for (lock, std::chrono::milliseconds { 50 });
+        }
+
+        if (! gotResponse)
+            return Outcome::crashed;
+
+        if (response != nullptr)
+        {
+            for (const auto* item : response->getChildIterator())
+            {
+                auto desc = std::make_unique<PluginDescription>();
+
+                if (desc->loadFromXml (*item))
+                    results.add (std::move (desc));
+            }
+        }
+
+        return Outcome::finished;
+    }
+
+private:
+    friend class OutOfProcessPluginScannerTests;
+
+    void handleMessageFromWorker (const MemoryBlock& mb) override
+    {
+        const std::lock_guard<std::mutex> lock { mutex };
+        response = parseXML (mb.toString());
+        gotResponse = true;
+        condvar.notify_one();
+    }
+
+    void handleConnectionLost() override
+    {
+        const std::lock_guard<std::mutex> lock { mutex };
+        connectionLost = true;
+        condvar.notify_one();
+    }
+
+    mutable std::mutex mutex;
+    std::condition_variable condvar;
+    std::unique_ptr<XmlElement> response;
+    bool gotResponse = false, connectionLost = false, launched = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkerProcess)
+};
+
+//==============================================================================
+OutOfProcessPluginScanner::OutOfProcessPluginScanner (const File& workerExecutable,
+                                                      const String& commandLineUniqueID,
+                                                      int maxWorkers)
+    : executable (workerExecutable),
+      commandLineUID (commandLineUniqueID),
+      maxNumWorkers (jmax (1, maxWorkers))
+{
+}
+
+OutOfProcessPluginScanner::~OutOfProcessPluginScanner()
+{
+    // All the scans should have finished before the scanner is deleted
+    jassert (numWorkersRunning == (int) idleWorkers.size());
+
+    saveCache();
+}
+
+void OutOfProcessPluginScanner::setTimeoutForEachPlugin (int newTimeoutMs)
+{
+    timeoutMs = jmax (1, newTimeoutMs);
+}
+
+//==============================================================================
+bool OutOfProcessPluginScanner::findPluginTypesFor (AudioPluginFormat& format,
+                                                    OwnedArray<PluginDescription>& result,
+                                                    const String& fileOrIdentifier)
+{
+    const auto cacheKey = format.getName() + ":" + fileOrIdentifier;
+    bool loadedOk = true;
+
+    if (findCachedTypes (cacheKey, fileOrIdentifier, result, loadedOk))
+        return loadedOk;
+
+    OwnedArray<PluginDescription> found;
+    auto outcome = WorkerProcess::Outcome::workerFailed;
+
+    // A worker that fails before it has been given the plugin is replaced by a new one
+    constexpr auto maxNumAttempts = 3;
+
+    for (auto attempt = 0; attempt < maxNumAttempts && outcome == WorkerProcess::Outcome::workerFailed; ++attempt)
+    {
+        auto worker = acquireWorker();
+
+        if (worker == nullptr)
+            return true;
+
+        if (! worker->isLaunched() && ! worker->launch (executable, commandLineUID))
+        {
+            // The worker process couldn't be started, so the plugin has to be scanned in this
+            // process instead. Check that the executable creates an OutOfProcessPluginScanner::Worker
+            // when it's launched with the right command line!
+            jassertfalse;
+
+            releaseWorker (std::move (worker), false);
+            format.findAllTypesForFile (result, fileOrIdentifier);
+            return true;
+        }
+
+        outcome = worker->scan (format.getName(), fileOrIdentifier, timeoutMs,
+                                [this] { return shouldExit(); }, found);
+
+        releaseWorker (std::move (worker), outcome == WorkerProcess::Outcome::finished);
+    }
+
+    // The plugin is only blamed, and cached, if a worker was given it
+    if (outcome == WorkerProcess::Outcome::abandoned || outcome == WorkerProcess::Outcome::workerFailed)
+        return true;
+
+    loadedOk = (outcome == WorkerProcess::Outcome::finished);
+    addToCache (cacheKey, fileOrIdentifier, found, loadedOk);
+
+    result.addCopiesOf (found);
+    return loadedOk;
+}
+
+void OutOfProcessPluginScanner::scanFinished()
+{
+    std::vector<std::unique_ptr<WorkerProcess>> workersToStop;
+
+    {
+        const std::lock_guard<std::mutex> lock { workersMutex };
+        numWorkersRunning -= (int) idleWorkers.size();
+        workersToStop = std::move (idleWorkers);
+        idleWorkers.clear();
+    }
+
+    workersToStop.clear();
+    saveCache();
+}
+
+std::unique_ptr<OutOfProcessPluginScanner::WorkerProcess> OutOfProcessPluginScanner::acquireWorker()
+{
+    // These get killed after the lock has been released
+    std::vector<std::unique_ptr<WorkerProcess>> deadWorkers;
+
+    std::unique_lock<std::mutex> lock { workersMutex };
+
+    for (;;)
+    {
+        // A worker may have died while it was idle
+        while (! idleWorkers.empty() && ! idleWorkers.back()->isConnected())
+        {
+            deadWorkers.push_back (std::move (idleWorkers.back()));
+            idleWorkers.pop_back();
+            --numWorkersRunning;
+        }
+
+        if (! idleWorkers.empty())
+        {
+            auto worker = std::move (idleWorkers.back());
+            idleWorkers.pop_back();
+            return worker;
+        }
+
+        if (numWorkersRunning < maxNumWorkers)
+        {
+            ++numWorkersRunning;
+            return std::make_unique<WorkerProcess>();
+        }
+
+        if (shouldExit())
+            return nullptr;
+
+        workerReleased.wait_for (lock, std::chrono::milliseconds { 50 });
+    }
+}
+
+void OutOfProcessPluginScanner::releaseWorker (std::unique_ptr<WorkerProcess> worker, bool isStillUsable)
+{
+    {
+        const std::lock_guard<std::mutex> lock { workersMutex };
+
+        if (isStillUsable && worker->isConnected())
+            idleWorkers.push_back (std::move (worker));
+        else
+            --numWorkersRunning;
+    }
+
+    workerReleased.notify_one();
+
+    // A worker that's no longer usable gets killed here, outside the lock
+    worker.reset();
+}
+
+//==============================================================================
+static bool getPluginFileFingerprint (const String& fileOrIdentifier, Time& modificationTime, int64& size)
+{
+    if (! File::isAbsolutePath (fileOrIdentifier))
+        return false;
+
+    const File file (fileOrIdentifier);
+
+    if (! file.exists())
+        return false;
+
+    modificationTime = file.getLastModificationTime();
+    size = 0;
+
+    if (! file.isDirectory())
+    {
+        size = file.getSize();
+        return true;
+    }
+
+    // A bundle's own modification time doesn't necessarily change when the files inside it do
+    for (const auto& entry : RangedDirectoryIterator (file, true, "*", File::findFiles))
+    {
+        modificationTime = jmax (modificationTime, entry.getModificationTime());
+        size += entry.getFileSize();
+    }
+
+    return true;
+}
+
+bool OutOfProcessPluginScanner::findCachedTypes (const String& key,
+                                                 const String& fileOrIdentifier,
+                                                 OwnedArray<PluginDescription>& result,
+                                                 bool& loadedOk)
+{
+    {
+        const ScopedLock sl (cacheLock);
+
+        if (cacheFile == File() || cache.find (key) == cache.end())
+            return false;
+    }
+
+    Time modificationTime;
+    int64 size = 0;
+
+    if (! getPluginFileFingerprint (fileOrIdentifier, modificationTime, size))
+        return false;
+
+    const ScopedLock sl (cacheLock);
+    const auto it = cache.find (key);
+
+    if (it == cache.end()
+         || it->second.modificationTime != modificationTime
+         || it->second.size != size)
+        return false;
+
+    for (const auto& desc : it->second.types)
+        result.add (new PluginDescription (desc));
+
+    loadedOk = it->second.loadedOk;
+    return true;
+}
+
+void OutOfProcessPluginScanner::addToCache (const String& key,
+                                            const String& fileOrIdentifier,
+                                            const OwnedArray<PluginDescription>& types,
+                                            bool loadedOk)
+{
+    CacheEntry entry;
+
+    {
+        const ScopedLock sl (cacheLock);
+
+        if (cacheFile == File())
+            return;
+    }
+
+    if (! getPluginFileFingerprint (fileOrIdentifier, entry.modificationTime, entry.size))
+        return;
+
+    entry.loadedOk = loadedOk;
+
+    for (const auto* desc : types)
+        entry.types.add (*desc);
+
+    const ScopedLock sl (cacheLock);
+    cache[key] = std::move (entry);
+    cacheNeedsSaving = true;
+}
+
+void OutOfProcessPluginScanner::setCacheFile (const File& newCacheFile)
+{
+    const ScopedLock sl (cacheLock);
+
+    cacheFile = newCacheFile;
+    cache.clear();
+    cacheNeedsSaving = false;
+
+    if (auto xml = (cacheFile.existsAsFile() ? parseXML (cacheFile) : nullptr))
+    {
+        for (const auto* fileXml : xml->getChildWithTagNameIterator ("FILE"))
+        {
+            CacheEntry entry;
+            entry.modificationTime = Time (fileXml->getStringAttribute ("fileTime").getHexValue64());
+            entry.size = fileXml->getStringAttribute ("size").getHexValue64();
+            entry.loadedOk = fileXml->getBoolAttribute ("loaded", true);
+
+            for (const auto* descXml : fileXml->getChildIterator())
+            {
+                PluginDescription desc;
+
+                if (desc.loadFromXml (*descXml))
+                    entry.types.add (desc);
+            }
+
+            cache[fileXml->getStringAttribute ("key")] = std::move (entry);
+        }
+    }
+}
+
+void OutOfProcessPluginScanner::clearCache()
+{
+    const ScopedLock sl (cacheLock);
+
+    cache.clear();
+    cacheNeedsSaving = true;
+}
+
+void OutOfProcessPluginScanner::saveCache()
+{
+    const ScopedLock sl (cacheLock);
+
+    if (! cacheNeedsSaving || cacheFile == File())
+        return;
+
+    XmlElement xml ("PLUGINSCANCACHE");
+
+    for (const auto& [key, entry] : cache)
+    {
+        auto* fileXml = xml.createNewChildElement ("FILE");
+        fileXml->setAttribute ("key", key);
+        fileXml->setAttribute ("fileTime", String::toHexString (entry.modificationTime.toMilliseconds()));
+        fileXml->setAttribute ("size", String::toHexString (entry.size));
+        fileXml->setAttribute ("loaded", entry.loadedOk);
+
+        for (const auto& desc : entry.types)
+            fileXml->addChildElement (desc.createXml().release());
+    }
+
+    if (xml.writeTo (cacheFile))
+        cacheNeedsSaving = false;
+}
+
+//==============================================================================
+// Killing the worker from the coordinator only asks it to quit, which it can't do while a
+// plugin is hanging on its message thread, so the worker has to keep an eye on itself
+class OutOfProcessPluginScanner::Worker::Watchdog final : private Thread
+{
+public:
+    Watchdog()  : Thread ("Plugin scan watchdog")
+    {
+        startThread (Priority::low);
+    }
+
+    ~Watchdog() override
+    {
+        stopThread (2000);
+    }
+
+    void scanStarted (int timeoutMs) noexcept
+    {
+        // Give the coordinator a moment to notice the timeout first
+        deadline = Time::getMillisecondCounter() + (uint32) timeoutMs + 1000;
+        isScanning = true;
+    }
+
+    void scanFinished() noexcept
+    {
+        isScanning = false;
+    }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (isScanning && (int) (Time::getMillisecondCounter() - deadline.load()) > 0)
+                Process::terminate();
+
+            wait (100);
+        }
+    }
+
+    std::atomic<uint32> deadline { 0 };
+    std::atomic<bool> isScanning { false };
+};
+
+//==============================================================================
+OutOfProcessPluginScanner::Worker::Worker()
+    : watchdog (std::make_unique<Watchdog>())
+{
+    formatManager.addDefaultFormats();
+}
+
+OutOfProcessPluginScanner::Worker::~Worker()
+{
+    cancelPendingUpdate();
+}
+
+void OutOfProcessPluginScanner::Worker::handleMessageFromCoordinator (const MemoryBlock& mb)
+{
+    if (mb.isEmpty())
+        return;
+
+    // Plugins are loaded on the message thread, unless their format needs the message
+    // thread to be free while they're created, in which case they're loaded here
+    MemoryInputStream stream { mb, false };
+    const auto formatName = stream.readString();
+
+    PluginDescription pd;
+    pd.fileOrIdentifier = stream.readString();
+
+    for (auto* format : formatManager.getFormats())
+    {
+        if (format->getName() == formatName && format->requiresUnblockedMessageThreadDuringCreation (pd))
+        {
+            sendResults (scan (mb));
+            return;
+        }
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock { mutex };
+        pendingRequests.push (mb);
+    }
+
+    triggerAsyncUpdate();
+}
+
+void OutOfProcessPluginScanner::Worker::handleConnectionLost()
+{
+    JUCEApplicationBase::quit();
+}
+
+void OutOfProcessPluginScanner::Worker::handleAsyncUpdate()
+{
+    for (;;)
+    {
+        MemoryBlock request;
+
+        {
+            const std::lock_guard<std::mutex> lock { mutex };
+
+            if (pendingRequests.empty())
+                return;
+
+            request = std::move (pendingRequests.front());
+            pendingRequests.pop();
+        }
+
+        sendResults (scan (request));
+    }
+}
+
+OwnedArray<PluginDescription> OutOfProcessPluginScanner::Worker::scan (const MemoryBlock& request)
+{
+    MemoryInputStream stream { request, false };
+    const auto formatName = stream.readString();
+    const auto fileOrIdentifier = stream.readString();
+    const auto timeoutMs = stream.readInt();
+
+    OwnedArray<PluginDescription> results;
+    watchdog->scanStarted (timeoutMs);
+
+    for (auto* format : formatManager.getFormats())
+    {
+        if (format->getName() == formatName)
+        {
+            format->findAllTypesForFile (results, fileOrIdentifier);
+            break;
+        }
+    }
+
+    watchdog->scanFinished();
+    return results;
+}
+
+void OutOfProcessPluginScanner::Worker::sendResults (const OwnedArray<PluginDescription>& results)
+{
+    XmlElement xml ("LIST");
+
+    for (const auto* desc : results)
+        xml.addChildElement (desc->createXml().release());
+
+    const auto str = xml.toString();
+    sendMessageToCoordinator ({ str.toRawUTF8(), str.getNumBytesAsUTF8() });
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+// These tests only use results that are already in the cache, and workers that have
+// never been launched, so that no worker processes are needed
+class OutOfProcessPluginScannerTests final : public UnitTest
+{
+public:
+    OutOfProcessPluginScannerTests()
+        : UnitTest ("OutOfProcessPluginScanner", UnitTestCategories::audioProcessors)
+    {}
+
+    void runTest() override
+    {
+        const auto directory = File::getSpecialLocation (File::tempDirectory).getNonexistentChildFile ("OutOfProcessPluginScannerTests", {});
+        directory.createDirectory();
+
+        const auto cacheFile = directory.getChildFile ("cache.xml");
+        const auto makePlugin = [&] (const String& fileName)
+        {
+            const auto file = directory.getChildFile (fileName);
+            file.replaceWithText ("plugin");
+            return file.getFullPathName();
+        };
+
+        beginTest ("Cached results depend on the format, and on the size and modification time of the file");
+        {
+            OutOfProcessPluginScanner scanner ({}, "test");
+            scanner.setCacheFile (cacheFile);
+
+            FakeFormat format ("Fake"), otherFormat ("Other");
+            const auto plugin = makePlugin ("a.fake");
+
+            addToCache (scanner, format, plugin, 2, true);
+
+            OwnedArray<PluginDescription> found;
+            expect (scanner.findPluginTypesFor (format, found, plugin));
+            expectEquals (found.size(), 2);
+            expectEquals (found[1]->name, String ("a 1"));
+            expectEquals (format.numScans.load(), 0);
+
+            expect (! isCached (scanner, otherFormat, plugin));
+
+            File (plugin).appendText ("changed");
+            expect (! isCached (scanner, format, plugin));
+
+            addToCache (scanner, format, plugin, 2, true);
+            expect (isCached (scanner, format, plugin));
+
+            File (plugin).setLastModificationTime (File (plugin).getLastModificationTime() + RelativeTime::seconds (10.0));
+            expect (! isCached (scanner, format, plugin));
+
+            // For a bundle, the files inside count
+            const auto bundle = directory.getChildFile ("b.bundle");
+            bundle.getChildFile ("Contents").createDirectory();
+            bundle.getChildFile ("Contents").getChildFile ("binary").replaceWithText ("binary");
+
+            addToCache (scanner, format, bundle.getFullPathName(), 1, true);
+            expect (isCached (scanner, format, bundle.getFullPathName()));
+
+            bundle.getChildFile ("Contents").getChildFile ("binary").appendText ("changed");
+            expect (! isCached (scanner, format, bundle.getFullPathName()));
+
+            // Identifiers that aren't files can't be checked, so they aren't cached
+            addToCache (scanner, format, "urn:fake:plugin", 1, true);
+            expect (! isCached (scanner, format, "urn:fake:plugin"));
+        }
+
+        beginTest ("The cache is saved and reloaded, including plugins that failed to load");
+        {
+            cacheFile.deleteFile();
+
+            FakeFormat format ("Fake");
+            const auto good = makePlugin ("good.fake");
+            const auto bad  = makePlugin ("bad.fake");
+
+            {
+                OutOfProcessPluginScanner scanner ({}, "test");
+                scanner.setCacheFile (cacheFile);
+                addToCache (scanner, format, good, 3, true);
+                addToCache (scanner, format, bad, 0, false);
+                scanner.scanFinished();
+            }
+
+            expect (cacheFile.existsAsFile());
+
+            {
+                OutOfProcessPluginScanner scanner ({}, "test");
+                scanner.setCacheFile (cacheFile);
+
+                OwnedArray<PluginDescription> found;
+                expect (scanner.findPluginTypesFor (format, found, good));
+                expectEquals (found.size(), 3);
+                expectEquals (found[2]->name, String ("good 2"));
+
+                found.clear();
+                expect (! scanner.findPluginTypesFor (format, found, bad));
+                expectEquals (found.size(), 0);
+                expectEquals (format.numScans.load(), 0);
+
+                scanner.clearCache();
+            }
+
+            OutOfProcessPluginScanner scanner ({}, "test");
+            scanner.setCacheFile (cacheFile);
+            expect (! isCached (scanner, format, good));
+        }
+
+        beginTest ("The dead-man's pedal is kept up to date while several threads are scanning");
+        {
+            cacheFile.deleteFile();
+
+            const auto pluginDirectory = directory.getChildFile ("plugins");
+            pluginDirectory.createDirectory();
+
+            FakeFormat format ("Fake");
+            KnownPluginList list;
+            auto& scanner = *new OutOfProcessPluginScanner ({}, "test");
+            list.setCustomScanner (std::unique_ptr<KnownPluginList::CustomScanner> (&scanner));
+            scanner.setCacheFile (cacheFile);
+
+            constexpr auto numPlugins = 16;
+
+            for (auto i = 0; i < numPlugins; ++i)
+            {
+                const auto file = pluginDirectory.getChildFile ("plugin" + String (i) + ".fake");
+                file.replaceWithText ("plugin");
+
+                // The last one crashed the last time it was scanned
+                const auto crashedLastTime = i == numPlugins - 1;
+                addToCache (scanner, format, file.getFullPathName(), crashedLastTime ? 0 : 1, ! crashedLastTime);
+            }
+
+            // This one crashed the whole host last time, so it's still on the pedal
+            const auto crashed = pluginDirectory.getChildFile ("crashed.fake");
+            crashed.replaceWithText ("plugin");
+
+            const auto pedal = directory.getChildFile ("pedal.txt");
+            pedal.replaceWithText (crashed.getFullPathName());
+
+            {
+                PluginDirectoryScanner directoryScanner (list, format, FileSearchPath (pluginDirectory.getFullPathName()), false, pedal);
+                expect (list.getBlacklistedFiles().contains (crashed.getFullPathName()));
+
+                std::vector<std::thread> threads;
+
+                for (auto i = 0; i < 4; ++i)
+                {
+                    threads.emplace_back ([&directoryScanner]
+                    {
+                        String nameOfPluginBeingScanned;
+
+                        while (directoryScanner.scanNextFile (true, nameOfPluginBeingScanned))
+                        {}
+                    });
+                }
+
+                for (auto& thread : threads)
+                    thread.join();
+
+                expect (directoryScanner.getFailedFiles().isEmpty());
+            }
+
+            StringArray pedalContents;
+            pedal.readLines (pedalContents);
+            pedalContents.removeEmptyStrings();
+            expect (pedalContents.isEmpty());
+
+            expectEquals (list.getNumTypes(), numPlugins - 1);
+            expectEquals (list.getBlacklistedFiles().size(), 2);
+            expect (list.getBlacklistedFiles().contains (pluginDirectory.getChildFile ("plugin" + String (numPlugins - 1) + ".fake").getFullPathName()));
+            expectEquals (format.numScans.load(), 0);
+        }
+
+        beginTest ("Workers that die between scans are replaced, and the next plugin isn't blamed");
+        {
+            using Outcome = OutOfProcessPluginScanner::WorkerProcess::Outcome;
+
+            OutOfProcessPluginScanner scanner ({}, "test", 2);
+
+            // A worker that dies after it has finished a scan, e.g. while unloading the plugin
+            auto worker = scanner.acquireWorker();
+            worker->handleConnectionLost();
+            scanner.releaseWorker (std::move (worker), true);
+
+            expect (scanner.idleWorkers.empty());
+            expectEquals (scanner.numWorkersRunning, 0);
+
+            // A worker that dies while it's idle
+            scanner.releaseWorker (scanner.acquireWorker(), true);
+            expectEquals ((int) scanner.idleWorkers.size(), 1);
+
+            const auto* idleWorker = scanner.idleWorkers.back().get();
+            scanner.idleWorkers.back()->handleConnectionLost();
+
+            worker = scanner.acquireWorker();
+            expect (worker.get() != idleWorker);
+            expect (worker->isConnected());
+            expect (scanner.idleWorkers.empty());
+            expectEquals (scanner.numWorkersRunning, 1);
+
+            // A worker that has died isn't sent the plugin
+            worker->handleConnectionLost();
+
+            OwnedArray<PluginDescription> found;
+            expect (worker->scan ("Fake", makePlugin ("c.fake"), 1000, [] { return false; }, found) == Outcome::workerFailed);
+            expect (found.isEmpty());
+
+            scanner.releaseWorker (std::move (worker), false);
+            expectEquals (scanner.numWorkersRunning, 0);
+        }
+
+        directory.deleteRecursively();
+    }
+
+private:
+    // A format whose plugins are files with a .fake extension. It should never be asked
+    // to scan them, as they're all in the cache.
+    class FakeFormat final : public AudioPluginFormat
+    {
+    public:
+        explicit FakeFormat (String nameIn) : formatName (std::move (nameIn)) {}
+
+        String getName() const override                                             { return formatName; }
+        bool fileMightContainThisPluginType (const String& f) override              { return f.endsWith (".fake"); }
+        String getNameOfPluginFromIdentifier (const String& f) override             { return f.fromLastOccurrenceOf ("/", false, false).upToLastOccurrenceOf (".", false, false); }
+        bool pluginNeedsRescanning (const PluginDescription&) override              { return false; }
+        bool doesPluginStillExist (const PluginDescription& d) override             { return File (d.fileOrIdentifier).exists(); }
+        bool canScanForPlugins() const override                                     { return true; }
+        bool isTrivialToScan() const override                                       { return false; }
+        FileSearchPath getDefaultLocationsToSearch() override                       { return {}; }
+        bool requiresUnblockedMessageThreadDuringCreation (const PluginDescription&) const override { return false; }
+
+        void findAllTypesForFile (OwnedArray<PluginDescription>&, const String&) override
+        {
+            ++numScans;
+        }
+
+        StringArray searchPathsForPlugins (const FileSearchPath& path, bool, bool) override
+        {
+            StringArray result;
+
+            for (auto i = 0; i < path.getNumPaths(); ++i)
+                for (const auto& entry : RangedDirectoryIterator (path[i], false, "*.fake"))
+                    result.add (entry.getFile().getFullPathName());
+
+            return result;
+        }
+
+        std::atomic<int> numScans { 0 };
+
+    private:
+        void createPluginInstance (const PluginDescription&, double, int, PluginCreationCallback callback) override
+        {
+            callback (nullptr, "Fake plugins can't be created");
+        }
+
+        const String formatName;
+    };
+
+    static void addToCache (OutOfProcessPluginScanner& scanner, AudioPluginFormat& format,
+                            const String& fileOrIdentifier, int numTypes, bool loadedOk)
+    {
+        OwnedArray<PluginDescription> types;
+
+        for (auto i = 0; i < numTypes; ++i)
+        {
+            auto* desc = types.add (new PluginDescription());
+            desc->name = format.getNameOfPluginFromIdentifier (fileOrIdentifier) + " " + String (i);
+            desc->pluginFormatName = format.getName();
+            desc->fileOrIdentifier = fileOrIdentifier;
+            desc->uniqueId = desc->deprecatedUid = i + 1;
+        }
+
+        scanner.addToCache (format.getName() + ":" + fileOrIdentifier, fileOrIdentifier, types, loadedOk);
+    }
+
+    static bool isCached (OutOfProcessPluginScanner& scanner, AudioPluginFormat& format, const String& fileOrIdentifier)
+    {
+        OwnedArray<PluginDescription> found;
+        auto loadedOk = true;
+        return scanner.findCachedTypes (format.getName() + ":" + fileOrIdentifier, fileOrIdentifier, found, loadedOk);
+    }
+};
+
+static OutOfProcessPluginScannerTests outOfProcessPluginScannerTests;
+
+#endif
+
+} // namespace juce
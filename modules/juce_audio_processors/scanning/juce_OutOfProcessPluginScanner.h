@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A KnownPluginList::CustomScanner that loads each plugin in a separate worker
+    process, so that a plugin which crashes or hangs can't take the host down with it.
+
+    The scanner launches up to a given number of worker processes, and each call to
+    findPluginTypesFor() borrows one of them for the duration of the scan. If several
+    threads are scanning at once (e.g. a PluginListComponent that has been given some
+    threads with PluginListComponent::setNumberOfThreadsForScanning()), then that
+    many plugins will be scanned in parallel.
+
+    The worker processes are launched from an executable that must create a
+    OutOfProcessPluginScanner::Worker when it sees the matching command line - this is
+    usually the host's own executable, e.g.
+
+    @code
+    void initialise (const String& commandLine) override
+    {
+        auto worker = std::make_unique<OutOfProcessPluginScanner::Worker>();
+
+        if (worker->initialiseFromCommandLine (commandLine, "myhostscanner"))
+        {
+            scannerWorker = std::move (worker);
+            return;
+        }
+
+        ...
+        knownPluginList.setCustomScanner (std::make_unique<OutOfProcessPluginScanner> (File::getSpecialLocation (File::currentExecutableFile),
+                                                                                         "myhostscanner",
+                                                                                         SystemStats::getNumCpus()));
+    }
+    @endcode
+
+    Optionally, the scanner can keep a cache file which records what was found in
+    each plugin file, along with the file's size and modification time. A file that
+    hasn't changed since it was cached won't be loaded again, even if it's not in the
+    KnownPluginList or if it previously failed to load.
+
+    @see KnownPluginList::setCustomScanner, PluginDirectoryScanner
+
+    @tags{Audio}
+*/
+class JUCE_API  OutOfProcessPluginScanner  : public KnownPluginList::CustomScanner
+{
+public:
+    //==============================================================================
+    /** Creates a scanner.
+
+        @param workerExecutable         the executable to launch for each worker process
+        @param commandLineUniqueID      a short alphanumeric identifier (no spaces!) that the
+                                        worker process passes to Worker::initialiseFromCommandLine()
+        @param maxNumWorkers            the maximum number of worker processes that may be
+                                        running at the same time
+    */
+    OutOfProcessPluginScanner (const File& workerExecutable,
+                               const String& commandLineUniqueID,
+                               int maxNumWorkers = 1);
+
+    /** Destructor. */
+    ~OutOfProcessPluginScanner() override;
+
+    //==============================================================================
+    /** Sets the time that a worker process is given to scan a single plugin file.
+        If it takes longer than this, the worker is killed and the plugin is treated
+        as though it had crashed. The default is 60 seconds.
+    */
+    void setTimeoutForEachPlugin (int newTimeoutMs);
+
+    /** Sets a file in which to cache the results of each scan.
+
+        The cache is read when this is called, and written when a scan finishes. Pass
+        File() to stop using a cache.
+
+        Plugins are only cached if their identifier is a file or a bundle directory, and
+        an entry is used only as long as the size and modification time of the file (or
+        of the files inside the bundle) haven't changed.
+    */
+    void setCacheFile (const File& newCacheFile);
+
+    /** Removes all the entries from the cache. */
+    void clearCache();
+
+    //==============================================================================
+    /** @internal */
+    bool findPluginTypesFor (AudioPluginFormat&, OwnedArray<PluginDescription>&, const String&) override;
+    /** @internal */
+    void scanFinished() override;
+
+    //==============================================================================
+    /**
+        The object that does the scanning inside a worker process.
+
+        Create one of these in the worker executable, and call initialiseFromCommandLine()
+        with the same ID that was passed to the OutOfProcessPluginScanner. When the
+        coordinator process disconnects, the worker calls JUCEApplicationBase::quit().
+        If a plugin takes longer to scan than the coordinator's timeout, the worker
+        process terminates itself, as the plugin may be stuck on the message thread.
+
+        @tags{Audio}
+    */
+    class JUCE_API  Worker  : private ChildProcessWorker,
+                              private AsyncUpdater
+    {
+    public:
+        /** Creates a worker which can scan all the default plugin formats.
+            @see getFormatManager
+        */
+        Worker();
+
+        /** Destructor. */
+        ~Worker() override;
+
+        /** Returns the formats that the worker can scan, so that you can add any
+            custom formats to it.
+        */
+        AudioPluginFormatManager& getFormatManager() noexcept     { return formatManager; }
+
+        /** Connects to the coordinator process if the command line was generated by an
+            OutOfProcessPluginScanner using the same ID. Returns false otherwise.
+        */
+        using ChildProcessWorker::initialiseFromCommandLine;
+
+    private:
+        class Watchdog;
+
+        void handleMessageFromCoordinator (const MemoryBlock&) override;
+        void handleConnectionLost() override;
+        void handleAsyncUpdate() override;
+
+        OwnedArray<PluginDescription> scan (const MemoryBlock&);
+        void sendResults (const OwnedArray<PluginDescription>&);
+
+        AudioPluginFormatManager formatManager;
+        std::mutex mutex;
+        std::queue<MemoryBlock> pendingRequests;
+        std::unique_ptr<Watchdog> watchdog;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Worker)
+    };
+
+private:
+    //==============================================================================
+    class WorkerProcess;
+    friend class OutOfProcessPluginScannerTests;
+
+    struct CacheEntry
+    {
+        Time modificationTime;
+        int64 size = 0;
+        bool loadedOk = true;
+        Array<PluginDescription> types;
+    };
+
+    std::unique_ptr<WorkerProcess> acquireWorker();
+    void releaseWorker (std::unique_ptr<WorkerProcess>, bool isStillUsable);
+
+    bool findCachedTypes (const String& key, const String& fileOrIdentifier, OwnedArray<PluginDescription>&, bool& loadedOk);
+    void addToCache (const String& key, const String& fileOrIdentifier, const OwnedArray<PluginDescription>&, bool loadedOk);
+    void saveCache();
+
+    const File executable;
+    const String commandLineUID;
+    const int maxNumWorkers;
+    std::atomic<int> timeoutMs { 60000 };
+
+    std::mutex workersMutex;
+    std::condition_variable workerReleased;
+    std::vector<std::unique_ptr<WorkerProcess>> idleWorkers;
+    int numWorkersRunning = 0;
+
+    CriticalSection cacheLock;
+    File cacheFile;
+    std::map<String, CacheEntry> cache;
+    bool cacheNeedsSaving = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OutOfProcessPluginScanner)
+};
+
+} // namespace juce
@@ -96,16 +96,14 @@ bool PluginDirectoryScanner::scanNextFile (bool dontRescanIfAlreadyInList,
             OwnedArray<PluginDescription> typesFound;
 
             // Add this plugin to the end of the dead-man's pedal list in case it crashes...
-            auto crashedPlugins = readDeadMansPedalFile (deadMansPedalFile);
-            crashedPlugins.removeString (file);
-            crashedPlugins.add (file);
-            setDeadMansPedalFile (crashedPlugins);
+            updateDeadMansPedalFile (file, true);
 
             list.scanAndAddFile (file, dontRescanIfAlreadyInList, typesFound, format);
 
             // Managed to load without crashing, so remove it from the dead-man's-pedal..
-            crashedPlugins.removeString (file);
-            setDeadMansPedalFile (crashedPlugins);
+            updateDeadMansPedalFile (file, false);
+
+            const ScopedLock sl (fileListLock);
 
             if (typesFound.size() == 0 && ! list.getBlacklistedFiles().contains (file))
                 failedFiles.add (file);
@@ -122,6 +120,21 @@ bool PluginDirectoryScanner::skipNextFile()
     return --nextIndex > 0;
 }
 
+void PluginDirectoryScanner::updateDeadMansPedalFile (const String& file, bool isBeingScanned)
+{
+    // Other threads may be scanning at the same time, so the file has to be re-read
+    // and written while holding the lock, or their entries could be lost
+    const ScopedLock sl (fileListLock);
+
+    auto crashedPlugins = readDeadMansPedalFile (deadMansPedalFile);
+    crashedPlugins.removeString (file);
+
+    if (isBeingScanned)
+        crashedPlugins.add (file);
+
+    setDeadMansPedalFile (crashedPlugins);
+}
+
 void PluginDirectoryScanner::setDeadMansPedalFile (const StringArray& newContents)
 {
     if (deadMansPedalFile.getFullPathName().isNotEmpty())
@@ -31,7 +31,9 @@ namespace juce
     Scans a directory for plugins, and adds them to a KnownPluginList.
 
     To use one of these, create it and call scanNextFile() repeatedly, until
-    it returns false.
+    it returns false. To scan several files at once, scanNextFile() can be called
+    from more than one thread - this is most useful along with a custom scanner
+    such as OutOfProcessPluginScanner, which can load the plugins in parallel.
 
     @tags{Audio}
 */
@@ -125,12 +127,14 @@ private:
     StringArray filesOrIdentifiersToScan;
     File deadMansPedalFile;
     StringArray failedFiles;
+    CriticalSection fileListLock;
     Atomic<int> nextIndex;
     std::atomic<float> progress { 0.0f };
     const bool allowAsync;
 
     void updateProgress();
     void setDeadMansPedalFile (const StringArray& newContents);
+    void updateDeadMansPedalFile (const String& file, bool isBeingScanned);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginDirectoryScanner)
 };
@@ -66,11 +66,14 @@ private:
     using Listener = AudioProcessorValueTreeState::Listener;
 
 public:
-    explicit ParameterAdapter (RangedAudioParameter& parameterIn)
+    explicit ParameterAdapter (RangedAudioParameter& parameterIn,
+                               std::atomic<ParameterAdapter*>* dirtyListToUse = nullptr)
         : parameter (parameterIn),
           // For legacy reasons, the unnormalised value should *not* be snapped on construction
-          unnormalisedValue (getRange().convertFrom0to1 (parameter.getDefaultValue()))
+          unnormalisedValue (getRange().convertFrom0to1 (parameter.getDefaultValue())),
+          dirtyList (dirtyListToUse)
     {
+        markAsDirty();
         parameter.addListener (this);
 
         if (auto* ptr = dynamic_cast<Parameter*> (&parameter))
@@ -108,6 +111,10 @@ public:
     float getDenormalisedValue() const                { return unnormalisedValue; }
     std::atomic<float>& getRawDenormalisedValue()     { return unnormalisedValue; }
 
+    // Only valid for an adapter that has just been taken from the dirty list, and must
+    // be read before flushToTree() allows the adapter to be pushed onto the list again
+    ParameterAdapter* getNextDirty() const noexcept   { return nextDirty; }
+
     bool flushToTree (const Identifier& key, UndoManager* um)
     {
         auto needsUpdateTestValue = true;
@@ -146,7 +153,24 @@ private:
         unnormalisedValue = newValue;
         listeners.call ([this] (Listener& l) { l.parameterChanged (parameter.paramID, unnormalisedValue); });
         listenersNeedCalling = false;
-        needsUpdate = true;
+        markAsDirty();
+    }
+
+    // This may be called from any thread, including the audio thread. Whichever thread
+    // sets the needsUpdate flag pushes the adapter onto the dirty list, so an adapter is
+    // never on the list more than once, and the list is only ever emptied as a whole.
+    void markAsDirty() noexcept
+    {
+        if (needsUpdate.exchange (true) || dirtyList == nullptr)
+            return;
+
+        auto* head = dirtyList->load();
+
+        do
+        {
+            nextDirty = head;
+        }
+        while (! dirtyList->compare_exchange_weak (head, this));
     }
 
     float denormalise (float normalised) const
@@ -197,8 +221,10 @@ private:
     RangedAudioParameter& parameter;
     LockedListeners listeners;
     std::atomic<float> unnormalisedValue { 0.0f };
-    std::atomic<bool> needsUpdate { true }, listenersNeedCalling { true };
+    std::atomic<bool> needsUpdate { false }, listenersNeedCalling { true };
     bool ignoreParameterChangedCallbacks { false };
+    std::atomic<ParameterAdapter*>* dirtyList = nullptr;
+    ParameterAdapter* nextDirty = nullptr;
 };
 
 //==============================================================================
@@ -262,7 +288,7 @@ AudioProcessorValueTreeState::AudioProcessorValueTreeState (AudioProcessor& proc
 AudioProcessorValueTreeState::AudioProcessorValueTreeState (AudioProcessor& p, UndoManager* um)
     : processor (p), undoManager (um)
 {
-    startTimerHz (10);
+    startTimer (minFlushIntervalMs);
     state.addListener (this);
 }
 
@@ -323,7 +349,13 @@ RangedAudioParameter* AudioProcessorValueTreeState::createAndAddParameter (std::
 //==============================================================================
 void AudioProcessorValueTreeState::addParameterAdapter (RangedAudioParameter& param)
 {
-    adapterTable.emplace (param.paramID, std::make_unique<ParameterAdapter> (param));
+    // A new adapter puts itself on the dirty list straight away, so one mustn't be created
+    // for a duplicate ID, or it would be left on the list after the table had rejected it.
+    // The processor will already have asserted that the IDs must be unique.
+    if (adapterTable.find (param.paramID) != adapterTable.end())
+        return;
+
+    adapterTable.emplace (param.paramID, std::make_unique<ParameterAdapter> (param, &dirtyAdapters));
 }
 
 AudioProcessorValueTreeState::ParameterAdapter* AudioProcessorValueTreeState::getParameterAdapter (StringRef paramID) const
@@ -394,6 +426,194 @@ void AudioProcessorValueTreeState::replaceState (const ValueTree& newState)
         undoManager->clearUndoHistory();
 }
 
+//==============================================================================
+// The binary state starts with a header and a format version. The rest is laid out like
+// ValueTree::writeToStream(), except that each child is preceded by a byte which says
+// whether it's a parameter's tree, stored as just the parameter's ID and value, or any
+// other tree, which is stored using ValueTree::writeToStream().
+const uint32 magicStateNumber = 0x21324358;
+const int stateBinaryVersion = 1;
+
+enum class StateChildType : uint8
+{
+    parameter,
+    tree
+};
+
+void AudioProcessorValueTreeState::copyStateToBinary (MemoryBlock& destData)
+{
+    ScopedLock lock (valueTreeChanging);
+    flushParameterValuesToValueTree();
+
+    MemoryOutputStream out (destData, false);
+    out.writeInt ((int) magicStateNumber);
+    out.writeCompressedInt (stateBinaryVersion);
+    writeStateToStream (out);
+}
+
+bool AudioProcessorValueTreeState::replaceStateFromBinary (const void* data, int sizeInBytes)
+{
+    const auto newState = [&]
+    {
+        if (sizeInBytes > 4 && ByteOrder::littleEndianInt (data) == magicStateNumber)
+        {
+            MemoryInputStream in (addBytesToPointer (data, 4), (size_t) sizeInBytes - 4, false);
+
+            if (in.readCompressedInt() > stateBinaryVersion)
+                return ValueTree();
+
+            return readStateFromStream (in);
+        }
+
+        return AudioProcessor::getValueTreeFromBinary (data, sizeInBytes);
+    }();
+
+    if (! newState.isValid() || (state.isValid() && ! newState.hasType (state.getType())))
+        return false;
+
+    replaceState (newState);
+    return true;
+}
+
+void AudioProcessorValueTreeState::writeStateToStream (OutputStream& out) const
+{
+    const auto isCompactParameterTree = [this] (const ValueTree& child)
+    {
+        if (! (child.hasType (valueType)
+               && child.getNumProperties() == 2
+               && child.getNumChildren() == 0
+               && child.getProperty (idPropertyID).isString()))
+            return false;
+
+        const auto& value = child.getProperty (valuePropertyID);
+        return value.isDouble() || value.isInt() || value.isInt64();
+    };
+
+    out.writeString (state.getType().toString());
+    out.writeCompressedInt (state.getNumProperties());
+
+    for (int i = 0; i < state.getNumProperties(); ++i)
+    {
+        const auto name = state.getPropertyName (i);
+        out.writeString (name.toString());
+        state.getProperty (name).writeToStream (out);
+    }
+
+    out.writeCompressedInt (state.getNumChildren());
+
+    for (const auto& child : state)
+    {
+        if (isCompactParameterTree (child))
+        {
+            out.writeByte ((char) StateChildType::parameter);
+            out.writeString (child.getProperty (idPropertyID).toString());
+            out.writeFloat ((float) child.getProperty (valuePropertyID));
+        }
+        else
+        {
+            out.writeByte ((char) StateChildType::tree);
+            child.writeToStream (out);
+        }
+    }
+}
+
+ValueTree AudioProcessorValueTreeState::readStateFromStream (InputStream& in) const
+{
+    // This reads a value written by OutputStream::writeCompressedInt(), like
+    // InputStream::readCompressedInt() does, but it fails if the stream ends part way
+    // through. Every property and child takes at least one byte, so a count that's larger
+    // than the rest of the stream can only come from corrupted data.
+    const auto readCount = [&in]
+    {
+        if (in.isExhausted())
+            return -1;
+
+        const auto sizeByte = (uint8) in.readByte();
+        const auto numBytes = sizeByte & 0x7f;
+        char bytes[4] = {};
+
+        if (numBytes > 4 || (sizeByte & 0x80) != 0 || in.read (bytes, numBytes) != numBytes)
+            return -1;
+
+        const auto count = (int) ByteOrder::littleEndianInt (bytes);
+        const auto numBytesRemaining = in.getNumBytesRemaining();
+
+        if (count < 0 || (numBytesRemaining >= 0 && count > numBytesRemaining))
+            return -1;
+
+        return count;
+    };
+
+    const auto type = in.readString();
+
+    if (type.isEmpty())
+        return {};
+
+    ValueTree result (type);
+
+    const auto numProperties = readCount();
+
+    if (numProperties < 0)
+        return {};
+
+    for (int i = 0; i < numProperties; ++i)
+    {
+        if (in.isExhausted())
+            return {};
+
+        const auto name = in.readString();
+
+        if (name.isEmpty())
+            return {};
+
+        result.setProperty (name, var::readFromStream (in), nullptr);
+    }
+
+    const auto numChildren = readCount();
+
+    if (numChildren < 0)
+        return {};
+
+    for (int i = 0; i < numChildren; ++i)
+    {
+        if (in.isExhausted())
+            return {};
+
+        ValueTree child;
+
+        switch ((StateChildType) in.readByte())
+        {
+            case StateChildType::parameter:
+            {
+                const auto id = in.readString();
+
+                if (in.getNumBytesRemaining() < (int64) sizeof (float))
+                    return {};
+
+                const auto value = in.readFloat();
+
+                // A parameter without an ID can't be attached to anything
+                if (id.isEmpty())
+                    continue;
+
+                child = ValueTree (valueType, { { idPropertyID, id }, { valuePropertyID, value } });
+                break;
+            }
+
+            case StateChildType::tree:
+                child = ValueTree::readFromStream (in);
+                break;
+        }
+
+        if (! child.isValid())
+            return {};
+
+        result.appendChild (child, nullptr);
+    }
+
+    return result;
+}
+
 void AudioProcessorValueTreeState::setNewState (ValueTree vt)
 {
     jassert (vt.getParent() == state);
@@ -454,18 +674,24 @@ bool AudioProcessorValueTreeState::flushParameterValuesToValueTree()
 
     bool anyUpdated = false;
 
-    for (auto& p : adapterTable)
-        anyUpdated |= p.second->flushToTree (valuePropertyID, undoManager);
+    for (auto* adapter = dirtyAdapters.exchange (nullptr); adapter != nullptr;)
+    {
+        auto* next = adapter->getNextDirty();
+        anyUpdated |= adapter->flushToTree (valuePropertyID, undoManager);
+        adapter = next;
+    }
 
     return anyUpdated;
 }
 
 void AudioProcessorValueTreeState::timerCallback()
 {
-    auto anythingUpdated = flushParameterValuesToValueTree();
+    // The timer only runs quickly while the dirty list has something on it. Otherwise it
+    // backs off to a couple of ticks a second, and an idle tick doesn't even take the lock.
+    const auto anythingUpdated = dirtyAdapters.load() != nullptr && flushParameterValuesToValueTree();
 
-    startTimer (anythingUpdated ? 1000 / 50
-                                : jlimit (50, 500, getTimerInterval() + 20));
+    startTimer (anythingUpdated ? minFlushIntervalMs
+                                : jlimit (minFlushIntervalMs, maxFlushIntervalMs, getTimerInterval() + 20));
 }
 
 //==============================================================================
@@ -977,6 +1203,187 @@ public:
             expectEquals (listener.value, newValue);
             expectEquals (listener.id, String (key));
         }
+
+        beginTest ("A parameter with a duplicate ID is ignored by the state");
+        {
+            TestAudioProcessor proc ({ std::make_unique<AudioParameterFloat> ("a", "", NormalisableRange<float> (0.0f, 1.0f), 0.25f),
+                                       std::make_unique<AudioParameterFloat> ("a", "", NormalisableRange<float> (0.0f, 1.0f), 0.75f) });
+
+            proc.state.getParameter ("a")->setValueNotifyingHost (0.5f);
+
+            const auto state = proc.state.copyState();
+            expectEquals (state.getNumChildren(), 1);
+            expectEquals ((float) state.getChild (0).getProperty ("value"), 0.5f);
+        }
+
+        beginTest ("Only parameters which have changed are flushed to the state");
+        {
+            struct PropertyCounter final : public ValueTree::Listener
+            {
+                void valueTreePropertyChanged (ValueTree& tree, const Identifier&) override
+                {
+                    changedIds.addIfNotAlreadyThere (tree.getProperty ("id").toString());
+                }
+
+                StringArray changedIds;
+            };
+
+            TestAudioProcessor proc;
+            std::vector<RangedAudioParameter*> params;
+
+            for (auto i = 0; i < 100; ++i)
+                params.push_back (proc.state.createAndAddParameter (std::make_unique<Parameter> (ParameterID { String (i), 1 },
+                                                                                                  String(),
+                                                                                                  NormalisableRange<float>(),
+                                                                                                  0.0f)));
+
+            proc.state.state = ValueTree { "state" };
+
+            PropertyCounter counter;
+            proc.state.state.addListener (&counter);
+
+            std::thread ([&]
+            {
+                params[3]->setValueNotifyingHost (0.25f);
+                params[42]->setValueNotifyingHost (0.5f);
+                params[42]->setValueNotifyingHost (0.75f);
+            }).join();
+
+            const auto copy = proc.state.copyState();
+
+            expectEquals (counter.changedIds.size(), 2);
+            expect (counter.changedIds.contains ("3"));
+            expect (counter.changedIds.contains ("42"));
+            expectEquals (float (copy.getChildWithProperty ("id", "3").getProperty ("value")), 0.25f);
+            expectEquals (float (copy.getChildWithProperty ("id", "42").getProperty ("value")), 0.75f);
+            expectEquals (float (copy.getChildWithProperty ("id", "7").getProperty ("value")), 0.0f);
+
+            counter.changedIds.clear();
+            proc.state.copyState();
+            expect (counter.changedIds.isEmpty());
+
+            proc.state.state.removeListener (&counter);
+        }
+
+        beginTest ("The state can be stored and restored as binary data");
+        {
+            TestAudioProcessor proc ({ std::make_unique<AudioParameterFloat> ("a", "", NormalisableRange<float> (-10.0f, 10.0f), 0.0f),
+                                       std::make_unique<AudioParameterInt> ("b", "", 0, 100, 50),
+                                       std::make_unique<AudioParameterBool> ("c", "", false) });
+
+            proc.state.state.setProperty ("extra", "something", nullptr);
+            proc.state.state.appendChild (ValueTree ("CUSTOM", { { "x", 42 } }), nullptr);
+
+            proc.state.getParameter ("a")->setValueNotifyingHost (0.3f);
+            proc.state.getParameter ("b")->setValueNotifyingHost (0.75f);
+            proc.state.getParameter ("c")->setValueNotifyingHost (1.0f);
+
+            MemoryBlock binary, xml;
+            proc.state.copyStateToBinary (binary);
+            AudioProcessor::copyXmlToBinary (*proc.state.copyState().createXml(), xml);
+
+            expect (binary.getSize() < xml.getSize());
+
+            const auto expectedValues = std::map<String, float> { { "a", -4.0f }, { "b", 75.0f }, { "c", 1.0f } };
+
+            const auto expectRestored = [&] (const MemoryBlock& data)
+            {
+                for (const auto& id : { "a", "b", "c" })
+                    proc.state.getParameter (id)->setValueNotifyingHost (0.0f);
+
+                proc.state.state.removeProperty ("extra", nullptr);
+                proc.state.state.removeChild (proc.state.state.getChildWithName ("CUSTOM"), nullptr);
+
+                expect (proc.state.replaceStateFromBinary (data.getData(), (int) data.getSize()));
+
+                for (const auto& [id, value] : expectedValues)
+                    expectWithinAbsoluteError (proc.state.getRawParameterValue (id)->load(), value, 1.0e-5f);
+
+                expectEquals (proc.state.state.getProperty ("extra").toString(), String ("something"));
+                expectEquals ((int) proc.state.state.getChildWithName ("CUSTOM").getProperty ("x"), 42);
+            };
+
+            expectRestored (binary);
+            expectRestored (xml);
+
+            MemoryBlock tree;
+            AudioProcessor::copyValueTreeToBinary (proc.state.copyState(), tree);
+            expect (AudioProcessor::getValueTreeFromBinary (tree.getData(), (int) tree.getSize()).isEquivalentTo (proc.state.copyState()));
+            expectRestored (tree);
+
+            MemoryBlock otherType;
+            AudioProcessor::copyValueTreeToBinary (ValueTree ("other"), otherType);
+            expect (! proc.state.replaceStateFromBinary (otherType.getData(), (int) otherType.getSize()));
+
+            const char garbage[] = "not a state";
+            expect (! proc.state.replaceStateFromBinary (garbage, (int) sizeof (garbage)));
+        }
+
+        beginTest ("Truncated or corrupted binary state is rejected");
+        {
+            TestAudioProcessor proc ({ std::make_unique<AudioParameterFloat> ("a", "", NormalisableRange<float> (-10.0f, 10.0f), 0.0f),
+                                       std::make_unique<AudioParameterInt> ("b", "", 0, 100, 50) });
+
+            proc.state.state.setProperty ("extra", "something", nullptr);
+            proc.state.getParameter ("a")->setValueNotifyingHost (0.3f);
+
+            MemoryBlock binary;
+            proc.state.copyStateToBinary (binary);
+
+            const auto originalState = proc.state.copyState();
+
+            for (size_t size = 0; size < binary.getSize(); ++size)
+            {
+                expect (! proc.state.replaceStateFromBinary (binary.getData(), (int) size));
+                expect (proc.state.copyState().isEquivalentTo (originalState));
+            }
+
+            // Writes a state with the given property and child counts, and the children
+            // that the callback writes
+            const auto makeState = [] (int numProperties, int numChildren, auto&& writeChildren)
+            {
+                MemoryBlock block;
+                MemoryOutputStream out (block, false);
+                out.writeInt ((int) magicStateNumber);
+                out.writeCompressedInt (stateBinaryVersion);
+                out.writeString ("state");
+                out.writeCompressedInt (numProperties);
+                out.writeCompressedInt (numChildren);
+                writeChildren (out);
+                out.flush();
+                return block;
+            };
+
+            const auto writeParameter = [] (OutputStream& out, const String& id, float value)
+            {
+                out.writeByte ((char) StateChildType::parameter);
+                out.writeString (id);
+                out.writeFloat (value);
+            };
+
+            const auto noChildren = [] (OutputStream&) {};
+
+            for (const auto& corrupted : { makeState (0, -1, noChildren),
+                                           makeState (0, 1 << 30, noChildren),
+                                           makeState (-1, 0, noChildren),
+                                           makeState (1 << 30, 0, noChildren),
+                                           makeState (0, 2, [&] (OutputStream& out) { writeParameter (out, "a", 1.0f); }),
+                                           makeState (0, 1, [] (OutputStream& out) { out.writeByte (7); }) })
+            {
+                expect (! proc.state.replaceStateFromBinary (corrupted.getData(), (int) corrupted.getSize()));
+                expect (proc.state.copyState().isEquivalentTo (originalState));
+            }
+
+            const auto withEmptyID = makeState (0, 2, [&] (OutputStream& out)
+            {
+                writeParameter (out, "", 1.0f);
+                writeParameter (out, "b", 25.0f);
+            });
+
+            expect (proc.state.replaceStateFromBinary (withEmptyID.getData(), (int) withEmptyID.getSize()));
+            expect (! proc.state.state.getChildWithProperty ("id", "").isValid());
+            expectEquals (proc.state.getRawParameterValue ("b")->load(), 25.0f);
+        }
     }
     JUCE_END_IGNORE_WARNINGS_MSVC
 };
@@ -394,6 +394,38 @@ public:
     */
     void replaceState (const ValueTree& newState);
 
+    //==============================================================================
+    /** Writes the state into a binary blob, e.g. in your getStateInformation() method.
+
+        This produces the same state as copyState(), but it writes the state tree
+        straight into the MemoryBlock without copying it or converting it to XML first,
+        and the parameter values are stored compactly. This makes it much quicker than
+        using copyState() with AudioProcessor::copyXmlToBinary().
+
+        Use replaceStateFromBinary() to load the data again.
+
+        Note: This method uses locks to synchronise thread access, so whilst it is
+        thread-safe, it is not realtime-safe. Do not call this method from within
+        your audio processing code!
+    */
+    void copyStateToBinary (MemoryBlock& destData);
+
+    /** Replaces the state with one that was stored in a binary blob, e.g. in your
+        setStateInformation() method.
+
+        This can read data that was written by copyStateToBinary(), and also a state
+        tree that was stored with AudioProcessor::copyValueTreeToBinary() or
+        AudioProcessor::copyXmlToBinary(). The state is only replaced if the stored
+        tree has the same type as the current state.
+
+        Returns false if the data couldn't be read.
+
+        Note: This method uses locks to synchronise thread access, so whilst it is
+        thread-safe, it is not realtime-safe. Do not call this method from within
+        your audio processing code!
+    */
+    bool replaceStateFromBinary (const void* data, int sizeInBytes);
+
     //==============================================================================
     /** A reference to the processor with which this state is associated. */
     AudioProcessor& processor;
@@ -643,6 +675,9 @@ private:
     void valueTreeRedirected (ValueTree&) override;
     void updateParameterConnectionsToChildTrees();
 
+    void writeStateToStream (OutputStream&) const;
+    ValueTree readStateFromStream (InputStream&) const;
+
     const Identifier valueType { "PARAM" }, valuePropertyID { "value" }, idPropertyID { "id" };
 
     struct StringRefLessThan final
@@ -650,6 +685,11 @@ private:
         bool operator() (StringRef a, StringRef b) const noexcept { return a.text.compare (b.text) < 0; }
     };
 
+    static constexpr int minFlushIntervalMs = 1000 / 60, maxFlushIntervalMs = 500;
+
+    // The adapters whose values have changed since the last flush, linked through the
+    // adapters themselves so that the audio thread can add to it without locking
+    std::atomic<ParameterAdapter*> dirtyAdapters { nullptr };
     std::map<StringRef, std::unique_ptr<ParameterAdapter>, StringRefLessThan> adapterTable;
 
     CriticalSection valueTreeChanging;
@@ -176,7 +176,13 @@ void UnitTestRunner::runTests (const Array<UnitTest*>& tests, int64 randomSeed)
 
 void UnitTestRunner::runAllTests (int64 randomSeed)
 {
-    runTests (UnitTest::getAllTests(), randomSeed);
+    Array<UnitTest*> tests;
+
+    for (auto* test : UnitTest::getAllTests())
+        if (test->getCategory() != "Benchmarks")
+            tests.add (test);
+
+    runTests (tests, randomSeed);
 }
 
 void UnitTestRunner::runTestsInCategory (const String& category, int64 randomSeed)
@@ -342,7 +342,9 @@ public:
     void runTests (const Array<UnitTest*>& tests, int64 randomSeed = 0);
 
     /** Runs all the UnitTest objects that currently exist.
-        This calls runTests() for all the objects listed in UnitTest::getAllTests().
+        This calls runTests() for all the objects listed in UnitTest::getAllTests(), except
+        for the ones in the "Benchmarks" category, which only report timings. To run those,
+        use runTestsInCategory().
 
         If you want to run the tests with a predetermined seed, you can pass that into
         the randomSeed argument, or pass 0 to have a randomly-generated seed chosen.
@@ -0,0 +1,761 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+namespace PhaseVocoderHelpers
+{
+    constexpr double minimumRatio = 0.25, maximumRatio = 4.0;
+
+    /** The largest factor by which the analysis hop can be smaller than the synthesis hop. */
+    constexpr int maximumStretch = 16;
+
+    /** The most frames that are scheduled before the channels render them. */
+    constexpr int framesPerBatch = 16;
+
+    static float wrapPhase (float phase) noexcept
+    {
+        return phase - MathConstants<float>::twoPi * std::round (phase / MathConstants<float>::twoPi);
+    }
+
+    /** Third-order Lagrange interpolation between y0 and y1. */
+    static float interpolate (const float* y, float x) noexcept
+    {
+        const auto xm1 = x + 1.0f, xm2 = x - 1.0f, xm3 = x - 2.0f;
+
+        return y[-1] * (-x * xm2 * xm3 / 6.0f)
+             + y[0]  * (xm1 * xm2 * xm3 / 2.0f)
+             + y[1]  * (-xm1 * x * xm3 / 2.0f)
+             + y[2]  * (xm1 * x * xm2 / 6.0f);
+    }
+}
+
+//==============================================================================
+PhaseVocoder::PhaseVocoder (int order)
+    : fftOrder (order),
+      fftSize (1 << order),
+      numBins (fftSize / 2 + 1),
+      synthesisHop (fftSize / 4),
+      lookahead (fftSize),
+      // The analysis hop can produce up to one synthesis hop less than its ideal share
+      // of output, which reads up to four stretched samples at the highest pitch ratio,
+      // and the interpolator needs a sample before and two after the read position
+      outputPadding ((int) PhaseVocoderHelpers::maximumRatio + 4),
+      analysisWindow ((size_t) fftSize + 1),
+      synthesisWindow ((size_t) fftSize),
+      schedule ((size_t) PhaseVocoderHelpers::framesPerBatch),
+      rotations ((size_t) (PhaseVocoderHelpers::framesPerBatch * numBins)),
+      phaseAdvances ((size_t) numBins),
+      powers ((size_t) numBins),
+      rotationPhases ((size_t) numBins),
+      peakPhases ((size_t) numBins),
+      peaks ((size_t) numBins)
+{
+    // The analysis hop must stay at least a sample long at the largest stretch
+    jassert (fftOrder >= 6);
+
+    WindowingFunction<float>::fillWindowingTables (analysisWindow, (size_t) fftSize + 1, WindowingFunction<float>::hann, false);
+
+    for (int i = 0; i < synthesisHop; ++i)
+    {
+        auto sum = 0.0f;
+
+        for (auto j = i; j < fftSize; j += synthesisHop)
+            sum += analysisWindow[j] * analysisWindow[j];
+
+        for (auto j = i; j < fftSize; j += synthesisHop)
+            synthesisWindow[j] = analysisWindow[j] / sum;
+    }
+}
+
+void PhaseVocoder::setTimeRatio (double newTimeRatio) noexcept
+{
+    jassert (newTimeRatio >= PhaseVocoderHelpers::minimumRatio && newTimeRatio <= PhaseVocoderHelpers::maximumRatio);
+    timeRatio = jlimit (PhaseVocoderHelpers::minimumRatio, PhaseVocoderHelpers::maximumRatio, newTimeRatio);
+}
+
+void PhaseVocoder::setPitchRatio (double newPitchRatio) noexcept
+{
+    jassert (newPitchRatio >= PhaseVocoderHelpers::minimumRatio && newPitchRatio <= PhaseVocoderHelpers::maximumRatio);
+    pitchRatio = jlimit (PhaseVocoderHelpers::minimumRatio, PhaseVocoderHelpers::maximumRatio, newPitchRatio);
+}
+
+//==============================================================================
+void PhaseVocoder::prepare (const ProcessSpec& spec)
+{
+    const auto numChannels = (int) spec.numChannels;
+    maximumBlockSize = spec.maximumBlockSize;
+
+    // Frames are analysed as soon as there's enough input, so at most a frame and its
+    // lookahead are left over between pushes. Each push of a block can produce up to the block
+    // size times the largest stretch, which must fit alongside the output that
+    // hasn't been popped yet.
+    inputFifo    .setSize (numChannels, fftSize + lookahead + (int) maximumBlockSize);
+    stretchedFifo.setSize (numChannels, (PhaseVocoderHelpers::maximumStretch + 2) * (int) maximumBlockSize + 2 * fftSize);
+    overlapAdd   .setSize (numChannels, fftSize);
+
+    // The spectrum of the last frame of each batch is kept in front of the next batch's,
+    // as the phase advances of the next frame are measured from it
+    frames .setSize (numChannels, 2 * fftSize);
+    spectra.setSize (numChannels, 2 * numBins * (PhaseVocoderHelpers::framesPerBatch + 1));
+
+    ffts.clear();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        ffts.add (new FFT (fftOrder));
+
+    reset();
+}
+
+void PhaseVocoder::reset() noexcept
+{
+    for (auto* buffer : { &inputFifo, &stretchedFifo, &overlapAdd, &frames, &spectra })
+        buffer->clear();
+
+    FloatVectorOperations::clear (rotationPhases, numBins);
+
+    // Starting with a frame and its lookahead's worth of silence, less a sample, means
+    // that each frame is analysed as soon as the last sample it needs arrives, and the
+    // output is padded so that there's always enough to read until the next frame
+    numInInput = fftSize + lookahead - 1;
+    numStretched = jmin (outputPadding, stretchedFifo.getNumSamples());
+    scanPosition = numInInput;
+    onsetPosition = -1;
+    analysisPosition = 0.0;
+    readPosition = 1.0;
+    timingError = 0.0;
+    averageEnergy = 0.0f;
+    analysisHop = 0;
+    isFirstFrame = true;
+    isHoldingOnset = false;
+}
+
+//==============================================================================
+void PhaseVocoder::pushSamples (const AudioBlock<const float>& input) noexcept
+{
+    const auto numChannels = (size_t) inputFifo.getNumChannels();
+
+    jassert (input.getNumChannels() == numChannels);
+    jassert (input.getNumSamples() <= maximumBlockSize);
+
+    auto numSamples = (int) input.getNumSamples();
+
+    if (numSamples == 0)
+        return;
+
+    // If this is hit, the output isn't being popped, or more than the maximum
+    // block size has been pushed, so some of the input will be lost
+    jassert (numInInput + numSamples <= inputFifo.getNumSamples());
+    numSamples = jmin (numSamples, inputFifo.getNumSamples() - numInInput);
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+        FloatVectorOperations::copy (inputFifo.getWritePointer ((int) channel, numInInput),
+                                     input.getChannelPointer (channel), numSamples);
+
+    numInInput += numSamples;
+    processFrames();
+}
+
+size_t PhaseVocoder::getNumSamplesAvailable() const noexcept
+{
+    // Each output sample is interpolated from the stretched samples either side of
+    // its read position, so the last one must be at least three from the end
+    const auto lastPosition = numStretched - 3 - readPosition;
+
+    return lastPosition < 0.0 ? 0 : (size_t) (lastPosition / pitchRatio) + 1;
+}
+
+size_t PhaseVocoder::popSamples (const AudioBlock<float>& output) noexcept
+{
+    const auto numChannels = (size_t) stretchedFifo.getNumChannels();
+    const auto numSamples = jmin (output.getNumSamples(), getNumSamplesAvailable());
+
+    jassert (output.getNumChannels() == numChannels);
+
+    if (numSamples == 0)
+        return 0;
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* stretched = stretchedFifo.getReadPointer ((int) channel);
+        auto* out = output.getChannelPointer (channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto position = readPosition + (double) i * pitchRatio;
+            const auto index = jmin ((int) position, numStretched - 3);
+
+            out[i] = PhaseVocoderHelpers::interpolate (stretched + index, (float) (position - index));
+        }
+    }
+
+    readPosition += (double) numSamples * pitchRatio;
+
+    const auto numToDiscard = (int) readPosition - 1;
+
+    if (numToDiscard > 0)
+    {
+        discard (stretchedFifo, numStretched, numToDiscard);
+        readPosition -= numToDiscard;
+    }
+
+    return numSamples;
+}
+
+//==============================================================================
+int PhaseVocoder::getLatencyInSamples() const noexcept
+{
+    // The input is padded so that each frame is centred half a frame plus the
+    // lookahead, less a sample, before the last input it needs, and the centre of the
+    // first stretched frame is half a frame after the output padding
+    return roundToInt ((outputPadding - 1 + fftSize / 2) / pitchRatio
+                         + (fftSize / 2 + lookahead - 1) * timeRatio);
+}
+
+//==============================================================================
+void PhaseVocoder::processBlock (const AudioBlock<const float>& input, const AudioBlock<float>& output, bool bypassed) noexcept
+{
+    // Stretching the signal changes the number of output samples, so it has to be
+    // done with pushSamples() and popSamples()
+    jassert (approximatelyEqual (timeRatio, 1.0));
+
+    const auto numSamples = output.getNumSamples();
+    jassert (input.getNumSamples() == numSamples);
+
+    const auto ratios = std::make_pair (timeRatio, pitchRatio);
+
+    timeRatio = 1.0;
+
+    if (bypassed)
+        pitchRatio = 1.0;
+
+    // All the input is read before any output is written, so the blocks may be the same
+    pushSamples (input);
+    const auto numPopped = popSamples (output);
+
+    std::tie (timeRatio, pitchRatio) = ratios;
+
+    if (numPopped < numSamples)
+        output.getSubBlock (numPopped).clear();
+}
+
+template <typename Callback>
+void PhaseVocoder::forEachChannel (Callback&& callback)
+{
+    const auto numChannels = inputFifo.getNumChannels();
+
+    if (threadPool == nullptr || numChannels < 2)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            callback (channel);
+
+        return;
+    }
+
+    // This thread renders the first channel while the pool renders the others
+    WaitableEvent finished;
+    std::atomic<int> numRemaining { numChannels - 1 };
+
+    for (int channel = 1; channel < numChannels; ++channel)
+    {
+        threadPool->addJob ([&, channel]
+        {
+            callback (channel);
+
+            if (--numRemaining == 0)
+                finished.signal();
+        });
+    }
+
+    callback (0);
+    finished.wait();
+}
+
+void PhaseVocoder::processFrames() noexcept
+{
+    if (preserveTransients)
+        detectOnsets();
+
+    // The hops only depend on the onsets, which are detected in all the channels
+    // together, so the frames are scheduled first, and then every channel renders
+    // them with the same hops
+    while (const auto numFrames = scheduleFrames())
+    {
+        forEachChannel ([this, numFrames] (int channel) { analyseFrames (channel, numFrames); });
+        calculateRotations (numFrames);
+        forEachChannel ([this, numFrames] (int channel) { synthesiseFrames (channel, numFrames); });
+
+        numStretched += numFrames * synthesisHop;
+    }
+
+    // The next frame can start beyond the end of the input when the analysis hop
+    // is longer than a frame, in which case the input is skipped as it arrives
+    const auto numToDiscard = jmin ((int) analysisPosition, numInInput);
+
+    discard (inputFifo, numInInput, numToDiscard);
+    analysisPosition -= numToDiscard;
+    scanPosition -= numToDiscard;
+
+    if (onsetPosition >= 0)
+        onsetPosition -= numToDiscard;
+}
+
+int PhaseVocoder::scheduleFrames() noexcept
+{
+    int numFrames = 0;
+
+    for (; numFrames < PhaseVocoderHelpers::framesPerBatch; ++numFrames)
+    {
+        const auto frameStart = (int) analysisPosition;
+
+        // An onset which a long hop has skipped over is dropped
+        if (onsetPosition >= 0 && onsetPosition < frameStart)
+            onsetPosition = -1;
+
+        if (frameStart + fftSize + lookahead > numInInput
+             || numStretched + (numFrames + 1) * synthesisHop > stretchedFifo.getNumSamples())
+            break;
+
+        // The frames which contain an onset are analysed with the synthesis hop, so
+        // that they line up with each other and the onset is only heard once, and the
+        // first of them starts from the analysed phases to keep the attack intact
+        const auto containsOnset = onsetPosition >= 0 && frameStart + fftSize > onsetPosition;
+        const auto isFirstOfOnset = containsOnset && ! isHoldingOnset;
+        isHoldingOnset = containsOnset;
+
+        schedule[numFrames] = { frameStart, analysisHop, isFirstFrame || isFirstOfOnset };
+
+        const auto hop = getNextAnalysisHop();
+        const auto nextPosition = analysisPosition + hop;
+        analysisHop = (int) nextPosition - frameStart;
+        analysisPosition = nextPosition;
+        timingError += hop - synthesisHop / (timeRatio * pitchRatio);
+        isFirstFrame = false;
+
+        if (isHoldingOnset && (int) analysisPosition > onsetPosition)
+        {
+            onsetPosition = -1;
+            isHoldingOnset = false;
+        }
+    }
+
+    return numFrames;
+}
+
+double PhaseVocoder::getNextAnalysisHop() const noexcept
+{
+    const auto stretch = timeRatio * pitchRatio;
+    const auto idealHop = synthesisHop / stretch;
+
+    if (isHoldingOnset)
+        return synthesisHop;
+
+    if (onsetPosition < 0)
+    {
+        // The distance lost or gained while holding an onset is made up gradually
+        return jlimit (jmax (1.0, idealHop * 0.5), idealHop * 2.0, idealHop - timingError * 0.25);
+    }
+
+    // A frame maps its centre to the stretched signal, so when the first frame with
+    // the onset in it is analysed at the ideal position, the onset near its end comes
+    // out early (or late, when compressing). The frames leading up to it are spaced
+    // so that the onset lands where the ideal stretch would put it.
+    const auto numHops = jmax (1.0, std::ceil ((onsetPosition - fftSize + 1 - analysisPosition) / idealHop));
+    const auto targetPosition = analysisPosition - timingError + numHops * idealHop;
+    const auto targetDeviation = (onsetPosition - targetPosition - fftSize / 2) * (1.0 - stretch);
+
+    return jmax (1.0, idealHop + (targetDeviation - timingError) / numHops);
+}
+
+void PhaseVocoder::detectOnsets() noexcept
+{
+    // The energy of the first difference of the signal, which emphasises the high
+    // frequencies, is compared with its recent average in short segments. Only one
+    // onset is tracked at a time, which is enough as each is held for a frame.
+    const auto segmentSize = synthesisHop / 4;
+
+    for (; scanPosition + segmentSize <= numInInput; scanPosition += segmentSize)
+    {
+        auto energy = 0.0f;
+
+        for (int channel = 0; channel < inputFifo.getNumChannels(); ++channel)
+        {
+            const auto* samples = inputFifo.getReadPointer (channel, scanPosition);
+
+            for (int i = 1; i < segmentSize; ++i)
+                energy += square (samples[i] - samples[i - 1]);
+        }
+
+        if (onsetPosition < 0 && energy > 8.0f * averageEnergy + 1.0e-6f * (float) segmentSize)
+            onsetPosition = scanPosition;
+
+        averageEnergy += 0.2f * (energy - averageEnergy);
+    }
+}
+
+void PhaseVocoder::analyseFrames (int channel, int numFrames) noexcept
+{
+    auto* frameData = frames.getWritePointer (channel);
+    auto* spectrum = spectra.getWritePointer (channel, 2 * numBins);
+
+    for (int i = 0; i < numFrames; ++i, spectrum += 2 * numBins)
+    {
+        FloatVectorOperations::multiply (frameData, inputFifo.getReadPointer (channel, schedule[i].start), analysisWindow, fftSize);
+        ffts.getUnchecked (channel)->performRealOnlyForwardTransform (frameData, true);
+        FloatVectorOperations::copy (spectrum, frameData, 2 * numBins);
+    }
+}
+
+void PhaseVocoder::calculateRotations (int numFrames) noexcept
+{
+    const auto numChannels = spectra.getNumChannels();
+    const auto binFrequency = MathConstants<float>::twoPi / (float) fftSize;
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        const auto& scheduled = schedule[i];
+        auto* rotation = rotations + i * numBins;
+
+        // The first frame, and the first frame of an onset, use the analysed phases as
+        // they are, which keeps the attack's waveform intact
+        if (scheduled.usesAnalysedPhases)
+        {
+            std::fill (rotation, rotation + numBins, Complex<float> (1.0f));
+            FloatVectorOperations::clear (rotationPhases, numBins);
+            continue;
+        }
+
+        // The peaks are found in the total power of the channels. The product of each bin
+        // with its conjugate in the last frame has the bin's phase advance as its angle,
+        // so summing them gives an advance weighted by each channel's power, which doesn't
+        // cancel out when the channels are out of phase.
+        FloatVectorOperations::clear (powers, numBins);
+        std::fill (phaseAdvances.get(), phaseAdvances + numBins, Complex<float>());
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* previousSpectrum = reinterpret_cast<const Complex<float>*> (spectra.getReadPointer (channel, 2 * numBins * i));
+            const auto* spectrum = previousSpectrum + numBins;
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                powers[bin] += std::norm (spectrum[bin]);
+                phaseAdvances[bin] += spectrum[bin] * std::conj (previousSpectrum[bin]);
+            }
+        }
+
+        int numPeaks = 0;
+
+        for (int bin = 2; bin < numBins - 2; ++bin)
+            if (powers[bin] > powers[bin - 1] && powers[bin] >= powers[bin + 1]
+                 && powers[bin] > powers[bin - 2] && powers[bin] >= powers[bin + 2])
+                peaks[numPeaks++] = bin;
+
+        // Without any peaks (e.g. in silence) every bin is treated as its own peak,
+        // which is the plain phase vocoder
+        if (numPeaks == 0)
+            for (int bin = 0; bin < numBins; ++bin)
+                peaks[numPeaks++] = bin;
+
+        // A peak's synthesised phase advances by its instantaneous frequency over the
+        // synthesis hop, where the analysed one advanced over the analysis hop, and the
+        // difference between the two is added to the rotation from the last frame. The bin
+        // frequencies are multiplied by the hops as integers, modulo the frame size, so
+        // that the phases don't lose precision.
+        const auto hopRatio = (float) synthesisHop / (float) scheduled.hop;
+
+        for (int j = 0; j < numPeaks; ++j)
+        {
+            const auto bin = peaks[j];
+            const auto expectedAnalysisAdvance = binFrequency * (float) ((bin * scheduled.hop) % fftSize);
+            const auto expectedSynthesisAdvance = binFrequency * (float) ((bin * synthesisHop) % fftSize);
+            const auto deviation = PhaseVocoderHelpers::wrapPhase (std::arg (phaseAdvances[bin]) - expectedAnalysisAdvance);
+
+            peakPhases[j] = PhaseVocoderHelpers::wrapPhase (rotationPhases[bin]
+                                                              + expectedSynthesisAdvance - expectedAnalysisAdvance
+                                                              + deviation * (hopRatio - 1.0f));
+        }
+
+        // The bins around each peak, up to half way to the next one, keep their phase
+        // relationship with the peak, which means rotating them all by the same amount
+        for (int j = 0, start = 0; j < numPeaks; ++j)
+        {
+            const auto end = j + 1 < numPeaks ? (peaks[j] + peaks[j + 1]) / 2 + 1 : numBins;
+
+            std::fill (rotation + start, rotation + end, std::polar (1.0f, peakPhases[j]));
+            std::fill (rotationPhases + start, rotationPhases + end, peakPhases[j]);
+
+            start = end;
+        }
+    }
+}
+
+void PhaseVocoder::synthesiseFrames (int channel, int numFrames) noexcept
+{
+    auto* frameData = frames.getWritePointer (channel);
+    auto* synthesisSpectrum = reinterpret_cast<Complex<float>*> (frameData);
+    auto* spectrum = reinterpret_cast<Complex<float>*> (spectra.getWritePointer (channel));
+    auto* out = overlapAdd.getWritePointer (channel);
+    const auto overlap = (size_t) (fftSize - synthesisHop);
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        const auto* analysed = spectrum + (i + 1) * numBins;
+        const auto* rotation = rotations + i * numBins;
+
+        for (int bin = 0; bin < numBins; ++bin)
+            synthesisSpectrum[bin] = analysed[bin] * rotation[bin];
+
+        ffts.getUnchecked (channel)->performRealOnlyInverseTransform (frameData);
+        FloatVectorOperations::addWithMultiply (out, frameData, synthesisWindow, fftSize);
+
+        FloatVectorOperations::copy (stretchedFifo.getWritePointer (channel, numStretched + i * synthesisHop), out, synthesisHop);
+
+        std::memmove (out, out + synthesisHop, overlap * sizeof (float));
+        FloatVectorOperations::clear (out + overlap, synthesisHop);
+    }
+
+    std::copy (spectrum + numFrames * numBins, spectrum + (numFrames + 1) * numBins, spectrum);
+}
+
+void PhaseVocoder::discard (AudioBuffer<float>& fifo, int& numInFifo, int numToDiscard) noexcept
+{
+    if (numToDiscard <= 0)
+        return;
+
+    const auto numLeft = numInFifo - numToDiscard;
+
+    for (int channel = 0; channel < fifo.getNumChannels(); ++channel)
+    {
+        auto* data = fifo.getWritePointer (channel);
+        std::memmove (data, data + numToDiscard, (size_t) numLeft * sizeof (float));
+    }
+
+    numInFifo = numLeft;
+}
+
+//==============================================================================
+AudioBuffer<float> PhaseVocoder::renderOffline (const AudioBuffer<float>& input,
+                                                double timeRatio,
+                                                double pitchRatio,
+                                                int fftOrder,
+                                                ThreadPool* threadPool)
+{
+    const auto numChannels = input.getNumChannels();
+    const auto numInput = input.getNumSamples();
+    const auto numOutput = roundToInt (numInput * timeRatio);
+
+    AudioBuffer<float> output (numChannels, numOutput);
+
+    if (numChannels == 0)
+        return output;
+
+    // Large blocks give the thread pool more frames to work on at once
+    constexpr size_t blockSize = 4096;
+
+    PhaseVocoder vocoder (fftOrder);
+    vocoder.threadPool = threadPool;
+    vocoder.setTimeRatio (timeRatio);
+    vocoder.setPitchRatio (pitchRatio);
+    vocoder.prepare ({ 44100.0, (uint32) blockSize, (uint32) numChannels });
+
+    AudioBuffer<float> silence (numChannels, (int) blockSize), popped (numChannels, (int) blockSize);
+    silence.clear();
+
+    const AudioBlock<const float> source (input);
+    AudioBlock<float> destination (output);
+
+    // The first samples out of the vocoder are its latency, which is skipped; once
+    // the input runs out, silence is pushed to flush the rest of the output out
+    auto numToSkip = (size_t) vocoder.getLatencyInSamples();
+    size_t numRead = 0, numWritten = 0;
+
+    while (numWritten < (size_t) numOutput)
+    {
+        const auto numToPush = jmin (blockSize, (size_t) numInput - jmin (numRead, (size_t) numInput));
+
+        if (numToPush > 0)
+            vocoder.pushSamples (source.getSubBlock (numRead, numToPush));
+        else
+            vocoder.pushSamples (AudioBlock<const float> (silence));
+
+        numRead += numToPush;
+
+        while (auto numPopped = vocoder.popSamples (AudioBlock<float> (popped)))
+        {
+            const auto numSkipped = jmin (numToSkip, numPopped);
+            const auto numToWrite = jmin (numPopped - numSkipped, (size_t) numOutput - numWritten);
+
+            if (numToWrite > 0)
+                destination.getSubBlock (numWritten, numToWrite)
+                           .copyFrom (AudioBlock<float> (popped).getSubBlock (numSkipped, numToWrite));
+
+            numToSkip -= numSkipped;
+            numWritten += numToWrite;
+        }
+    }
+
+    return output;
+}
+
+//==============================================================================
+TimeStretchAudioSource::TimeStretchAudioSource (PositionableAudioSource* inputSource,
+                                                bool deleteInputWhenDeleted,
+                                                int channels,
+                                                int fftOrder)
+    : input (inputSource, deleteInputWhenDeleted),
+      vocoder (fftOrder),
+      numChannels (channels)
+{
+    jassert (input != nullptr);
+}
+
+TimeStretchAudioSource::~TimeStretchAudioSource() {}
+
+void TimeStretchAudioSource::setTimeRatio (double newTimeRatio)
+{
+    const SpinLock::ScopedLockType sl (ratioLock);
+    timeRatio = jlimit (PhaseVocoderHelpers::minimumRatio, PhaseVocoderHelpers::maximumRatio, newTimeRatio);
+}
+
+void TimeStretchAudioSource::setPitchRatio (double newPitchRatio)
+{
+    const SpinLock::ScopedLockType sl (ratioLock);
+    pitchRatio = jlimit (PhaseVocoderHelpers::minimumRatio, PhaseVocoderHelpers::maximumRatio, newPitchRatio);
+}
+
+//==============================================================================
+void TimeStretchAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    const ScopedLock sl (callbackLock);
+
+    blockSize = jmax (1, samplesPerBlockExpected);
+    input->prepareToPlay (blockSize, sampleRate);
+    buffer.setSize (numChannels, blockSize);
+    vocoder.prepare ({ sampleRate, (uint32) blockSize, (uint32) numChannels });
+
+    setNextReadPosition (position);
+}
+
+void TimeStretchAudioSource::releaseResources()
+{
+    input->releaseResources();
+    buffer.setSize (numChannels, 0);
+}
+
+void TimeStretchAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
+{
+    const ScopedLock sl (callbackLock);
+
+    {
+        const SpinLock::ScopedLockType ratioSl (ratioLock);
+        vocoder.setTimeRatio (timeRatio);
+        vocoder.setPitchRatio (pitchRatio);
+    }
+
+    // The vocoder's output for the first samples after a change of position is its
+    // latency, which is thrown away
+    while (numToSkip > 0)
+    {
+        const auto numToPop = jmin (numToSkip, (size_t) blockSize);
+        fillVocoder (numToPop);
+        numToSkip -= vocoder.popSamples (AudioBlock<float> (buffer).getSubBlock (0, numToPop));
+    }
+
+    for (int done = 0; done < info.numSamples;)
+    {
+        const auto numToPop = jmin (info.numSamples - done, blockSize);
+        fillVocoder ((size_t) numToPop);
+
+        const auto numPopped = (int) vocoder.popSamples (AudioBlock<float> (buffer).getSubBlock (0, (size_t) numToPop));
+
+        for (int channel = 0; channel < info.buffer->getNumChannels(); ++channel)
+        {
+            if (channel < numChannels)
+                info.buffer->copyFrom (channel, info.startSample + done, buffer, channel, 0, numPopped);
+            else
+                info.buffer->clear (channel, info.startSample + done, numPopped);
+        }
+
+        done += numPopped;
+    }
+
+    position += info.numSamples;
+}
+
+void TimeStretchAudioSource::fillVocoder (size_t numSamplesNeeded)
+{
+    while (vocoder.getNumSamplesAvailable() < numSamplesNeeded)
+    {
+        AudioSourceChannelInfo readInfo (&buffer, 0, blockSize);
+        input->getNextAudioBlock (readInfo);
+        vocoder.pushSamples (AudioBlock<const float> (buffer));
+    }
+}
+
+//==============================================================================
+void TimeStretchAudioSource::setNextReadPosition (int64 newPosition)
+{
+    const ScopedLock sl (callbackLock);
+
+    position = newPosition;
+
+    const SpinLock::ScopedLockType ratioSl (ratioLock);
+    input->setNextReadPosition ((int64) ((double) newPosition / timeRatio));
+
+    if (blockSize > 0)
+    {
+        vocoder.setTimeRatio (timeRatio);
+        vocoder.setPitchRatio (pitchRatio);
+        vocoder.reset();
+        numToSkip = (size_t) vocoder.getLatencyInSamples();
+    }
+}
+
+int64 TimeStretchAudioSource::getNextReadPosition() const
+{
+    const auto totalLength = getTotalLength();
+    return isLooping() && totalLength > 0 ? position % totalLength : position;
+}
+
+int64 TimeStretchAudioSource::getTotalLength() const
+{
+    const SpinLock::ScopedLockType sl (ratioLock);
+    return (int64) ((double) input->getTotalLength() * timeRatio);
+}
+
+bool TimeStretchAudioSource::isLooping() const
+{
+    return input->isLooping();
+}
+
+void TimeStretchAudioSource::setLooping (bool shouldLoop)
+{
+    input->setLooping (shouldLoop);
+}
+
+} // namespace juce::dsp
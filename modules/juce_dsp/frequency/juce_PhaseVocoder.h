@@ -0,0 +1,306 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+/**
+    A phase vocoder which changes the duration and the pitch of a signal
+    independently of each other.
+
+    The signal is stretched in time by analysing overlapping frames at one hop
+    size and resynthesising them at another, and is then resampled to give the
+    requested pitch. The phases of the resynthesised frames are locked to the
+    spectral peaks around them (identity phase locking), which keeps the
+    "phasiness" of a plain phase vocoder down. Onsets are detected a frame ahead,
+    and the frames which contain one are neither stretched nor have their phases
+    changed, so that drums and other attacks stay sharp and in time instead of
+    being smeared out.
+
+    All the channels are stretched together: they share the onsets and the hops
+    between frames, and each frame's phases are rotated by the same amounts in
+    every channel, so the relationships between the channels (e.g. the stereo
+    image) are kept.
+
+    Because a stretched signal doesn't produce the same number of output samples
+    as it's given, the processor is driven with pushSamples() and popSamples():
+    the caller feeds in input as it becomes available, and reads out whatever
+    output is ready. When only the pitch is changed, the process() method can be
+    used like any other processor, with getLatencyInSamples() samples of latency.
+
+    All the buffers are allocated in prepare(), so the processor can be used on
+    the audio thread as long as no more than the prepared maximum block size is
+    pushed at a time, and the output is popped regularly. For offline rendering,
+    renderOffline() processes a whole buffer, and can share the work for the
+    channels out to a thread pool.
+
+    This class only supports float, like the FFT class.
+
+    @see STFT, TimeStretchAudioSource
+
+    @tags{DSP}
+*/
+class JUCE_API PhaseVocoder
+{
+public:
+    //==============================================================================
+    /** Creates a PhaseVocoder.
+
+        @param fftOrder     the base-2 logarithm of the frame size. Larger frames give
+                            a better frequency resolution at the expense of more
+                            latency and less precise transients; the default of
+                            2048 samples suits most material at 44.1 or 48kHz.
+    */
+    explicit PhaseVocoder (int fftOrder = 11);
+
+    //==============================================================================
+    /** Sets how much longer the output is than the input.
+
+        A ratio of 2 plays the signal at half speed, and 0.5 at double speed. The
+        ratio can be changed at any time and must be between 0.25 and 4.
+    */
+    void setTimeRatio (double newTimeRatio) noexcept;
+
+    /** Sets the factor by which all the frequencies of the signal are multiplied.
+
+        A ratio of 2 shifts the signal up by an octave, and 0.5 down by an octave.
+        The ratio can be changed at any time and must be between 0.25 and 4.
+    */
+    void setPitchRatio (double newPitchRatio) noexcept;
+
+    /** Returns the current time ratio. */
+    double getTimeRatio() const noexcept                    { return timeRatio; }
+
+    /** Returns the current pitch ratio. */
+    double getPitchRatio() const noexcept                   { return pitchRatio; }
+
+    /** Enables or disables the detection of onsets, which is on by default.
+
+        This is best turned off for material without any attacks, such as pads or
+        sustained tones, where a false detection would be heard as a small glitch.
+    */
+    void setPreservesTransients (bool shouldPreserveTransients) noexcept   { preserveTransients = shouldPreserveTransients; }
+
+    //==============================================================================
+    /** Initialises the processor. */
+    void prepare (const ProcessSpec& spec);
+
+    /** Resets the internal state of the processor. */
+    void reset() noexcept;
+
+    //==============================================================================
+    /** Adds some input to the processor.
+
+        The block must have the number of channels given to prepare(), and no more
+        samples than the maximum block size.
+    */
+    void pushSamples (const AudioBlock<const float>& input) noexcept;
+
+    /** Returns the number of output samples which can be read with popSamples(). */
+    size_t getNumSamplesAvailable() const noexcept;
+
+    /** Reads as much output as is available, up to the size of the given block.
+
+        @returns the number of samples written to the start of the block
+    */
+    size_t popSamples (const AudioBlock<float>& output) noexcept;
+
+    //==============================================================================
+    /** Processes the input and output blocks supplied in the processing context.
+
+        This can only be used when the time ratio is 1, so that the output has as
+        many samples as the input. When the context is bypassed, the signal still
+        goes through the vocoder, but with a pitch ratio of 1.
+    */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        static_assert (std::is_same_v<typename ProcessContext::SampleType, float>,
+                       "The PhaseVocoder only supports float, like the FFT class");
+
+        processBlock (context.getInputBlock(), context.getOutputBlock(), context.isBypassed);
+    }
+
+    //==============================================================================
+    /** Returns the delay of the output relative to the input, in output samples.
+
+        This depends on the current ratios, so it changes when they're changed.
+        With a time ratio of 1 it's the latency of the process() method.
+    */
+    int getLatencyInSamples() const noexcept;
+
+    /** Returns the size of each frame. */
+    int getFFTSize() const noexcept                         { return fftSize; }
+
+    //==============================================================================
+    /** Stretches and pitch-shifts a whole buffer.
+
+        The channels are all processed by one PhaseVocoder, and when a thread pool is
+        given, it renders them in parallel, a batch of frames at a time. The result is trimmed
+        so that it starts at the start of the stretched input, and has the input
+        length multiplied by the time ratio.
+    */
+    static AudioBuffer<float> renderOffline (const AudioBuffer<float>& input,
+                                             double timeRatio,
+                                             double pitchRatio,
+                                             int fftOrder = 11,
+                                             ThreadPool* threadPool = nullptr);
+
+private:
+    //==============================================================================
+    struct ScheduledFrame
+    {
+        int start, hop;
+        bool usesAnalysedPhases;
+    };
+
+    void processBlock (const AudioBlock<const float>& input, const AudioBlock<float>& output, bool bypassed) noexcept;
+    void processFrames() noexcept;
+    int scheduleFrames() noexcept;
+    double getNextAnalysisHop() const noexcept;
+    void detectOnsets() noexcept;
+    void analyseFrames (int channel, int numFrames) noexcept;
+    void calculateRotations (int numFrames) noexcept;
+    void synthesiseFrames (int channel, int numFrames) noexcept;
+
+    template <typename Callback>
+    void forEachChannel (Callback&& callback);
+
+    static void discard (AudioBuffer<float>& fifo, int& numInFifo, int numToDiscard) noexcept;
+
+    //==============================================================================
+    const int fftOrder, fftSize, numBins, synthesisHop, lookahead, outputPadding;
+
+    HeapBlock<float> analysisWindow, synthesisWindow;
+
+    // Each channel has its own FFT, as the fallback engine can only be used on one thread at a time
+    OwnedArray<FFT> ffts;
+
+    HeapBlock<ScheduledFrame> schedule;
+    HeapBlock<Complex<float>> rotations, phaseAdvances;
+    HeapBlock<float> powers, rotationPhases, peakPhases;
+    HeapBlock<int> peaks;
+
+    AudioBuffer<float> inputFifo, stretchedFifo, overlapAdd, frames, spectra;
+    ThreadPool* threadPool = nullptr;
+
+    int numInInput = 0, numStretched = 0, analysisHop = 0, scanPosition = 0, onsetPosition = -1;
+    double analysisPosition = 0.0, readPosition = 0.0, timingError = 0.0;
+    float averageEnergy = 0.0f;
+    bool isFirstFrame = true, isHoldingOnset = false;
+
+    double timeRatio = 1.0, pitchRatio = 1.0;
+    bool preserveTransients = true;
+    size_t maximumBlockSize = 0;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PhaseVocoder)
+};
+
+//==============================================================================
+/**
+    A PositionableAudioSource which plays another source at a different speed
+    and pitch, using a PhaseVocoder.
+
+    The positions and length of this source are those of the input multiplied by
+    the time ratio, and the latency of the vocoder is compensated for whenever the
+    read position is set, so that the output lines up with the input.
+
+    @see PhaseVocoder
+
+    @tags{DSP}
+*/
+class JUCE_API TimeStretchAudioSource  : public PositionableAudioSource
+{
+public:
+    //==============================================================================
+    /** Creates a TimeStretchAudioSource for a given input source.
+
+        @param inputSource              the input source to read from
+        @param deleteInputWhenDeleted   if true, the input source will be deleted when
+                                        this object is deleted
+        @param numChannels              the number of channels to process
+        @param fftOrder                 the base-2 logarithm of the vocoder's frame size
+    */
+    TimeStretchAudioSource (PositionableAudioSource* inputSource,
+                            bool deleteInputWhenDeleted,
+                            int numChannels = 2,
+                            int fftOrder = 11);
+
+    /** Destructor. */
+    ~TimeStretchAudioSource() override;
+
+    //==============================================================================
+    /** Changes the time ratio, where 2 plays the input at half speed.
+
+        (This value can be changed at any time, even while the source is running).
+        It must be between 0.25 and 4.
+    */
+    void setTimeRatio (double newTimeRatio);
+
+    /** Changes the pitch ratio, where 2 shifts the input up an octave.
+
+        (This value can be changed at any time, even while the source is running).
+        It must be between 0.25 and 4.
+    */
+    void setPitchRatio (double newPitchRatio);
+
+    /** Returns the current time ratio. */
+    double getTimeRatio() const noexcept                    { return timeRatio; }
+
+    /** Returns the current pitch ratio. */
+    double getPitchRatio() const noexcept                   { return pitchRatio; }
+
+    //==============================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock (const AudioSourceChannelInfo&) override;
+
+    void setNextReadPosition (int64 newPosition) override;
+    int64 getNextReadPosition() const override;
+    int64 getTotalLength() const override;
+    bool isLooping() const override;
+    void setLooping (bool shouldLoop) override;
+
+private:
+    //==============================================================================
+    void fillVocoder (size_t numSamplesNeeded);
+
+    OptionalScopedPointer<PositionableAudioSource> input;
+    PhaseVocoder vocoder;
+    AudioBuffer<float> buffer;
+    const int numChannels;
+    int blockSize = 0;
+    int64 position = 0;
+    size_t numToSkip = 0;
+    double timeRatio = 1.0, pitchRatio = 1.0;
+    SpinLock ratioLock;
+    CriticalSection callbackLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimeStretchAudioSource)
+};
+
+} // namespace juce::dsp
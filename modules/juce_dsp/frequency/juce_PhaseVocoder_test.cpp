@@ -0,0 +1,273 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+struct PhaseVocoderTests final : public UnitTest
+{
+    PhaseVocoderTests()
+        : UnitTest ("PhaseVocoder", UnitTestCategories::dsp)
+    {}
+
+    static constexpr double sampleRate = 44100.0;
+
+    static AudioBuffer<float> makeSine (int numChannels, int numSamples, double frequency)
+    {
+        AudioBuffer<float> buffer (numChannels, numSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample (channel, i, 0.5f * (float) std::sin (MathConstants<double>::twoPi * frequency * i / sampleRate));
+
+        return buffer;
+    }
+
+    // Measures the frequency of a steady tone from its rising zero crossings
+    static double measureFrequency (const float* samples, int numSamples)
+    {
+        double first = -1.0, last = -1.0;
+        int numCrossings = 0;
+
+        for (int i = 1; i < numSamples; ++i)
+        {
+            if (samples[i - 1] < 0.0f && samples[i] >= 0.0f)
+            {
+                last = (i - 1) + samples[i - 1] / (double) (samples[i - 1] - samples[i]);
+
+                if (numCrossings++ == 0)
+                    first = last;
+            }
+        }
+
+        return numCrossings > 1 ? (numCrossings - 1) * sampleRate / (last - first) : 0.0;
+    }
+
+    void expectFrequency (const float* samples, int numSamples, double expected)
+    {
+        const auto frequency = measureFrequency (samples, numSamples);
+        expectWithinAbsoluteError (frequency, expected, expected * 0.005);
+    }
+
+    void runTest() override
+    {
+        beginTest ("Unchanged ratios reconstruct the signal");
+        {
+            constexpr int numChannels = 2, numSamples = 16384;
+
+            AudioBuffer<float> input (numChannels, numSamples);
+            auto random = getRandom();
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    input.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+            AudioBuffer<float> output (input);
+
+            PhaseVocoder vocoder (10);
+            vocoder.prepare ({ sampleRate, 512, (uint32) numChannels });
+
+            AudioBlock<float> block (output);
+
+            for (size_t start = 0; start < (size_t) numSamples;)
+            {
+                auto num = jmin ((size_t) numSamples - start, (size_t) random.nextInt ({ 1, 512 }));
+                auto subBlock = block.getSubBlock (start, num);
+                vocoder.process (ProcessContextReplacing<float> (subBlock));
+                start += num;
+            }
+
+            const auto latency = vocoder.getLatencyInSamples();
+            auto maxError = 0.0f;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = latency; i < numSamples; ++i)
+                    maxError = jmax (maxError, std::abs (output.getSample (channel, i) - input.getSample (channel, i - latency)));
+
+            expectLessThan (maxError, 1.0e-3f);
+        }
+
+        beginTest ("Pitch shifting changes the frequency without changing the duration");
+        {
+            for (auto pitchRatio : { 0.5, 0.8, 1.25, 2.0 })
+            {
+                constexpr int numSamples = 32768;
+                auto buffer = makeSine (1, numSamples, 440.0);
+
+                PhaseVocoder vocoder;
+                vocoder.setPitchRatio (pitchRatio);
+                vocoder.prepare ({ sampleRate, 256, 1 });
+
+                AudioBlock<float> block (buffer);
+
+                for (size_t start = 0; start < (size_t) numSamples; start += 256)
+                {
+                    auto subBlock = block.getSubBlock (start, 256);
+                    vocoder.process (ProcessContextReplacing<float> (subBlock));
+                }
+
+                // Skip the latency and the frames which overlap the start of the tone
+                const auto settled = 3 * vocoder.getFFTSize() + vocoder.getLatencyInSamples();
+                expectFrequency (buffer.getReadPointer (0, settled), numSamples - settled, 440.0 * pitchRatio);
+            }
+        }
+
+        beginTest ("Time stretching changes the duration without changing the frequency");
+        {
+            ThreadPool threadPool (2);
+
+            for (auto timeRatio : { 0.5, 0.8, 1.5, 3.0 })
+            {
+                constexpr int numSamples = 32768;
+                const auto input = makeSine (2, numSamples, 440.0);
+
+                const auto output = PhaseVocoder::renderOffline (input, timeRatio, 1.0, 11, &threadPool);
+                const auto numOutput = output.getNumSamples();
+
+                expectEquals (numOutput, roundToInt (numSamples * timeRatio));
+
+                const auto margin = 4096;
+                expectFrequency (output.getReadPointer (0, margin), numOutput - 2 * margin, 440.0);
+
+                // The channels share their hops and phase rotations, so identical channels give identical results
+                auto channelsMatch = true;
+
+                for (int i = 0; i < numOutput; ++i)
+                    channelsMatch &= exactlyEqual (output.getSample (0, i), output.getSample (1, i));
+
+                expect (channelsMatch);
+            }
+        }
+
+        beginTest ("Transients stay in place when stretched");
+        {
+            constexpr int numSamples = 44100, clickPosition = 20000;
+
+            AudioBuffer<float> input (1, numSamples);
+            input.clear();
+
+            for (int i = 0; i < 64; ++i)
+                input.setSample (0, clickPosition + i, 1.0f - (float) i / 64.0f);
+
+            for (auto timeRatio : { 0.6, 1.5, 3.0 })
+            {
+                const auto output = PhaseVocoder::renderOffline (input, timeRatio, 1.0);
+                const auto* samples = output.getReadPointer (0);
+
+                const auto onset = std::find_if (samples, samples + output.getNumSamples(),
+                                                 [] (float s) { return std::abs (s) > 0.1f; }) - samples;
+
+                // Without the frames around the click being lined up, it would be spread
+                // out across them, starting well before its stretched position
+                expectWithinAbsoluteError ((double) onset, clickPosition * timeRatio, 64.0);
+                expectWithinAbsoluteError (output.getSample (0, (int) onset), 1.0f, 0.1f);
+            }
+        }
+
+        beginTest ("Channels stay in sync when only one of them has an onset");
+        {
+            constexpr int numSamples = 44100, clickPosition = 20000;
+            constexpr auto timeRatio = 1.5;
+
+            // Both channels have the same tone, but only the first has a click
+            auto input = makeSine (2, numSamples, 440.0);
+
+            for (int i = 0; i < 64; ++i)
+                input.setSample (0, clickPosition + i, input.getSample (0, clickPosition + i) + 1.0f - (float) i / 64.0f);
+
+            const auto output = PhaseVocoder::renderOffline (input, timeRatio, 1.0);
+
+            // Both channels restart from the analysed phases at the click, so once the frames
+            // have moved past it, the tones are identical again instead of having drifted apart
+            const auto settled = roundToInt (clickPosition * timeRatio) + 2 * (1 << 11);
+            auto maxDifference = 0.0f;
+
+            for (int i = settled; i < output.getNumSamples(); ++i)
+                maxDifference = jmax (maxDifference, std::abs (output.getSample (0, i) - output.getSample (1, i)));
+
+            expectLessThan (maxDifference, 1.0e-4f);
+
+            // The thread pool only changes where the channels are rendered
+            ThreadPool threadPool (2);
+            const auto parallelOutput = PhaseVocoder::renderOffline (input, timeRatio, 1.0, 11, &threadPool);
+            auto outputsMatch = true;
+
+            for (int channel = 0; channel < output.getNumChannels(); ++channel)
+                for (int i = 0; i < output.getNumSamples(); ++i)
+                    outputsMatch &= exactlyEqual (output.getSample (channel, i), parallelOutput.getSample (channel, i));
+
+            expect (outputsMatch);
+        }
+
+        beginTest ("TimeStretchAudioSource");
+        {
+            constexpr int numSamples = 32768, blockSize = 480;
+
+            auto input = makeSine (2, numSamples, 440.0);
+            TimeStretchAudioSource source (new MemoryAudioSource (input, true), true);
+
+            source.prepareToPlay (blockSize, sampleRate);
+
+            // With unchanged ratios the latency is compensated for, so the output
+            // lines up with the input
+            {
+                AudioBuffer<float> output (2, blockSize);
+                auto maxError = 0.0f;
+
+                for (int start = 0; start + blockSize <= 8 * blockSize; start += blockSize)
+                {
+                    source.getNextAudioBlock (AudioSourceChannelInfo (output));
+
+                    for (int i = 0; i < blockSize; ++i)
+                        maxError = jmax (maxError, std::abs (output.getSample (1, i) - input.getSample (1, start + i)));
+                }
+
+                expectLessThan (maxError, 1.0e-3f);
+                expectEquals (source.getNextReadPosition(), (int64) 8 * blockSize);
+            }
+
+            source.setTimeRatio (2.0);
+            source.setPitchRatio (1.5);
+            source.setNextReadPosition (4096);
+
+            expectEquals (source.getTotalLength(), (int64) 2 * numSamples);
+
+            AudioBuffer<float> output (2, 16384);
+
+            for (int start = 0; start < output.getNumSamples(); start += blockSize)
+            {
+                const auto num = jmin (blockSize, output.getNumSamples() - start);
+                source.getNextAudioBlock (AudioSourceChannelInfo (&output, start, num));
+            }
+
+            expectFrequency (output.getReadPointer (0, 4096), output.getNumSamples() - 4096, 660.0);
+        }
+    }
+};
+
+static PhaseVocoderTests phaseVocoderTests;
+
+} // namespace juce::dsp
@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+STFT::STFT (int fftOrder, int hop, WindowingMethod window)
+    : fft (fftOrder),
+      fftSize (1 << fftOrder),
+      hopSize (hop),
+      analysisWindow ((size_t) fftSize + 1),
+      synthesisWindow ((size_t) fftSize)
+{
+    jassert (hopSize > 0 && hopSize <= fftSize);
+
+    // The window is made periodic by leaving out the last point of a symmetric
+    // window one sample longer, so that the overlapping frames add up evenly
+    WindowingFunction<float>::fillWindowingTables (analysisWindow, (size_t) fftSize + 1, window, false);
+
+    // Dividing by the sum of the overlapping squared windows gives the synthesis
+    // window which reconstructs the signal exactly from unmodified frames
+    for (int i = 0; i < hopSize; ++i)
+    {
+        auto sum = 0.0f;
+
+        for (auto j = i; j < fftSize; j += hopSize)
+            sum += analysisWindow[j] * analysisWindow[j];
+
+        for (auto j = i; j < fftSize; j += hopSize)
+            synthesisWindow[j] = sum > 0.0f ? analysisWindow[j] / sum : 0.0f;
+    }
+}
+
+void STFT::setFrameCallback (FrameCallback newCallback)
+{
+    frameCallback = std::move (newCallback);
+}
+
+void STFT::prepare (const ProcessSpec& spec)
+{
+    auto numChannels = (int) spec.numChannels;
+
+    inputFrames .setSize (numChannels, fftSize);
+    outputFrames.setSize (numChannels, fftSize);
+    spectra     .setSize (numChannels, 2 * fftSize);
+
+    spectrumPointers.resize ((size_t) numChannels);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        spectrumPointers[(size_t) channel] = reinterpret_cast<Complex<float>*> (spectra.getWritePointer (channel));
+
+    reset();
+}
+
+void STFT::reset() noexcept
+{
+    inputFrames.clear();
+    outputFrames.clear();
+    spectra.clear();
+    samplesInHop = 0;
+}
+
+//==============================================================================
+void STFT::processBlock (const AudioBlock<const float>& input, const AudioBlock<float>& output, bool bypassed) noexcept
+{
+    const auto numChannels = output.getNumChannels();
+    const auto numSamples  = output.getNumSamples();
+
+    jassert (input.getNumChannels() == numChannels);
+    jassert (input.getNumSamples() == numSamples);
+    jassert (numChannels <= (size_t) inputFrames.getNumChannels());
+
+    // Each step runs up to the end of the current hop, reading the whole input
+    // segment before writing the output, so the blocks may be the same
+    for (size_t start = 0; start < numSamples;)
+    {
+        const auto num = jmin (numSamples - start, (size_t) (hopSize - samplesInHop));
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            FloatVectorOperations::copy (inputFrames.getWritePointer ((int) channel, fftSize - hopSize + samplesInHop),
+                                         input.getChannelPointer (channel) + start, num);
+
+            FloatVectorOperations::copy (output.getChannelPointer (channel) + start,
+                                         outputFrames.getReadPointer ((int) channel, samplesInHop), num);
+        }
+
+        start += num;
+        samplesInHop += (int) num;
+
+        if (samplesInHop == hopSize)
+        {
+            processFrame (bypassed);
+            samplesInHop = 0;
+        }
+    }
+}
+
+void STFT::processFrame (bool bypassed) noexcept
+{
+    const auto numChannels = inputFrames.getNumChannels();
+    const auto transform = frameCallback != nullptr && ! bypassed;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* spectrum = spectra.getWritePointer (channel);
+        FloatVectorOperations::multiply (spectrum, inputFrames.getReadPointer (channel), analysisWindow, fftSize);
+
+        if (transform)
+            fft.performRealOnlyForwardTransform (spectrum, true);
+    }
+
+    if (transform)
+        frameCallback (spectrumPointers.data(), (size_t) numChannels, (size_t) getNumBins());
+
+    const auto overlap = (size_t) (fftSize - hopSize);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* spectrum = spectra.getWritePointer (channel);
+
+        // The forward and inverse transforms cancel out when nothing has
+        // changed the spectrum, so they can be skipped
+        if (transform)
+            fft.performRealOnlyInverseTransform (spectrum);
+
+        auto* out = outputFrames.getWritePointer (channel);
+        std::memmove (out, out + hopSize, overlap * sizeof (float));
+        FloatVectorOperations::clear (out + overlap, hopSize);
+        FloatVectorOperations::addWithMultiply (out, spectrum, synthesisWindow, fftSize);
+
+        auto* in = inputFrames.getWritePointer (channel);
+        std::memmove (in, in + hopSize, overlap * sizeof (float));
+    }
+}
+
+} // namespace juce::dsp
@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+/**
+    A streaming short-time Fourier transform, which splits a signal into
+    overlapping windowed frames, hands their spectra to a callback, and
+    resynthesises the signal from the modified spectra using overlap-add.
+
+    This takes care of the framing, hop scheduling and overlap-add that every
+    spectral effect needs, so that the callback only has to deal with one frame
+    of spectra at a time. All the buffers are allocated in prepare(), so process()
+    is realtime-safe as long as the callback is.
+
+    The frames are transformed with the real-only transform of the FFT class, so
+    each spectrum has getNumBins() = getFFTSize() / 2 + 1 complex bins, from DC to
+    Nyquist. The synthesis window is derived from the analysis window so that the
+    signal is reconstructed perfectly (apart from the latency) when the spectra
+    aren't modified, for any window type and any hop size up to the FFT size.
+
+    The processor adds getLatencyInSamples() samples of latency. The input and
+    output blocks are read and written directly, and may be the same block.
+
+    @see FFT, WindowingFunction
+
+    @tags{DSP}
+*/
+class JUCE_API STFT
+{
+public:
+    //==============================================================================
+    using WindowingMethod = WindowingFunction<float>::WindowingMethod;
+
+    /** The type of function called for every frame.
+
+        It's given an array of numChannels spectra, each of numBins complex values,
+        which it can modify in place. It's called on the audio thread, from process().
+    */
+    using FrameCallback = std::function<void (Complex<float>* const* spectra, size_t numChannels, size_t numBins)>;
+
+    //==============================================================================
+    /** Creates an STFT.
+
+        @param fftOrder     the base-2 logarithm of the FFT size
+        @param hopSize      the number of samples between the start of each frame, which
+                            must be between 1 and the FFT size
+        @param window       the window applied to each frame before the transform
+    */
+    STFT (int fftOrder, int hopSize, WindowingMethod window = WindowingFunction<float>::hann);
+
+    //==============================================================================
+    /** Sets the function called for every frame.
+
+        This isn't thread-safe, so set it before calling prepare(), or while the
+        processor isn't being used. If there's no callback, the signal is just
+        delayed.
+    */
+    void setFrameCallback (FrameCallback newCallback);
+
+    /** Initialises the processor. */
+    void prepare (const ProcessSpec& spec);
+
+    /** Resets the internal state of the processor. */
+    void reset() noexcept;
+
+    //==============================================================================
+    /** Processes the input and output blocks supplied in the processing context.
+
+        When the context is bypassed the frame callback isn't called, but the
+        signal is still delayed by getLatencyInSamples().
+    */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        static_assert (std::is_same_v<typename ProcessContext::SampleType, float>,
+                       "The STFT only supports float, like the FFT class");
+
+        processBlock (context.getInputBlock(), context.getOutputBlock(), context.isBypassed);
+    }
+
+    //==============================================================================
+    /** Returns the latency added by the processor, in samples. */
+    int getLatencyInSamples() const noexcept            { return fftSize; }
+
+    /** Returns the size of each frame. */
+    int getFFTSize() const noexcept                     { return fftSize; }
+
+    /** Returns the number of samples between the start of each frame. */
+    int getHopSize() const noexcept                     { return hopSize; }
+
+    /** Returns the number of complex bins in each spectrum passed to the callback. */
+    int getNumBins() const noexcept                     { return fftSize / 2 + 1; }
+
+private:
+    //==============================================================================
+    void processBlock (const AudioBlock<const float>& input, const AudioBlock<float>& output, bool bypassed) noexcept;
+    void processFrame (bool bypassed) noexcept;
+
+    //==============================================================================
+    FFT fft;
+    const int fftSize, hopSize;
+
+    HeapBlock<float> analysisWindow, synthesisWindow;
+    AudioBuffer<float> inputFrames, outputFrames, spectra;
+    std::vector<Complex<float>*> spectrumPointers;
+    int samplesInHop = 0;
+
+    FrameCallback frameCallback;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (STFT)
+};
+
+} // namespace juce::dsp
@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+struct STFTTests final : public UnitTest
+{
+    STFTTests()
+        : UnitTest ("STFT", UnitTestCategories::dsp)
+    {}
+
+    // Processes noise in blocks of varying size, and returns the largest difference
+    // between the output and the input scaled by expectedGain and delayed by the latency
+    float processNoise (STFT& stft, float expectedGain)
+    {
+        constexpr int numChannels = 2, numSamples = 8192;
+
+        AudioBuffer<float> input (numChannels, numSamples);
+        auto random = getRandom();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                input.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        AudioBuffer<float> output (input);
+
+        stft.prepare ({ 44100.0, (uint32) numSamples, (uint32) numChannels });
+
+        AudioBlock<float> block (output);
+
+        for (size_t start = 0; start < (size_t) numSamples;)
+        {
+            auto num = jmin ((size_t) numSamples - start, (size_t) random.nextInt ({ 1, 700 }));
+            auto subBlock = block.getSubBlock (start, num);
+            stft.process (ProcessContextReplacing<float> (subBlock));
+            start += num;
+        }
+
+        const auto latency = stft.getLatencyInSamples();
+        auto maxError = 0.0f;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto expected = i < latency ? 0.0f : input.getSample (channel, i - latency) * expectedGain;
+                maxError = jmax (maxError, std::abs (output.getSample (channel, i) - expected));
+            }
+        }
+
+        return maxError;
+    }
+
+    void runTest() override
+    {
+        beginTest ("Unmodified frames are reconstructed perfectly");
+        {
+            for (auto [order, hop, window] : { std::tuple<int, int, STFT::WindowingMethod> { 9, 128, WindowingFunction<float>::hann },
+                                               { 10, 512, WindowingFunction<float>::hann },
+                                               { 10, 300, WindowingFunction<float>::blackman },
+                                               { 8, 256, WindowingFunction<float>::rectangular } })
+            {
+                STFT stft (order, hop, window);
+                expectLessThan (processNoise (stft, 1.0f), 1.0e-6f);
+
+                stft.setFrameCallback ([] (Complex<float>* const*, size_t, size_t) {});
+                expectLessThan (processNoise (stft, 1.0f), 1.0e-4f);
+            }
+        }
+
+        beginTest ("The callback receives every channel of each frame");
+        {
+            STFT stft (9, 128);
+            int numFrames = 0;
+
+            stft.setFrameCallback ([&] (Complex<float>* const* spectra, size_t numChannels, size_t numBins)
+            {
+                expectEquals ((int) numChannels, 2);
+                expectEquals ((int) numBins, 257);
+
+                for (size_t channel = 0; channel < numChannels; ++channel)
+                    for (size_t bin = 0; bin < numBins; ++bin)
+                        spectra[channel][bin] *= 0.5f;
+
+                ++numFrames;
+            });
+
+            expectLessThan (processNoise (stft, 0.5f), 1.0e-4f);
+            expectEquals (numFrames, 8192 / 128);
+        }
+
+        beginTest ("Bypassed frames aren't passed to the callback");
+        {
+            STFT stft (8, 64);
+            stft.setFrameCallback ([this] (Complex<float>* const*, size_t, size_t) { expect (false); });
+            stft.prepare ({ 44100.0, 512, 1 });
+
+            AudioBuffer<float> buffer (1, 512);
+            buffer.clear();
+
+            AudioBlock<float> block (buffer);
+            ProcessContextReplacing<float> context (block);
+            context.isBypassed = true;
+            stft.process (context);
+        }
+    }
+};
+
+static STFTTests stftTests;
+
+} // namespace juce::dsp
@@ -64,19 +64,27 @@
 #include "processors/juce_DelayLine.cpp"
 #include "processors/juce_DryWetMixer.cpp"
 #include "processors/juce_StateVariableTPTFilter.cpp"
+#include "processors/juce_ParameterSmootherBank.cpp"
+#include "processors/juce_MultibandCrossover.cpp"
+#include "processors/juce_StateVariableTPTFilterBank.cpp"
 #include "maths/juce_SpecialFunctions.cpp"
 #include "maths/juce_Matrix.cpp"
 #include "maths/juce_LookupTable.cpp"
+#include "maths/juce_BandLimitedWavetable.cpp"
 #include "frequency/juce_FFT.cpp"
 #include "frequency/juce_Convolution.cpp"
 #include "frequency/juce_Windowing.cpp"
+#include "frequency/juce_STFT.cpp"
+#include "frequency/juce_PhaseVocoder.cpp"
 #include "filter_design/juce_FilterDesign.cpp"
 #include "widgets/juce_LadderFilter.cpp"
 #include "widgets/juce_Compressor.cpp"
 #include "widgets/juce_NoiseGate.cpp"
 #include "widgets/juce_Limiter.cpp"
+#include "widgets/juce_LookAheadLimiter.cpp"
 #include "widgets/juce_Phaser.cpp"
 #include "widgets/juce_Chorus.cpp"
+#include "widgets/juce_FDNReverb.cpp"
 
 #if JUCE_USE_SIMD
  #if JUCE_INTEL
@@ -94,7 +102,9 @@
 
 #if JUCE_UNIT_TESTS
  #include "maths/juce_Matrix_test.cpp"
+ #include "maths/juce_FastMathApproximations_test.cpp"
  #include "maths/juce_LogRampedValue_test.cpp"
+ #include "maths/juce_BandLimitedWavetable_test.cpp"
 
  #if JUCE_USE_SIMD
   #include "containers/juce_SIMDRegister_test.cpp"
@@ -103,6 +113,14 @@
  #include "containers/juce_AudioBlock_test.cpp"
  #include "frequency/juce_Convolution_test.cpp"
  #include "frequency/juce_FFT_test.cpp"
+ #include "frequency/juce_STFT_test.cpp"
+ #include "frequency/juce_PhaseVocoder_test.cpp"
  #include "processors/juce_FIRFilter_test.cpp"
  #include "processors/juce_ProcessorChain_test.cpp"
+ #include "processors/juce_ParameterSmootherBank_test.cpp"
+ #include "processors/juce_MultibandCrossover_test.cpp"
+ #include "processors/juce_StateVariableTPTFilterBank_test.cpp"
+ #include "widgets/juce_Compressor_test.cpp"
+ #include "widgets/juce_FDNReverb_test.cpp"
+ #include "widgets/juce_LookAheadLimiter_test.cpp"
 #endif
@@ -247,6 +247,7 @@ namespace util
 #include "maths/juce_Polynomial.h"
 #include "maths/juce_FastMathApproximations.h"
 #include "maths/juce_LookupTable.h"
+#include "maths/juce_BandLimitedWavetable.h"
 #include "maths/juce_LogRampedValue.h"
 #include "containers/juce_AudioBlock.h"
 #include "processors/juce_ProcessContext.h"
@@ -265,11 +266,17 @@ namespace util
 #include "processors/juce_LinkwitzRileyFilter.h"
 #include "processors/juce_DryWetMixer.h"
 #include "processors/juce_StateVariableTPTFilter.h"
+#include "processors/juce_StateVariableTPTFilterBank.h"
+#include "processors/juce_ParameterSmootherBank.h"
+#include "processors/juce_MultibandCrossover.h"
 #include "frequency/juce_FFT.h"
 #include "frequency/juce_Convolution.h"
 #include "frequency/juce_Windowing.h"
+#include "frequency/juce_STFT.h"
+#include "frequency/juce_PhaseVocoder.h"
 #include "filter_design/juce_FilterDesign.h"
 #include "widgets/juce_Reverb.h"
+#include "widgets/juce_FDNReverb.h"
 #include "widgets/juce_Bias.h"
 #include "widgets/juce_Gain.h"
 #include "widgets/juce_WaveShaper.h"
@@ -278,5 +285,6 @@ namespace util
 #include "widgets/juce_Compressor.h"
 #include "widgets/juce_NoiseGate.h"
 #include "widgets/juce_Limiter.h"
+#include "widgets/juce_LookAheadLimiter.h"
 #include "widgets/juce_Phaser.h"
 #include "widgets/juce_Chorus.h"
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+template <typename FloatType>
+BandLimitedWavetable<FloatType>::BandLimitedWavetable (const std::function<FloatType (FloatType)>& waveform, size_t size)
+{
+    initialise (waveform, size);
+}
+
+template <typename FloatType>
+void BandLimitedWavetable<FloatType>::initialise (const std::function<FloatType (FloatType)>& waveform, size_t size)
+{
+    HeapBlock<FloatType> cycle (size);
+
+    for (size_t i = 0; i < size; ++i)
+        cycle[i] = waveform ((FloatType) i / (FloatType) size);
+
+    initialise (cycle.get(), size);
+}
+
+template <typename FloatType>
+void BandLimitedWavetable<FloatType>::initialise (const FloatType* singleCycle, size_t size)
+{
+    // The table size must be a power of two, so that it can be band-limited with an FFT
+    jassert (isPowerOfTwo (size) && size >= 4);
+
+    tableSize = size;
+    numLevels = jmax (1, findHighestSetBit ((uint32) size) - 1);
+
+    // Keep each level aligned, so that oscillators reading neighbouring phases share cache lines
+    stride = (tableSize + 1 + 15) & ~(size_t) 15;
+    data.allocate (stride * (size_t) numLevels, true);
+
+    FFT fft (findHighestSetBit ((uint32) size));
+    std::vector<float> spectrum (2 * size), buffer (2 * size);
+
+    for (size_t i = 0; i < size; ++i)
+        spectrum[i] = (float) singleCycle[i];
+
+    fft.performRealOnlyForwardTransform (spectrum.data());
+
+    for (int level = 0; level < numLevels; ++level)
+    {
+        // Remove all the harmonics above the limit for this level, from both the positive
+        // and negative halves of the spectrum
+        const auto numHarmonics = getNumHarmonics (level);
+        std::copy (spectrum.begin(), spectrum.end(), buffer.begin());
+
+        for (auto bin = numHarmonics + 1; bin < size - numHarmonics; ++bin)
+            buffer[2 * bin] = buffer[2 * bin + 1] = 0.0f;
+
+        fft.performRealOnlyInverseTransform (buffer.data());
+
+        auto* table = data.get() + (size_t) level * stride;
+
+        for (size_t i = 0; i < size; ++i)
+            table[i] = (FloatType) buffer[i];
+
+        table[size] = table[0];
+    }
+}
+
+template <typename FloatType>
+void BandLimitedWavetable<FloatType>::getSamples (int level, const FloatType* phases, FloatType* output, size_t numSamples) const noexcept
+{
+    jassert (isPositiveAndBelow (level, numLevels));
+
+    const auto* table = getLevelData (level);
+
+    FloatVectorOperations::multiply (output, phases, (FloatType) tableSize, numSamples);
+
+    for (size_t n = 0; n < numSamples; ++n)
+    {
+        const auto position = output[n];
+        jassert (isPositiveAndBelow (position, (FloatType) tableSize));
+
+        const auto i = static_cast<size_t> (position);
+        const auto x0 = table[i];
+        output[n] = x0 + (position - FloatType (i)) * (table[i + 1] - x0);
+    }
+}
+
+//==============================================================================
+template class BandLimitedWavetable<float>;
+template class BandLimitedWavetable<double>;
+
+} // namespace juce::dsp
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+/**
+    A set of band-limited versions of a single-cycle waveform, for alias-free
+    wavetable oscillators.
+
+    The table is built from one cycle of a waveform, and holds one "mipmap" level per
+    octave: level 0 contains all the harmonics that fit in the table, and each
+    following level contains half as many harmonics as the one before, down to a
+    single sine wave. An oscillator should read from the level returned by
+    getLevelForIncrement() for the frequency it's playing at, so that none of the
+    harmonics it plays are above Nyquist.
+
+    All the levels are stored one after the other in a single allocation, each followed
+    by a guard point, so that reading with linear interpolation never needs to wrap.
+
+    Example:
+
+        BandLimitedWavetable<float> saw ([] (float phase) { return 2.0f * phase - 1.0f; }, 2048);
+
+        auto increment = frequency / sampleRate;
+        auto level = saw.getLevelForIncrement (increment);
+
+        for (auto& sample : samples)
+        {
+            sample = saw.getSample (level, phase);
+            phase += increment;
+            phase -= std::floor (phase);
+        }
+
+    @see LookupTable
+
+    @tags{DSP}
+*/
+template <typename FloatType>
+class BandLimitedWavetable
+{
+public:
+    //==============================================================================
+    /** Creates an empty wavetable. You need to call initialise() before using it. */
+    BandLimitedWavetable() = default;
+
+    /** Creates and initialises a wavetable.
+
+        @param waveform     A function returning one cycle of the waveform, for phases
+                            between 0 and 1.
+        @param tableSize    The number of points in each level, which must be a power
+                            of two.
+    */
+    BandLimitedWavetable (const std::function<FloatType (FloatType)>& waveform, size_t tableSize);
+
+    /** Builds the table from a function returning one cycle of the waveform, for phases
+        between 0 and 1. The table size must be a power of two.
+    */
+    void initialise (const std::function<FloatType (FloatType)>& waveform, size_t tableSize);
+
+    /** Builds the table from an array holding one cycle of the waveform. The number of
+        samples must be a power of two.
+    */
+    void initialise (const FloatType* singleCycle, size_t tableSize);
+
+    //==============================================================================
+    /** Returns true if the wavetable is initialised and ready to be used. */
+    bool isInitialised() const noexcept                 { return numLevels > 0; }
+
+    /** Returns the number of points in each level. */
+    size_t getTableSize() const noexcept                { return tableSize; }
+
+    /** Returns the number of mipmap levels. */
+    int getNumLevels() const noexcept                   { return numLevels; }
+
+    /** Returns the highest harmonic contained in a level. */
+    size_t getNumHarmonics (int level) const noexcept   { return jmax ((size_t) 1, (tableSize / 2 - 1) >> level); }
+
+    /** Returns the level to use when the phase advances by the given proportion of a
+        cycle for each sample (i.e. frequency / sampleRate).
+    */
+    int getLevelForIncrement (FloatType phaseIncrement) const noexcept
+    {
+        const auto maxHarmonic = (FloatType) 0.5 / jmax (std::abs (phaseIncrement), std::numeric_limits<FloatType>::min());
+        int level = 0;
+
+        while (level < numLevels - 1 && (FloatType) getNumHarmonics (level) > maxHarmonic)
+            ++level;
+
+        return level;
+    }
+
+    //==============================================================================
+    /** Returns the linearly interpolated value of a level at the given phase, which must
+        be between 0 and 1.
+    */
+    FloatType getSample (int level, FloatType phase) const noexcept
+    {
+        jassert (isPositiveAndBelow (level, numLevels));
+        jassert (isPositiveAndBelow (phase, (FloatType) 1));
+
+        const auto* table = getLevelData (level);
+        const auto position = phase * (FloatType) tableSize;
+        const auto i = static_cast<size_t> (position);
+        const auto x0 = table[i];
+
+        return x0 + (position - FloatType (i)) * (table[i + 1] - x0);
+    }
+
+    /** Fills an array with the interpolated values of a level at an array of phases,
+        which must be between 0 and 1. The input and output arrays may be the same.
+    */
+    void getSamples (int level, const FloatType* phases, FloatType* output, size_t numSamples) const noexcept;
+
+   #if JUCE_USE_SIMD
+    /** Returns the interpolated values at a register of phases, where each element of the
+        register can read from a different level. This lets a synth render one voice per
+        element of the register.
+
+        @param levels   An array containing one level per element of the register.
+        @param phases   The phases to read, each of which must be between 0 and 1.
+    */
+    SIMDRegister<FloatType> getSamples (const int* levels, SIMDRegister<FloatType> phases) const noexcept
+    {
+        using Vec = SIMDRegister<FloatType>;
+
+        const auto positions = phases * (FloatType) tableSize;
+        const auto truncated = Vec::truncate (positions);
+        alignas (sizeof (Vec)) FloatType x0[Vec::SIMDNumElements], x1[Vec::SIMDNumElements];
+
+        for (size_t lane = 0; lane < Vec::size(); ++lane)
+        {
+            jassert (isPositiveAndBelow (levels[lane], numLevels));
+
+            const auto* table = getLevelData (levels[lane]) + static_cast<size_t> (truncated.get (lane));
+            x0[lane] = table[0];
+            x1[lane] = table[1];
+        }
+
+        const auto y0 = Vec::fromRawArray (x0);
+        return Vec::multiplyAdd (y0, positions - truncated, Vec::fromRawArray (x1) - y0);
+    }
+   #endif
+
+    /** Returns a pointer to the samples of a level. Each level contains getTableSize()
+        samples, followed by a copy of the first sample.
+    */
+    const FloatType* getLevelData (int level) const noexcept    { return data.get() + (size_t) level * stride; }
+
+private:
+    //==============================================================================
+    HeapBlock<FloatType> data;
+    size_t tableSize = 0, stride = 0;
+    int numLevels = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BandLimitedWavetable)
+};
+
+} // namespace juce::dsp
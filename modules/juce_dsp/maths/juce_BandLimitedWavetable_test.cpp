@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+class BandLimitedWavetableTests final : public UnitTest
+{
+public:
+    BandLimitedWavetableTests()
+        : UnitTest ("BandLimitedWavetable", UnitTestCategories::dsp)
+    {}
+
+    void runTest() override
+    {
+        constexpr size_t tableSize = 1024;
+
+        beginTest ("A sine wave is the same at every level");
+        {
+            BandLimitedWavetable<double> sine ([] (double phase) { return std::sin (MathConstants<double>::twoPi * phase); }, tableSize);
+
+            expectEquals (sine.getNumLevels(), 9);
+
+            for (int level = 0; level < sine.getNumLevels(); ++level)
+                for (auto phase = 0.0; phase < 1.0; phase += 0.0123)
+                    expectWithinAbsoluteError (sine.getSample (level, phase), std::sin (MathConstants<double>::twoPi * phase), 1.0e-4);
+        }
+
+        beginTest ("Levels don't contain harmonics above their limit");
+        {
+            BandLimitedWavetable<float> saw ([] (float phase) { return 2.0f * phase - 1.0f; }, tableSize);
+
+            for (auto increment : { 0.0001f, 0.003f, 0.01f, 0.1f, 0.3f })
+            {
+                const auto level = saw.getLevelForIncrement (increment);
+                expectLessOrEqual ((float) saw.getNumHarmonics (level) * increment, 0.5f);
+
+                if (level > 0)
+                    expectGreaterThan ((float) saw.getNumHarmonics (level - 1) * increment, 0.5f);
+            }
+
+            for (int level = 0; level < saw.getNumLevels(); ++level)
+            {
+                const auto* table = saw.getLevelData (level);
+
+                const auto harmonicMagnitude = [&] (size_t harmonic)
+                {
+                    std::complex<double> sum;
+
+                    for (size_t i = 0; i < tableSize; ++i)
+                        sum += (double) table[i] * std::polar (1.0, -MathConstants<double>::twoPi * (double) (harmonic * i) / (double) tableSize);
+
+                    return std::abs (sum) / (double) tableSize;
+                };
+
+                const auto limit = saw.getNumHarmonics (level);
+                expectGreaterThan (harmonicMagnitude (limit), 1.0e-4);
+                expectLessThan (harmonicMagnitude (limit + 1), 1.0e-5);
+            }
+        }
+
+       #if JUCE_USE_SIMD
+        beginTest ("Reading several levels at once matches reading them one by one");
+        {
+            using Vec = SIMDRegister<float>;
+
+            BandLimitedWavetable<float> square ([] (float phase) { return phase < 0.5f ? 1.0f : -1.0f; }, tableSize);
+
+            alignas (Vec::SIMDRegisterSize) float phases[Vec::size()];
+            int levels[Vec::size()];
+
+            for (size_t lane = 0; lane < Vec::size(); ++lane)
+            {
+                phases[lane] = (float) lane * 0.1234f;
+                levels[lane] = (int) lane % square.getNumLevels();
+            }
+
+            const auto result = square.getSamples (levels, Vec::fromRawArray (phases));
+
+            for (size_t lane = 0; lane < Vec::size(); ++lane)
+                expectWithinAbsoluteError (result.get (lane), square.getSample (levels[lane], phases[lane]), 1.0e-6f);
+        }
+       #endif
+    }
+};
+
+static BandLimitedWavetableTests bandLimitedWavetableTests;
+
+} // namespace juce::dsp
@@ -26,6 +26,9 @@
 namespace juce::dsp
 {
 
+template <typename SampleType>
+class AudioBlock;
+
 /**
     This class contains various fast mathematical function approximations.
 
@@ -57,8 +60,35 @@ struct FastMathApproximations
     template <typename FloatType>
     static void cosh (FloatType* values, size_t numValues) noexcept
     {
-        for (size_t i = 0; i < numValues; ++i)
-            values[i] = FastMathApproximations::cosh (values[i]);
+        applyToArray (values, numValues, [] (auto x) { return FastMathApproximations::cosh (x); });
+    }
+
+   #if JUCE_USE_SIMD
+    /** Provides a fast approximation of the function cosh(x) using a Pade approximant
+        continued fraction, calculated on every element of a SIMDRegister.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -5 and +5 for limiting the error.
+    */
+    template <typename FloatType>
+    static SIMDRegister<FloatType> cosh (SIMDRegister<FloatType> x) noexcept
+    {
+        auto x2 = x * x;
+        return polynomial (x2, -39251520, -18471600, -1075032, -14615)
+               / polynomial (x2, -39251520, 1154160, -16632, 127);
+    }
+   #endif
+
+    /** Provides a fast approximation of the function cosh(x) using a Pade approximant
+        continued fraction, calculated on every channel of an AudioBlock.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -5 and +5 for limiting the error.
+    */
+    template <typename SampleType>
+    static void cosh (const AudioBlock<SampleType>& block) noexcept
+    {
+        applyToBlock (block, [] (auto* values, size_t numValues) { FastMathApproximations::cosh (values, numValues); });
     }
 
     /** Provides a fast approximation of the function sinh(x) using a Pade approximant
@@ -85,8 +115,35 @@ struct FastMathApproximations
     template <typename FloatType>
     static void sinh (FloatType* values, size_t numValues) noexcept
     {
-        for (size_t i = 0; i < numValues; ++i)
-            values[i] = FastMathApproximations::sinh (values[i]);
+        applyToArray (values, numValues, [] (auto x) { return FastMathApproximations::sinh (x); });
+    }
+
+   #if JUCE_USE_SIMD
+    /** Provides a fast approximation of the function sinh(x) using a Pade approximant
+        continued fraction, calculated on every element of a SIMDRegister.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -5 and +5 for limiting the error.
+    */
+    template <typename FloatType>
+    static SIMDRegister<FloatType> sinh (SIMDRegister<FloatType> x) noexcept
+    {
+        auto x2 = x * x;
+        return x * polynomial (x2, -11511339840.0, -1640635920.0, -52785432, -479249)
+                 / polynomial (x2, -11511339840.0, 277920720, -3177720, 18361);
+    }
+   #endif
+
+    /** Provides a fast approximation of the function sinh(x) using a Pade approximant
+        continued fraction, calculated on every channel of an AudioBlock.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -5 and +5 for limiting the error.
+    */
+    template <typename SampleType>
+    static void sinh (const AudioBlock<SampleType>& block) noexcept
+    {
+        applyToBlock (block, [] (auto* values, size_t numValues) { FastMathApproximations::sinh (values, numValues); });
     }
 
     /** Provides a fast approximation of the function tanh(x) using a Pade approximant
@@ -113,8 +170,35 @@ struct FastMathApproximations
     template <typename FloatType>
     static void tanh (FloatType* values, size_t numValues) noexcept
     {
-        for (size_t i = 0; i < numValues; ++i)
-            values[i] = FastMathApproximations::tanh (values[i]);
+        applyToArray (values, numValues, [] (auto x) { return FastMathApproximations::tanh (x); });
+    }
+
+   #if JUCE_USE_SIMD
+    /** Provides a fast approximation of the function tanh(x) using a Pade approximant
+        continued fraction, calculated on every element of a SIMDRegister.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -5 and +5 for limiting the error.
+    */
+    template <typename FloatType>
+    static SIMDRegister<FloatType> tanh (SIMDRegister<FloatType> x) noexcept
+    {
+        auto x2 = x * x;
+        return x * polynomial (x2, 135135, 17325, 378, 1)
+                 / polynomial (x2, 135135, 62370, 3150, 28);
+    }
+   #endif
+
+    /** Provides a fast approximation of the function tanh(x) using a Pade approximant
+        continued fraction, calculated on every channel of an AudioBlock.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -5 and +5 for limiting the error.
+    */
+    template <typename SampleType>
+    static void tanh (const AudioBlock<SampleType>& block) noexcept
+    {
+        applyToBlock (block, [] (auto* values, size_t numValues) { FastMathApproximations::tanh (values, numValues); });
     }
 
     //==============================================================================
@@ -142,8 +226,35 @@ struct FastMathApproximations
     template <typename FloatType>
     static void cos (FloatType* values, size_t numValues) noexcept
     {
-        for (size_t i = 0; i < numValues; ++i)
-            values[i] = FastMathApproximations::cos (values[i]);
+        applyToArray (values, numValues, [] (auto x) { return FastMathApproximations::cos (x); });
+    }
+
+   #if JUCE_USE_SIMD
+    /** Provides a fast approximation of the function cos(x) using a Pade approximant
+        continued fraction, calculated on every element of a SIMDRegister.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -pi and +pi for limiting the error.
+    */
+    template <typename FloatType>
+    static SIMDRegister<FloatType> cos (SIMDRegister<FloatType> x) noexcept
+    {
+        auto x2 = x * x;
+        return polynomial (x2, 39251520, -18471600, 1075032, -14615)
+               / polynomial (x2, 39251520, 1154160, 16632, 127);
+    }
+   #endif
+
+    /** Provides a fast approximation of the function cos(x) using a Pade approximant
+        continued fraction, calculated on every channel of an AudioBlock.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -pi and +pi for limiting the error.
+    */
+    template <typename SampleType>
+    static void cos (const AudioBlock<SampleType>& block) noexcept
+    {
+        applyToBlock (block, [] (auto* values, size_t numValues) { FastMathApproximations::cos (values, numValues); });
     }
 
     /** Provides a fast approximation of the function sin(x) using a Pade approximant
@@ -170,8 +281,35 @@ struct FastMathApproximations
     template <typename FloatType>
     static void sin (FloatType* values, size_t numValues) noexcept
     {
-        for (size_t i = 0; i < numValues; ++i)
-            values[i] = FastMathApproximations::sin (values[i]);
+        applyToArray (values, numValues, [] (auto x) { return FastMathApproximations::sin (x); });
+    }
+
+   #if JUCE_USE_SIMD
+    /** Provides a fast approximation of the function sin(x) using a Pade approximant
+        continued fraction, calculated on every element of a SIMDRegister.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -pi and +pi for limiting the error.
+    */
+    template <typename FloatType>
+    static SIMDRegister<FloatType> sin (SIMDRegister<FloatType> x) noexcept
+    {
+        auto x2 = x * x;
+        return x * polynomial (x2, 11511339840.0, -1640635920.0, 52785432, -479249)
+                 / polynomial (x2, 11511339840.0, 277920720, 3177720, 18361);
+    }
+   #endif
+
+    /** Provides a fast approximation of the function sin(x) using a Pade approximant
+        continued fraction, calculated on every channel of an AudioBlock.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -pi and +pi for limiting the error.
+    */
+    template <typename SampleType>
+    static void sin (const AudioBlock<SampleType>& block) noexcept
+    {
+        applyToBlock (block, [] (auto* values, size_t numValues) { FastMathApproximations::sin (values, numValues); });
     }
 
     /** Provides a fast approximation of the function tan(x) using a Pade approximant
@@ -198,8 +336,35 @@ struct FastMathApproximations
     template <typename FloatType>
     static void tan (FloatType* values, size_t numValues) noexcept
     {
-        for (size_t i = 0; i < numValues; ++i)
-            values[i] = FastMathApproximations::tan (values[i]);
+        applyToArray (values, numValues, [] (auto x) { return FastMathApproximations::tan (x); });
+    }
+
+   #if JUCE_USE_SIMD
+    /** Provides a fast approximation of the function tan(x) using a Pade approximant
+        continued fraction, calculated on every element of a SIMDRegister.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -pi/2 and +pi/2 for limiting the error.
+    */
+    template <typename FloatType>
+    static SIMDRegister<FloatType> tan (SIMDRegister<FloatType> x) noexcept
+    {
+        auto x2 = x * x;
+        return x * polynomial (x2, -135135, 17325, -378, 1)
+                 / polynomial (x2, -135135, 62370, -3150, 28);
+    }
+   #endif
+
+    /** Provides a fast approximation of the function tan(x) using a Pade approximant
+        continued fraction, calculated on every channel of an AudioBlock.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -pi/2 and +pi/2 for limiting the error.
+    */
+    template <typename SampleType>
+    static void tan (const AudioBlock<SampleType>& block) noexcept
+    {
+        applyToBlock (block, [] (auto* values, size_t numValues) { FastMathApproximations::tan (values, numValues); });
     }
 
     //==============================================================================
@@ -226,8 +391,34 @@ struct FastMathApproximations
     template <typename FloatType>
     static void exp (FloatType* values, size_t numValues) noexcept
     {
-        for (size_t i = 0; i < numValues; ++i)
-            values[i] = FastMathApproximations::exp (values[i]);
+        applyToArray (values, numValues, [] (auto x) { return FastMathApproximations::exp (x); });
+    }
+
+   #if JUCE_USE_SIMD
+    /** Provides a fast approximation of the function exp(x) using a Pade approximant
+        continued fraction, calculated on every element of a SIMDRegister.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -6 and +4 for limiting the error.
+    */
+    template <typename FloatType>
+    static SIMDRegister<FloatType> exp (SIMDRegister<FloatType> x) noexcept
+    {
+        return polynomial (x, 1680, 840, 180, 20, 1)
+               / polynomial (x, 1680, -840, 180, -20, 1);
+    }
+   #endif
+
+    /** Provides a fast approximation of the function exp(x) using a Pade approximant
+        continued fraction, calculated on every channel of an AudioBlock.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -6 and +4 for limiting the error.
+    */
+    template <typename SampleType>
+    static void exp (const AudioBlock<SampleType>& block) noexcept
+    {
+        applyToBlock (block, [] (auto* values, size_t numValues) { FastMathApproximations::exp (values, numValues); });
     }
 
     /** Provides a fast approximation of the function log(x+1) using a Pade approximant
@@ -252,10 +443,201 @@ struct FastMathApproximations
     */
     template <typename FloatType>
     static void logNPlusOne (FloatType* values, size_t numValues) noexcept
+    {
+        applyToArray (values, numValues, [] (auto x) { return FastMathApproximations::logNPlusOne (x); });
+    }
+
+   #if JUCE_USE_SIMD
+    /** Provides a fast approximation of the function log(x+1) using a Pade approximant
+        continued fraction, calculated on every element of a SIMDRegister.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -0.8 and +5 for limiting the error.
+    */
+    template <typename FloatType>
+    static SIMDRegister<FloatType> logNPlusOne (SIMDRegister<FloatType> x) noexcept
+    {
+        return x * polynomial (x, 7560, 15120, 9870, 2310, 137)
+                 / polynomial (x, 7560, 18900, 16800, 6300, 900, 30);
+    }
+   #endif
+
+    /** Provides a fast approximation of the function log(x+1) using a Pade approximant
+        continued fraction, calculated on every channel of an AudioBlock.
+
+        Note: This is an approximation which works on a limited range. You are
+        advised to use input values only between -0.8 and +5 for limiting the error.
+    */
+    template <typename SampleType>
+    static void logNPlusOne (const AudioBlock<SampleType>& block) noexcept
+    {
+        applyToBlock (block, [] (auto* values, size_t numValues) { FastMathApproximations::logNPlusOne (values, numValues); });
+    }
+
+    //==============================================================================
+    /** Provides a fast approximation of the function log2(x), calculated sample by sample.
+
+        The exponent is read directly from the floating point representation, and only the
+        mantissa is approximated by a polynomial, so unlike the approximants above this works
+        over the whole range of positive normal numbers. The absolute error of the
+        approximation is less than 4e-7, on top of the rounding error of FloatType.
+
+        Note: Zero, negative, denormal and non-finite inputs give meaningless results.
+    */
+    template <typename FloatType>
+    static FloatType log2 (FloatType x) noexcept
+    {
+        using Traits = FloatTraits<FloatType>;
+
+        auto bits = Traits::toBits (x);
+        const auto exponent = (FloatType) ((typename Traits::SignedBits) (bits >> Traits::mantissaBits) - Traits::exponentBias);
+        const auto t = Traits::fromBits ((bits & Traits::mantissaMask) | Traits::exponentOfOne) - 1;
+
+        return exponent + t * ((FloatType) 1.442664050683737
+                             + t * ((FloatType) -0.7205155920431597
+                             + t * ((FloatType) 0.4731138286199253
+                             + t * ((FloatType) -0.324617777612139
+                             + t * ((FloatType) 0.19238710028044226
+                             + t * ((FloatType) -0.07815969169213172
+                             + t * (FloatType) 0.015128338170021885))))));
+    }
+
+    /** Provides a fast approximation of the function log2(x), calculated on a whole buffer.
+
+        This applies the sample by sample approximation to each value in turn. Unlike the
+        approximants above there's no SIMDRegister version, because SIMDRegister has no
+        integer shifts or conversions with which to read the exponent.
+
+        The absolute error of the approximation is less than 4e-7, on top of the rounding
+        error of FloatType.
+
+        Note: Zero, negative, denormal and non-finite inputs give meaningless results.
+    */
+    template <typename FloatType>
+    static void log2 (FloatType* values, size_t numValues) noexcept
+    {
+        for (size_t i = 0; i < numValues; ++i)
+            values[i] = FastMathApproximations::log2 (values[i]);
+    }
+
+    /** Provides a fast approximation of the function 2^x, calculated sample by sample.
+
+        The integer part of x is written directly into the exponent of the result, and only
+        the fractional part is approximated by a polynomial. The relative error of the
+        approximation is less than 3e-9, on top of the rounding error of FloatType. Inputs are
+        clamped so that the result is always a normal number.
+    */
+    template <typename FloatType>
+    static FloatType exp2 (FloatType x) noexcept
+    {
+        using Traits = FloatTraits<FloatType>;
+
+        x = jmax ((FloatType) (1 - Traits::exponentBias), jmin ((FloatType) Traits::exponentBias, x));
+
+        auto integer = (typename Traits::SignedBits) x;
+        integer -= x < (FloatType) integer ? 1 : 0;
+
+        const auto f = x - (FloatType) integer;
+        const auto fraction = 1 + f * ((FloatType) 0.6931470010113541
+                                + f * ((FloatType) 0.24022992409452462
+                                + f * ((FloatType) 0.055482406449883614
+                                + f * ((FloatType) 0.009681281975402493
+                                + f * ((FloatType) 0.0012414198781509679
+                                + f * (FloatType) 0.00021796369175135216)))));
+
+        return Traits::fromBits (Traits::toBits (fraction) + ((typename Traits::Bits) integer << Traits::mantissaBits));
+    }
+
+    /** Provides a fast approximation of the function 2^x, calculated on a whole buffer.
+
+        This applies the sample by sample approximation to each value in turn. Unlike the
+        approximants above there's no SIMDRegister version, because SIMDRegister has no
+        integer shifts or conversions with which to write the exponent.
+
+        The relative error of the approximation is less than 3e-9, on top of the rounding
+        error of FloatType. Inputs are clamped so that the results are always normal numbers.
+    */
+    template <typename FloatType>
+    static void exp2 (FloatType* values, size_t numValues) noexcept
     {
         for (size_t i = 0; i < numValues; ++i)
-            values[i] = FastMathApproximations::logNPlusOne (values[i]);
+            values[i] = FastMathApproximations::exp2 (values[i]);
     }
+
+private:
+    //==============================================================================
+    template <typename FloatType, typename Function>
+    static void applyToArray (FloatType* values, size_t numValues, Function&& function) noexcept
+    {
+        auto* end = values + numValues;
+
+       #if JUCE_USE_SIMD
+        if constexpr (std::is_same_v<FloatType, float> || std::is_same_v<FloatType, double>)
+        {
+            using Vec = SIMDRegister<FloatType>;
+
+            for (auto* aligned = jmin (Vec::getNextSIMDAlignedPtr (values), end); values < aligned; ++values)
+                *values = function (*values);
+
+            for (; values + Vec::size() <= end; values += Vec::size())
+                function (Vec::fromRawArray (values)).copyToRawArray (values);
+        }
+       #endif
+
+        for (; values < end; ++values)
+            *values = function (*values);
+    }
+
+    template <typename SampleType, typename Function>
+    static void applyToBlock (const AudioBlock<SampleType>& block, Function&& function) noexcept
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            function (block.getChannelPointer (channel), block.getNumSamples());
+    }
+
+   #if JUCE_USE_SIMD
+    // Evaluates c0 + x * (c1 + x * (c2 + ...)) using multiply-adds
+    template <typename FloatType, typename... Coefficients>
+    static SIMDRegister<FloatType> polynomial (SIMDRegister<FloatType> x, double c0, Coefficients... coefficients) noexcept
+    {
+        using Vec = SIMDRegister<FloatType>;
+
+        if constexpr (sizeof... (coefficients) == 0)
+            return Vec::expand ((FloatType) c0);
+        else
+            return Vec::multiplyAdd (Vec::expand ((FloatType) c0), x, polynomial (x, coefficients...));
+    }
+   #endif
+
+    //==============================================================================
+    template <typename FloatType>
+    struct FloatTraits
+    {
+        static_assert (std::is_same_v<FloatType, float> || std::is_same_v<FloatType, double>,
+                       "Only IEEE-754 single and double precision types are supported");
+
+        using Bits       = std::conditional_t<std::is_same_v<FloatType, float>, uint32, uint64>;
+        using SignedBits = std::conditional_t<std::is_same_v<FloatType, float>, int32, int64>;
+
+        static constexpr int mantissaBits = std::numeric_limits<FloatType>::digits - 1;
+        static constexpr SignedBits exponentBias = std::numeric_limits<FloatType>::max_exponent - 1;
+        static constexpr Bits mantissaMask  = ((Bits) 1 << mantissaBits) - 1;
+        static constexpr Bits exponentOfOne = (Bits) exponentBias << mantissaBits;
+
+        static Bits toBits (FloatType value) noexcept
+        {
+            Bits result;
+            std::memcpy (&result, &value, sizeof (result));
+            return result;
+        }
+
+        static FloatType fromBits (Bits bits) noexcept
+        {
+            FloatType result;
+            std::memcpy (&result, &bits, sizeof (result));
+            return result;
+        }
+    };
 };
 
 } // namespace juce::dsp
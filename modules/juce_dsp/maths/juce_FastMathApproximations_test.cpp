@@ -0,0 +1,265 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+namespace FastMathApproximationsTestHelpers
+{
+    // Calls a callback for each of the approximations, with the equivalent
+    // standard library function and the range it's designed for
+    template <typename FloatType, typename Callback>
+    static void forEachFunction (Callback&& callback)
+    {
+        constexpr auto pi = MathConstants<FloatType>::pi;
+
+        #define JUCE_FAST_MATH_FUNCTION(name, reference, start, end) \
+            callback (#name, (FloatType) (start), (FloatType) (end), \
+                      [] (FloatType x) { return reference (x); }, \
+                      [] (auto x) { return FastMathApproximations::name (x); }, \
+                      [] (FloatType* values, size_t numValues) { FastMathApproximations::name (values, numValues); });
+
+        JUCE_FAST_MATH_FUNCTION (cosh,        std::cosh,  -5, 5)
+        JUCE_FAST_MATH_FUNCTION (sinh,        std::sinh,  -5, 5)
+        JUCE_FAST_MATH_FUNCTION (tanh,        std::tanh,  -5, 5)
+        JUCE_FAST_MATH_FUNCTION (cos,         std::cos,   -pi, pi)
+        JUCE_FAST_MATH_FUNCTION (sin,         std::sin,   -pi, pi)
+        JUCE_FAST_MATH_FUNCTION (tan,         std::tan,   -pi / 2 + (FloatType) 0.01, pi / 2 - (FloatType) 0.01)
+        JUCE_FAST_MATH_FUNCTION (exp,         std::exp,   -6, 4)
+        JUCE_FAST_MATH_FUNCTION (logNPlusOne, std::log1p, -0.8, 5)
+        JUCE_FAST_MATH_FUNCTION (log2,        std::log2,  0.001, 1000)
+        JUCE_FAST_MATH_FUNCTION (exp2,        std::exp2,  -10, 10)
+
+        #undef JUCE_FAST_MATH_FUNCTION
+    }
+
+    template <typename FloatType>
+    static std::vector<FloatType> makeRamp (FloatType start, FloatType end, size_t numValues)
+    {
+        std::vector<FloatType> result (numValues);
+
+        for (size_t i = 0; i < numValues; ++i)
+            result[i] = start + (end - start) * (FloatType) i / (FloatType) (numValues - 1);
+
+        return result;
+    }
+}
+
+//==============================================================================
+struct FastMathApproximationsTests final : public UnitTest
+{
+    FastMathApproximationsTests()
+        : UnitTest ("FastMathApproximations", UnitTestCategories::dsp)
+    {}
+
+    template <typename FloatType>
+    void expectArrayVersionsMatchScalarVersions()
+    {
+        using namespace FastMathApproximationsTestHelpers;
+
+        forEachFunction<FloatType> ([this] (const char* functionName, FloatType start, FloatType end, auto, auto scalar, auto array)
+        {
+            // An odd length and offset so that the unaligned start and end are used
+            const auto ramp = makeRamp (start, end, 1001);
+
+            for (auto offset : std::initializer_list<size_t> { 0, 1 })
+            {
+                auto values = ramp;
+                array (values.data() + offset, values.size() - offset);
+
+                auto maxError = (FloatType) 0;
+
+                for (auto i = offset; i < values.size(); ++i)
+                    maxError = jmax (maxError, std::abs (values[i] - scalar (ramp[i])) / jmax ((FloatType) 1, std::abs (values[i])));
+
+                expect (maxError < (FloatType) 1.0e-5, String (functionName) + ": " + String (maxError));
+            }
+        });
+    }
+
+    template <typename FloatType>
+    void expectLog2AndExp2AreAccurate()
+    {
+        constexpr auto epsilon = (double) std::numeric_limits<FloatType>::epsilon();
+        constexpr auto maxExponent = std::numeric_limits<FloatType>::max_exponent - 1;
+        constexpr auto stepsPerOctave = 64;
+
+        auto maxLog2Error = 0.0, maxExp2Error = 0.0;
+
+        // Several values in every octave of the normal range
+        for (int exponent = 1 - maxExponent; exponent < maxExponent; ++exponent)
+        {
+            for (int step = 0; step < stepsPerOctave; ++step)
+            {
+                const auto x = std::ldexp ((FloatType) 1 + (FloatType) step / (FloatType) stepsPerOctave, exponent);
+                const auto expected = std::log2 ((double) x);
+
+                // The absolute error of the approximation, plus the rounding error of the result
+                maxLog2Error = jmax (maxLog2Error, std::abs ((double) FastMathApproximations::log2 (x) - expected)
+                                                     / (4.0e-7 + 4.0 * epsilon * std::abs (expected)));
+            }
+        }
+
+        for (int i = (1 - maxExponent) * stepsPerOctave; i < maxExponent * stepsPerOctave; ++i)
+        {
+            const auto x = (FloatType) i / (FloatType) stepsPerOctave + (FloatType) 0.3 / (FloatType) stepsPerOctave;
+            const auto expected = std::exp2 ((double) x);
+
+            // The relative error of the approximation, plus a few rounding errors
+            maxExp2Error = jmax (maxExp2Error, std::abs ((double) FastMathApproximations::exp2 (x) - expected)
+                                                 / (expected * (3.0e-9 + 4.0 * epsilon)));
+        }
+
+        expectLessThan (maxLog2Error, 1.0);
+        expectLessThan (maxExp2Error, 1.0);
+
+        // Inputs outside the range are clamped, so the results stay normal
+        expect (std::isnormal (FastMathApproximations::exp2 ((FloatType) -100000)));
+        expect (std::isnormal (FastMathApproximations::exp2 ((FloatType) 100000)));
+    }
+
+    void runTest() override
+    {
+        beginTest ("log2 and exp2 are accurate across the whole range of normal numbers");
+        {
+            expectLog2AndExp2AreAccurate<float>();
+            expectLog2AndExp2AreAccurate<double>();
+        }
+
+        beginTest ("Array and SIMD versions match the scalar versions");
+        {
+            expectArrayVersionsMatchScalarVersions<float>();
+            expectArrayVersionsMatchScalarVersions<double>();
+        }
+
+        beginTest ("AudioBlock versions process every channel");
+        {
+            AudioBuffer<float> buffer (3, 37);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    buffer.setSample (channel, i, (float) (i - 18) * 0.2f + (float) channel);
+
+            AudioBuffer<float> expected (buffer);
+            FastMathApproximations::tanh (AudioBlock<float> (buffer));
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    expectWithinAbsoluteError (buffer.getSample (channel, i),
+                                               FastMathApproximations::tanh (expected.getSample (channel, i)),
+                                               1.0e-6f);
+        }
+    }
+};
+
+static FastMathApproximationsTests fastMathApproximationsTests;
+
+//==============================================================================
+struct FastMathApproximationsBenchmark final : public UnitTest
+{
+    FastMathApproximationsBenchmark()
+        : UnitTest ("FastMathApproximations Benchmark", UnitTestCategories::benchmarks)
+    {}
+
+    template <typename Callback>
+    static double timeInNanosecondsPerValue (size_t numValues, Callback&& callback)
+    {
+        constexpr int numRepeats = 200;
+        auto start = Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numRepeats; ++i)
+            callback();
+
+        return Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start) * 1.0e9 / (numRepeats * (double) numValues);
+    }
+
+    template <typename FloatType>
+    void logTable (const String& typeName)
+    {
+        using namespace FastMathApproximationsTestHelpers;
+
+        logMessage (typeName + ": function, max error (relative when above 1), ns/value for std, scalar approximation, array approximation");
+
+        forEachFunction<FloatType> ([this] (const char* functionName, FloatType start, FloatType end, auto reference, auto scalar, auto array)
+        {
+            constexpr size_t numValues = 4096;
+            const auto ramp = makeRamp (start, end, numValues);
+            auto values = ramp;
+
+            array (values.data(), numValues);
+
+            auto maxError = 0.0;
+
+            for (size_t i = 0; i < numValues; ++i)
+            {
+                auto expected = (double) reference (ramp[i]);
+                maxError = jmax (maxError, std::abs ((double) values[i] - expected) / jmax (1.0, std::abs (expected)));
+            }
+
+            // The sum is only there to stop the loops being optimised away
+            auto sum = (FloatType) 0;
+
+            auto referenceTime = timeInNanosecondsPerValue (numValues, [&]
+            {
+                for (auto x : ramp)
+                    sum += reference (x);
+            });
+
+            auto scalarTime = timeInNanosecondsPerValue (numValues, [&]
+            {
+                for (auto x : ramp)
+                    sum += scalar (x);
+            });
+
+            auto arrayTime = timeInNanosecondsPerValue (numValues, [&]
+            {
+                std::copy (ramp.begin(), ramp.end(), values.begin());
+                array (values.data(), numValues);
+                sum += values[0];
+            });
+
+            logMessage (String (functionName).paddedRight (' ', 12)
+                        + String (maxError, 9).paddedLeft (' ', 14)
+                        + String (referenceTime, 3).paddedLeft (' ', 10)
+                        + String (scalarTime, 3).paddedLeft (' ', 10)
+                        + String (arrayTime, 3).paddedLeft (' ', 10));
+
+            expect (std::isfinite (sum));
+        });
+    }
+
+    void runTest() override
+    {
+        beginTest ("Accuracy and throughput");
+
+        logTable<float> ("float");
+        logTable<double> ("double");
+    }
+};
+
+static FastMathApproximationsBenchmark fastMathApproximationsBenchmark;
+
+} // namespace juce::dsp
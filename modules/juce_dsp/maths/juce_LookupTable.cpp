@@ -143,6 +143,90 @@ double LookupTableTransform<FloatType>::calculateRelativeDifference (double x, d
     return absDiff / std::min (absX, absY);
 }
 
+//==============================================================================
+template <typename FloatType>
+void LookupTableTransform2D<FloatType>::initialise (const std::function<FloatType (FloatType, FloatType)>& functionToApproximate,
+                                                    FloatType minX, FloatType maxX, size_t numPointsX,
+                                                    FloatType minY, FloatType maxY, size_t numPointsY)
+{
+    jassert (maxX > minX && maxY > minY);
+    jassert (numPointsX > 1 && numPointsY > 1);
+
+    numX = numPointsX;
+    numY = numPointsY;
+    minInputX = minX;
+    maxInputX = maxX;
+
+    scalerX = FloatType (numX - 1) / (maxX - minX);
+    offsetX = -minX * scalerX;
+    scalerY = FloatType (numY - 1) / (maxY - minY);
+    offsetY = -minY * scalerY;
+
+    // Each row has a guard point at the end, and there's a guard row at the end, so that
+    // the interpolation never needs to check whether it's reading past the last point
+    rowSize = numX + 1;
+    data.resize (static_cast<int> (rowSize * (numY + 1)));
+
+    for (size_t row = 0; row < numY; ++row)
+    {
+        const auto y = jlimit (minY, maxY, jmap (FloatType (row), FloatType (0), FloatType (numY - 1), minY, maxY));
+
+        for (size_t column = 0; column < numX; ++column)
+        {
+            const auto x = jlimit (minX, maxX, jmap (FloatType (column), FloatType (0), FloatType (numX - 1), minX, maxX));
+            const auto value = functionToApproximate (x, y);
+
+            jassert (! std::isnan (value));
+            jassert (! std::isinf (value));
+
+            data.getReference (static_cast<int> (row * rowSize + column)) = value;
+        }
+
+        data.getReference (static_cast<int> (row * rowSize + numX)) = data.getUnchecked (static_cast<int> (row * rowSize + numX - 1));
+    }
+
+    for (size_t column = 0; column < rowSize; ++column)
+        data.getReference (static_cast<int> (numY * rowSize + column)) = data.getUnchecked (static_cast<int> ((numY - 1) * rowSize + column));
+}
+
+template <typename FloatType>
+void LookupTableTransform2D<FloatType>::process (const FloatType* input, FloatType* output,
+                                                 size_t numSamples, FloatType y) const noexcept
+{
+    jassert (isInitialised());  // Use the non-default constructor or call initialise() before first use
+
+    const auto yIndex = jlimit (FloatType(), FloatType (numY - 1), scalerY * y + offsetY);
+    const auto yi = static_cast<size_t> (yIndex);
+    const auto yf = yIndex - FloatType (yi);
+
+    const auto* row0 = data.begin() + yi * rowSize;
+    const auto* row1 = row0 + rowSize;
+
+    FloatVectorOperations::clip (output, input, minInputX, maxInputX, numSamples);
+    FloatVectorOperations::multiply (output, scalerX, numSamples);
+    FloatVectorOperations::add (output, offsetX, numSamples);
+
+    for (size_t n = 0; n < numSamples; ++n)
+    {
+        const auto index = output[n];
+        const auto i = static_cast<size_t> (index);
+        const auto f = index - FloatType (i);
+
+        const auto a = row0[i] + f * (row0[i + 1] - row0[i]);
+        const auto b = row1[i] + f * (row1[i + 1] - row1[i]);
+
+        output[n] = a + yf * (b - a);
+    }
+}
+
+template <typename FloatType>
+void LookupTableTransform2D<FloatType>::process (const FloatType* inputX, const FloatType* inputY,
+                                                 FloatType* output, size_t numSamples) const noexcept
+{
+    for (size_t n = 0; n < numSamples; ++n)
+        output[n] = processSample (inputX[n], inputY[n]);
+}
+
 //==============================================================================
 template class LookupTable<float>;
 template class LookupTable<double>;
@@ -150,4 +234,7 @@ template class LookupTable<double>;
 template class LookupTableTransform<float>;
 template class LookupTableTransform<double>;
 
+template class LookupTableTransform2D<float>;
+template class LookupTableTransform2D<double>;
+
 } // namespace juce::dsp
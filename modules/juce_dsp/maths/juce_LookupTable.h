@@ -128,6 +128,62 @@ public:
         return getUnchecked (index);
     }
 
+    //==============================================================================
+    /** Calculates the approximated values for an array of indices without range checking.
+
+        The input and output arrays may be the same.
+
+        @see getUnchecked
+    */
+    void getUnchecked (const FloatType* indices, FloatType* output, size_t numValues) const noexcept
+    {
+        jassert (isInitialised());  // Use the non-default constructor or call initialise() before first use
+
+        const auto* table = data.begin();
+
+        for (size_t n = 0; n < numValues; ++n)
+        {
+            const auto index = indices[n];
+            jassert (isPositiveAndBelow (index, FloatType (getNumPoints())));
+
+            const auto i = static_cast<size_t> (index);
+            const auto x0 = table[i];
+            output[n] = x0 + (index - FloatType (i)) * (table[i + 1] - x0);
+        }
+    }
+
+   #if JUCE_USE_SIMD
+    /** Calculates the approximated values for a register of indices without range checking.
+
+        The interpolation is done on all the elements of the register at once; only the
+        loading of the table entries is done element by element.
+
+        @see getUnchecked
+    */
+    SIMDRegister<FloatType> getUnchecked (SIMDRegister<FloatType> index) const noexcept
+    {
+        using Vec = SIMDRegister<FloatType>;
+
+        jassert (isInitialised());  // Use the non-default constructor or call initialise() before first use
+
+        const auto truncated = Vec::truncate (index);
+        const auto* table = data.begin();
+        alignas (sizeof (Vec)) FloatType x0[Vec::SIMDNumElements], x1[Vec::SIMDNumElements];
+
+        for (size_t lane = 0; lane < Vec::size(); ++lane)
+        {
+            const auto i = static_cast<size_t> (truncated.get (lane));
+            jassert (i < getNumPoints());
+
+            x0[lane] = table[i];
+            x1[lane] = table[i + 1];
+        }
+
+        const auto y0 = Vec::fromRawArray (x0);
+        return Vec::multiplyAdd (y0, index - truncated, Vec::fromRawArray (x1) - y0);
+    }
+   #endif
+
     //==============================================================================
     /** @see getUnchecked */
     FloatType operator[] (FloatType index) const noexcept       { return getUnchecked (index); }
@@ -256,6 +312,30 @@ public:
         return lookupTable[index];
     }
 
+   #if JUCE_USE_SIMD
+    /** Calculates the approximated values for a register of input values without range
+        checking.
+
+        @see processSampleUnchecked
+    */
+    SIMDRegister<FloatType> processSampleUnchecked (SIMDRegister<FloatType> value) const noexcept
+    {
+        return lookupTable.getUnchecked (SIMDRegister<FloatType>::multiplyAdd (SIMDRegister<FloatType>::expand (offset),
+                                                                               value,
+                                                                               SIMDRegister<FloatType>::expand (scaler)));
+    }
+
+    /** Calculates the approximated values for a register of input values with range checking.
+
+        @see processSample
+    */
+    SIMDRegister<FloatType> processSample (SIMDRegister<FloatType> value) const noexcept
+    {
+        using Vec = SIMDRegister<FloatType>;
+        return processSampleUnchecked (Vec::min (Vec::expand (maxInputValue), Vec::max (Vec::expand (minInputValue), value)));
+    }
+   #endif
+
     //==============================================================================
     /** @see processSampleUnchecked */
     FloatType operator[] (FloatType index) const noexcept       { return processSampleUnchecked (index); }
@@ -269,8 +349,12 @@ public:
     */
     void processUnchecked (const FloatType* input, FloatType* output, size_t numSamples) const noexcept
     {
-        for (size_t i = 0; i < numSamples; ++i)
-            output[i] = processSampleUnchecked (input[i]);
+        // The indices are calculated for the whole block first, so that both passes
+        // can be vectorised
+        FloatVectorOperations::multiply (output, input, scaler, numSamples);
+        FloatVectorOperations::add (output, offset, numSamples);
+
+        lookupTable.getUnchecked (output, output, numSamples);
     }
 
     //==============================================================================
@@ -279,8 +363,8 @@ public:
     */
     void process (const FloatType* input, FloatType* output, size_t numSamples) const noexcept
     {
-        for (size_t i = 0; i < numSamples; ++i)
-            output[i] = processSample (input[i]);
+        FloatVectorOperations::clip (output, input, minInputValue, maxInputValue, numSamples);
+        processUnchecked (output, output, numSamples);
     }
 
     //==============================================================================
@@ -324,4 +408,117 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LookupTableTransform)
 };
 
+
+//==============================================================================
+/** Class for approximating expensive functions of two variables, using bilinear
+    interpolation between pre-calculated values.
+
+    This is typically used for waveshapers where the second variable is a drive or
+    shape parameter, which usually only changes once per block:
+
+        LookupTableTransform2D<float> shaper ([] (float x, float drive) { return std::tanh (x * drive); },
+                                              -1.0f, 1.0f, 256,
+                                               1.0f, 10.0f, 32);
+
+        shaper.process (input, output, numSamples, currentDrive);
+
+    Each row of the table holds all the values for one value of the second variable,
+    so processing a block with a fixed second variable only touches two rows.
+
+    Note: If you try to call the function with inputs outside the provided ranges,
+    they will be clipped to those ranges.
+
+    @see LookupTableTransform
+
+    @tags{DSP}
+*/
+template <typename FloatType>
+class LookupTableTransform2D
+{
+public:
+    //==============================================================================
+    /** Creates an uninitialised LookupTableTransform2D object.
+
+        You need to call initialise() before using the object. Prefer using the
+        non-default constructor instead.
+
+        @see initialise
+    */
+    LookupTableTransform2D() = default;
+
+    /** Creates and initialises a LookupTableTransform2D object.
+
+        @param functionToApproximate The function to be approximated. This should be a
+                                     mapping from two FloatTypes to FloatType.
+        @param minX                  The lowest value of the first input.
+        @param maxX                  The highest value of the first input.
+        @param numPointsX            The number of pre-calculated values along the first input.
+        @param minY                  The lowest value of the second input.
+        @param maxY                  The highest value of the second input.
+        @param numPointsY            The number of pre-calculated values along the second input.
+    */
+    LookupTableTransform2D (const std::function<FloatType (FloatType, FloatType)>& functionToApproximate,
+                            FloatType minX, FloatType maxX, size_t numPointsX,
+                            FloatType minY, FloatType maxY, size_t numPointsY)
+    {
+        initialise (functionToApproximate, minX, maxX, numPointsX, minY, maxY, numPointsY);
+    }
+
+    /** Initialises or changes the parameters of a LookupTableTransform2D object.
+
+        @see LookupTableTransform2D
+    */
+    void initialise (const std::function<FloatType (FloatType, FloatType)>& functionToApproximate,
+                     FloatType minX, FloatType maxX, size_t numPointsX,
+                     FloatType minY, FloatType maxY, size_t numPointsY);
+
+    /** Returns true if the table is initialised and ready to be used. */
+    bool isInitialised() const noexcept                     { return ! data.isEmpty(); }
+
+    //==============================================================================
+    /** Calculates the approximated value for the given inputs with range checking. */
+    FloatType processSample (FloatType x, FloatType y) const noexcept
+    {
+        jassert (isInitialised());  // Use the non-default constructor or call initialise() before first use
+
+        const auto xIndex = jlimit (FloatType(), FloatType (numX - 1), scalerX * x + offsetX);
+        const auto yIndex = jlimit (FloatType(), FloatType (numY - 1), scalerY * y + offsetY);
+
+        const auto xi = static_cast<size_t> (xIndex);
+        const auto yi = static_cast<size_t> (yIndex);
+        const auto xf = xIndex - FloatType (xi);
+        const auto yf = yIndex - FloatType (yi);
+
+        const auto* row0 = data.begin() + yi * rowSize;
+        const auto* row1 = row0 + rowSize;
+
+        const auto a = row0[xi] + xf * (row0[xi + 1] - row0[xi]);
+        const auto b = row1[xi] + xf * (row1[xi + 1] - row1[xi]);
+
+        return a + yf * (b - a);
+    }
+
+    /** @see processSample */
+    FloatType operator() (FloatType x, FloatType y) const noexcept      { return processSample (x, y); }
+
+    //==============================================================================
+    /** Processes an array of values for the first input, using the same value of the
+        second input for the whole array. The input and output arrays may be the same.
+    */
+    void process (const FloatType* input, FloatType* output, size_t numSamples, FloatType y) const noexcept;
+
+    /** Processes an array of values for both inputs. The input and output arrays may
+        be the same.
+    */
+    void process (const FloatType* inputX, const FloatType* inputY, FloatType* output, size_t numSamples) const noexcept;
+
+private:
+    //==============================================================================
+    Array<FloatType> data;
+    size_t numX = 0, numY = 0, rowSize = 0;
+    FloatType minInputX {}, maxInputX {}, scalerX {}, offsetX {}, scalerY {}, offsetY {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LookupTableTransform2D)
+};
+
 } // namespace juce::dsp
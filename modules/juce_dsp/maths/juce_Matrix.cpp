@@ -26,6 +26,215 @@
 namespace juce::dsp
 {
 
+namespace MatrixHelpers
+{
+    template <typename ElementType>
+    static void multiplyDirect (const ElementType* a, const ElementType* b, ElementType* dst,
+                                size_t n, size_t p, size_t m) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t k = 0; k < p; ++k)
+            {
+                auto ak = a[i * p + k];
+                auto* bk = b + k * m;
+
+                for (size_t j = 0; j < m; ++j)
+                    dst[j] += ak * bk[j];
+            }
+
+            dst += m;
+        }
+    }
+
+   #if JUCE_USE_SIMD
+    /*  A blocked matrix product, in the style of BLIS/GotoBLAS.
+
+        The right-hand matrix is copied a kBlock x nBlock panel at a time into
+        SIMD registers, and the left-hand one an mBlock x kBlock panel at a time,
+        so that both are read contiguously by the kernel. The kernel computes a
+        tile of tileRows x tileColumns results which stays in registers for the
+        whole depth of the panel.
+    */
+    template <typename ElementType>
+    struct BlockedMultiply
+    {
+        using Vec = SIMDRegister<ElementType>;
+
+        static constexpr size_t vecSize = Vec::SIMDNumElements;
+        static constexpr size_t tileRows = 4, tileVecs = 2, tileColumns = tileVecs * vecSize;
+        static constexpr size_t mBlock = 64, kBlock = 256, nBlock = 256;
+
+        static bool isWorthUsing (size_t n, size_t p, size_t m) noexcept
+        {
+            return n >= tileRows && m >= tileColumns && n * p * m >= 16 * 16 * 16;
+        }
+
+        static void multiply (const ElementType* a, const ElementType* b, ElementType* dst,
+                              size_t n, size_t p, size_t m)
+        {
+            auto maxDepth = jmin (kBlock, p);
+            std::vector<Vec> packedB (maxDepth * roundUp (jmin (nBlock, m), tileColumns) / vecSize);
+            std::vector<ElementType> packedA (maxDepth * roundUp (jmin (mBlock, n), tileRows));
+
+            for (size_t j0 = 0; j0 < m; j0 += nBlock)
+            {
+                auto numColumns = jmin (nBlock, m - j0);
+                auto numColumnTiles = (numColumns + tileColumns - 1) / tileColumns;
+
+                for (size_t k0 = 0; k0 < p; k0 += kBlock)
+                {
+                    auto depth = jmin (kBlock, p - k0);
+                    packRight (b + k0 * m + j0, m, depth, numColumns, packedB.data());
+
+                    for (size_t i0 = 0; i0 < n; i0 += mBlock)
+                    {
+                        auto numRows = jmin (mBlock, n - i0);
+                        packLeft (a + i0 * p + k0, p, numRows, depth, packedA.data());
+
+                        for (size_t tj = 0; tj < numColumnTiles; ++tj)
+                        {
+                            auto tileWidth = jmin (tileColumns, numColumns - tj * tileColumns);
+
+                            for (size_t ti = 0; ti < numRows; ti += tileRows)
+                                kernel (packedA.data() + ti * depth,
+                                        packedB.data() + tj * depth * tileVecs,
+                                        depth,
+                                        dst + (i0 + ti) * m + j0 + tj * tileColumns, m,
+                                        jmin (tileRows, numRows - ti), tileWidth);
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        static size_t roundUp (size_t x, size_t multiple) noexcept
+        {
+            return (x + multiple - 1) / multiple * multiple;
+        }
+
+        // Copies a depth x numColumns panel into column tiles, zero-padding the last one
+        static void packRight (const ElementType* src, size_t stride, size_t depth, size_t numColumns, Vec* dst) noexcept
+        {
+            alignas (sizeof (Vec)) ElementType lanes[vecSize];
+
+            for (size_t j = 0; j < numColumns; j += tileColumns)
+            {
+                for (size_t k = 0; k < depth; ++k)
+                {
+                    auto* row = src + k * stride + j;
+
+                    for (size_t v = 0; v < tileVecs; ++v)
+                    {
+                        for (size_t l = 0; l < vecSize; ++l)
+                        {
+                            auto column = v * vecSize + l;
+                            lanes[l] = j + column < numColumns ? row[column] : ElementType();
+                        }
+
+                        *dst++ = Vec::fromRawArray (lanes);
+                    }
+                }
+            }
+        }
+
+        // Copies a numRows x depth panel into row tiles, zero-padding the last one
+        static void packLeft (const ElementType* src, size_t stride, size_t numRows, size_t depth, ElementType* dst) noexcept
+        {
+            for (size_t i = 0; i < numRows; i += tileRows)
+                for (size_t k = 0; k < depth; ++k)
+                    for (size_t r = 0; r < tileRows; ++r)
+                        *dst++ = i + r < numRows ? src[(i + r) * stride + k] : ElementType();
+        }
+
+        static void kernel (const ElementType* a, const Vec* b, size_t depth,
+                            ElementType* dst, size_t stride, size_t numRows, size_t numColumns) noexcept
+        {
+            Vec sums[tileRows][tileVecs];
+
+            for (auto& row : sums)
+                for (auto& v : row)
+                    v = Vec::expand (0);
+
+            for (size_t k = 0; k < depth; ++k)
+            {
+                for (size_t r = 0; r < tileRows; ++r)
+                {
+                    auto ar = Vec::expand (a[r]);
+
+                    for (size_t v = 0; v < tileVecs; ++v)
+                        sums[r][v] = Vec::multiplyAdd (sums[r][v], ar, b[v]);
+                }
+
+                a += tileRows;
+                b += tileVecs;
+            }
+
+            alignas (sizeof (Vec)) ElementType result[tileColumns];
+
+            for (size_t r = 0; r < numRows; ++r)
+            {
+                for (size_t v = 0; v < tileVecs; ++v)
+                    sums[r][v].copyToRawArray (result + v * vecSize);
+
+                auto* row = dst + r * stride;
+
+                for (size_t j = 0; j < numColumns; ++j)
+                    row[j] += result[j];
+            }
+        }
+    };
+   #endif
+
+    template <typename ElementType>
+    static ElementType dotProduct (const ElementType* a, const ElementType* b, size_t num) noexcept
+    {
+        ElementType s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        size_t i = 0;
+
+        for (; i + 4 <= num; i += 4)
+        {
+            s0 += a[i]     * b[i];
+            s1 += a[i + 1] * b[i + 1];
+            s2 += a[i + 2] * b[i + 2];
+            s3 += a[i + 3] * b[i + 3];
+        }
+
+        for (; i < num; ++i)
+            s0 += a[i] * b[i];
+
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    // Solves U x = b in place, where U is upper triangular and b has numColumns columns
+    template <typename ElementType>
+    static void backSubstitute (const Matrix<ElementType>& u, Matrix<ElementType>& b) noexcept
+    {
+        auto n = u.getNumRows(), numColumns = b.getNumColumns();
+        auto* x = b.getRawDataPointer();
+
+        for (size_t i = n; i-- > 0;)
+        {
+            auto* coeffs = u.getRawDataPointer() + i * n;
+            auto* xi = x + i * numColumns;
+
+            if (numColumns == 1)
+            {
+                *xi -= dotProduct (coeffs + i + 1, x + i + 1, n - i - 1);
+            }
+            else
+            {
+                for (auto k = i + 1; k < n; ++k)
+                    FloatVectorOperations::addWithMultiply (xi, x + k * numColumns, -coeffs[k], numColumns);
+            }
+
+            FloatVectorOperations::multiply (xi, 1 / coeffs[i], numColumns);
+        }
+    }
+}
+
+//==============================================================================
 template <typename ElementType>
 Matrix<ElementType> Matrix<ElementType>::identity (size_t size)
 {
@@ -115,30 +324,58 @@ Matrix<ElementType> Matrix<ElementType>::operator* (const Matrix<ElementType>& o
 
     jassert (p == other.getNumRows());
 
-    size_t offsetMat = 0, offsetlhs = 0;
-
     auto* dst = result.getRawDataPointer();
     auto* a = getRawDataPointer();
     auto* b = other.getRawDataPointer();
 
-    for (size_t i = 0; i < n; ++i)
+   #if JUCE_USE_SIMD
+    using Blocked = MatrixHelpers::BlockedMultiply<ElementType>;
+
+    if (Blocked::isWorthUsing (n, p, m))
     {
-        size_t offsetrhs = 0;
+        Blocked::multiply (a, b, dst, n, p, m);
+        return result;
+    }
+   #endif
 
-        for (size_t k = 0; k < p; ++k)
+    MatrixHelpers::multiplyDirect (a, b, dst, n, p, m);
+    return result;
+}
+
+template <typename ElementType>
+void Matrix<ElementType>::multiplyBlock (const AudioBlock<const ElementType>& input,
+                                         const AudioBlock<ElementType>& output) const noexcept
+{
+    jassert (columns == input.getNumChannels() && rows == output.getNumChannels());
+    jassert (input.getNumSamples() == output.getNumSamples());
+
+    // Working through the block in chunks keeps the input channels in the cache
+    // while each output channel is accumulated
+    constexpr size_t chunkSize = 256;
+    auto numSamples = jmin (input.getNumSamples(), output.getNumSamples());
+
+    for (size_t start = 0; start < numSamples; start += chunkSize)
+    {
+        auto num = jmin (chunkSize, numSamples - start);
+
+        for (size_t row = 0; row < rows; ++row)
         {
-            auto ak = a[offsetlhs++];
+            auto* dst = output.getChannelPointer (row) + start;
+
+            if (columns == 0)
+            {
+                FloatVectorOperations::clear (dst, num);
+                continue;
+            }
 
-            for (size_t j = 0; j < m; ++j)
-                dst[offsetMat + j] += ak * b[offsetrhs + j];
+            auto* coeffs = getRawDataPointer() + row * columns;
 
-            offsetrhs += m;
-        }
+            FloatVectorOperations::multiply (dst, input.getChannelPointer (0) + start, coeffs[0], num);
 
-        offsetMat += m;
+            for (size_t column = 1; column < columns; ++column)
+                FloatVectorOperations::addWithMultiply (dst, input.getChannelPointer (column) + start, coeffs[column], num);
+        }
     }
-
-    return result;
 }
 
 //==============================================================================
@@ -225,52 +462,28 @@ bool Matrix<ElementType>::solve (Matrix& b) const noexcept
 
         default:
         {
-            Matrix<ElementType> M (A);
-
-            for (size_t j = 0; j < n; ++j)
-            {
-                if (approximatelyEqual (M (j, j), (ElementType) 0))
-                {
-                    auto i = j;
-                    while (i < n && approximatelyEqual (M (i, j), (ElementType) 0))
-                        ++i;
-
-                    if (i == n)
-                        return false;
-
-                    for (size_t k = 0; k < n; ++k)
-                        M (j, k) += M (i, k);
-
-                    x[j] += x[i];
-                }
-
-                auto t = 1 / M (j, j);
-
-                for (size_t k = 0; k < n; ++k)
-                    M (j, k) *= t;
-
-                x[j] *= t;
-
-                for (size_t k = j + 1; k < n; ++k)
-                {
-                    auto u = -M (k, j);
-
-                    for (size_t l = 0; l < n; ++l)
-                        M (k, l) += u * M (j, l);
-
-                    x[k] += u * x[j];
-                }
-            }
-
-            for (int k = static_cast<int> (n) - 2; k >= 0; --k)
-                for (size_t i = static_cast<size_t> (k) + 1; i < n; ++i)
-                    x[k] -= M (static_cast<size_t> (k), i) * x[i];
+            LUDecomposition<ElementType> lu (A);
+            return lu.solve (b);
         }
     }
 
     return true;
 }
 
+template <typename ElementType>
+bool Matrix<ElementType>::solveLU (Matrix& b) const
+{
+    LUDecomposition<ElementType> lu (*this);
+    return lu.solve (b);
+}
+
+template <typename ElementType>
+bool Matrix<ElementType>::solveCholesky (Matrix& b) const
+{
+    CholeskyDecomposition<ElementType> cholesky (*this);
+    return cholesky.solve (b);
+}
+
 //==============================================================================
 template <typename ElementType>
 String Matrix<ElementType>::toString() const
@@ -308,7 +521,183 @@ String Matrix<ElementType>::toString() const
     return result.toString();
 }
 
+//==============================================================================
+template <typename ElementType>
+LUDecomposition<ElementType>::LUDecomposition (const Matrix<ElementType>& matrix)
+    : lu (matrix)
+{
+    jassert (matrix.isSquare());
+
+    auto n = lu.getNumRows();
+    auto* data = lu.getRawDataPointer();
+    pivots.resize (n);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        auto pivot = k;
+        auto largest = std::abs (data[k * n + k]);
+
+        for (auto i = k + 1; i < n; ++i)
+        {
+            auto value = std::abs (data[i * n + k]);
+
+            if (value > largest)
+            {
+                largest = value;
+                pivot = i;
+            }
+        }
+
+        if (! (largest > std::numeric_limits<ElementType>::min()))
+        {
+            valid = false;
+            return;
+        }
+
+        pivots[k] = pivot;
+
+        if (pivot != k)
+        {
+            lu.swapRows (k, pivot);
+            oddPermutation = ! oddPermutation;
+        }
+
+        auto* rowK = data + k * n;
+        auto scale = 1 / rowK[k];
+
+        for (auto i = k + 1; i < n; ++i)
+        {
+            auto* rowI = data + i * n;
+            auto factor = (rowI[k] *= scale);
+
+            FloatVectorOperations::addWithMultiply (rowI + k + 1, rowK + k + 1, -factor, n - k - 1);
+        }
+    }
+}
+
+template <typename ElementType>
+bool LUDecomposition<ElementType>::solve (Matrix<ElementType>& b) const noexcept
+{
+    auto n = lu.getNumRows();
+    jassert (b.getNumRows() == n);
+
+    if (! valid || b.getNumRows() != n)
+        return false;
+
+    auto numColumns = b.getNumColumns();
+    auto* x = b.getRawDataPointer();
+
+    for (size_t k = 0; k < n; ++k)
+        if (pivots[k] != k)
+            b.swapRows (k, pivots[k]);
+
+    // L has an implicit unit diagonal
+    for (size_t i = 1; i < n; ++i)
+    {
+        auto* coeffs = lu.getRawDataPointer() + i * n;
+        auto* xi = x + i * numColumns;
+
+        if (numColumns == 1)
+        {
+            *xi -= MatrixHelpers::dotProduct (coeffs, x, i);
+        }
+        else
+        {
+            for (size_t k = 0; k < i; ++k)
+                FloatVectorOperations::addWithMultiply (xi, x + k * numColumns, -coeffs[k], numColumns);
+        }
+    }
+
+    MatrixHelpers::backSubstitute (lu, b);
+    return true;
+}
+
+template <typename ElementType>
+ElementType LUDecomposition<ElementType>::getDeterminant() const noexcept
+{
+    if (! valid)
+        return 0;
+
+    ElementType result = oddPermutation ? -1 : 1;
+
+    for (size_t i = 0; i < lu.getNumRows(); ++i)
+        result *= lu (i, i);
+
+    return result;
+}
+
+//==============================================================================
+template <typename ElementType>
+CholeskyDecomposition<ElementType>::CholeskyDecomposition (const Matrix<ElementType>& matrix)
+    : upper (matrix.getNumRows(), matrix.getNumColumns())
+{
+    jassert (matrix.isSquare());
+
+    auto n = upper.getNumRows();
+    auto* data = upper.getRawDataPointer();
+
+    for (size_t i = 0; i < n; ++i)
+        for (auto j = i; j < n; ++j)
+            data[i * n + j] = matrix (j, i);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        auto* rowK = data + k * n;
+
+        if (! (rowK[k] > 0))
+        {
+            valid = false;
+            return;
+        }
+
+        rowK[k] = std::sqrt (rowK[k]);
+        FloatVectorOperations::multiply (rowK + k + 1, 1 / rowK[k], n - k - 1);
+
+        for (auto i = k + 1; i < n; ++i)
+            FloatVectorOperations::addWithMultiply (data + i * n + i, rowK + i, -rowK[i], n - i);
+    }
+}
+
+template <typename ElementType>
+bool CholeskyDecomposition<ElementType>::solve (Matrix<ElementType>& b) const noexcept
+{
+    auto n = upper.getNumRows();
+    jassert (b.getNumRows() == n);
+
+    if (! valid || b.getNumRows() != n)
+        return false;
+
+    auto numColumns = b.getNumColumns();
+    auto* x = b.getRawDataPointer();
+
+    // Solves U^T y = b a column of U^T (a row of U) at a time
+    for (size_t k = 0; k < n; ++k)
+    {
+        auto* rowK = upper.getRawDataPointer() + k * n;
+        auto* xk = x + k * numColumns;
+
+        FloatVectorOperations::multiply (xk, 1 / rowK[k], numColumns);
+
+        if (numColumns == 1)
+        {
+            FloatVectorOperations::addWithMultiply (x + k + 1, rowK + k + 1, -*xk, n - k - 1);
+        }
+        else
+        {
+            for (auto i = k + 1; i < n; ++i)
+                FloatVectorOperations::addWithMultiply (x + i * numColumns, xk, -rowK[i], numColumns);
+        }
+    }
+
+    MatrixHelpers::backSubstitute (upper, b);
+    return true;
+}
+
 template class Matrix<float>;
 template class Matrix<double>;
+template class LUDecomposition<float>;
+template class LUDecomposition<double>;
+template class CholeskyDecomposition<float>;
+template class CholeskyDecomposition<double>;
 
 } // namespace juce::dsp
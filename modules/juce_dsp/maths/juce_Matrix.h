@@ -26,6 +26,9 @@
 namespace juce::dsp
 {
 
+template <typename SampleType>
+class AudioBlock;
+
 /**
     General matrix and vectors class, meant for classic math manipulation such as
     additions, multiplications, and linear systems of equations solving.
@@ -155,9 +158,25 @@ public:
     /** Scalar multiplication */
     inline Matrix operator* (ElementType scalar) const                  { Matrix result (*this); result *= scalar; return result; }
 
-    /** Matrix multiplication */
+    /** Matrix multiplication.
+
+        Large products are computed a cache-sized block at a time with SIMD
+        kernels, small ones directly.
+    */
     Matrix operator* (const Matrix& other) const;
 
+    /** Multiplies every sample frame of a multichannel block by this matrix.
+
+        This treats each frame of the input block as a column vector with one
+        element per channel, so the matrix must have as many columns as the input
+        has channels, and as many rows as the output has channels. This is what
+        you need for things like ambisonic decoding or channel mixing matrices.
+
+        The two blocks must have the same length and must not share any memory.
+    */
+    void multiplyBlock (const AudioBlock<const ElementType>& input,
+                        const AudioBlock<ElementType>& output) const noexcept;
+
     /** Does a hadarmard product with the receiver and other and stores the result in the receiver */
     inline Matrix& hadarmard (const Matrix& other) noexcept             { return apply (other, [] (ElementType a, ElementType b) { return a * b; } ); }
 
@@ -199,6 +218,32 @@ public:
      */
     bool solve (Matrix& b) const noexcept;
 
+    /** Solves a linear system of equations using an LU decomposition with partial
+        pivoting.
+
+        The matrix must be a square matrix N times N, and b must have N rows. It
+        may have more than one column, in which case each column is solved
+        separately. After the execution of the algorithm, b will contain the
+        solution.
+
+        Returns false if the matrix is singular.
+
+        @see LUDecomposition
+    */
+    bool solveLU (Matrix& b) const;
+
+    /** Solves a linear system of equations using a Cholesky decomposition.
+
+        This is about twice as fast as solveLU(), but the matrix must be symmetric
+        and positive-definite, as normal equations matrices (A^T A) used in least
+        squares problems are. Only the lower triangle of the matrix is read.
+
+        Returns false if the matrix isn't positive-definite.
+
+        @see CholeskyDecomposition
+    */
+    bool solveCholesky (Matrix& b) const;
+
     //==============================================================================
     /** Returns a String displaying in a convenient way the matrix contents. */
     String toString() const;
@@ -248,4 +293,75 @@ private:
     JUCE_LEAK_DETECTOR (Matrix)
 };
 
+//==============================================================================
+/**
+    The LU decomposition of a square matrix, with partial pivoting.
+
+    Decomposing a matrix is the expensive part of solving a system of equations,
+    so if you need to solve for several right-hand sides with the same matrix,
+    create one of these and call solve() as many times as needed.
+
+    @see Matrix::solveLU
+
+    @tags{DSP}
+*/
+template <typename ElementType>
+class LUDecomposition
+{
+public:
+    /** Decomposes a square matrix. Check isValid() before using the result. */
+    explicit LUDecomposition (const Matrix<ElementType>& matrix);
+
+    /** Returns false if the matrix was singular. */
+    bool isValid() const noexcept                    { return valid; }
+
+    /** Solves the system for b, which must have as many rows as the matrix.
+        Every column of b is solved, and replaced by its solution.
+    */
+    bool solve (Matrix<ElementType>& b) const noexcept;
+
+    /** Returns the determinant of the decomposed matrix. */
+    ElementType getDeterminant() const noexcept;
+
+private:
+    Matrix<ElementType> lu;
+    std::vector<size_t> pivots;
+    bool valid = true, oddPermutation = false;
+
+    JUCE_LEAK_DETECTOR (LUDecomposition)
+};
+
+//==============================================================================
+/**
+    The Cholesky decomposition of a symmetric positive-definite matrix.
+
+    The matrix is stored as an upper triangular matrix U, with U^T U equal to the
+    original matrix. Only the lower triangle of the original matrix is read.
+
+    @see Matrix::solveCholesky
+
+    @tags{DSP}
+*/
+template <typename ElementType>
+class CholeskyDecomposition
+{
+public:
+    /** Decomposes a square matrix. Check isValid() before using the result. */
+    explicit CholeskyDecomposition (const Matrix<ElementType>& matrix);
+
+    /** Returns false if the matrix wasn't positive-definite. */
+    bool isValid() const noexcept                    { return valid; }
+
+    /** Solves the system for b, which must have as many rows as the matrix.
+        Every column of b is solved, and replaced by its solution.
+    */
+    bool solve (Matrix<ElementType>& b) const noexcept;
+
+private:
+    Matrix<ElementType> upper;
+    bool valid = true;
+
+    JUCE_LEAK_DETECTOR (CholeskyDecomposition)
+};
+
 } // namespace juce::dsp
@@ -144,6 +144,128 @@ struct LinearAlgebraUnitTest final : public UnitTest
         }
     };
 
+    template <typename ElementType>
+    static Matrix<ElementType> makeRandomMatrix (Random& random, size_t rows, size_t columns)
+    {
+        Matrix<ElementType> result (rows, columns);
+
+        for (auto& x : result)
+            x = (ElementType) (random.nextDouble() * 2.0 - 1.0);
+
+        return result;
+    }
+
+    template <typename ElementType>
+    static Matrix<ElementType> multiplyNaively (const Matrix<ElementType>& a, const Matrix<ElementType>& b)
+    {
+        Matrix<ElementType> result (a.getNumRows(), b.getNumColumns());
+
+        for (size_t i = 0; i < a.getNumRows(); ++i)
+            for (size_t j = 0; j < b.getNumColumns(); ++j)
+                for (size_t k = 0; k < a.getNumColumns(); ++k)
+                    result (i, j) += a (i, k) * b (k, j);
+
+        return result;
+    }
+
+    struct LargeMultiplicationTest
+    {
+        template <typename ElementType>
+        static void run (LinearAlgebraUnitTest& u)
+        {
+            auto random = u.getRandom();
+
+            // Sizes that aren't multiples of the block and tile sizes
+            for (auto [n, p, m] : { std::tuple<size_t, size_t, size_t> { 17, 33, 9 },
+                                    { 64, 64, 64 },
+                                    { 70, 300, 261 },
+                                    { 3, 40, 100 } })
+            {
+                auto a = makeRandomMatrix<ElementType> (random, n, p);
+                auto b = makeRandomMatrix<ElementType> (random, p, m);
+
+                u.expect (Matrix<ElementType>::compare (a * b, multiplyNaively (a, b), (ElementType) 1e-3));
+            }
+        }
+    };
+
+    struct BlockMultiplicationTest
+    {
+        template <typename ElementType>
+        static void run (LinearAlgebraUnitTest& u)
+        {
+            auto random = u.getRandom();
+            constexpr size_t numSamples = 300;
+
+            auto matrix = makeRandomMatrix<ElementType> (random, 3, 4);
+            auto frames = makeRandomMatrix<ElementType> (random, 4, numSamples);
+
+            HeapBlock<char> inputData, outputData;
+            AudioBlock<ElementType> input (inputData, 4, numSamples), output (outputData, 3, numSamples);
+
+            for (size_t channel = 0; channel < 4; ++channel)
+                for (size_t i = 0; i < numSamples; ++i)
+                    input.setSample ((int) channel, (int) i, frames (channel, i));
+
+            matrix.multiplyBlock (input, output);
+
+            auto expected = matrix * frames;
+            auto maxError = (ElementType) 0;
+
+            for (size_t channel = 0; channel < 3; ++channel)
+                for (size_t i = 0; i < numSamples; ++i)
+                    maxError = jmax (maxError, std::abs (output.getSample ((int) channel, (int) i) - expected (channel, i)));
+
+            u.expectLessThan (maxError, (ElementType) 1e-5);
+        }
+    };
+
+    struct DecompositionTest
+    {
+        template <typename ElementType>
+        static void run (LinearAlgebraUnitTest& u)
+        {
+            auto random = u.getRandom();
+
+            for (auto n : std::initializer_list<size_t> { 1, 5, 40, 129 })
+            {
+                auto a = makeRandomMatrix<ElementType> (random, n, n);
+                auto x = makeRandomMatrix<ElementType> (random, n, 3);
+
+                // Diagonally dominant, so that the system is well conditioned
+                for (size_t i = 0; i < n; ++i)
+                    a (i, i) += (ElementType) n;
+
+                auto b = a * x;
+                u.expect (a.solveLU (b));
+                u.expect (Matrix<ElementType>::compare (b, x, (ElementType) 1e-3));
+
+                // A^T A is symmetric and positive-definite
+                Matrix<ElementType> transposed (n, n);
+
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t j = 0; j < n; ++j)
+                        transposed (i, j) = a (j, i);
+
+                auto normal = transposed * a;
+                auto c = normal * x;
+                u.expect (normal.solveCholesky (c));
+                u.expect (Matrix<ElementType>::compare (c, x, (ElementType) 1e-3));
+            }
+
+            const ElementType data[] = { 2, 1, 1, 0, 3, 4, 1, 5, 6 };
+            LUDecomposition<ElementType> lu (Matrix<ElementType> (3, 3, data));
+            u.expect (lu.isValid());
+            u.expectWithinAbsoluteError (lu.getDeterminant(), (ElementType) -3, (ElementType) 1e-4);
+
+            const ElementType singular[] = { 1, 2, 2, 4 };
+            u.expect (! LUDecomposition<ElementType> (Matrix<ElementType> (2, 2, singular)).isValid());
+
+            const ElementType indefinite[] = { 1, 2, 2, 1 };
+            u.expect (! CholeskyDecomposition<ElementType> (Matrix<ElementType> (2, 2, indefinite)).isValid());
+        }
+    };
+
     template <class TheTest>
     void runTestForAllTypes (const char* unitTestName)
     {
@@ -162,9 +284,63 @@ struct LinearAlgebraUnitTest final : public UnitTest
         runTestForAllTypes<MultiplicationTest> ("MultiplicationTest");
         runTestForAllTypes<IdentityMatrixTest> ("IdentityMatrixTest");
         runTestForAllTypes<SolvingTest> ("SolvingTest");
+        runTestForAllTypes<LargeMultiplicationTest> ("LargeMultiplicationTest");
+        runTestForAllTypes<BlockMultiplicationTest> ("BlockMultiplicationTest");
+        runTestForAllTypes<DecompositionTest> ("DecompositionTest");
     }
 };
 
 static LinearAlgebraUnitTest linearAlgebraUnitTest;
 
+//==============================================================================
+struct LinearAlgebraBenchmark final : public UnitTest
+{
+    LinearAlgebraBenchmark()
+        : UnitTest ("Linear Algebra Benchmark", UnitTestCategories::benchmarks)
+    {}
+
+    template <typename Callback>
+    static double timeInMicroseconds (int numRepeats, Callback&& callback)
+    {
+        auto start = Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numRepeats; ++i)
+            callback();
+
+        return Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start) * 1.0e6 / numRepeats;
+    }
+
+    void runTest() override
+    {
+        beginTest ("Multiply and solve");
+
+        auto random = getRandom();
+
+        for (auto n : std::initializer_list<size_t> { 4, 8, 16, 32, 64, 128, 256, 512 })
+        {
+            auto a = LinearAlgebraUnitTest::makeRandomMatrix<float> (random, n, n);
+            auto b = LinearAlgebraUnitTest::makeRandomMatrix<float> (random, n, n);
+
+            for (size_t i = 0; i < n; ++i)
+                a (i, i) += (float) n;
+
+            // Roughly the same amount of work for every size
+            auto numRepeats = jmax (1, (int) (4.0e6 / std::pow ((double) n, 3.0)));
+            auto result = a * b;
+            auto x = b;
+
+            auto multiplyTime = timeInMicroseconds (numRepeats, [&] { result = a * b; });
+            auto solveTime    = timeInMicroseconds (numRepeats, [&] { x = b; a.solveLU (x); });
+
+            logMessage (String (n) + "x" + String (n) + ": multiply " + String (multiplyTime, 2) + " us ("
+                        + String (2.0 * std::pow ((double) n, 3.0) / (multiplyTime * 1000.0), 2) + " GFLOPS), "
+                        + "LU solve with " + String (n) + " right-hand sides " + String (solveTime, 2) + " us");
+
+            expect (result.getNumRows() == n && x.getNumColumns() == n);
+        }
+    }
+};
+
+static LinearAlgebraBenchmark linearAlgebraBenchmark;
+
 } // namespace juce::dsp
@@ -106,6 +106,34 @@ SampleType BallisticsFilter<SampleType>::processSample (int channel, SampleType
     return result;
 }
 
+template <typename SampleType>
+void BallisticsFilter<SampleType>::processChannel (int channel, const SampleType* input, SampleType* output, size_t numSamples) noexcept
+{
+    jassert (isPositiveAndBelow (channel, yold.size()));
+
+    // The rectification and square root are done on the whole block, leaving only
+    // the recursive part of the filter to be run sample by sample
+    if (levelType == LevelCalculationType::RMS)
+        FloatVectorOperations::multiply (output, input, input, numSamples);
+    else
+        FloatVectorOperations::abs (output, input, numSamples);
+
+    auto state = yold[(size_t) channel];
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const auto value = output[i];
+        state = value + (value > state ? cteAT : cteRL) * (state - value);
+        output[i] = state;
+    }
+
+    yold[(size_t) channel] = state;
+
+    if (levelType == LevelCalculationType::RMS)
+        for (size_t i = 0; i < numSamples; ++i)
+            output[i] = std::sqrt (output[i]);
+}
+
 template <typename SampleType>
 void BallisticsFilter<SampleType>::snapToZero() noexcept
 {
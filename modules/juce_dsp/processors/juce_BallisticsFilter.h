@@ -111,13 +111,7 @@ public:
         }
 
         for (size_t channel = 0; channel < numChannels; ++channel)
-        {
-            auto* inputSamples  = inputBlock .getChannelPointer (channel);
-            auto* outputSamples = outputBlock.getChannelPointer (channel);
-
-            for (size_t i = 0; i < numSamples; ++i)
-                outputSamples[i] = processSample ((int) channel, inputSamples[i]);
-        }
+            processChannel ((int) channel, inputBlock.getChannelPointer (channel), outputBlock.getChannelPointer (channel), numSamples);
 
        #if JUCE_DSP_ENABLE_SNAP_TO_ZERO
         snapToZero();
@@ -135,6 +129,7 @@ public:
 
 private:
     //==============================================================================
+    void processChannel (int channel, const SampleType* input, SampleType* output, size_t numSamples) noexcept;
     SampleType calculateLimitedCte (SampleType) const noexcept;
 
     //==============================================================================
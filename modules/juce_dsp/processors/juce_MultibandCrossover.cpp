@@ -0,0 +1,308 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce::dsp
+{
+
+namespace MultibandCrossoverHelpers
+{
+   #if JUCE_USE_SIMD
+    template <typename SampleType>
+    struct Lanes
+    {
+        using Type = SIMDRegister<SampleType>;
+        static constexpr size_t size = Type::size();
+
+        static Type load (const SampleType* source) noexcept              { return Type::fromRawArray (source); }
+        static void store (SampleType* destination, Type value) noexcept  { value.copyToRawArray (destination); }
+        static SampleType* align (SampleType* pointer) noexcept           { return Type::getNextSIMDAlignedPtr (pointer); }
+    };
+   #else
+    template <typename SampleType>
+    struct Lanes
+    {
+        using Type = SampleType;
+        static constexpr size_t size = 1;
+
+        static Type load (const SampleType* source) noexcept              { return *source; }
+        static void store (SampleType* destination, Type value) noexcept  { *destination = value; }
+        static SampleType* align (SampleType* pointer) noexcept           { return pointer; }
+    };
+   #endif
+}
+
+//==============================================================================
+template <typename SampleType>
+MultibandCrossover<SampleType>::MultibandCrossover()
+{
+    setNumBands (2);
+}
+
+template <typename SampleType>
+void MultibandCrossover<SampleType>::setNumBands (int newNumBands)
+{
+    jassert (newNumBands > 0);
+
+    numBands = newNumBands;
+    const auto numCrossovers = (size_t) numBands - 1;
+
+    frequencies.resize (numCrossovers);
+    g.resize (numCrossovers);
+    h.resize (numCrossovers);
+
+    for (size_t i = 0; i < numCrossovers; ++i)
+    {
+        frequencies[i] = (SampleType) (100.0 * std::pow (100.0, (double) (i + 1) / (double) (numCrossovers + 1)));
+        update ((int) i);
+    }
+
+    if (numChannels > 0)
+    {
+        allocate();
+        reset();
+    }
+}
+
+template <typename SampleType>
+void MultibandCrossover<SampleType>::setCrossoverFrequency (int index, SampleType newFrequencyHz)
+{
+    jassert (isPositiveAndBelow (index, numBands - 1));
+    jassert (isPositiveAndBelow (newFrequencyHz, static_cast<SampleType> (sampleRate * 0.5)));
+
+    frequencies[(size_t) index] = newFrequencyHz;
+    update (index);
+}
+
+//==============================================================================
+template <typename SampleType>
+void MultibandCrossover<SampleType>::prepare (const ProcessSpec& spec)
+{
+    jassert (spec.sampleRate > 0);
+    jassert (spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    numChannels = spec.numChannels;
+    maximumBlockSize = spec.maximumBlockSize;
+
+    for (int i = 0; i < numBands - 1; ++i)
+        update (i);
+
+    allocate();
+    reset();
+}
+
+template <typename SampleType>
+void MultibandCrossover<SampleType>::reset()
+{
+    std::fill (states, states + numGroups * numStates * MultibandCrossoverHelpers::Lanes<SampleType>::size, (SampleType) 0);
+    lastBlockSize = 0;
+}
+
+template <typename SampleType>
+void MultibandCrossover<SampleType>::snapToZero() noexcept
+{
+    for (auto* s = states, * end = states + numGroups * numStates * MultibandCrossoverHelpers::Lanes<SampleType>::size; s != end; ++s)
+        util::snapToZero (*s);
+}
+
+//==============================================================================
+template <typename SampleType>
+void MultibandCrossover<SampleType>::process (const AudioBlock<const SampleType>& inputBlock) noexcept
+{
+    constexpr auto numLanes = MultibandCrossoverHelpers::Lanes<SampleType>::size;
+
+    const auto numSamples = inputBlock.getNumSamples();
+
+    jassert (inputBlock.getNumChannels() == numChannels);
+    jassert (numSamples <= maximumBlockSize);
+
+    lastBlockSize = numSamples;
+
+    if (numSamples == 0)
+        return;
+
+    for (size_t channel = 0; channel < numGroups * numLanes; ++channel)
+        laneInputs[channel] = channel < numChannels ? inputBlock.getChannelPointer (channel) : zeros;
+
+    for (size_t group = 0; group < numGroups; ++group)
+        processGroup (group, numSamples);
+
+   #if JUCE_DSP_ENABLE_SNAP_TO_ZERO
+    snapToZero();
+   #endif
+}
+
+template <typename SampleType>
+AudioBlock<SampleType> MultibandCrossover<SampleType>::getBand (int band) const noexcept
+{
+    jassert (isPositiveAndBelow (band, numBands));
+
+    return getBands().getSubsetChannelBlock ((size_t) band * numChannels, numChannels);
+}
+
+template <typename SampleType>
+AudioBlock<SampleType> MultibandCrossover<SampleType>::getBands() const noexcept
+{
+    return { bandPointers.get(), (size_t) numBands * numChannels, lastBlockSize };
+}
+
+//==============================================================================
+template <typename SampleType>
+void MultibandCrossover<SampleType>::processGroup (size_t group, size_t numSamples) noexcept
+{
+    using Lanes = MultibandCrossoverHelpers::Lanes<SampleType>;
+    constexpr auto numLanes = Lanes::size;
+
+    const auto numCrossovers = (size_t) numBands - 1;
+    const auto* inputs = laneInputs.get() + group * numLanes;
+    auto* const* outputs = laneOutputs.get() + group * (size_t) numBands * numLanes;
+    auto* const groupStates = states + group * numStates * numLanes;
+
+    alignas (sizeof (typename Lanes::Type)) SampleType lanes[numLanes];
+
+    const auto writeBand = [&] (size_t band, typename Lanes::Type value, size_t i)
+    {
+        Lanes::store (lanes, value);
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+            outputs[band * numLanes + lane][i] = lanes[lane];
+    };
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        for (size_t lane = 0; lane < numLanes; ++lane)
+            lanes[lane] = inputs[lane][i];
+
+        auto x = Lanes::load (lanes);
+        auto* s = groupStates;
+
+        for (size_t k = 0; k < numCrossovers; ++k)
+        {
+            // The LR4 split, as in LinkwitzRileyFilter::processSample()
+            const auto gk = g[k], hk = h[k], rk = R2 + gk;
+
+            const auto s1 = Lanes::load (s), s2 = Lanes::load (s + numLanes);
+            const auto s3 = Lanes::load (s + 2 * numLanes), s4 = Lanes::load (s + 3 * numLanes);
+
+            const auto yH = (x - s1 * rk - s2) * hk;
+            const auto yB = yH * gk + s1;
+            const auto yL = yB * gk + s2;
+            Lanes::store (s,            yH * gk + yB);
+            Lanes::store (s + numLanes, yB * gk + yL);
+
+            const auto yH2 = (yL - s3 * rk - s4) * hk;
+            const auto yB2 = yH2 * gk + s3;
+            const auto yL2 = yB2 * gk + s4;
+            Lanes::store (s + 2 * numLanes, yH2 * gk + yB2);
+            Lanes::store (s + 3 * numLanes, yB2 * gk + yL2);
+
+            s += 4 * numLanes;
+
+            // The low band then goes through the all-passes of the crossovers above it,
+            // which the high band will go through as it's split further
+            auto low = yL2;
+            x = yL - yB * R2 + yH - yL2;
+
+            for (auto j = k + 1; j < numCrossovers; ++j)
+            {
+                const auto gj = g[j];
+                const auto a1 = Lanes::load (s), a2 = Lanes::load (s + numLanes);
+
+                const auto aH = (low - a1 * (R2 + gj) - a2) * h[j];
+                const auto aB = aH * gj + a1;
+                const auto aL = aB * gj + a2;
+                Lanes::store (s,            aH * gj + aB);
+                Lanes::store (s + numLanes, aB * gj + aL);
+
+                s += 2 * numLanes;
+                low = aL - aB * R2 + aH;
+            }
+
+            writeBand (k, low, i);
+        }
+
+        writeBand (numCrossovers, x, i);
+    }
+}
+
+template <typename SampleType>
+void MultibandCrossover<SampleType>::update (int index) noexcept
+{
+    const auto gi = std::tan (MathConstants<double>::pi * frequencies[(size_t) index] / sampleRate);
+
+    g[(size_t) index] = (SampleType) gi;
+    h[(size_t) index] = (SampleType) (1.0 / (1.0 + (double) R2 * gi + gi * gi));
+}
+
+template <typename SampleType>
+void MultibandCrossover<SampleType>::allocate()
+{
+    using Lanes = MultibandCrossoverHelpers::Lanes<SampleType>;
+    constexpr auto numLanes = Lanes::size;
+
+    const auto numCrossovers = (size_t) numBands - 1;
+    const auto numBandChannels = (size_t) numBands * numChannels;
+
+    // Each crossover has four states, and each band below it has an all-pass with two
+    numGroups = (numChannels + numLanes - 1) / numLanes;
+    numStates = 4 * numCrossovers + numCrossovers * (numCrossovers - 1);
+
+    stateStorage.allocate (numGroups * numStates * numLanes + numLanes, true);
+    states = Lanes::align (stateStorage.get());
+
+    bandStorage.allocate ((numBandChannels + 2) * maximumBlockSize, true);
+    bandPointers.allocate (numBandChannels, false);
+
+    for (size_t channel = 0; channel < numBandChannels; ++channel)
+        bandPointers[channel] = bandStorage.get() + channel * maximumBlockSize;
+
+    zeros  = bandStorage.get() + numBandChannels * maximumBlockSize;
+    unused = zeros + maximumBlockSize;
+
+    laneInputs.allocate (numGroups * numLanes, true);
+    laneOutputs.allocate (numGroups * (size_t) numBands * numLanes, false);
+
+    for (size_t group = 0; group < numGroups; ++group)
+    {
+        for (size_t band = 0; band < (size_t) numBands; ++band)
+        {
+            for (size_t lane = 0; lane < numLanes; ++lane)
+            {
+                const auto channel = group * numLanes + lane;
+
+                laneOutputs[(group * (size_t) numBands + band) * numLanes + lane]
+                    = channel < numChannels ? bandPointers[band * numChannels + channel] : unused;
+            }
+        }
+    }
+
+    lastBlockSize = 0;
+}
+
+//==============================================================================
+template class MultibandCrossover<float>;
+template class MultibandCrossover<double>;
+
+} // namespace juce::dsp
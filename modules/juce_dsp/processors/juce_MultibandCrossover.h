@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce::dsp
+{
+
+/**
+    Splits a signal into any number of frequency bands, using Linkwitz-Riley
+    crossovers.
+
+    The bands are phase-aligned, so that their sum has a flat magnitude response:
+    each band also passes through the all-pass filters matching the crossovers it
+    wasn't split by, just as a hand-built tree of LinkwitzRileyFilter objects with
+    all-pass compensation would do. But rather than running each filter of the tree
+    over the whole block in turn, this class runs all the crossovers and compensation
+    filters for a sample at once, in a single pass over the input. The states of the
+    filters are interleaved so that several channels are processed together in a
+    SIMDRegister, where SIMD is available.
+
+    The bands are written into a buffer which is allocated in prepare(), and can be
+    read after each call to process() with getBand(), or all at once with getBands().
+
+    The crossovers use the same -24 dB/octave LR4 TPT structure as
+    LinkwitzRileyFilter, so with the same frequencies they give the same output,
+    apart from rounding errors.
+
+    @see LinkwitzRileyFilter
+
+    @tags{DSP}
+*/
+template <typename SampleType>
+class MultibandCrossover
+{
+public:
+    //==============================================================================
+    /** Creates a crossover with two bands, split at 1 kHz. */
+    MultibandCrossover();
+
+    //==============================================================================
+    /** Sets the number of bands.
+
+        The crossover frequencies are reset to be spaced evenly on a logarithmic
+        scale between 100 Hz and 10 kHz. This allocates memory if the crossover has
+        already been prepared, so it isn't realtime-safe.
+    */
+    void setNumBands (int newNumBands);
+
+    /** Returns the number of bands. */
+    int getNumBands() const noexcept                                { return numBands; }
+
+    /** Sets the frequency in Hz of one of the crossovers, between bands index and
+        index + 1.
+
+        The bands are only meaningful if the frequencies are in ascending order, but
+        the bands will still add up to a flat magnitude response if they aren't.
+    */
+    void setCrossoverFrequency (int index, SampleType newFrequencyHz);
+
+    /** Returns the frequency in Hz of one of the crossovers. */
+    SampleType getCrossoverFrequency (int index) const noexcept     { return frequencies[(size_t) index]; }
+
+    //==============================================================================
+    /** Initialises the crossover, and allocates the buffer for the bands. */
+    void prepare (const ProcessSpec& spec);
+
+    /** Resets the internal state variables of the filters. */
+    void reset();
+
+    /** Ensure that the state variables are rounded to zero if the state
+        variables are denormals. This is only needed if you are doing
+        sample by sample processing.
+    */
+    void snapToZero() noexcept;
+
+    //==============================================================================
+    /** Splits a block into bands.
+
+        The block must have the number of channels passed to prepare(), and no more
+        than the maximum block size. The bands can be read afterwards with getBand()
+        or getBands().
+    */
+    void process (const AudioBlock<const SampleType>& inputBlock) noexcept;
+
+    /** Returns one of the bands of the last block passed to process().
+
+        The band has the same number of channels and samples as that block.
+    */
+    AudioBlock<SampleType> getBand (int band) const noexcept;
+
+    /** Returns all the bands of the last block passed to process(), one after the
+        other, so that channel c of band b is channel b * numChannels + c.
+    */
+    AudioBlock<SampleType> getBands() const noexcept;
+
+private:
+    //==============================================================================
+    void processGroup (size_t group, size_t numSamples) noexcept;
+    void update (int index) noexcept;
+    void allocate();
+
+    //==============================================================================
+    std::vector<SampleType> frequencies, g, h;
+    const SampleType R2 = MathConstants<SampleType>::sqrt2;
+
+    // The states of the filters, interleaved by channel in groups of SIMD lanes
+    HeapBlock<SampleType> stateStorage;
+    SampleType* states = nullptr;
+    size_t numStates = 0, numGroups = 0;
+
+    // The bands, followed by a row of zeros and a row for the unused lanes to write to
+    HeapBlock<SampleType> bandStorage;
+    HeapBlock<SampleType*> bandPointers, laneOutputs;
+    HeapBlock<const SampleType*> laneInputs;
+    SampleType* zeros = nullptr;
+    SampleType* unused = nullptr;
+
+    double sampleRate = 44100.0;
+    int numBands = 0;
+    size_t numChannels = 0, maximumBlockSize = 0, lastBlockSize = 0;
+};
+
+} // namespace juce::dsp
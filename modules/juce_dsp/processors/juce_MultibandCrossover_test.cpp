@@ -0,0 +1,275 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce::dsp
+{
+
+struct MultibandCrossoverTests final : public UnitTest
+{
+    MultibandCrossoverTests()
+        : UnitTest ("MultibandCrossover", UnitTestCategories::dsp)
+    {}
+
+    // Splits a block the long way, with a LinkwitzRileyFilter for each crossover and
+    // an all-pass LinkwitzRileyFilter for each band below each crossover
+    template <typename SampleType>
+    struct FilterTree
+    {
+        FilterTree (const std::vector<SampleType>& frequencies, const ProcessSpec& spec)
+            : crossovers (frequencies.size())
+        {
+            for (size_t k = 0; k < frequencies.size(); ++k)
+            {
+                crossovers[k].setCutoffFrequency (frequencies[k]);
+                crossovers[k].prepare (spec);
+
+                for (auto j = k + 1; j < frequencies.size(); ++j)
+                {
+                    auto& allpass = allpasses.emplace_back();
+                    allpass.setType (LinkwitzRileyFilterType::allpass);
+                    allpass.setCutoffFrequency (frequencies[j]);
+                    allpass.prepare (spec);
+                }
+            }
+        }
+
+        void processSample (int channel, SampleType x, std::vector<SampleType>& bands)
+        {
+            auto allpass = allpasses.begin();
+
+            for (size_t k = 0; k < crossovers.size(); ++k)
+            {
+                SampleType low, high;
+                crossovers[k].processSample (channel, x, low, high);
+
+                for (auto j = k + 1; j < crossovers.size(); ++j)
+                    low = (allpass++)->processSample (channel, low);
+
+                bands[k] = low;
+                x = high;
+            }
+
+            bands.back() = x;
+        }
+
+        // The crossover snaps its filter states to zero at the end of each block, which
+        // changes its output by more than rounding errors would, so the tree has to match
+        void snapToZero()
+        {
+           #if JUCE_DSP_ENABLE_SNAP_TO_ZERO
+            for (auto* filters : { &crossovers, &allpasses })
+                for (auto& filter : *filters)
+                    filter.snapToZero();
+           #endif
+        }
+
+        std::vector<LinkwitzRileyFilter<SampleType>> crossovers, allpasses;
+    };
+
+    template <typename SampleType>
+    void compareWithFilterTree (int numBands, int numChannels, SampleType tolerance)
+    {
+        constexpr size_t maximumBlockSize = 128;
+        const ProcessSpec spec { 48000.0, (uint32) maximumBlockSize, (uint32) numChannels };
+
+        MultibandCrossover<SampleType> crossover;
+        crossover.setNumBands (numBands);
+
+        std::vector<SampleType> frequencies;
+
+        for (int k = 0; k < numBands - 1; ++k)
+        {
+            frequencies.push_back ((SampleType) (80.0 * std::pow (2.5, k)));
+            crossover.setCrossoverFrequency (k, frequencies.back());
+        }
+
+        crossover.prepare (spec);
+        FilterTree<SampleType> tree (frequencies, spec);
+
+        auto random = getRandom();
+        AudioBuffer<SampleType> input (numChannels, (int) maximumBlockSize);
+        std::vector<SampleType> bands ((size_t) numBands);
+        auto maxError = (SampleType) 0;
+
+        for (int block = 0; block < 100; ++block)
+        {
+            const auto numSamples = random.nextInt ({ 1, (int) maximumBlockSize + 1 });
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    input.setSample (channel, i, (SampleType) (random.nextDouble() * 2.0 - 1.0));
+
+            crossover.process (AudioBlock<const SampleType> (input).getSubBlock (0, (size_t) numSamples));
+            expectEquals (crossover.getBands().getNumSamples(), (size_t) numSamples);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    tree.processSample (channel, input.getSample (channel, i), bands);
+
+                    for (int band = 0; band < numBands; ++band)
+                        maxError = jmax (maxError, std::abs (crossover.getBand (band).getSample (channel, i) - bands[(size_t) band]));
+                }
+            }
+
+            tree.snapToZero();
+        }
+
+        expectLessThan (maxError, tolerance);
+    }
+
+    // Returns the gain of each band, and of their sum, for a sine wave at a frequency.
+    // The gains are measured over 12800 samples, so they are only exact for multiples
+    // of 3.75 Hz at 48 kHz
+    std::vector<double> getBandGains (MultibandCrossover<double>& crossover, double frequency)
+    {
+        constexpr int blockSize = 256, numBlocks = 100, numSettlingBlocks = 50;
+        const auto numBands = (size_t) crossover.getNumBands();
+
+        crossover.reset();
+
+        AudioBuffer<double> input (1, blockSize);
+        std::vector<double> energies (numBands + 1);
+        auto inputEnergy = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int i = 0; i < blockSize; ++i)
+                input.setSample (0, i, std::sin (MathConstants<double>::twoPi * frequency * (block * blockSize + i) / 48000.0));
+
+            crossover.process (AudioBlock<const double> (input));
+
+            if (block < numSettlingBlocks)
+                continue;
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                auto sum = 0.0;
+
+                for (size_t band = 0; band < numBands; ++band)
+                {
+                    const auto sample = crossover.getBand ((int) band).getSample (0, i);
+                    energies[band] += sample * sample;
+                    sum += sample;
+                }
+
+                energies[numBands] += sum * sum;
+                inputEnergy += square (input.getSample (0, i));
+            }
+        }
+
+        for (auto& energy : energies)
+            energy = std::sqrt (energy / inputEnergy);
+
+        return energies;
+    }
+
+    void runTest() override
+    {
+        beginTest ("The bands match a tree of LinkwitzRileyFilters");
+        {
+            for (auto numChannels : { 1, 2, 3, 5, 8 })
+            {
+                for (auto numBands : { 1, 2, 3, 5, 8 })
+                {
+                    compareWithFilterTree<float>  (numBands, numChannels, 1.0e-4f);
+                    compareWithFilterTree<double> (numBands, numChannels, 1.0e-8);
+                }
+            }
+        }
+
+        beginTest ("The bands add up to a flat magnitude response");
+        {
+            MultibandCrossover<double> crossover;
+            crossover.setNumBands (5);
+            crossover.prepare ({ 48000.0, 256, 1 });
+
+            for (auto frequency : { 22.5, 97.5, 101.25, 438.75, 1001.25, 3161.25, 9000.0, 19998.75 })
+                expectWithinAbsoluteError (getBandGains (crossover, frequency).back(), 1.0, 1.0e-3);
+        }
+
+        beginTest ("Sine waves are sent to the right band");
+        {
+            MultibandCrossover<double> crossover;
+            crossover.setNumBands (4);
+            crossover.prepare ({ 48000.0, 256, 1 });
+            crossover.setCrossoverFrequency (0, 200.0);
+            crossover.setCrossoverFrequency (1, 1000.0);
+            crossover.setCrossoverFrequency (2, 5000.0);
+
+            const std::pair<double, int> sines[] { { 40.0, 0 }, { 450.0, 1 }, { 2200.0, 2 }, { 16000.0, 3 } };
+
+            for (const auto& [frequency, expectedBand] : sines)
+            {
+                const auto gains = getBandGains (crossover, frequency);
+
+                for (int band = 0; band < 4; ++band)
+                {
+                    if (band == expectedBand)
+                        expectGreaterThan (gains[(size_t) band], 0.9);
+                    else
+                        expectLessThan (gains[(size_t) band], 0.1);
+                }
+            }
+        }
+
+        beginTest ("Changing the number of bands after preparing");
+        {
+            MultibandCrossover<float> crossover;
+            crossover.prepare ({ 48000.0, 64, 2 });
+            crossover.setNumBands (6);
+
+            AudioBuffer<float> input (2, 64);
+            input.clear();
+            input.setSample (1, 0, 1.0f);
+
+            crossover.process (AudioBlock<const float> (input));
+
+            expectEquals (crossover.getBands().getNumChannels(), (size_t) 12);
+            expectEquals (crossover.getBand (5).getNumChannels(), (size_t) 2);
+
+            auto leftEnergy = 0.0f, rightEnergy = 0.0f;
+
+            for (int band = 0; band < 6; ++band)
+            {
+                const auto block = crossover.getBand (band);
+
+                for (size_t i = 0; i < 64; ++i)
+                {
+                    leftEnergy  += square (block.getSample (0, (int) i));
+                    rightEnergy += square (block.getSample (1, (int) i));
+                }
+            }
+
+            expectEquals (leftEnergy, 0.0f);
+            expectGreaterThan (rightEnergy, 0.0f);
+        }
+    }
+};
+
+static MultibandCrossoverTests multibandCrossoverTests;
+
+} // namespace juce::dsp
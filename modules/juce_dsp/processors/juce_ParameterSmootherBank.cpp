@@ -0,0 +1,415 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+namespace ParameterSmootherBankHelpers
+{
+   #if JUCE_USE_SIMD
+    template <typename FloatType>
+    constexpr size_t numLanes = SIMDRegister<FloatType>::size();
+
+    template <typename FloatType>
+    static FloatType* alignToLanes (FloatType* pointer) noexcept
+    {
+        return SIMDRegister<FloatType>::getNextSIMDAlignedPtr (pointer);
+    }
+
+    /** Raises each lane to the same integer power, by repeated squaring. */
+    template <typename FloatType>
+    static SIMDRegister<FloatType> power (SIMDRegister<FloatType> base, size_t exponent) noexcept
+    {
+        auto result = SIMDRegister<FloatType>::expand ((FloatType) 1);
+
+        for (; exponent > 0; exponent >>= 1)
+        {
+            if ((exponent & 1) != 0)
+                result *= base;
+
+            base *= base;
+        }
+
+        return result;
+    }
+   #else
+    template <typename FloatType>
+    constexpr size_t numLanes = 1;
+
+    template <typename FloatType>
+    static FloatType* alignToLanes (FloatType* pointer) noexcept    { return pointer; }
+   #endif
+
+    template <typename FloatType>
+    static size_t roundUpToLanes (size_t num) noexcept
+    {
+        return (num + numLanes<FloatType> - 1) / numLanes<FloatType> * numLanes<FloatType>;
+    }
+}
+
+//==============================================================================
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::prepare (size_t newNumParameters, size_t newMaximumBlockSize)
+{
+    using namespace ParameterSmootherBankHelpers;
+
+    numParameters = newNumParameters;
+    maximumBlockSize = newMaximumBlockSize;
+
+    const auto defaultValue = (FloatType) (std::is_same_v<SmoothingType, ValueSmoothingTypes::Linear> ? 0 : 1);
+
+    values .assign (numParameters, defaultValue);
+    targets.assign (numParameters, defaultValue);
+    rampLengths.assign (numParameters, 0);
+    slots.assign (numParameters, -1);
+    rampStates.assign (numParameters, RampState::stale);
+    parameters.assign (numParameters, 0);
+
+    finishedInLastBlock.clear();
+    finishedInLastBlock.reserve (numParameters);
+
+    // The arrays for the active ramps are padded to a whole number of SIMD registers,
+    // so that they can be processed without a scalar tail
+    const auto capacity = roundUpToLanes<FloatType> (numParameters);
+    activeStorage.allocate (4 * capacity + numLanes<FloatType>, true);
+
+    currents    = alignToLanes (activeStorage.get());
+    steps       = currents + capacity;
+    rampTargets = steps + capacity;
+    countdowns  = rampTargets + capacity;
+
+    const auto stride = roundUpToLanes<FloatType> (maximumBlockSize);
+    rampStorage.allocate (numParameters * stride + numLanes<FloatType>, true);
+    rampPointers.allocate (numParameters, false);
+
+    for (size_t i = 0; i < numParameters; ++i)
+        rampPointers[i] = alignToLanes (rampStorage.get()) + i * stride;
+
+    numActive = 0;
+    lastBlockSize = 0;
+}
+
+//==============================================================================
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::setRampLength (double sampleRate, double rampLengthInSeconds) noexcept
+{
+    jassert (sampleRate > 0 && rampLengthInSeconds >= 0);
+
+    for (size_t i = 0; i < numParameters; ++i)
+        setRampLength (i, (int) std::floor (rampLengthInSeconds * sampleRate));
+}
+
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::setRampLength (size_t parameter, int numSteps) noexcept
+{
+    rampLengths[parameter] = numSteps;
+    setCurrentAndTargetValue (parameter, targets[parameter]);
+}
+
+//==============================================================================
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::setCurrentAndTargetValue (size_t parameter, FloatType newValue) noexcept
+{
+    stopRamp (parameter);
+
+    values[parameter] = targets[parameter] = newValue;
+    rampStates[parameter] = RampState::stale;
+}
+
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::setTargetValue (size_t parameter, FloatType newValue) noexcept
+{
+    if (approximatelyEqual (newValue, targets[parameter]))
+        return;
+
+    const auto numSteps = rampLengths[parameter];
+
+    if (numSteps <= 0)
+    {
+        setCurrentAndTargetValue (parameter, newValue);
+        return;
+    }
+
+    // Multiplicative smoothed values cannot ever reach 0!
+    jassert (! (std::is_same_v<SmoothingType, ValueSmoothingTypes::Multiplicative>
+                && approximatelyEqual (newValue, (FloatType) 0)));
+
+    const auto current = getCurrentValue (parameter);
+    targets[parameter] = newValue;
+
+    if (slots[parameter] < 0)
+    {
+        slots[parameter] = (int) numActive;
+        parameters[numActive++] = parameter;
+    }
+
+    const auto slot = (size_t) slots[parameter];
+
+    currents[slot] = current;
+    rampTargets[slot] = newValue;
+    countdowns[slot] = (FloatType) numSteps;
+
+    if constexpr (std::is_same_v<SmoothingType, ValueSmoothingTypes::Linear>)
+        steps[slot] = (newValue - current) / (FloatType) numSteps;
+    else
+        steps[slot] = std::exp ((std::log (std::abs (newValue)) - std::log (std::abs (current))) / (FloatType) numSteps);
+}
+
+template <typename FloatType, typename SmoothingType>
+FloatType ParameterSmootherBank<FloatType, SmoothingType>::getCurrentValue (size_t parameter) const noexcept
+{
+    const auto slot = slots[parameter];
+    return slot >= 0 ? currents[slot] : values[parameter];
+}
+
+//==============================================================================
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::advance (size_t numSamples) noexcept
+{
+    jassert (numSamples <= maximumBlockSize);
+
+    beginBlock (numSamples);
+
+    for (size_t slot = 0; slot < numActive; ++slot)
+    {
+        const auto parameter = parameters[slot];
+
+        writeRamp (slot, rampPointers[parameter], numSamples);
+        rampStates[parameter] = RampState::lastBlock;
+    }
+
+    advanceActive (numSamples);
+}
+
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::skip (size_t numSamples) noexcept
+{
+    beginBlock (0);
+    advanceActive (numSamples);
+}
+
+template <typename FloatType, typename SmoothingType>
+AudioBlock<const FloatType> ParameterSmootherBank<FloatType, SmoothingType>::getRamp (size_t parameter) noexcept
+{
+    // The ramps are only written by advance()
+    jassert (lastBlockSize > 0);
+
+    auto& state = rampStates[parameter];
+
+    // The values of a parameter which isn't ramping are only written when they're
+    // first asked for after it stops, so that constant parameters cost nothing
+    if (slots[parameter] < 0 && state == RampState::stale)
+    {
+        std::fill (rampPointers[parameter], rampPointers[parameter] + maximumBlockSize, values[parameter]);
+        state = RampState::constant;
+    }
+
+    return { rampPointers.get() + parameter, 1, lastBlockSize };
+}
+
+//==============================================================================
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::stopRamp (size_t parameter) noexcept
+{
+    const auto slot = slots[parameter];
+
+    if (slot < 0)
+        return;
+
+    // The last active ramp is moved into the gap, to keep them packed together
+    const auto last = --numActive;
+
+    if ((size_t) slot != last)
+    {
+        currents[slot]    = currents[last];
+        steps[slot]       = steps[last];
+        rampTargets[slot] = rampTargets[last];
+        countdowns[slot]  = countdowns[last];
+        parameters[(size_t) slot] = parameters[last];
+        slots[parameters[last]] = slot;
+    }
+
+    slots[parameter] = -1;
+}
+
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::beginBlock (size_t numSamples) noexcept
+{
+    // The ramps which finished during the last block still hold its values
+    for (auto parameter : finishedInLastBlock)
+        if (slots[parameter] < 0 && rampStates[parameter] == RampState::lastBlock)
+            rampStates[parameter] = RampState::stale;
+
+    finishedInLastBlock.clear();
+    lastBlockSize = numSamples;
+}
+
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::advanceActive (size_t numSamples) noexcept
+{
+    using namespace ParameterSmootherBankHelpers;
+    constexpr auto isLinear = std::is_same_v<SmoothingType, ValueSmoothingTypes::Linear>;
+
+    const auto num = (FloatType) numSamples;
+    size_t slot = 0;
+
+   #if JUCE_USE_SIMD
+    using Vec = SIMDRegister<FloatType>;
+
+    const auto numVec = Vec::expand (num);
+    const auto zero = Vec::expand ((FloatType) 0);
+
+    for (; slot < numActive; slot += Vec::size())
+    {
+        const auto current   = Vec::fromRawArray (currents + slot);
+        const auto step      = Vec::fromRawArray (steps + slot);
+        const auto target    = Vec::fromRawArray (rampTargets + slot);
+        const auto countdown = Vec::fromRawArray (countdowns + slot) - numVec;
+
+        const auto advanced = [&]
+        {
+            if constexpr (isLinear)
+                return Vec::multiplyAdd (current, step, numVec);
+            else
+                return current * power (step, numSamples);
+        }();
+
+        const auto finished = Vec::lessThanOrEqual (countdown, zero);
+
+        ((target & finished) + (advanced & ~finished)).copyToRawArray (currents + slot);
+        countdown.copyToRawArray (countdowns + slot);
+    }
+   #else
+    for (; slot < numActive; ++slot)
+    {
+        countdowns[slot] -= num;
+
+        if (countdowns[slot] <= 0)
+            currents[slot] = rampTargets[slot];
+        else if constexpr (isLinear)
+            currents[slot] += steps[slot] * num;
+        else
+            currents[slot] *= std::pow (steps[slot], num);
+    }
+   #endif
+
+    // The finished ramps are removed afterwards, as that moves the others around
+    for (slot = 0; slot < numActive;)
+    {
+        if (countdowns[slot] > 0)
+        {
+            ++slot;
+            continue;
+        }
+
+        const auto parameter = parameters[slot];
+        values[parameter] = targets[parameter];
+        finishedInLastBlock.push_back (parameter);
+        stopRamp (parameter);
+    }
+}
+
+template <typename FloatType, typename SmoothingType>
+void ParameterSmootherBank<FloatType, SmoothingType>::writeRamp (size_t slot, FloatType* destination, size_t numSamples) const noexcept
+{
+    constexpr auto isLinear = std::is_same_v<SmoothingType, ValueSmoothingTypes::Linear>;
+
+    // The value at sample i is the one SmoothedValue::getNextValue() would return on
+    // its (i + 1)th call, which is the target from the end of the countdown onwards
+    const auto numRamping = (size_t) jlimit ((FloatType) 0, (FloatType) numSamples, countdowns[slot] - 1);
+    const auto current = currents[slot];
+    const auto step = steps[slot];
+    size_t i = 0;
+
+   #if JUCE_USE_SIMD
+    using Vec = SIMDRegister<FloatType>;
+    constexpr auto numLanes = Vec::size();
+
+    if (numRamping >= numLanes)
+    {
+        alignas (sizeof (Vec)) FloatType laneValues[numLanes];
+
+        if constexpr (isLinear)
+        {
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                laneValues[lane] = (FloatType) (lane + 1);
+
+            // Each value is calculated from the start of the ramp rather than by
+            // accumulating the steps, so that the errors don't build up
+            auto index = Vec::fromRawArray (laneValues);
+            const auto currentVec = Vec::expand (current), stepVec = Vec::expand (step);
+
+            for (; i + numLanes <= numRamping; i += numLanes)
+            {
+                Vec::multiplyAdd (currentVec, stepVec, index).copyToRawArray (destination + i);
+                index += (FloatType) numLanes;
+            }
+        }
+        else
+        {
+            auto value = current;
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                laneValues[lane] = (value *= step);
+
+            auto stepPower = step;
+
+            for (size_t lane = 1; lane < numLanes; ++lane)
+                stepPower *= step;
+
+            auto valueVec = Vec::fromRawArray (laneValues);
+            const auto stepVec = Vec::expand (stepPower);
+
+            for (; i + numLanes <= numRamping; i += numLanes)
+            {
+                valueVec.copyToRawArray (destination + i);
+                valueVec *= stepVec;
+            }
+        }
+    }
+   #endif
+
+    if constexpr (isLinear)
+    {
+        for (; i < numRamping; ++i)
+            destination[i] = current + step * (FloatType) (i + 1);
+    }
+    else
+    {
+        for (auto value = i > 0 ? destination[i - 1] : current; i < numRamping; ++i)
+            destination[i] = (value *= step);
+    }
+
+    std::fill (destination + numRamping, destination + numSamples, rampTargets[slot]);
+}
+
+//==============================================================================
+template class ParameterSmootherBank<float,  ValueSmoothingTypes::Linear>;
+template class ParameterSmootherBank<double, ValueSmoothingTypes::Linear>;
+template class ParameterSmootherBank<float,  ValueSmoothingTypes::Multiplicative>;
+template class ParameterSmootherBank<double, ValueSmoothingTypes::Multiplicative>;
+
+} // namespace juce::dsp
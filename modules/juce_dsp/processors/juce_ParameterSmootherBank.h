@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+/**
+    Smooths the values of a large number of parameters at once.
+
+    A SmoothedValue per parameter has to be advanced one sample at a time, which
+    puts a branch into every inner loop, and adds up when there are thousands of
+    automated parameters. This class keeps the state of all the parameters in
+    arrays instead, and only advances the ones which are actually ramping, a block
+    at a time, using SIMD where it's available.
+
+    Call advance() once per block (or sub-block), and then read the per-sample
+    values of each parameter with getRamp(), or its value at the end of the block
+    with getCurrentValue(). When only the values at the block boundaries are
+    needed, skip() moves all the ramps on without writing the per-sample values,
+    which is cheaper still.
+
+    The ramps follow exactly the same curves as a SmoothedValue with the same
+    smoothing type, apart from rounding errors.
+
+    All the memory is allocated in prepare(), so everything else is realtime-safe.
+    The per-sample values take up the number of parameters times the maximum block
+    size, so for very large banks it's worth advancing in sub-blocks of 32 or 64
+    samples, which also keeps them in the cache. This class isn't thread-safe.
+
+    @see SmoothedValue
+
+    @tags{DSP}
+*/
+template <typename FloatType, typename SmoothingType = ValueSmoothingTypes::Linear>
+class ParameterSmootherBank
+{
+public:
+    //==============================================================================
+    /** Creates an empty ParameterSmootherBank. */
+    ParameterSmootherBank() = default;
+
+    //==============================================================================
+    /** Allocates the bank, and sets all the parameters to their default value
+        (0 for linear smoothing and 1 for multiplicative smoothing), with no ramp.
+
+        @param numParameters        the number of parameters
+        @param maximumBlockSize     the largest number of samples passed to advance()
+    */
+    void prepare (size_t numParameters, size_t maximumBlockSize);
+
+    /** Returns the number of parameters in the bank. */
+    size_t getNumParameters() const noexcept                    { return numParameters; }
+
+    //==============================================================================
+    /** Sets the ramp length of every parameter, and stops any ramps in progress. */
+    void setRampLength (double sampleRate, double rampLengthInSeconds) noexcept;
+
+    /** Sets the ramp length of a parameter in samples, and stops its ramp. */
+    void setRampLength (size_t parameter, int numSteps) noexcept;
+
+    //==============================================================================
+    /** Sets a parameter to a new value immediately, without a ramp. */
+    void setCurrentAndTargetValue (size_t parameter, FloatType newValue) noexcept;
+
+    /** Starts ramping a parameter towards a new value, from its current value. */
+    void setTargetValue (size_t parameter, FloatType newValue) noexcept;
+
+    /** Returns the value of a parameter at the end of the last block. */
+    FloatType getCurrentValue (size_t parameter) const noexcept;
+
+    /** Returns the value a parameter is ramping towards. */
+    FloatType getTargetValue (size_t parameter) const noexcept  { return targets[parameter]; }
+
+    /** Returns true if a parameter hasn't reached its target yet. */
+    bool isSmoothing (size_t parameter) const noexcept          { return slots[parameter] >= 0; }
+
+    /** Returns the number of parameters which are currently ramping. */
+    size_t getNumSmoothing() const noexcept                     { return numActive; }
+
+    //==============================================================================
+    /** Moves all the ramps on by a block, writing the values for each sample. */
+    void advance (size_t numSamples) noexcept;
+
+    /** Moves all the ramps on by a block, without writing the values for each sample.
+
+        This is identical to calling advance() with the same number of samples, apart
+        from getRamp() being unavailable until the next call to advance().
+    */
+    void skip (size_t numSamples) noexcept;
+
+    /** Returns the values of a parameter for each sample of the last block passed to
+        advance().
+
+        The block stays valid until the next call to advance(), skip(), or any of the
+        methods which change the parameter's value.
+    */
+    AudioBlock<const FloatType> getRamp (size_t parameter) noexcept;
+
+private:
+    //==============================================================================
+    enum class RampState : uint8
+    {
+        stale,      // the ramp has to be filled with the current value
+        constant,   // the ramp is filled with the current value
+        lastBlock   // the ramp holds the values written by the last call to advance()
+    };
+
+    void stopRamp (size_t parameter) noexcept;
+    void beginBlock (size_t numSamples) noexcept;
+    void advanceActive (size_t numSamples) noexcept;
+    void writeRamp (size_t slot, FloatType* destination, size_t numSamples) const noexcept;
+
+    //==============================================================================
+    // The state of each parameter
+    std::vector<FloatType> values, targets;
+    std::vector<int> rampLengths, slots;
+    std::vector<RampState> rampStates;
+    std::vector<size_t> finishedInLastBlock;
+    HeapBlock<FloatType*> rampPointers;
+    HeapBlock<FloatType> rampStorage;
+
+    // The state of each active ramp, packed at the start of the arrays
+    HeapBlock<FloatType> activeStorage;
+    FloatType* currents = nullptr;
+    FloatType* steps = nullptr;
+    FloatType* rampTargets = nullptr;
+    FloatType* countdowns = nullptr;
+    std::vector<size_t> parameters;
+
+    size_t numParameters = 0, numActive = 0, maximumBlockSize = 0, lastBlockSize = 0;
+};
+
+} // namespace juce::dsp
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+struct ParameterSmootherBankTests final : public UnitTest
+{
+    ParameterSmootherBankTests()
+        : UnitTest ("ParameterSmootherBank", UnitTestCategories::dsp)
+    {}
+
+    // Drives a bank and an array of SmoothedValues with the same random target
+    // changes and block sizes, and checks that they produce the same values
+    template <typename FloatType, typename SmoothingType>
+    void compareWithSmoothedValues (bool useSkip)
+    {
+        constexpr size_t numParameters = 37, maximumBlockSize = 64;
+        constexpr auto isLinear = std::is_same_v<SmoothingType, ValueSmoothingTypes::Linear>;
+        const auto tolerance = (FloatType) (std::is_same_v<FloatType, float> ? 1.0e-4 : 1.0e-10);
+
+        auto random = getRandom();
+        auto randomValue = [&] { return (FloatType) (isLinear ? random.nextDouble() * 2.0 - 1.0 : 0.1 + random.nextDouble() * 10.0); };
+
+        ParameterSmootherBank<FloatType, SmoothingType> bank;
+        bank.prepare (numParameters, maximumBlockSize);
+
+        std::vector<SmoothedValue<FloatType, SmoothingType>> smoothedValues (numParameters);
+
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            const auto numSteps = random.nextInt (300);
+            bank.setRampLength (i, numSteps);
+            smoothedValues[i].reset (numSteps);
+        }
+
+        auto maxError = (FloatType) 0;
+        auto smoothingMatches = true;
+
+        for (int block = 0; block < 500; ++block)
+        {
+            for (int change = random.nextInt (4); --change >= 0;)
+            {
+                const auto parameter = (size_t) random.nextInt ((int) numParameters);
+                const auto value = randomValue();
+
+                if (random.nextInt (8) == 0)
+                {
+                    bank.setCurrentAndTargetValue (parameter, value);
+                    smoothedValues[parameter].setCurrentAndTargetValue (value);
+                }
+                else
+                {
+                    bank.setTargetValue (parameter, value);
+                    smoothedValues[parameter].setTargetValue (value);
+                }
+            }
+
+            const auto numSamples = (size_t) random.nextInt ({ 1, (int) maximumBlockSize + 1 });
+
+            if (useSkip)
+                bank.skip (numSamples);
+            else
+                bank.advance (numSamples);
+
+            for (size_t i = 0; i < numParameters; ++i)
+            {
+                auto& smoothedValue = smoothedValues[i];
+
+                if (useSkip)
+                {
+                    smoothedValue.skip ((int) numSamples);
+                }
+                else
+                {
+                    const auto ramp = bank.getRamp (i);
+                    expectEquals (ramp.getNumSamples(), numSamples);
+
+                    for (size_t n = 0; n < numSamples; ++n)
+                    {
+                        const auto expected = smoothedValue.getNextValue();
+                        maxError = jmax (maxError, std::abs (ramp.getSample (0, (int) n) - expected) / jmax ((FloatType) 1, std::abs (expected)));
+                    }
+                }
+
+                const auto expected = smoothedValue.getCurrentValue();
+                maxError = jmax (maxError, std::abs (bank.getCurrentValue (i) - expected) / jmax ((FloatType) 1, std::abs (expected)));
+                smoothingMatches &= bank.isSmoothing (i) == smoothedValue.isSmoothing();
+            }
+        }
+
+        expectLessThan (maxError, tolerance);
+        expect (smoothingMatches);
+    }
+
+    void runTest() override
+    {
+        for (auto useSkip : { false, true })
+        {
+            const String method (useSkip ? "skip" : "advance");
+
+            beginTest ("Linear ramps match SmoothedValue using " + method);
+            compareWithSmoothedValues<float,  ValueSmoothingTypes::Linear> (useSkip);
+            compareWithSmoothedValues<double, ValueSmoothingTypes::Linear> (useSkip);
+
+            beginTest ("Multiplicative ramps match SmoothedValue using " + method);
+            compareWithSmoothedValues<float,  ValueSmoothingTypes::Multiplicative> (useSkip);
+            compareWithSmoothedValues<double, ValueSmoothingTypes::Multiplicative> (useSkip);
+        }
+
+        beginTest ("Only the ramping parameters are active");
+        {
+            ParameterSmootherBank<float> bank;
+            bank.prepare (1000, 32);
+            bank.setRampLength (48000.0, 0.001);
+
+            for (size_t i = 0; i < 1000; i += 10)
+                bank.setTargetValue (i, 1.0f);
+
+            expectEquals (bank.getNumSmoothing(), (size_t) 100);
+
+            bank.advance (32);
+            expectEquals (bank.getNumSmoothing(), (size_t) 100);
+
+            bank.advance (16);
+            expectEquals (bank.getNumSmoothing(), (size_t) 0);
+
+            const auto ramp = bank.getRamp (10);
+            expectEquals (ramp.getSample (0, 14), 47.0f / 48.0f);
+            expectEquals (ramp.getSample (0, 15), 1.0f);
+
+            bank.advance (32);
+            expectEquals (bank.getRamp (10).getSample (0, 0), 1.0f);
+            expectEquals (bank.getRamp (11).getSample (0, 31), 0.0f);
+        }
+    }
+};
+
+static ParameterSmootherBankTests parameterSmootherBankTests;
+
+} // namespace juce::dsp
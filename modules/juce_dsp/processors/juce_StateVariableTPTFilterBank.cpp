@@ -0,0 +1,297 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce::dsp
+{
+
+namespace StateVariableTPTFilterBankHelpers
+{
+   #if JUCE_USE_SIMD
+    template <typename SampleType>
+    struct Lanes
+    {
+        using Type = SIMDRegister<SampleType>;
+        static constexpr size_t size = Type::size();
+
+        static Type load (const SampleType* source) noexcept              { return Type::fromRawArray (source); }
+        static void store (SampleType* destination, Type value) noexcept  { value.copyToRawArray (destination); }
+        static Type expand (SampleType value) noexcept                    { return Type::expand (value); }
+        static SampleType* align (SampleType* pointer) noexcept           { return Type::getNextSIMDAlignedPtr (pointer); }
+    };
+   #else
+    template <typename SampleType>
+    struct Lanes
+    {
+        using Type = SampleType;
+        static constexpr size_t size = 1;
+
+        static Type load (const SampleType* source) noexcept              { return *source; }
+        static void store (SampleType* destination, Type value) noexcept  { *destination = value; }
+        static Type expand (SampleType value) noexcept                    { return value; }
+        static SampleType* align (SampleType* pointer) noexcept           { return pointer; }
+    };
+   #endif
+}
+
+//==============================================================================
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::setType (size_t filter, Type newType) noexcept
+{
+    jassert (filter < numFilters);
+
+    types[filter] = newType;
+    updateWeights (filter);
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::setCutoffFrequency (size_t filter, SampleType newFrequencyHz) noexcept
+{
+    jassert (filter < numFilters);
+    jassert (isPositiveAndBelow (newFrequencyHz, static_cast<SampleType> (sampleRate * 0.5)));
+
+    cutoffFrequencies[filter] = newFrequencyHz;
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::setResonance (size_t filter, SampleType newResonance) noexcept
+{
+    jassert (filter < numFilters);
+    jassert (newResonance > static_cast<SampleType> (0));
+
+    resonances[filter] = newResonance;
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::setCoefficientUpdateInterval (int numSamples) noexcept
+{
+    jassert (numSamples > 0);
+
+    updateInterval = jmax (1, numSamples);
+}
+
+//==============================================================================
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::prepare (const ProcessSpec& spec)
+{
+    using Lanes = StateVariableTPTFilterBankHelpers::Lanes<SampleType>;
+
+    jassert (spec.sampleRate > 0);
+    jassert (spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    numFilters = spec.numChannels;
+    maximumBlockSize = spec.maximumBlockSize;
+    numGroups = (numFilters + Lanes::size - 1) / Lanes::size;
+
+    // The same defaults as StateVariableTPTFilter
+    cutoffFrequencies.assign (numFilters, static_cast<SampleType> (1000.0));
+    resonances.assign (numFilters, static_cast<SampleType> (1.0 / MathConstants<double>::sqrt2));
+    types.assign (numFilters, Type::lowpass);
+
+    const auto rowSize = numGroups * Lanes::size;
+    laneStorage.allocate (numRows * rowSize + Lanes::size, true);
+
+    for (int row = 0; row < numRows; ++row)
+        rows[row] = Lanes::align (laneStorage.get()) + (size_t) row * rowSize;
+
+    laneInputs.allocate (rowSize, true);
+    laneOutputs.allocate (rowSize, true);
+
+    scratchStorage.allocate (2 * maximumBlockSize, true);
+    zeros  = scratchStorage.get();
+    unused = zeros + maximumBlockSize;
+
+    for (size_t filter = 0; filter < numFilters; ++filter)
+    {
+        updateWeights (filter);
+        reset (filter);
+    }
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::reset() noexcept
+{
+    for (size_t filter = 0; filter < numFilters; ++filter)
+        reset (filter);
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::reset (size_t filter) noexcept
+{
+    jassert (filter < numFilters);
+
+    const auto frequency = jlimit (static_cast<SampleType> (0), static_cast<SampleType> (sampleRate * 0.499), cutoffFrequencies[filter]);
+
+    rows[s1Row][filter] = 0;
+    rows[s2Row][filter] = 0;
+    rows[gRow] [filter] = FastMathApproximations::tan (static_cast<SampleType> (MathConstants<double>::pi * frequency / sampleRate));
+    rows[r2Row][filter] = static_cast<SampleType> (1) / resonances[filter];
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::snapToZero() noexcept
+{
+    for (auto row : { s1Row, s2Row })
+        for (size_t filter = 0; filter < numFilters; ++filter)
+            util::snapToZero (rows[row][filter]);
+}
+
+//==============================================================================
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::processBlock (const AudioBlock<const SampleType>& inputBlock,
+                                                           const AudioBlock<SampleType>& outputBlock,
+                                                           const AudioBlock<const SampleType>* cutoffModulation) noexcept
+{
+    const auto numChannels = outputBlock.getNumChannels();
+    const auto numSamples  = outputBlock.getNumSamples();
+
+    jassert (numChannels <= numFilters);
+    jassert (numSamples <= maximumBlockSize);
+
+    if (numSamples == 0)
+        return;
+
+    // The lanes beyond the last channel read silence, and write somewhere harmless
+    for (size_t channel = 0; channel < numGroups * StateVariableTPTFilterBankHelpers::Lanes<SampleType>::size; ++channel)
+    {
+        const auto isUsed = channel < numChannels;
+        laneInputs[channel]  = isUsed ? inputBlock .getChannelPointer (channel) : zeros;
+        laneOutputs[channel] = isUsed ? outputBlock.getChannelPointer (channel) : unused;
+    }
+
+    for (size_t group = 0; group < numGroups; ++group)
+        processGroup (group, numSamples, cutoffModulation);
+
+   #if JUCE_DSP_ENABLE_SNAP_TO_ZERO
+    snapToZero();
+   #endif
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::processGroup (size_t group, size_t numSamples,
+                                                           const AudioBlock<const SampleType>* cutoffModulation) noexcept
+{
+    using Lanes = StateVariableTPTFilterBankHelpers::Lanes<SampleType>;
+    constexpr auto numLanes = Lanes::size;
+
+    const auto firstFilter = group * numLanes;
+    const auto* inputs  = laneInputs.get()  + firstFilter;
+    auto* const* outputs = laneOutputs.get() + firstFilter;
+
+    const auto numModulated = cutoffModulation != nullptr ? cutoffModulation->getNumChannels() : 0;
+    const auto maximumFrequency = static_cast<SampleType> (sampleRate * 0.499);
+    const auto angleScale = static_cast<SampleType> (MathConstants<double>::pi / sampleRate);
+    const auto one = Lanes::expand (static_cast<SampleType> (1));
+
+    auto s1 = Lanes::load (rows[s1Row] + firstFilter);
+    auto s2 = Lanes::load (rows[s2Row] + firstFilter);
+    auto g  = Lanes::load (rows[gRow]  + firstFilter);
+    auto r2 = Lanes::load (rows[r2Row] + firstFilter);
+
+    const auto lowpassWeight  = Lanes::load (rows[lowpassRow]  + firstFilter);
+    const auto bandpassWeight = Lanes::load (rows[bandpassRow] + firstFilter);
+    const auto highpassWeight = Lanes::load (rows[highpassRow] + firstFilter);
+
+    alignas (sizeof (typename Lanes::Type)) SampleType lanes[numLanes];
+
+    for (size_t start = 0; start < numSamples; start += (size_t) updateInterval)
+    {
+        const auto end = jmin (numSamples, start + (size_t) updateInterval);
+
+        // Work out the coefficients for the end of the interval, and ramp towards them
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            const auto filter = firstFilter + lane;
+            auto frequency = (SampleType) 0;
+
+            if (filter < numModulated)
+                frequency = cutoffModulation->getSample ((int) filter, (int) end - 1);
+            else if (filter < numFilters)
+                frequency = cutoffFrequencies[filter];
+
+            lanes[lane] = jlimit ((SampleType) 0, maximumFrequency, frequency) * angleScale;
+        }
+
+        const auto gTarget = FastMathApproximations::tan (Lanes::load (lanes));
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+            lanes[lane] = firstFilter + lane < numFilters ? (SampleType) 1 / resonances[firstFilter + lane] : (SampleType) 1;
+
+        const auto r2Target = Lanes::load (lanes);
+
+        const auto scale = (SampleType) 1 / (SampleType) (end - start);
+        const auto gStep  = (gTarget  - g)  * scale;
+        const auto r2Step = (r2Target - r2) * scale;
+
+        for (auto i = start; i < end; ++i)
+        {
+            g  = g  + gStep;
+            r2 = r2 + r2Step;
+
+            const auto h = one / (g * (r2 + g) + one);
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                lanes[lane] = inputs[lane][i];
+
+            // The same as StateVariableTPTFilter::processSample(), for all the types at once
+            const auto yHP = (Lanes::load (lanes) - s1 * (g + r2) - s2) * h;
+
+            const auto yBP = yHP * g + s1;
+            s1             = yHP * g + yBP;
+
+            const auto yLP = yBP * g + s2;
+            s2             = yBP * g + yLP;
+
+            Lanes::store (lanes, yLP * lowpassWeight + yBP * bandpassWeight + yHP * highpassWeight);
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                outputs[lane][i] = lanes[lane];
+        }
+
+        g  = gTarget;
+        r2 = r2Target;
+    }
+
+    Lanes::store (rows[s1Row] + firstFilter, s1);
+    Lanes::store (rows[s2Row] + firstFilter, s2);
+    Lanes::store (rows[gRow]  + firstFilter, g);
+    Lanes::store (rows[r2Row] + firstFilter, r2);
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::updateWeights (size_t filter) noexcept
+{
+    const auto type = types[filter];
+
+    rows[lowpassRow] [filter] = type == Type::lowpass  ? 1 : 0;
+    rows[bandpassRow][filter] = type == Type::bandpass ? 1 : 0;
+    rows[highpassRow][filter] = type == Type::highpass ? 1 : 0;
+}
+
+//==============================================================================
+template class StateVariableTPTFilterBank<float>;
+template class StateVariableTPTFilterBank<double>;
+
+} // namespace juce::dsp
@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce::dsp
+{
+
+/**
+    A bank of StateVariableTPTFilters, one for each channel of the blocks it
+    processes, which are run side by side in the lanes of a SIMDRegister.
+
+    This is intended for polyphonic instruments, where every voice has its own
+    filter with its own modulated cutoff frequency: if each voice renders into a
+    channel of the same block, the filters for 4 or 8 voices are processed at once.
+
+    Rather than calling std::tan each time the cutoff frequency changes, the filter
+    coefficients are only recalculated every few samples, using
+    FastMathApproximations::tan on all the lanes at once, and interpolated linearly
+    between those updates. The interval between the updates can be set with
+    setCoefficientUpdateInterval(). The cutoff frequencies can be changed for each
+    block with setCutoffFrequency(), or modulated at audio rate by passing a block
+    of frequencies to process().
+
+    Each filter can have a different type. With a constant cutoff frequency, the
+    output is the same as a StateVariableTPTFilter's, apart from rounding errors.
+
+    @see StateVariableTPTFilter
+
+    @tags{DSP}
+*/
+template <typename SampleType>
+class StateVariableTPTFilterBank
+{
+public:
+    //==============================================================================
+    using Type = StateVariableTPTFilterType;
+
+    //==============================================================================
+    /** Creates an empty filter bank. */
+    StateVariableTPTFilterBank() = default;
+
+    //==============================================================================
+    /** Sets the type of one of the filters. */
+    void setType (size_t filter, Type newType) noexcept;
+
+    /** Sets the cutoff frequency of one of the filters in Hz.
+
+        The filter moves to the new frequency over the next coefficient update
+        interval.
+    */
+    void setCutoffFrequency (size_t filter, SampleType newFrequencyHz) noexcept;
+
+    /** Sets the resonance of one of the filters.
+
+        As with StateVariableTPTFilter, the value for a standard 12 dB / octave
+        filter is 1 / sqrt (2).
+    */
+    void setResonance (size_t filter, SampleType newResonance) noexcept;
+
+    /** Sets the number of samples between each recalculation of the filter
+        coefficients. The default is 16.
+    */
+    void setCoefficientUpdateInterval (int numSamples) noexcept;
+
+    //==============================================================================
+    /** Returns the type of one of the filters. */
+    Type getType (size_t filter) const noexcept                      { return types[filter]; }
+
+    /** Returns the cutoff frequency of one of the filters. */
+    SampleType getCutoffFrequency (size_t filter) const noexcept     { return cutoffFrequencies[filter]; }
+
+    /** Returns the resonance of one of the filters. */
+    SampleType getResonance (size_t filter) const noexcept           { return resonances[filter]; }
+
+    /** Returns the number of samples between each recalculation of the filter
+        coefficients.
+    */
+    int getCoefficientUpdateInterval() const noexcept               { return updateInterval; }
+
+    /** Returns the number of filters, which is the number of channels passed to
+        prepare().
+    */
+    size_t getNumFilters() const noexcept                           { return numFilters; }
+
+    //==============================================================================
+    /** Initialises the bank, with a filter for each channel of the spec. */
+    void prepare (const ProcessSpec& spec);
+
+    /** Resets the internal state variables of all the filters. */
+    void reset() noexcept;
+
+    /** Resets the internal state variables of one of the filters, and moves it
+        straight to its cutoff frequency and resonance, e.g. when a voice starts.
+    */
+    void reset (size_t filter) noexcept;
+
+    /** Ensure that the state variables are rounded to zero if the state
+        variables are denormals.
+    */
+    void snapToZero() noexcept;
+
+    //==============================================================================
+    /** Processes the input and output samples supplied in the processing context,
+        with channel n going through filter n.
+    */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        processContext (context, nullptr);
+    }
+
+    /** Processes the input and output samples supplied in the processing context,
+        with channel n going through filter n, and its cutoff frequency in Hz being
+        taken from channel n of the modulation block.
+
+        The frequencies are only read at the end of each coefficient update interval,
+        and replace the ones set with setCutoffFrequency().
+    */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context, const AudioBlock<const SampleType>& cutoffModulation) noexcept
+    {
+        jassert (cutoffModulation.getNumChannels() >= context.getOutputBlock().getNumChannels());
+        jassert (cutoffModulation.getNumSamples()  == context.getOutputBlock().getNumSamples());
+
+        processContext (context, &cutoffModulation);
+    }
+
+private:
+    //==============================================================================
+    template <typename ProcessContext>
+    void processContext (const ProcessContext& context, const AudioBlock<const SampleType>* cutoffModulation) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock      = context.getOutputBlock();
+
+        jassert (inputBlock.getNumChannels() == outputBlock.getNumChannels());
+        jassert (inputBlock.getNumSamples()  == outputBlock.getNumSamples());
+
+        if (context.isBypassed)
+        {
+            outputBlock.copyFrom (inputBlock);
+            return;
+        }
+
+        processBlock (inputBlock, outputBlock, cutoffModulation);
+    }
+
+    void processBlock (const AudioBlock<const SampleType>& inputBlock,
+                       const AudioBlock<SampleType>& outputBlock,
+                       const AudioBlock<const SampleType>* cutoffModulation) noexcept;
+
+    void processGroup (size_t group, size_t numSamples,
+                       const AudioBlock<const SampleType>* cutoffModulation) noexcept;
+
+    void updateWeights (size_t filter) noexcept;
+
+    //==============================================================================
+    // The parameters of each filter
+    std::vector<SampleType> cutoffFrequencies, resonances;
+    std::vector<Type> types;
+
+    // The state and coefficients of each filter, padded to a whole number of SIMD
+    // registers, with the filters in the lanes
+    enum Row { s1Row, s2Row, gRow, r2Row, lowpassRow, bandpassRow, highpassRow, numRows };
+
+    HeapBlock<SampleType> laneStorage;
+    SampleType* rows[numRows] {};
+
+    HeapBlock<const SampleType*> laneInputs;
+    HeapBlock<SampleType*> laneOutputs;
+    HeapBlock<SampleType> scratchStorage;
+    SampleType* zeros = nullptr;
+    SampleType* unused = nullptr;
+
+    double sampleRate = 44100.0;
+    size_t numFilters = 0, numGroups = 0, maximumBlockSize = 0;
+    int updateInterval = 16;
+};
+
+} // namespace juce::dsp
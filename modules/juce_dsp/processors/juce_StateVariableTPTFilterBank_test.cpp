@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce::dsp
+{
+
+struct StateVariableTPTFilterBankTests final : public UnitTest
+{
+    StateVariableTPTFilterBankTests()
+        : UnitTest ("StateVariableTPTFilterBank", UnitTestCategories::dsp)
+    {}
+
+    // Runs a bank and a StateVariableTPTFilter per channel over the same noise,
+    // either with random fixed parameters or with the cutoff changing every sample
+    template <typename SampleType>
+    void compareWithFilters (bool modulateCutoff, SampleType tolerance)
+    {
+        constexpr int numFilters = 11, maximumBlockSize = 64;
+        const ProcessSpec spec { 48000.0, (uint32) maximumBlockSize, (uint32) numFilters };
+        const StateVariableTPTFilterType types[] { StateVariableTPTFilterType::lowpass,
+                                                   StateVariableTPTFilterType::bandpass,
+                                                   StateVariableTPTFilterType::highpass };
+
+        auto random = getRandom();
+
+        StateVariableTPTFilterBank<SampleType> bank;
+        bank.prepare (spec);
+
+        if (modulateCutoff)
+            bank.setCoefficientUpdateInterval (1);
+
+        std::vector<StateVariableTPTFilter<SampleType>> filters ((size_t) numFilters);
+
+        for (size_t i = 0; i < (size_t) numFilters; ++i)
+        {
+            const auto type = types[i % 3];
+            const auto frequency = (SampleType) (50.0 + random.nextDouble() * 12000.0);
+            const auto resonance = (SampleType) (0.5 + random.nextDouble() * 4.0);
+
+            bank.setType (i, type);
+            bank.setCutoffFrequency (i, frequency);
+            bank.setResonance (i, resonance);
+            bank.reset (i);
+
+            filters[i].setType (type);
+            filters[i].prepare ({ spec.sampleRate, spec.maximumBlockSize, 1 });
+            filters[i].setCutoffFrequency (frequency);
+            filters[i].setResonance (resonance);
+        }
+
+        AudioBuffer<SampleType> buffer (numFilters, maximumBlockSize), expected (numFilters, maximumBlockSize),
+                                modulation (numFilters, maximumBlockSize);
+        auto maxError = (SampleType) 0;
+
+        for (int block = 0; block < 200; ++block)
+        {
+            const auto numSamples = random.nextInt ({ 1, maximumBlockSize + 1 });
+
+            for (int channel = 0; channel < numFilters; ++channel)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const auto x = (SampleType) (random.nextDouble() * 2.0 - 1.0);
+                    buffer.setSample (channel, i, x);
+                    modulation.setSample (channel, i, (SampleType) (50.0 + random.nextDouble() * 12000.0));
+
+                    if (modulateCutoff)
+                        filters[(size_t) channel].setCutoffFrequency (modulation.getSample (channel, i));
+
+                    expected.setSample (channel, i, filters[(size_t) channel].processSample (0, x));
+                }
+            }
+
+            auto subBlock = AudioBlock<SampleType> (buffer).getSubBlock (0, (size_t) numSamples);
+
+            if (modulateCutoff)
+                bank.process (ProcessContextReplacing<SampleType> (subBlock),
+                              AudioBlock<const SampleType> (modulation).getSubBlock (0, (size_t) numSamples));
+            else
+                bank.process (ProcessContextReplacing<SampleType> (subBlock));
+
+            for (int channel = 0; channel < numFilters; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    maxError = jmax (maxError, std::abs (buffer.getSample (channel, i) - expected.getSample (channel, i)));
+        }
+
+        expectLessThan (maxError, tolerance);
+    }
+
+    void runTest() override
+    {
+        beginTest ("Fixed filters match StateVariableTPTFilter");
+        {
+            compareWithFilters<float>  (false, 1.0e-4f);
+            compareWithFilters<double> (false, 1.0e-9);
+        }
+
+        beginTest ("Filters modulated every sample match StateVariableTPTFilter");
+        {
+            compareWithFilters<float>  (true, 1.0e-4f);
+            compareWithFilters<double> (true, 1.0e-9);
+        }
+
+        beginTest ("Interpolated coefficients follow a cutoff sweep");
+        {
+            constexpr int blockSize = 256, numSamples = 188 * blockSize;
+            AudioBuffer<float> input (2, numSamples), modulation (2, numSamples);
+
+            auto random = getRandom();
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto frequency = 200.0f * std::pow (40.0f, (float) i / (float) numSamples);
+
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    input.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+                    modulation.setSample (channel, i, frequency);
+                }
+            }
+
+            // One bank is updated every sample, and the other every 32 samples
+            StateVariableTPTFilterBank<float> exact, interpolated;
+
+            AudioBuffer<float> exactOutput (2, numSamples), interpolatedOutput (2, numSamples);
+
+            for (auto* bank : { &exact, &interpolated })
+            {
+                bank->prepare ({ 48000.0, (uint32) blockSize, 2 });
+                bank->setCoefficientUpdateInterval (bank == &exact ? 1 : 32);
+
+                for (size_t channel = 0; channel < 2; ++channel)
+                {
+                    bank->setCutoffFrequency (channel, modulation.getSample (0, 0));
+                    bank->reset (channel);
+                }
+            }
+
+            for (int start = 0; start < numSamples; start += blockSize)
+            {
+                const auto inputBlock = AudioBlock<const float> (input).getSubBlock ((size_t) start, (size_t) blockSize);
+                const auto modulationBlock = AudioBlock<const float> (modulation).getSubBlock ((size_t) start, (size_t) blockSize);
+                auto exactBlock = AudioBlock<float> (exactOutput).getSubBlock ((size_t) start, (size_t) blockSize);
+                auto interpolatedBlock = AudioBlock<float> (interpolatedOutput).getSubBlock ((size_t) start, (size_t) blockSize);
+
+                exact.process (ProcessContextNonReplacing<float> (inputBlock, exactBlock), modulationBlock);
+                interpolated.process (ProcessContextNonReplacing<float> (inputBlock, interpolatedBlock), modulationBlock);
+            }
+
+            auto maxError = 0.0f;
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    maxError = jmax (maxError, std::abs (exactOutput.getSample (channel, i) - interpolatedOutput.getSample (channel, i)));
+
+            expectLessThan (maxError, 0.01f);
+        }
+
+        beginTest ("Resetting one filter leaves the others alone");
+        {
+            StateVariableTPTFilterBank<float> bank;
+            bank.prepare ({ 48000.0, 16, 6 });
+
+            AudioBuffer<float> buffer (6, 16);
+            AudioBlock<float> block (buffer);
+            buffer.clear();
+
+            for (int channel = 0; channel < 6; ++channel)
+                buffer.setSample (channel, 0, 1.0f);
+
+            bank.process (ProcessContextReplacing<float> (block));
+            bank.reset (3);
+
+            buffer.clear();
+            bank.process (ProcessContextReplacing<float> (block));
+
+            for (size_t channel = 0; channel < 6; ++channel)
+            {
+                const auto range = block.getSingleChannelBlock (channel).findMinAndMax();
+
+                if (channel == 3)
+                    expect (range.isEmpty() && exactlyEqual (range.getStart(), 0.0f));
+                else
+                    expect (! range.isEmpty());
+            }
+        }
+    }
+};
+
+static StateVariableTPTFilterBankTests stateVariableTPTFilterBankTests;
+
+} // namespace juce::dsp
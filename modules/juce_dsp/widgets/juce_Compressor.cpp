@@ -72,9 +72,13 @@ void Compressor<SampleType>::prepare (const ProcessSpec& spec)
     jassert (spec.numChannels > 0);
 
     sampleRate = spec.sampleRate;
+    maximumBlockSize = spec.maximumBlockSize;
 
     envelopeFilter.prepare (spec);
 
+    // One channel per detector, plus one for scratch space
+    gainBuffer.setSize ((int) spec.numChannels + 1, (int) spec.maximumBlockSize, false, false, true);
+
     update();
     reset();
 }
@@ -100,6 +104,67 @@ SampleType Compressor<SampleType>::processSample (int channel, SampleType inputV
     return gain * inputValue;
 }
 
+template <typename SampleType>
+void Compressor<SampleType>::processBlock (const AudioBlock<const SampleType>& inputBlock,
+                                          const AudioBlock<SampleType>& outputBlock,
+                                          const AudioBlock<const SampleType>& sidechainBlock) noexcept
+{
+    const auto numChannels = outputBlock.getNumChannels();
+    const auto numSamples  = outputBlock.getNumSamples();
+    const auto numSidechainChannels = sidechainBlock.getNumChannels();
+    const auto numDetectors = linked ? (size_t) 1 : numChannels;
+
+    jassert (numChannels < (size_t) gainBuffer.getNumChannels());
+
+    auto gains = AudioBlock<SampleType> (gainBuffer).getSubBlock (0, numSamples);
+    auto detectors = gains.getSubsetChannelBlock (0, numDetectors);
+
+    // Detector input
+    if (linked)
+    {
+        auto* detector = gains.getChannelPointer (0);
+        auto* scratch  = gains.getChannelPointer (numChannels);
+
+        FloatVectorOperations::abs (detector, sidechainBlock.getChannelPointer (0), numSamples);
+
+        for (size_t channel = 1; channel < numSidechainChannels; ++channel)
+        {
+            FloatVectorOperations::abs (scratch, sidechainBlock.getChannelPointer (channel), numSamples);
+            FloatVectorOperations::max (detector, detector, scratch, numSamples);
+        }
+    }
+    else
+    {
+        for (size_t channel = 0; channel < numDetectors; ++channel)
+            FloatVectorOperations::copy (gains.getChannelPointer (channel),
+                                         sidechainBlock.getChannelPointer (jmin (channel, numSidechainChannels - 1)),
+                                         numSamples);
+    }
+
+    // Ballistics filter with peak rectifier
+    envelopeFilter.process (ProcessContextReplacing<SampleType> (detectors));
+
+    // VCA, computing (env / threshold) ^ (1 / ratio - 1) above the threshold as
+    // 2 ^ ((1 / ratio - 1) * log2 (env / threshold))
+    for (size_t channel = 0; channel < numDetectors; ++channel)
+    {
+        auto* gain = gains.getChannelPointer (channel);
+
+        FloatVectorOperations::multiply (gain, thresholdInverse, numSamples);
+        FloatVectorOperations::max (gain, gain, static_cast<SampleType> (1.0), numSamples);
+        FastMathApproximations::log2 (gain, numSamples);
+        FloatVectorOperations::multiply (gain, ratioInverse - static_cast<SampleType> (1.0), numSamples);
+        FastMathApproximations::exp2 (gain, numSamples);
+    }
+
+    // Output
+    for (size_t channel = 0; channel < numChannels; ++channel)
+        FloatVectorOperations::multiply (outputBlock.getChannelPointer (channel),
+                                         inputBlock.getChannelPointer (channel),
+                                         gains.getChannelPointer (linked ? 0 : channel),
+                                         numSamples);
+}
+
 template <typename SampleType>
 void Compressor<SampleType>::update()
 {
@@ -30,6 +30,11 @@ namespace juce::dsp
     A simple compressor with standard threshold, ratio, attack time and release time
     controls.
 
+    When processing whole blocks, the detector can optionally be linked across all the
+    channels, and can be driven by a separate sidechain signal. The envelope and gain
+    computation are then done on the whole block at once, using vectorised operations
+    and fast log2/exp2 approximations, instead of sample by sample.
+
     @tags{DSP}
 */
 template <typename SampleType>
@@ -53,6 +58,12 @@ public:
     /** Sets the release time in milliseconds of the compressor.*/
     void setRelease (SampleType newRelease);
 
+    /** Sets whether the channels share a single detector, driven by the loudest
+        channel, so that they all receive the same gain reduction. This preserves
+        the stereo image. This only affects the block processing methods.
+    */
+    void setLinkedDetection (bool shouldBeLinked) noexcept     { linked = shouldBeLinked; }
+
     //==============================================================================
     /** Initialises the processor. */
     void prepare (const ProcessSpec& spec);
@@ -64,14 +75,28 @@ public:
     /** Processes the input and output samples supplied in the processing context. */
     template <typename ProcessContext>
     void process (const ProcessContext& context) noexcept
+    {
+        process (context, context.getInputBlock());
+    }
+
+    /** Processes the input and output samples supplied in the processing context,
+        using a separate sidechain signal to drive the detector.
+
+        The sidechain block must have the same number of samples as the context, and
+        either a single channel or the same number of channels as the context.
+    */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context, const AudioBlock<const SampleType>& sidechainBlock) noexcept
     {
         const auto& inputBlock = context.getInputBlock();
         auto& outputBlock      = context.getOutputBlock();
-        const auto numChannels = outputBlock.getNumChannels();
+        [[maybe_unused]] const auto numChannels = outputBlock.getNumChannels();
         const auto numSamples  = outputBlock.getNumSamples();
 
         jassert (inputBlock.getNumChannels() == numChannels);
         jassert (inputBlock.getNumSamples()  == numSamples);
+        jassert (sidechainBlock.getNumChannels() == 1 || sidechainBlock.getNumChannels() == numChannels);
+        jassert (sidechainBlock.getNumSamples()  == numSamples);
 
         if (context.isBypassed)
         {
@@ -79,13 +104,15 @@ public:
             return;
         }
 
-        for (size_t channel = 0; channel < numChannels; ++channel)
-        {
-            auto* inputSamples  = inputBlock .getChannelPointer (channel);
-            auto* outputSamples = outputBlock.getChannelPointer (channel);
+        // Make sure you call prepare() before processing!
+        jassert (maximumBlockSize > 0);
 
-            for (size_t i = 0; i < numSamples; ++i)
-                outputSamples[i] = processSample ((int) channel, inputSamples[i]);
+        for (size_t start = 0; start < numSamples; start += maximumBlockSize)
+        {
+            const auto length = jmin (maximumBlockSize, numSamples - start);
+            processBlock (inputBlock.getSubBlock (start, length),
+                          outputBlock.getSubBlock (start, length),
+                          sidechainBlock.getSubBlock (start, length));
         }
     }
 
@@ -95,13 +122,18 @@ public:
 private:
     //==============================================================================
     void update();
+    void processBlock (const AudioBlock<const SampleType>&, const AudioBlock<SampleType>&,
+                       const AudioBlock<const SampleType>&) noexcept;
 
     //==============================================================================
     SampleType threshold, thresholdInverse, ratioInverse;
     BallisticsFilter<SampleType> envelopeFilter;
+    AudioBuffer<SampleType> gainBuffer;
 
     double sampleRate = 44100.0;
+    size_t maximumBlockSize = 0;
     SampleType thresholddB = 0.0, ratio = 1.0, attackTime = 1.0, releaseTime = 100.0;
+    bool linked = false;
 };
 
 } // namespace juce::dsp
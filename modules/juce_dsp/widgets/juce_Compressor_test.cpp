@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+class CompressorTests final : public UnitTest
+{
+public:
+    CompressorTests()
+        : UnitTest ("Compressor", UnitTestCategories::dsp)
+    {}
+
+    void runTest() override
+    {
+        constexpr auto sampleRate = 44100.0;
+        constexpr auto blockSize = 256;
+        constexpr auto numSamples = 4096;
+
+        // With a constant input, the envelope settles on the input level, so the gain
+        // settles on (level / threshold) ^ (1 / ratio - 1)
+        constexpr auto loud = 0.9f, quiet = 0.05f, threshold = 0.1f, ratio = 4.0f;
+        const auto settledGain = std::pow (loud / threshold, 1.0f / ratio - 1.0f);
+
+        const auto makeCompressor = [&] (bool linked)
+        {
+            Compressor<float> compressor;
+            compressor.setThreshold (Decibels::gainToDecibels (threshold));
+            compressor.setRatio (ratio);
+            compressor.setAttack (1.0f);
+            compressor.setRelease (50.0f);
+            compressor.setLinkedDetection (linked);
+            compressor.prepare ({ sampleRate, (uint32) blockSize, 2 });
+            return compressor;
+        };
+
+        const auto makeConstantBuffer = [] (std::initializer_list<float> levels)
+        {
+            AudioBuffer<float> buffer ((int) levels.size(), numSamples);
+
+            for (auto [channel, level] : enumerate (levels))
+                FloatVectorOperations::fill (buffer.getWritePointer ((int) channel), level, numSamples);
+
+            return buffer;
+        };
+
+        const auto getGain = [] (const AudioBuffer<float>& output, const AudioBuffer<float>& input, int channel, int sample)
+        {
+            return output.getSample (channel, sample) / input.getSample (channel, sample);
+        };
+
+        beginTest ("Block processing matches sample processing");
+        {
+            auto blockCompressor = makeCompressor (false);
+            auto sampleCompressor = makeCompressor (false);
+
+            AudioBuffer<float> buffer (2, numSamples);
+            auto random = getRandom();
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample (channel, i, (random.nextFloat() * 2.0f - 1.0f) * (channel == 0 ? loud : quiet));
+
+            AudioBuffer<float> expected (buffer);
+
+            for (int channel = 0; channel < expected.getNumChannels(); ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    expected.setSample (channel, i, sampleCompressor.processSample (channel, expected.getSample (channel, i)));
+
+            AudioBlock<float> block (buffer);
+            blockCompressor.process (ProcessContextReplacing<float> (block));
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    expectWithinAbsoluteError (buffer.getSample (channel, i), expected.getSample (channel, i), 1.0e-5f);
+        }
+
+        beginTest ("Unlinked channels are compressed independently");
+        {
+            auto compressor = makeCompressor (false);
+            const auto input = makeConstantBuffer ({ loud, quiet });
+            auto output = input;
+
+            AudioBlock<float> block (output);
+            compressor.process (ProcessContextReplacing<float> (block));
+
+            expectWithinAbsoluteError (getGain (output, input, 0, numSamples - 1), settledGain, 1.0e-4f);
+
+            for (int i = 0; i < numSamples; ++i)
+                expectEquals (getGain (output, input, 1, i), 1.0f);
+        }
+
+        beginTest ("Linked channels all receive the gain reduction of the loudest channel");
+        {
+            auto compressor = makeCompressor (true);
+            const auto input = makeConstantBuffer ({ quiet, loud });
+            auto output = input;
+
+            AudioBlock<float> block (output);
+            compressor.process (ProcessContextReplacing<float> (block));
+
+            expectWithinAbsoluteError (getGain (output, input, 1, numSamples - 1), settledGain, 1.0e-4f);
+
+            for (int i = 0; i < numSamples; ++i)
+                expectWithinAbsoluteError (getGain (output, input, 0, i), getGain (output, input, 1, i), 1.0e-6f);
+        }
+
+        beginTest ("A sidechain signal drives the gain reduction");
+        {
+            const auto input = makeConstantBuffer ({ quiet, quiet });
+
+            {
+                auto compressor = makeCompressor (false);
+                const auto sidechain = makeConstantBuffer ({ loud });
+                auto output = input;
+
+                AudioBlock<float> block (output);
+                compressor.process (ProcessContextReplacing<float> (block), AudioBlock<const float> (sidechain));
+
+                // A mono sidechain drives every channel
+                for (int channel = 0; channel < output.getNumChannels(); ++channel)
+                    expectWithinAbsoluteError (getGain (output, input, channel, numSamples - 1), settledGain, 1.0e-4f);
+            }
+
+            {
+                auto compressor = makeCompressor (false);
+                const auto sidechain = makeConstantBuffer ({ quiet, loud });
+                auto output = input;
+
+                AudioBlock<float> block (output);
+                compressor.process (ProcessContextReplacing<float> (block), AudioBlock<const float> (sidechain));
+
+                // Each sidechain channel drives its own channel
+                for (int i = 0; i < numSamples; ++i)
+                    expectEquals (getGain (output, input, 0, i), 1.0f);
+
+                expectWithinAbsoluteError (getGain (output, input, 1, numSamples - 1), settledGain, 1.0e-4f);
+            }
+
+            {
+                auto compressor = makeCompressor (true);
+                const auto sidechain = makeConstantBuffer ({ quiet, loud });
+                auto output = input;
+
+                AudioBlock<float> block (output);
+                compressor.process (ProcessContextReplacing<float> (block), AudioBlock<const float> (sidechain));
+
+                // A linked detector follows the loudest sidechain channel
+                for (int channel = 0; channel < output.getNumChannels(); ++channel)
+                    expectWithinAbsoluteError (getGain (output, input, channel, numSamples - 1), settledGain, 1.0e-4f);
+            }
+        }
+    }
+};
+
+static CompressorTests compressorTests;
+
+} // namespace juce::dsp
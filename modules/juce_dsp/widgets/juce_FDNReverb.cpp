@@ -0,0 +1,384 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+//==============================================================================
+template <typename SampleType>
+FDNReverb<SampleType>::FDNReverb (int numDelayLines, MixingMatrix matrixType)
+    : numLines (numDelayLines <= 8 ? 8 : maxDelayLines),
+      matrix (matrixType)
+{
+    // Only networks of 8 or 16 delay lines are supported
+    jassert (numDelayLines == 8 || numDelayLines == 16);
+
+    const auto normalisation = (SampleType) (1.0 / std::sqrt ((double) numLines));
+
+    for (int column = 0; column < numLines; ++column)
+        for (int row = 0; row < numLines; ++row)
+            hadamardColumns[(size_t) column][(size_t) row] = (countNumberOfBits ((uint32) (row & column)) & 1) != 0 ? -normalisation
+                                                                                                                    :  normalisation;
+
+    const auto tapGain = (SampleType) (1.0 / std::sqrt ((double) numLines / 2.0));
+
+    for (int i = 0; i < numLines; ++i)
+    {
+        const auto tap = ((i / 2) & 1) != 0 ? -tapGain : tapGain;
+        outputTapsLeft [(size_t) i] = (i & 1) == 0 ? tap : SampleType();
+        outputTapsRight[(size_t) i] = (i & 1) != 0 ? tap : SampleType();
+    }
+
+    inputGain = (SampleType) (1.0 / std::sqrt ((double) numLines));
+}
+
+template <typename SampleType>
+void FDNReverb<SampleType>::setParameters (const Parameters& newParams)
+{
+    parameters = newParams;
+    update();
+}
+
+//==============================================================================
+template <typename SampleType>
+void FDNReverb<SampleType>::prepare (const ProcessSpec& spec)
+{
+    jassert (spec.sampleRate > 0);
+    jassert (spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+
+    // The base delay lengths are spread exponentially, and rounded to prime numbers
+    // of samples so that the echoes of the different lines don't line up
+    const auto isPrime = [] (int n)
+    {
+        if (n < 2)
+            return false;
+
+        for (int d = 2; d * d <= n; ++d)
+            if (n % d == 0)
+                return false;
+
+        return true;
+    };
+
+    for (int i = 0; i < numLines; ++i)
+    {
+        const auto proportion = (double) i / (double) (numLines - 1);
+        const auto delayMs = minDelayMs * std::pow (maxDelayMs / minDelayMs, proportion);
+        auto delaySamples = roundToInt (delayMs * sampleRate / 1000.0);
+
+        while (! isPrime (delaySamples))
+            ++delaySamples;
+
+        baseDelays[(size_t) i] = (SampleType) delaySamples;
+    }
+
+    const auto maxDelaySamples = (int) std::ceil ((maxDelayMs + 2.0 * maxModulationMs) * sampleRate / 1000.0) + 4;
+    const auto bufferSize = nextPowerOfTwo (maxDelaySamples);
+
+    delayBuffer.setSize (numLines, bufferSize, false, false, true);
+    delayBufferMask = bufferSize - 1;
+
+    update();
+    reset();
+}
+
+template <typename SampleType>
+void FDNReverb<SampleType>::reset()
+{
+    delayBuffer.clear();
+    writePosition = 0;
+
+    decayState = {};
+
+    for (int i = 0; i < numLines; ++i)
+    {
+        const auto phase = MathConstants<double>::twoPi * (double) i / (double) numLines;
+        modSin[(size_t) i] = (SampleType) std::sin (phase);
+        modCos[(size_t) i] = (SampleType) std::cos (phase);
+    }
+
+    for (auto* smoother : { &sizeScale, &wetGain1, &wetGain2, &dryGain })
+        smoother->reset (sampleRate, 0.05);
+}
+
+//==============================================================================
+template <typename SampleType>
+void FDNReverb<SampleType>::update()
+{
+    const auto width = jlimit (0.0f, 1.0f, parameters.width);
+    const auto wet   = jlimit (0.0f, 1.0f, parameters.wetLevel);
+
+    wetGain1.setTargetValue ((SampleType) (0.5f * wet * (1.0f + width)));
+    wetGain2.setTargetValue ((SampleType) (0.5f * wet * (1.0f - width)));
+    dryGain .setTargetValue ((SampleType) jlimit (0.0f, 1.0f, parameters.dryLevel));
+
+    const auto scale = jmap ((double) jlimit (0.0f, 1.0f, parameters.roomSize), 0.25, 1.0);
+    sizeScale.setTargetValue ((SampleType) scale);
+
+    modDepthSamples = (SampleType) (jlimit (0.0f, 1.0f, parameters.modulationDepth) * maxModulationMs * sampleRate / 1000.0);
+
+    // Each line gets a slightly different modulation rate to decorrelate them
+    for (int i = 0; i < numLines; ++i)
+    {
+        const auto rate = jlimit (0.0, 10.0, (double) parameters.modulationRate) * (1.0 + 0.25 * (double) i / (double) numLines);
+        const auto increment = MathConstants<double>::twoPi * rate / sampleRate;
+
+        modRotSin[(size_t) i] = (SampleType) std::sin (increment);
+        modRotCos[(size_t) i] = (SampleType) std::cos (increment);
+    }
+
+    // Each line has a one-pole filter in its feedback path, with its DC and Nyquist gains set
+    // so that low and high frequencies decay by 60 dB over their respective decay times
+    const auto lowDecay  = jmax (0.01, (double) parameters.decayTime);
+    const auto highDecay = lowDecay * (1.0 - 0.95 * (double) jlimit (0.0f, 1.0f, parameters.damping));
+
+    for (int i = 0; i < numLines; ++i)
+    {
+        const auto length = (double) baseDelays[(size_t) i] * scale + (double) modDepthSamples;
+        const auto gainDC      = std::pow (10.0, -3.0 * length / (lowDecay  * sampleRate));
+        const auto gainNyquist = std::pow (10.0, -3.0 * length / (highDecay * sampleRate));
+        const auto b = (gainDC - gainNyquist) / (gainDC + gainNyquist);
+
+        decayCoeffA[(size_t) i] = (SampleType) (gainDC * (1.0 - b));
+        decayCoeffB[(size_t) i] = (SampleType) b;
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void FDNReverb<SampleType>::processInPlace (AudioBlock<SampleType>& block) noexcept
+{
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples  = block.getNumSamples();
+
+    auto* left  = block.getChannelPointer (0);
+    auto* right = numChannels > 1 ? block.getChannelPointer (1) : nullptr;
+    auto* const* lines = delayBuffer.getArrayOfWritePointers();
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        computeDelayTimes();
+
+        for (int line = 0; line < numLines; ++line)
+        {
+            const auto readPosition = (SampleType) writePosition - delayTimes[(size_t) line];
+            const auto index = (int) std::floor (readPosition);
+            const auto fraction = readPosition - (SampleType) index;
+            const auto* samples = lines[line];
+
+            const auto a = samples[index & delayBufferMask];
+            const auto b = samples[(index + 1) & delayBufferMask];
+
+            lineOutputs[(size_t) line] = a + fraction * (b - a);
+        }
+
+        SampleType wetLeft {}, wetRight {};
+        filterAndMix (wetLeft, wetRight);
+
+        const auto inLeft  = left[i];
+        const auto inRight = right != nullptr ? right[i] : inLeft;
+
+        for (int line = 0; line < numLines; ++line)
+            lines[line][writePosition] = mixed[(size_t) line] + inputGain * ((line & 1) == 0 ? inLeft : inRight);
+
+        writePosition = (writePosition + 1) & delayBufferMask;
+        advanceModulation();
+
+        const auto w1 = wetGain1.getNextValue();
+        const auto w2 = wetGain2.getNextValue();
+        const auto d  = dryGain .getNextValue();
+
+        if (right != nullptr)
+        {
+            left[i]  = d * inLeft  + w1 * wetLeft  + w2 * wetRight;
+            right[i] = d * inRight + w1 * wetRight + w2 * wetLeft;
+        }
+        else
+        {
+            left[i] = d * inLeft + (SampleType) 0.5 * (w1 + w2) * (wetLeft + wetRight);
+        }
+    }
+
+    normaliseModulation();
+}
+
+//==============================================================================
+template <typename SampleType>
+void FDNReverb<SampleType>::computeDelayTimes() noexcept
+{
+    const auto scale = sizeScale.getNextValue();
+
+   #if JUCE_USE_SIMD
+    using Vec = SIMDRegister<SampleType>;
+
+    const auto vScale = Vec::expand (scale);
+    const auto vDepth = Vec::expand (modDepthSamples);
+
+    for (size_t i = 0; i < (size_t) numLines; i += Vec::size())
+    {
+        const auto modulation = Vec::multiplyAdd (vDepth, vDepth, Vec::fromRawArray (modSin.values + i));
+        Vec::multiplyAdd (modulation, vScale, Vec::fromRawArray (baseDelays.values + i)).copyToRawArray (delayTimes.values + i);
+    }
+   #else
+    for (size_t i = 0; i < (size_t) numLines; ++i)
+        delayTimes[i] = baseDelays[i] * scale + modDepthSamples * (1 + modSin[i]);
+   #endif
+}
+
+template <typename SampleType>
+void FDNReverb<SampleType>::filterAndMix (SampleType& wetLeft, SampleType& wetRight) noexcept
+{
+   #if JUCE_USE_SIMD
+    using Vec = SIMDRegister<SampleType>;
+
+    auto sumLeft  = Vec::expand (0);
+    auto sumRight = Vec::expand (0);
+    auto total    = Vec::expand (0);
+
+    for (size_t i = 0; i < (size_t) numLines; i += Vec::size())
+    {
+        const auto input = Vec::fromRawArray (lineOutputs.values + i) * Vec::fromRawArray (decayCoeffA.values + i);
+        const auto state = Vec::multiplyAdd (input, Vec::fromRawArray (decayCoeffB.values + i), Vec::fromRawArray (decayState.values + i));
+        state.copyToRawArray (decayState.values + i);
+
+        sumLeft  = Vec::multiplyAdd (sumLeft,  state, Vec::fromRawArray (outputTapsLeft .values + i));
+        sumRight = Vec::multiplyAdd (sumRight, state, Vec::fromRawArray (outputTapsRight.values + i));
+        total += state;
+    }
+
+    wetLeft  = sumLeft .sum();
+    wetRight = sumRight.sum();
+
+    if (matrix == MixingMatrix::householder)
+    {
+        // (I - 2/N 11^T) x
+        const auto reflection = Vec::expand (total.sum() * (SampleType) -2 / (SampleType) numLines);
+
+        for (size_t i = 0; i < (size_t) numLines; i += Vec::size())
+            (Vec::fromRawArray (decayState.values + i) + reflection).copyToRawArray (mixed.values + i);
+    }
+    else
+    {
+        for (size_t i = 0; i < (size_t) numLines; i += Vec::size())
+        {
+            auto result = Vec::expand (0);
+
+            for (size_t column = 0; column < (size_t) numLines; ++column)
+                result = Vec::multiplyAdd (result, Vec::fromRawArray (hadamardColumns[column].values + i), Vec::expand (decayState[column]));
+
+            result.copyToRawArray (mixed.values + i);
+        }
+    }
+   #else
+    SampleType total {};
+
+    for (size_t i = 0; i < (size_t) numLines; ++i)
+    {
+        const auto state = lineOutputs[i] * decayCoeffA[i] + decayCoeffB[i] * decayState[i];
+        decayState[i] = state;
+
+        wetLeft  += state * outputTapsLeft[i];
+        wetRight += state * outputTapsRight[i];
+        total += state;
+    }
+
+    if (matrix == MixingMatrix::householder)
+    {
+        const auto reflection = total * (SampleType) -2 / (SampleType) numLines;
+
+        for (size_t i = 0; i < (size_t) numLines; ++i)
+            mixed[i] = decayState[i] + reflection;
+    }
+    else
+    {
+        for (size_t i = 0; i < (size_t) numLines; ++i)
+        {
+            SampleType result {};
+
+            for (size_t column = 0; column < (size_t) numLines; ++column)
+                result += hadamardColumns[column][i] * decayState[column];
+
+            mixed[i] = result;
+        }
+    }
+   #endif
+
+    for (size_t i = 0; i < (size_t) numLines; ++i)
+        util::snapToZero (decayState[i]);
+}
+
+template <typename SampleType>
+void FDNReverb<SampleType>::advanceModulation() noexcept
+{
+    // Each LFO is a phasor rotated by a fixed angle every sample, which avoids
+    // having to call sin() for every line
+   #if JUCE_USE_SIMD
+    using Vec = SIMDRegister<SampleType>;
+
+    for (size_t i = 0; i < (size_t) numLines; i += Vec::size())
+    {
+        const auto s  = Vec::fromRawArray (modSin.values + i);
+        const auto c  = Vec::fromRawArray (modCos.values + i);
+        const auto rs = Vec::fromRawArray (modRotSin.values + i);
+        const auto rc = Vec::fromRawArray (modRotCos.values + i);
+
+        Vec::multiplyAdd (s * rc, c, rs).copyToRawArray (modSin.values + i);
+        (c * rc - s * rs).copyToRawArray (modCos.values + i);
+    }
+   #else
+    for (size_t i = 0; i < (size_t) numLines; ++i)
+    {
+        const auto s = modSin[i];
+        const auto c = modCos[i];
+
+        modSin[i] = s * modRotCos[i] + c * modRotSin[i];
+        modCos[i] = c * modRotCos[i] - s * modRotSin[i];
+    }
+   #endif
+}
+
+template <typename SampleType>
+void FDNReverb<SampleType>::normaliseModulation() noexcept
+{
+    for (size_t i = 0; i < (size_t) numLines; ++i)
+    {
+        const auto magnitude = std::sqrt (modSin[i] * modSin[i] + modCos[i] * modCos[i]);
+
+        if (magnitude > 0)
+        {
+            modSin[i] /= magnitude;
+            modCos[i] /= magnitude;
+        }
+    }
+}
+
+//==============================================================================
+template class FDNReverb<float>;
+template class FDNReverb<double>;
+
+} // namespace juce::dsp
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+/**
+    An algorithmic reverb built around a feedback delay network.
+
+    The input is fed into a set of 8 or 16 delay lines whose outputs are passed
+    through a frequency-dependent decay filter, mixed together by a lossless
+    (orthogonal) feedback matrix and written back into the lines. The delay lengths
+    are slowly modulated to avoid the metallic ringing of static networks.
+
+    Unlike the Freeverb-style juce::Reverb wrapped by dsp::Reverb, all the per-line
+    work (decay filtering, output taps, modulation and matrix mixing) is done on
+    whole vectors of lines at once using SIMDRegister, so it's cheap enough to be
+    used on every track of a large session.
+
+    The processor supports mono or stereo contexts with matching input and output
+    channel counts.
+
+    @see Reverb
+
+    @tags{DSP}
+*/
+template <typename SampleType>
+class FDNReverb
+{
+public:
+    //==============================================================================
+    /** The lossless matrix used to mix the delay line outputs back into the network. */
+    enum class MixingMatrix
+    {
+        hadamard,       /**< A normalised Hadamard matrix, which gives a very dense echo pattern. */
+        householder     /**< A Householder reflection, which is cheaper and slightly less diffuse. */
+    };
+
+    /** Holds the parameters used by the reverb. */
+    struct Parameters
+    {
+        float roomSize        = 0.5f;   /**< Scales the delay line lengths, 0 to 1. */
+        float decayTime       = 2.0f;   /**< The time in seconds for low frequencies to decay by 60 dB. */
+        float damping         = 0.5f;   /**< How much faster high frequencies decay, 0 to 1. */
+        float modulationDepth = 0.3f;   /**< The amount of delay modulation, 0 to 1. */
+        float modulationRate  = 0.7f;   /**< The rate in Hz of the delay modulation. */
+        float wetLevel        = 0.33f;  /**< Wet level, 0 to 1. */
+        float dryLevel        = 0.4f;   /**< Dry level, 0 to 1. */
+        float width           = 1.0f;   /**< Reverb width, 0 to 1. */
+    };
+
+    //==============================================================================
+    /** Creates an uninitialised reverb using the given number of delay lines, which
+        must be 8 or 16. Call prepare() before first use.
+    */
+    explicit FDNReverb (int numDelayLines = 8, MixingMatrix matrixType = MixingMatrix::hadamard);
+
+    //==============================================================================
+    /** Returns the reverb's current parameters. */
+    const Parameters& getParameters() const noexcept    { return parameters; }
+
+    /** Applies a new set of parameters to the reverb.
+        Note that this doesn't attempt to lock the reverb, so if you call this in parallel with
+        the process method, you may get artifacts.
+    */
+    void setParameters (const Parameters& newParams);
+
+    /** Returns the number of delay lines in the network. */
+    int getNumDelayLines() const noexcept               { return numLines; }
+
+    /** Returns the type of feedback matrix used by the network. */
+    MixingMatrix getMixingMatrix() const noexcept       { return matrix; }
+
+    /** Returns true if the reverb is enabled. */
+    bool isEnabled() const noexcept                     { return enabled; }
+
+    /** Enables/disables the reverb. */
+    void setEnabled (bool newValue) noexcept            { enabled = newValue; }
+
+    //==============================================================================
+    /** Initialises the processor. */
+    void prepare (const ProcessSpec& spec);
+
+    /** Resets the internal state variables of the processor. */
+    void reset();
+
+    //==============================================================================
+    /** Processes the input and output samples supplied in the processing context. */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock      = context.getOutputBlock();
+        const auto numChannels = outputBlock.getNumChannels();
+        [[maybe_unused]] const auto numSamples = outputBlock.getNumSamples();
+
+        jassert (inputBlock.getNumChannels() == numChannels);
+        jassert (inputBlock.getNumSamples()  == numSamples);
+
+        outputBlock.copyFrom (inputBlock);
+
+        if (! enabled || context.isBypassed)
+            return;
+
+        if (numChannels == 1 || numChannels == 2)
+            processInPlace (outputBlock);
+        else
+            jassertfalse;   // invalid channel configuration
+    }
+
+private:
+    //==============================================================================
+    static constexpr int maxDelayLines = 16;
+
+   #if JUCE_USE_SIMD
+    static constexpr size_t lineAlignment = SIMDRegister<SampleType>::SIMDRegisterSize;
+   #else
+    static constexpr size_t lineAlignment = alignof (SampleType);
+   #endif
+
+    /** One value per delay line, aligned so that it can be loaded into SIMD registers. */
+    struct alignas (lineAlignment) LineValues
+    {
+        SampleType operator[] (size_t i) const noexcept     { return values[i]; }
+        SampleType& operator[] (size_t i) noexcept          { return values[i]; }
+
+        SampleType values[maxDelayLines] = {};
+    };
+
+    //==============================================================================
+    void update();
+    void processInPlace (AudioBlock<SampleType>&) noexcept;
+    void computeDelayTimes() noexcept;
+    void filterAndMix (SampleType& wetLeft, SampleType& wetRight) noexcept;
+    void advanceModulation() noexcept;
+    void normaliseModulation() noexcept;
+
+    //==============================================================================
+    Parameters parameters;
+    int numLines;
+    MixingMatrix matrix;
+
+    AudioBuffer<SampleType> delayBuffer;
+    int delayBufferMask = 0, writePosition = 0;
+
+    LineValues baseDelays, delayTimes, lineOutputs, decayCoeffA, decayCoeffB, decayState, mixed,
+               outputTapsLeft, outputTapsRight, modSin, modCos, modRotSin, modRotCos;
+
+    std::array<LineValues, maxDelayLines> hadamardColumns;
+
+    SmoothedValue<SampleType, ValueSmoothingTypes::Linear> sizeScale, wetGain1, wetGain2, dryGain;
+    SampleType modDepthSamples = 0, inputGain = 0;
+    double sampleRate = 44100.0;
+    bool enabled = true;
+
+    static constexpr double minDelayMs = 23.0, maxDelayMs = 97.0, maxModulationMs = 1.5;
+};
+
+} // namespace juce::dsp
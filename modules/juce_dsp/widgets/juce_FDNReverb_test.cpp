@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+class FDNReverbTests final : public UnitTest
+{
+public:
+    FDNReverbTests()
+        : UnitTest ("FDNReverb", UnitTestCategories::dsp)
+    {}
+
+    void runTest() override
+    {
+        for (auto numLines : { 8, 16 })
+        {
+            for (auto matrix : { FDNReverb<float>::MixingMatrix::hadamard, FDNReverb<float>::MixingMatrix::householder })
+            {
+                const auto description = String (numLines) + " lines, "
+                                + (matrix == FDNReverb<float>::MixingMatrix::hadamard ? "Hadamard" : "Householder");
+
+                beginTest ("Impulse response decays at the requested rate: " + description);
+                {
+                    constexpr auto sampleRate = 48000.0;
+                    constexpr auto decayTime = 1.0f;
+
+                    FDNReverb<float> reverb (numLines, matrix);
+
+                    FDNReverb<float>::Parameters params;
+                    params.decayTime = decayTime;
+                    params.damping = 0.0f;
+                    params.modulationDepth = 0.0f;
+                    params.wetLevel = 1.0f;
+                    params.dryLevel = 0.0f;
+                    reverb.setParameters (params);
+                    reverb.prepare ({ sampleRate, 512, 2 });
+
+                    AudioBuffer<float> buffer (2, (int) sampleRate);
+                    buffer.clear();
+                    buffer.setSample (0, 0, 1.0f);
+                    buffer.setSample (1, 0, 1.0f);
+
+                    AudioBlock<float> block (buffer);
+
+                    for (size_t start = 0; start < block.getNumSamples(); start += 512)
+                    {
+                        auto subBlock = block.getSubBlock (start, jmin ((size_t) 512, block.getNumSamples() - start));
+                        reverb.process (ProcessContextReplacing<float> (subBlock));
+                    }
+
+                    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                    {
+                        const auto early = buffer.getRMSLevel (channel, (int) (0.2 * sampleRate), (int) (0.1 * sampleRate));
+                        const auto late  = buffer.getRMSLevel (channel, (int) (0.7 * sampleRate), (int) (0.1 * sampleRate));
+
+                        expect (std::isfinite (early) && std::isfinite (late));
+                        expect (early > 0.0f);
+
+                        // 60 dB per second, over half a second
+                        expectWithinAbsoluteError (Decibels::gainToDecibels (late / early), -30.0f, 6.0f);
+                    }
+                }
+            }
+        }
+
+        beginTest ("A disabled or fully dry reverb doesn't alter the signal");
+        {
+            FDNReverb<double> reverb;
+
+            FDNReverb<double>::Parameters params;
+            params.wetLevel = 0.0f;
+            params.dryLevel = 1.0f;
+            reverb.setParameters (params);
+            reverb.prepare ({ 44100.0, 256, 1 });
+
+            AudioBuffer<double> buffer (1, 256);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (0, i, std::sin ((double) i * 0.1));
+
+            AudioBuffer<double> original (buffer);
+            AudioBlock<double> block (buffer);
+            reverb.process (ProcessContextReplacing<double> (block));
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                expectWithinAbsoluteError (buffer.getSample (0, i), original.getSample (0, i), 1.0e-9);
+
+            params.wetLevel = 1.0f;
+            reverb.setParameters (params);
+            reverb.setEnabled (false);
+            reverb.process (ProcessContextReplacing<double> (block));
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                expectEquals (buffer.getSample (0, i), original.getSample (0, i));
+        }
+    }
+};
+
+static FDNReverbTests fdnReverbTests;
+
+} // namespace juce::dsp
@@ -0,0 +1,284 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+//==============================================================================
+template <typename SampleType>
+void LookAheadLimiter<SampleType>::setThreshold (SampleType newThresholddB)
+{
+    thresholddB = newThresholddB;
+    update();
+}
+
+template <typename SampleType>
+void LookAheadLimiter<SampleType>::setRelease (SampleType newReleaseMs)
+{
+    jassert (newReleaseMs > 0);
+
+    releaseTime = newReleaseMs;
+    update();
+}
+
+template <typename SampleType>
+void LookAheadLimiter<SampleType>::setLookAhead (SampleType newLookAheadMs)
+{
+    jassert (newLookAheadMs >= 0);
+
+    lookAheadTime = newLookAheadMs;
+}
+
+//==============================================================================
+template <typename SampleType>
+void LookAheadLimiter<SampleType>::prepare (const ProcessSpec& spec)
+{
+    jassert (spec.sampleRate > 0);
+    jassert (spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    maximumBlockSize = (int) spec.maximumBlockSize;
+    lookAheadSamples = roundToInt ((double) lookAheadTime * sampleRate / 1000.0);
+    windowSize = lookAheadSamples + 1;
+
+    const auto numChannels = (int) spec.numChannels;
+
+    history    .setSize (numChannels, historySize + maximumBlockSize, false, false, true);
+    delayBuffer.setSize (numChannels, getLatencyInSamples(), false, false, true);
+
+    peaks  .allocate ((size_t) maximumBlockSize, false);
+    scratch.allocate ((size_t) maximumBlockSize, false);
+    gains  .allocate ((size_t) maximumBlockSize, false);
+
+    windowValues .allocate ((size_t) windowSize, false);
+    windowIndices.allocate ((size_t) windowSize, false);
+    averageValues.allocate ((size_t) windowSize, false);
+
+    // The interpolator is a Kaiser-windowed sinc, split into one polyphase branch per
+    // oversampled position, each normalised to unity gain at DC. With an even number of
+    // taps the sinc is never evaluated at zero.
+    constexpr auto numTaps = oversamplingFactor * tapsPerPhase;
+    std::array<double, (size_t) numTaps> prototype;
+    WindowingFunction<double>::fillWindowingTables (prototype.data(), (size_t) numTaps,
+                                                    WindowingFunction<double>::kaiser, false, 8.0);
+
+    for (int i = 0; i < numTaps; ++i)
+    {
+        const auto x = MathConstants<double>::pi * ((double) i - (numTaps - 1) * 0.5) / (double) oversamplingFactor;
+        prototype[(size_t) i] *= std::sin (x) / x;
+    }
+
+    for (int phase = 0; phase < oversamplingFactor; ++phase)
+    {
+        double sum = 0;
+
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+            sum += prototype[(size_t) (tap * oversamplingFactor + phase)];
+
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+        {
+            const auto index = (size_t) (tap * oversamplingFactor + phase);
+            interpolationCoefficients[index] = (SampleType) (prototype[index] / sum);
+        }
+    }
+
+    update();
+    reset();
+}
+
+template <typename SampleType>
+void LookAheadLimiter<SampleType>::reset()
+{
+    history.clear();
+    delayBuffer.clear();
+    delayPosition = 0;
+
+    windowHead = 0;
+    windowCount = 0;
+    sampleCounter = 0;
+
+    for (int i = 0; i < windowSize; ++i)
+        averageValues[i] = (SampleType) 1;
+
+    averagePosition = 0;
+    averageSum = (double) windowSize;
+    releasedGain = 1;
+}
+
+//==============================================================================
+template <typename SampleType>
+void LookAheadLimiter<SampleType>::update()
+{
+    threshold = Decibels::decibelsToGain (thresholddB, (SampleType) -200.0);
+    releaseCoefficient = (SampleType) std::exp (-1.0 / ((double) releaseTime * sampleRate / 1000.0));
+}
+
+//==============================================================================
+template <typename SampleType>
+void LookAheadLimiter<SampleType>::processBlock (const AudioBlock<const SampleType>& input,
+                                                 const AudioBlock<SampleType>& output,
+                                                 bool bypassed) noexcept
+{
+    const auto numSamples = input.getNumSamples();
+
+    if (! bypassed)
+    {
+        detectPeaks (input);
+        computeGains (numSamples);
+    }
+
+    applyDelay (input, output);
+
+    if (! bypassed)
+        for (size_t channel = 0; channel < output.getNumChannels(); ++channel)
+            FloatVectorOperations::multiply (output.getChannelPointer (channel), gains.get(), numSamples);
+}
+
+template <typename SampleType>
+void LookAheadLimiter<SampleType>::detectPeaks (const AudioBlock<const SampleType>& input) noexcept
+{
+    const auto numChannels = input.getNumChannels();
+    const auto numSamples  = input.getNumSamples();
+
+    FloatVectorOperations::clear (peaks.get(), numSamples);
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        // The history buffer holds the last few samples of the previous block, followed by this block
+        auto* extended = history.getWritePointer ((int) channel);
+        FloatVectorOperations::copy (extended + historySize, input.getChannelPointer (channel), numSamples);
+
+        FloatVectorOperations::abs (scratch.get(), extended + historySize - detectorDelay, numSamples);
+        FloatVectorOperations::max (peaks.get(), peaks.get(), scratch.get(), numSamples);
+
+        if (truePeak)
+        {
+            for (int phase = 0; phase < oversamplingFactor; ++phase)
+            {
+                FloatVectorOperations::clear (scratch.get(), numSamples);
+
+                for (int tap = 0; tap < tapsPerPhase; ++tap)
+                    FloatVectorOperations::addWithMultiply (scratch.get(),
+                                                            extended + historySize - tap,
+                                                            interpolationCoefficients[(size_t) (tap * oversamplingFactor + phase)],
+                                                            numSamples);
+
+                FloatVectorOperations::abs (scratch.get(), scratch.get(), numSamples);
+                FloatVectorOperations::max (peaks.get(), peaks.get(), scratch.get(), numSamples);
+            }
+        }
+
+        // The ranges overlap when the block is shorter than the history
+        std::memmove (extended, extended + numSamples, (size_t) historySize * sizeof (SampleType));
+    }
+}
+
+template <typename SampleType>
+void LookAheadLimiter<SampleType>::computeGains (size_t numSamples) noexcept
+{
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const auto peak = peaks[i];
+        const auto required = peak > threshold ? threshold / peak : (SampleType) 1;
+
+        // Sliding window minimum of the required gain over the look-ahead period, using a
+        // monotonic queue so that each sample is pushed and popped at most once
+        if (windowCount > 0 && windowIndices[windowHead] <= sampleCounter - windowSize)
+        {
+            windowHead = (windowHead + 1) % windowSize;
+            --windowCount;
+        }
+
+        while (windowCount > 0 && windowValues[(windowHead + windowCount - 1) % windowSize] >= required)
+            --windowCount;
+
+        const auto back = (windowHead + windowCount) % windowSize;
+        windowValues[back] = required;
+        windowIndices[back] = sampleCounter++;
+        ++windowCount;
+
+        const auto minimum = windowValues[windowHead];
+
+        releasedGain = minimum < releasedGain ? minimum
+                                              : minimum + releaseCoefficient * (releasedGain - minimum);
+
+        // Averaging the held gain over the same window makes the gain reduction ramp down
+        // smoothly, while still reaching the required value by the time the peak is output
+        averageSum += (double) releasedGain - (double) averageValues[averagePosition];
+        averageValues[averagePosition] = releasedGain;
+        averagePosition = (averagePosition + 1) % windowSize;
+
+        gains[i] = jmin ((SampleType) (averageSum / (double) windowSize), (SampleType) 1);
+    }
+
+    // Recalculate the running sum to stop rounding errors from accumulating
+    averageSum = 0;
+
+    for (int i = 0; i < windowSize; ++i)
+        averageSum += (double) averageValues[i];
+}
+
+template <typename SampleType>
+void LookAheadLimiter<SampleType>::applyDelay (const AudioBlock<const SampleType>& input,
+                                               const AudioBlock<SampleType>& output) noexcept
+{
+    const auto numSamples = (int) input.getNumSamples();
+    const auto delaySize  = delayBuffer.getNumSamples();
+
+    if (delaySize == 0)
+    {
+        output.copyFrom (input);
+        return;
+    }
+
+    int position = delayPosition;
+
+    for (int start = 0; start < numSamples;)
+    {
+        const auto length = jmin (numSamples - start, delaySize - position);
+
+        for (size_t channel = 0; channel < input.getNumChannels(); ++channel)
+        {
+            auto* delayed = delayBuffer.getWritePointer ((int) channel, position);
+
+            // The input and output may be the same buffer, so go via the scratch space
+            FloatVectorOperations::copy (scratch.get(), input.getChannelPointer (channel) + start, length);
+            FloatVectorOperations::copy (output.getChannelPointer (channel) + start, delayed, length);
+            FloatVectorOperations::copy (delayed, scratch.get(), length);
+        }
+
+        start += length;
+        position = (position + length) % delaySize;
+    }
+
+    delayPosition = position;
+}
+
+//==============================================================================
+template class LookAheadLimiter<float>;
+template class LookAheadLimiter<double>;
+
+} // namespace juce::dsp
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+/**
+    A look-ahead brickwall limiter with optional true-peak detection, suitable for
+    use at the end of a mastering chain.
+
+    The input is delayed by the look-ahead time, so that the gain reduction needed
+    for an upcoming peak can be faded in before that peak reaches the output. The
+    peaks are detected with a 4x polyphase interpolator (in the spirit of
+    ITU-R BS.1770), so that inter-sample peaks are caught as well. The detection
+    is linked across all channels.
+
+    The processor introduces a fixed latency, which is returned by
+    getLatencyInSamples() and should be reported to the host. Unlike the simpler
+    Limiter class, changing the look-ahead time requires prepare() to be called
+    again.
+
+    @see Limiter
+
+    @tags{DSP}
+*/
+template <typename SampleType>
+class LookAheadLimiter
+{
+public:
+    //==============================================================================
+    /** Constructor. */
+    LookAheadLimiter() = default;
+
+    //==============================================================================
+    /** Sets the threshold in dB above which no peak may go. */
+    void setThreshold (SampleType newThresholddB);
+
+    /** Sets the release time in milliseconds of the limiter. */
+    void setRelease (SampleType newReleaseMs);
+
+    /** Sets the look-ahead time in milliseconds of the limiter.
+        This will only take effect the next time prepare() is called, as it changes
+        the latency of the processor.
+    */
+    void setLookAhead (SampleType newLookAheadMs);
+
+    /** Enables or disables detection of inter-sample peaks. When disabled, only the
+        sample values are used, which is cheaper. This doesn't change the latency.
+    */
+    void setTruePeakDetection (bool shouldUseTruePeak) noexcept     { truePeak = shouldUseTruePeak; }
+
+    /** Returns the latency in samples introduced by the processor. */
+    int getLatencyInSamples() const noexcept                        { return lookAheadSamples + detectorDelay; }
+
+    //==============================================================================
+    /** Initialises the processor. */
+    void prepare (const ProcessSpec& spec);
+
+    /** Resets the internal state variables of the processor. */
+    void reset();
+
+    //==============================================================================
+    /** Processes the input and output samples supplied in the processing context.
+
+        If the context is bypassed, the signal is still delayed by the latency of the
+        processor, so that bypassing doesn't cause a jump in time.
+    */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock      = context.getOutputBlock();
+        const auto numSamples  = outputBlock.getNumSamples();
+
+        jassert (inputBlock.getNumChannels() == outputBlock.getNumChannels());
+        jassert (inputBlock.getNumChannels() == (size_t) delayBuffer.getNumChannels());
+        jassert (inputBlock.getNumSamples()  == numSamples);
+
+        for (size_t start = 0; start < numSamples; start += (size_t) maximumBlockSize)
+        {
+            const auto length = jmin ((size_t) maximumBlockSize, numSamples - start);
+            processBlock (inputBlock.getSubBlock (start, length),
+                          outputBlock.getSubBlock (start, length),
+                          context.isBypassed);
+        }
+    }
+
+private:
+    //==============================================================================
+    void update();
+    void processBlock (const AudioBlock<const SampleType>&, const AudioBlock<SampleType>&, bool bypassed) noexcept;
+    void detectPeaks (const AudioBlock<const SampleType>&) noexcept;
+    void computeGains (size_t numSamples) noexcept;
+    void applyDelay (const AudioBlock<const SampleType>&, const AudioBlock<SampleType>&) noexcept;
+
+    //==============================================================================
+    static constexpr int oversamplingFactor = 4, tapsPerPhase = 12,
+                         historySize = tapsPerPhase - 1, detectorDelay = tapsPerPhase / 2;
+
+    std::array<SampleType, (size_t) (oversamplingFactor * tapsPerPhase)> interpolationCoefficients {};
+
+    AudioBuffer<SampleType> history, delayBuffer;
+    HeapBlock<SampleType> peaks, scratch, gains, windowValues, averageValues;
+    HeapBlock<int64> windowIndices;
+
+    int maximumBlockSize = 0, lookAheadSamples = 0, windowSize = 1, delayPosition = 0;
+    int windowHead = 0, windowCount = 0, averagePosition = 0;
+    int64 sampleCounter = 0;
+    double averageSum = 0;
+    SampleType releasedGain = 1, releaseCoefficient = 0, threshold = 1;
+
+    double sampleRate = 44100.0;
+    SampleType thresholddB = (SampleType) -0.3, releaseTime = (SampleType) 100.0, lookAheadTime = (SampleType) 5.0;
+    bool truePeak = true;
+};
+
+} // namespace juce::dsp
@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2022 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 7 End-User License
+   Agreement and JUCE Privacy Policy.
+
+   End User License Agreement: www.juce.com/juce-7-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce::dsp
+{
+
+class LookAheadLimiterTests final : public UnitTest
+{
+public:
+    LookAheadLimiterTests()
+        : UnitTest ("LookAheadLimiter", UnitTestCategories::dsp)
+    {}
+
+    void runTest() override
+    {
+        constexpr auto sampleRate = 44100.0;
+        constexpr auto blockSize = 256;
+
+        const auto processInBlocks = [] (LookAheadLimiter<float>& limiter, AudioBuffer<float>& buffer)
+        {
+            AudioBlock<float> block (buffer);
+
+            for (size_t start = 0; start < block.getNumSamples(); start += blockSize)
+            {
+                auto subBlock = block.getSubBlock (start, jmin ((size_t) blockSize, block.getNumSamples() - start));
+                limiter.process (ProcessContextReplacing<float> (subBlock));
+            }
+        };
+
+        beginTest ("Signals below the threshold are only delayed");
+        {
+            LookAheadLimiter<float> limiter;
+            limiter.setThreshold (-1.0f);
+            limiter.setLookAhead (2.0f);
+            limiter.prepare ({ sampleRate, (uint32) blockSize, 2 });
+
+            const auto latency = limiter.getLatencyInSamples();
+            expect (latency > roundToInt (2.0 * sampleRate / 1000.0));
+
+            AudioBuffer<float> buffer (2, 4096);
+            auto random = getRandom();
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    buffer.setSample (channel, i, (random.nextFloat() * 2.0f - 1.0f) * 0.1f);
+
+            AudioBuffer<float> original (buffer);
+            processInBlocks (limiter, buffer);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            {
+                for (int i = 0; i < latency; ++i)
+                    expectEquals (buffer.getSample (channel, i), 0.0f);
+
+                for (int i = latency; i < buffer.getNumSamples(); ++i)
+                    expectEquals (buffer.getSample (channel, i), original.getSample (channel, i - latency));
+            }
+        }
+
+        beginTest ("Peaks never exceed the threshold");
+        {
+            for (auto truePeak : { false, true })
+            {
+                LookAheadLimiter<float> limiter;
+                limiter.setThreshold (-6.0f);
+                limiter.setRelease (50.0f);
+                limiter.setTruePeakDetection (truePeak);
+                limiter.prepare ({ sampleRate, (uint32) blockSize, 1 });
+
+                AudioBuffer<float> buffer (1, 16384);
+
+                // A sine at a quarter of the sample rate with a phase offset has
+                // inter-sample peaks well above its sample peaks
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    buffer.setSample (0, i, 2.0f * std::sin (MathConstants<float>::halfPi * (float) i + 0.785f)
+                                          * (i % 3000 < 1500 ? 1.0f : 0.25f));
+
+                processInBlocks (limiter, buffer);
+
+                const auto threshold = Decibels::decibelsToGain (-6.0f);
+                const auto samplePeak = buffer.getMagnitude (0, 0, buffer.getNumSamples());
+
+                expectLessOrEqual (samplePeak, threshold * 1.001f);
+
+                if (truePeak)
+                {
+                    // Reconstruct the waveform half way between samples
+                    auto truePeakEstimate = 0.0f;
+
+                    for (int i = 1; i < buffer.getNumSamples() - 2; ++i)
+                    {
+                        const auto* data = buffer.getReadPointer (0, i - 1);
+                        const auto midpoint = (-data[0] + 9.0f * data[1] + 9.0f * data[2] - data[3]) / 16.0f;
+                        truePeakEstimate = jmax (truePeakEstimate, std::abs (midpoint));
+                    }
+
+                    expectLessOrEqual (truePeakEstimate, threshold * 1.05f);
+                }
+            }
+        }
+
+        beginTest ("Blocks shorter than the detector's history give the same result as longer ones");
+        {
+            AudioBuffer<float> input (2, 4096);
+            auto random = getRandom();
+
+            for (int channel = 0; channel < input.getNumChannels(); ++channel)
+                for (int i = 0; i < input.getNumSamples(); ++i)
+                    input.setSample (channel, i, (random.nextFloat() * 2.0f - 1.0f) * (i % 1000 < 500 ? 2.0f : 0.5f));
+
+            const auto makeLimiter = []
+            {
+                auto limiter = std::make_unique<LookAheadLimiter<float>>();
+                limiter->setThreshold (-3.0f);
+                limiter->setRelease (20.0f);
+                limiter->prepare ({ sampleRate, (uint32) blockSize, 2 });
+                return limiter;
+            };
+
+            AudioBuffer<float> expected (input);
+            processInBlocks (*makeLimiter(), expected);
+
+            AudioBuffer<float> output (input);
+            auto limiter = makeLimiter();
+            AudioBlock<float> block (output);
+
+            for (size_t start = 0, length = 1; start < block.getNumSamples(); start += length, length = length % 7 + 1)
+            {
+                auto subBlock = block.getSubBlock (start, jmin (length, block.getNumSamples() - start));
+                limiter->process (ProcessContextReplacing<float> (subBlock));
+            }
+
+            for (int channel = 0; channel < output.getNumChannels(); ++channel)
+                for (int i = 0; i < output.getNumSamples(); ++i)
+                    expectWithinAbsoluteError (output.getSample (channel, i), expected.getSample (channel, i), 1.0e-5f);
+        }
+    }
+};
+
+static LookAheadLimiterTests lookAheadLimiterTests;
+
+} // namespace juce::dsp
@@ -29,6 +29,11 @@ namespace juce::dsp
 /**
     Processor wrapper around juce::Reverb for easy integration into ProcessorChain.
 
+    For a denser, modulated reverb that's cheaper to run on many tracks at once,
+    see FDNReverb.
+
+    @see FDNReverb
+
     @tags{DSP}
 */
 class Reverb